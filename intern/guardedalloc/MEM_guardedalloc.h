@@ -233,6 +233,14 @@ void MEM_enable_fail_on_memleak(void);
  * NOTE: The switch between allocator types can only happen before any allocation did happen. */
 void MEM_use_lockfree_allocator(void);
 
+/* Serve small blocks of the lock-free allocator from size classes with per-thread caches.
+ *
+ * Speeds up workloads which do many small allocations from multiple threads, at the cost of
+ * keeping freed small blocks around for reuse instead of returning them to the system.
+ *
+ * NOTE: Unlike the allocator type, this can be changed at any time. */
+void MEM_enable_lockfree_size_classes(bool enable);
+
 /* Switch allocator to slow fully guarded mode.
  *
  * Use for debug purposes. This allocator contains lock section around every allocator call, which
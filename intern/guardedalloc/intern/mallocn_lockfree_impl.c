@@ -26,6 +26,8 @@
 #include <string.h> /* memcpy */
 #include <sys/types.h>
 
+#include <pthread.h>
+
 #include "MEM_guardedalloc.h"
 
 /* to ensure strict conversions */
@@ -52,12 +54,17 @@ static void (*error_callback)(const char *) = NULL;
 
 enum {
   MEMHEAD_ALIGN_FLAG = 1,
+  /* Block is owned by the size class allocator. */
+  MEMHEAD_SIZE_CLASS_FLAG = 2,
 };
 
+#define MEMHEAD_FLAGS_MASK ((size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_SIZE_CLASS_FLAG))
+
 #define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
 #define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
 #define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
 #define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_IS_SIZE_CLASS(memhead) ((memhead)->len & (size_t)MEMHEAD_SIZE_CLASS_FLAG)
 
 /* Uncomment this to have proper peak counter. */
 #define USE_ATOMIC_MAX
@@ -90,10 +97,261 @@ print_error(const char *str, ...)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Size Class Allocator
+ *
+ * Optional allocator for small blocks, enabled with #MEM_enable_lockfree_size_classes().
+ *
+ * Blocks (including their #MemHead) are rounded up to a multiple of #SIZE_CLASS_GRANULARITY
+ * and carved out of slabs which are requested from the system allocator. Every thread keeps a
+ * free list per size class, so the common allocation and free path does not touch any shared
+ * state apart from the memory counters.
+ *
+ * Blocks are not tied to the thread that allocated them: a block freed from another thread goes
+ * to the cache of the freeing thread. When a thread cache grows past its limit, a batch of blocks
+ * is handed back to the central free list of the size class at once, and an empty thread cache is
+ * refilled with a whole batch, which keeps the lock of the central list off the hot path.
+ *
+ * Slab memory is never given back to the system, it is reused for blocks of the same size class.
+ * \{ */
+
+#define SIZE_CLASS_GRANULARITY 16
+/* Largest block (including #MemHead) served from size classes. */
+#define SIZE_CLASS_MAX_BLOCK_SIZE 1024
+#define SIZE_CLASS_NUM (SIZE_CLASS_MAX_BLOCK_SIZE / SIZE_CLASS_GRANULARITY)
+#define SIZE_CLASS_SLAB_SIZE (64 * 1024)
+/* Amount of memory moved between thread and central lists at once. */
+#define SIZE_CLASS_BATCH_BYTES (8 * 1024)
+
+#ifdef _MSC_VER
+#  define SIZE_CLASS_THREAD_LOCAL __declspec(thread)
+#else
+#  define SIZE_CLASS_THREAD_LOCAL __thread
+#endif
+
+/* Free block, overlaps the #MemHead and the start of the data. */
+typedef struct SizeClassBlock {
+  struct SizeClassBlock *next;
+} SizeClassBlock;
+
+typedef struct SizeClassFreeList {
+  SizeClassBlock *first;
+  unsigned int num_blocks;
+} SizeClassFreeList;
+
+typedef struct SizeClassThreadCache {
+  SizeClassFreeList lists[SIZE_CLASS_NUM];
+} SizeClassThreadCache;
+
+typedef struct SizeClassCentral {
+  pthread_mutex_t mutex;
+  SizeClassFreeList list;
+  /* Unused part of the last slab. */
+  char *slab_cursor;
+  char *slab_end;
+} SizeClassCentral;
+
+static bool use_size_classes = false;
+/* Memory of all slabs, reported in statistics. */
+static size_t size_class_slab_mem = 0;
+
+static SizeClassCentral size_class_central[SIZE_CLASS_NUM];
+static pthread_once_t size_class_init_once = PTHREAD_ONCE_INIT;
+static pthread_key_t size_class_thread_key;
+static SIZE_CLASS_THREAD_LOCAL SizeClassThreadCache *size_class_thread_cache = NULL;
+
+/* Index of the size class for the given (already aligned) length of the data. */
+MEM_INLINE unsigned int size_class_index(size_t len)
+{
+  return (unsigned int)((len + sizeof(MemHead) - 1) / SIZE_CLASS_GRANULARITY);
+}
+
+MEM_INLINE size_t size_class_block_size(unsigned int index)
+{
+  return (size_t)(index + 1) * SIZE_CLASS_GRANULARITY;
+}
+
+MEM_INLINE unsigned int size_class_batch_size(unsigned int index)
+{
+  const size_t batch_size = SIZE_CLASS_BATCH_BYTES / size_class_block_size(index);
+  return (unsigned int)(batch_size < 8 ? 8 : batch_size);
+}
+
+/* Move up to `num_blocks` blocks from the start of `src` to the start of `dst`. */
+static void size_class_list_move(SizeClassFreeList *dst,
+                                 SizeClassFreeList *src,
+                                 unsigned int num_blocks)
+{
+  if (num_blocks > src->num_blocks) {
+    num_blocks = src->num_blocks;
+  }
+  if (num_blocks == 0) {
+    return;
+  }
+
+  SizeClassBlock *first = src->first;
+  SizeClassBlock *last = first;
+  for (unsigned int i = 1; i < num_blocks; i++) {
+    last = last->next;
+  }
+
+  src->first = last->next;
+  src->num_blocks -= num_blocks;
+  last->next = dst->first;
+  dst->first = first;
+  dst->num_blocks += num_blocks;
+}
+
+static void size_class_release_batch(SizeClassFreeList *list,
+                                     unsigned int index,
+                                     unsigned int num_blocks)
+{
+  SizeClassCentral *central = &size_class_central[index];
+
+  pthread_mutex_lock(&central->mutex);
+  size_class_list_move(&central->list, list, num_blocks);
+  pthread_mutex_unlock(&central->mutex);
+}
+
+static void size_class_thread_cache_free(void *cache_v)
+{
+  SizeClassThreadCache *cache = (SizeClassThreadCache *)cache_v;
+
+  for (unsigned int index = 0; index < SIZE_CLASS_NUM; index++) {
+    SizeClassFreeList *list = &cache->lists[index];
+    size_class_release_batch(list, index, list->num_blocks);
+  }
+
+  if (size_class_thread_cache == cache) {
+    size_class_thread_cache = NULL;
+  }
+  free(cache);
+}
+
+static void size_class_init(void)
+{
+  for (unsigned int index = 0; index < SIZE_CLASS_NUM; index++) {
+    pthread_mutex_init(&size_class_central[index].mutex, NULL);
+  }
+  /* Hand blocks of exiting threads back to the central lists. */
+  pthread_key_create(&size_class_thread_key, size_class_thread_cache_free);
+}
+
+static SizeClassThreadCache *size_class_thread_cache_get(void)
+{
+  SizeClassThreadCache *cache = size_class_thread_cache;
+
+  if (UNLIKELY(cache == NULL)) {
+    pthread_once(&size_class_init_once, size_class_init);
+    cache = (SizeClassThreadCache *)calloc(1, sizeof(SizeClassThreadCache));
+    if (cache == NULL) {
+      return NULL;
+    }
+    pthread_setspecific(size_class_thread_key, cache);
+    size_class_thread_cache = cache;
+  }
+
+  return cache;
+}
+
+/* Fill an empty thread list with a batch of blocks. */
+static bool size_class_refill(SizeClassFreeList *list, unsigned int index)
+{
+  SizeClassCentral *central = &size_class_central[index];
+  const size_t block_size = size_class_block_size(index);
+  const unsigned int batch_size = size_class_batch_size(index);
+
+  pthread_mutex_lock(&central->mutex);
+
+  size_class_list_move(list, &central->list, batch_size);
+
+  while (list->num_blocks < batch_size) {
+    if (central->slab_cursor + block_size > central->slab_end) {
+      char *slab = (char *)malloc(SIZE_CLASS_SLAB_SIZE);
+      if (slab == NULL) {
+        break;
+      }
+      atomic_add_and_fetch_z(&size_class_slab_mem, SIZE_CLASS_SLAB_SIZE);
+      central->slab_cursor = slab;
+      central->slab_end = slab + SIZE_CLASS_SLAB_SIZE;
+    }
+
+    SizeClassBlock *block = (SizeClassBlock *)central->slab_cursor;
+    central->slab_cursor += block_size;
+    block->next = list->first;
+    list->first = block;
+    list->num_blocks++;
+  }
+
+  pthread_mutex_unlock(&central->mutex);
+
+  return list->first != NULL;
+}
+
+/* Returns NULL when the block is to be allocated by the system allocator. */
+MEM_INLINE MemHead *size_class_alloc(size_t len)
+{
+  if (!use_size_classes || len + sizeof(MemHead) > SIZE_CLASS_MAX_BLOCK_SIZE) {
+    return NULL;
+  }
+
+  SizeClassThreadCache *cache = size_class_thread_cache_get();
+  if (UNLIKELY(cache == NULL)) {
+    return NULL;
+  }
+
+  const unsigned int index = size_class_index(len);
+  SizeClassFreeList *list = &cache->lists[index];
+  if (UNLIKELY(list->first == NULL) && !size_class_refill(list, index)) {
+    return NULL;
+  }
+
+  SizeClassBlock *block = list->first;
+  list->first = block->next;
+  list->num_blocks--;
+
+  MemHead *memh = (MemHead *)block;
+  memh->len = len | (size_t)MEMHEAD_SIZE_CLASS_FLAG;
+  return memh;
+}
+
+static void size_class_free(MemHead *memh, size_t len)
+{
+  const unsigned int index = size_class_index(len);
+  SizeClassThreadCache *cache = size_class_thread_cache_get();
+
+  if (UNLIKELY(cache == NULL)) {
+    /* Can only happen when out of memory, give the block back to the central list directly. */
+    SizeClassFreeList list = {(SizeClassBlock *)memh, 1};
+    ((SizeClassBlock *)memh)->next = NULL;
+    size_class_release_batch(&list, index, 1);
+    return;
+  }
+
+  SizeClassFreeList *list = &cache->lists[index];
+  SizeClassBlock *block = (SizeClassBlock *)memh;
+  block->next = list->first;
+  list->first = block;
+  list->num_blocks++;
+
+  const unsigned int batch_size = size_class_batch_size(index);
+  if (UNLIKELY(list->num_blocks > 2 * batch_size)) {
+    size_class_release_batch(list, index, batch_size);
+  }
+}
+
+void MEM_enable_lockfree_size_classes(bool enable)
+{
+  /* Blocks remember where they come from, so this is safe to change at any time. */
+  use_size_classes = enable;
+}
+
+/** \} */
+
 size_t MEM_lockfree_allocN_len(const void *vmemh)
 {
   if (vmemh) {
-    return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t)(MEMHEAD_ALIGN_FLAG));
+    return MEMHEAD_FROM_PTR(vmemh)->len & ~MEMHEAD_FLAGS_MASK;
   }
 
   return 0;
@@ -126,6 +384,9 @@ void MEM_lockfree_freeN(void *vmemh)
     MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
     aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
   }
+  else if (MEMHEAD_IS_SIZE_CLASS(memh)) {
+    size_class_free(memh, len);
+  }
   else {
     free(memh);
   }
@@ -233,10 +494,18 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)calloc(1, len + sizeof(MemHead));
+  memh = size_class_alloc(len);
+  if (memh) {
+    memset(memh + 1, 0, len);
+  }
+  else {
+    memh = (MemHead *)calloc(1, len + sizeof(MemHead));
+    if (LIKELY(memh)) {
+      memh->len = len;
+    }
+  }
 
   if (LIKELY(memh)) {
-    memh->len = len;
     atomic_add_and_fetch_u(&totblock, 1);
     atomic_add_and_fetch_z(&mem_in_use, len);
     update_maximum(&peak_mem, mem_in_use);
@@ -274,14 +543,19 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)malloc(len + sizeof(MemHead));
+  memh = size_class_alloc(len);
+  if (memh == NULL) {
+    memh = (MemHead *)malloc(len + sizeof(MemHead));
+    if (LIKELY(memh)) {
+      memh->len = len;
+    }
+  }
 
   if (LIKELY(memh)) {
     if (UNLIKELY(malloc_debug_memset && len)) {
       memset(memh + 1, 255, len);
     }
 
-    memh->len = len;
     atomic_add_and_fetch_u(&totblock, 1);
     atomic_add_and_fetch_z(&mem_in_use, len);
     update_maximum(&peak_mem, mem_in_use);
@@ -384,6 +658,10 @@ void MEM_lockfree_printmemlist_stats(void)
 {
   printf("\ntotal memory len: %.3f MB\n", (double)mem_in_use / (double)(1024 * 1024));
   printf("peak memory len: %.3f MB\n", (double)peak_mem / (double)(1024 * 1024));
+  if (size_class_slab_mem) {
+    printf("size class slabs len: %.3f MB\n",
+           (double)size_class_slab_mem / (double)(1024 * 1024));
+  }
   printf(
       "\nFor more detailed per-block statistics run Blender with memory debugging command line "
       "argument.\n");
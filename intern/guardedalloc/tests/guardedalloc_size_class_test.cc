@@ -0,0 +1,142 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+#include "guardedalloc_test_base.h"
+
+namespace {
+
+class LockFreeSizeClassTest : public LockFreeAllocatorTest {
+ protected:
+  virtual void SetUp()
+  {
+    LockFreeAllocatorTest::SetUp();
+    MEM_enable_lockfree_size_classes(true);
+  }
+
+  virtual void TearDown()
+  {
+    MEM_enable_lockfree_size_classes(false);
+  }
+};
+
+/* Allocate blocks of every small size, fill them with a pattern and check nothing overlaps. */
+void DoAllocFreePattern(std::vector<void *> &blocks)
+{
+  for (size_t len = 1; len <= 1100; len += 7) {
+    unsigned char *ptr = (unsigned char *)MEM_mallocN(len, __func__);
+    memset(ptr, (int)(len & 0xff), len);
+    blocks.push_back(ptr);
+  }
+
+  size_t len = 1;
+  for (void *ptr : blocks) {
+    EXPECT_GE(MEM_allocN_len(ptr), len);
+    const unsigned char *data = (const unsigned char *)ptr;
+    for (size_t i = 0; i < len; i++) {
+      EXPECT_EQ(data[i], (unsigned char)(len & 0xff));
+    }
+    len += 7;
+  }
+}
+
+}  // namespace
+
+TEST_F(LockFreeSizeClassTest, MemoryAccounting)
+{
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  const unsigned int blocks_in_use = MEM_get_memory_blocks_in_use();
+
+  std::vector<void *> blocks;
+  DoAllocFreePattern(blocks);
+  EXPECT_GT(MEM_get_memory_in_use(), mem_in_use);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use + blocks.size());
+
+  for (void *ptr : blocks) {
+    MEM_freeN(ptr);
+  }
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use);
+}
+
+TEST_F(LockFreeSizeClassTest, CallocReallocN)
+{
+  /* Reused blocks have to be cleared again. */
+  char *ptr = (char *)MEM_mallocN(40, __func__);
+  memset(ptr, 0xff, 40);
+  MEM_freeN(ptr);
+
+  ptr = (char *)MEM_callocN(40, __func__);
+  for (int i = 0; i < 40; i++) {
+    EXPECT_EQ(ptr[i], 0);
+  }
+
+  memset(ptr, 3, 40);
+  ptr = (char *)MEM_recallocN(ptr, 2000);
+  EXPECT_EQ(MEM_allocN_len(ptr), 2000u);
+  for (int i = 0; i < 2000; i++) {
+    EXPECT_EQ(ptr[i], i < 40 ? 3 : 0);
+  }
+
+  ptr = (char *)MEM_reallocN(ptr, 20);
+  EXPECT_EQ(MEM_allocN_len(ptr), 20u);
+  for (int i = 0; i < 20; i++) {
+    EXPECT_EQ(ptr[i], 3);
+  }
+  MEM_freeN(ptr);
+}
+
+TEST_F(LockFreeSizeClassTest, ToggleWithBlocksInUse)
+{
+  void *pooled = MEM_mallocN(64, __func__);
+  MEM_enable_lockfree_size_classes(false);
+  void *system = MEM_mallocN(64, __func__);
+  MEM_enable_lockfree_size_classes(true);
+
+  MEM_freeN(system);
+  MEM_freeN(pooled);
+}
+
+TEST_F(LockFreeSizeClassTest, FreeFromOtherThreads)
+{
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  const int num_threads = 4;
+  const int num_blocks = 20000;
+
+  /* Every thread allocates blocks which are then freed by the next thread. */
+  std::vector<std::vector<void *>> blocks(num_threads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&blocks, i]() {
+      for (int j = 0; j < num_blocks; j++) {
+        int *ptr = (int *)MEM_mallocN(sizeof(int) * (size_t)(1 + j % 64), __func__);
+        ptr[0] = j;
+        blocks[i].push_back(ptr);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&blocks, i]() {
+      std::vector<void *> &thread_blocks = blocks[(i + 1) % num_threads];
+      for (int j = 0; j < num_blocks; j++) {
+        EXPECT_EQ(((int *)thread_blocks[j])[0], j);
+        MEM_freeN(thread_blocks[j]);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use);
+}
@@ -97,6 +97,12 @@ bool numaAPI_RunProcessOnNode(int node);
 // Returns truth if affinity has successfully changed.
 bool numaAPI_RunThreadOnNode(int node);
 
+// Allows the current thread to run on all nodes again, undoing the affinity
+// set by numaAPI_RunThreadOnNode().
+//
+// Returns truth if affinity has successfully changed.
+bool numaAPI_RunThreadOnAllNodes(void);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Memory management.
 
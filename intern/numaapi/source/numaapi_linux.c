@@ -276,6 +276,10 @@ bool numaAPI_RunThreadOnNode(int node) {
   return true;
 }
 
+bool numaAPI_RunThreadOnAllNodes(void) {
+  return numa_run_on_node(-1) == 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Memory management.
 
@@ -262,6 +262,41 @@ bool numaAPI_RunThreadOnNode(int node) {
   return true;
 }
 
+bool numaAPI_RunThreadOnAllNodes(void) {
+  // A thread is only scheduled on processors of a single group, so the thread
+  // stays in the group it is currently in and is allowed to run on all active
+  // processors of that group. On systems with more than 64 logical processors
+  // this means nodes of other groups are not used by this thread.
+  HANDLE thread_handle = GetCurrentThread();
+  GROUP_AFFINITY group_affinity = { 0 };
+  if (_GetThreadGroupAffinity(thread_handle, &group_affinity) == 0) {
+    return false;
+  }
+  const DWORD num_group_processors =
+      _GetActiveProcessorCount(group_affinity.Group);
+  if (num_group_processors == 0) {
+    return false;
+  }
+  if (num_group_processors >= sizeof(KAFFINITY) * 8) {
+    group_affinity.Mask = ~(KAFFINITY)0;
+  } else {
+    group_affinity.Mask = ((KAFFINITY)1 << num_group_processors) - 1;
+  }
+  // Respect the process affinity, which is only defined for processes that
+  // run in a single group (the mask is zero otherwise).
+  DWORD_PTR process_mask, system_mask;
+  if (GetProcessAffinityMask(GetCurrentProcess(),
+                             &process_mask,
+                             &system_mask) != 0 &&
+      (group_affinity.Mask & process_mask) != 0) {
+    group_affinity.Mask &= process_mask;
+  }
+  if (_SetThreadGroupAffinity(thread_handle, &group_affinity, NULL) == 0) {
+    return false;
+  }
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Memory management.
 
@@ -20,6 +20,7 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 
 #ifdef _MSC_VER
 #  include <iso646.h>
@@ -35,6 +36,11 @@
 #include <opensubdiv/osd/types.h>
 #include <opensubdiv/version.h>
 
+#ifdef WITH_TBB
+#  include <tbb/blocked_range.h>
+#  include <tbb/parallel_for.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "internal/base/type.h"
@@ -183,6 +189,59 @@ class ConstPatchCoordWrapperBuffer : public RawDataWrapperVertexBuffer<const Pat
   }
 };
 
+// CPU evaluator which evaluates stencils from multiple threads.
+//
+// Stencil tables are created with factorized intermediate levels, so every
+// stencil only references coarse vertices and all of them can be evaluated
+// independently. Patches are still evaluated by the regular CPU evaluator,
+// they are mostly requested one coordinate at a time.
+class ParallelCpuEvaluator : public CpuEvaluator {
+ public:
+  // Number of stencils evaluated by a single task.
+  static const int kStencilsGrainSize = 1024;
+
+  template<typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+  static bool EvalStencils(SRC_BUFFER *src_buffer,
+                           const BufferDescriptor &src_desc,
+                           DST_BUFFER *dst_buffer,
+                           const BufferDescriptor &dst_desc,
+                           const STENCIL_TABLE *stencil_table,
+                           const ParallelCpuEvaluator * /*instance*/ = NULL,
+                           void * /*device_context*/ = NULL)
+  {
+    const int num_stencils = stencil_table->GetNumStencils();
+    if (num_stencils == 0) {
+      return false;
+    }
+    const float *src = src_buffer->BindCpuBuffer();
+    float *dst = dst_buffer->BindCpuBuffer();
+    const int *sizes = &stencil_table->GetSizes()[0];
+    const int *offsets = &stencil_table->GetOffsets()[0];
+    const int *indices = &stencil_table->GetControlIndices()[0];
+    const float *weights = &stencil_table->GetWeights()[0];
+#ifdef WITH_TBB
+    if (num_stencils > kStencilsGrainSize) {
+      tbb::parallel_for(tbb::blocked_range<int>(0, num_stencils, kStencilsGrainSize),
+                        [&](const tbb::blocked_range<int> &range) {
+                          CpuEvaluator::EvalStencils(src,
+                                                     src_desc,
+                                                     dst,
+                                                     dst_desc,
+                                                     sizes,
+                                                     offsets,
+                                                     indices,
+                                                     weights,
+                                                     range.begin(),
+                                                     range.end());
+                        });
+      return true;
+    }
+#endif
+    return CpuEvaluator::EvalStencils(
+        src, src_desc, dst, dst_desc, sizes, offsets, indices, weights, 0, num_stencils);
+  }
+};
+
 template<typename EVAL_VERTEX_BUFFER,
          typename STENCIL_TABLE,
          typename PATCH_TABLE,
@@ -399,6 +458,11 @@ class VolatileEvalOutput {
     return face_varying_evaluators.size() != 0;
   }
 
+  int getFaceVaryingWidth() const
+  {
+    return face_varying_width_;
+  }
+
   void refine()
   {
     // Evaluate vertex positions.
@@ -538,6 +602,30 @@ class VolatileEvalOutput {
   DEVICE_CONTEXT *device_context_;
 };
 
+// Get pointer to contiguous elements of the given buffer. Strided elements are gathered into the
+// given storage, so that the evaluator buffer can be updated with a single call.
+const float *getContiguousData(const void *buffer,
+                               const int start_offset,
+                               const int stride,
+                               const int num_vertices,
+                               const int num_components,
+                               vector<float> *r_storage)
+{
+  const unsigned char *current_buffer = (const unsigned char *)buffer;
+  current_buffer += start_offset;
+  if (stride == num_components * (int)sizeof(float)) {
+    return reinterpret_cast<const float *>(current_buffer);
+  }
+  r_storage->resize(num_vertices * num_components);
+  float *dst = r_storage->data();
+  for (int i = 0; i < num_vertices; ++i) {
+    memcpy(dst, current_buffer, sizeof(float) * num_components);
+    dst += num_components;
+    current_buffer += stride;
+  }
+  return r_storage->data();
+}
+
 void convertPatchCoordsToArray(const OpenSubdiv_PatchCoord *patch_coords,
                                const int num_patch_coords,
                                const OpenSubdiv::Far::PatchMap *patch_map,
@@ -559,7 +647,7 @@ class CpuEvalOutput : public VolatileEvalOutput<CpuVertexBuffer,
                                                 CpuVertexBuffer,
                                                 StencilTable,
                                                 CpuPatchTable,
-                                                CpuEvaluator> {
+                                                ParallelCpuEvaluator> {
  public:
   CpuEvalOutput(const StencilTable *vertex_stencils,
                 const StencilTable *varying_stencils,
@@ -571,12 +659,12 @@ class CpuEvalOutput : public VolatileEvalOutput<CpuVertexBuffer,
                            CpuVertexBuffer,
                            StencilTable,
                            CpuPatchTable,
-                           CpuEvaluator>(vertex_stencils,
-                                         varying_stencils,
-                                         all_face_varying_stencils,
-                                         face_varying_width,
-                                         patch_table,
-                                         evaluator_cache)
+                           ParallelCpuEvaluator>(vertex_stencils,
+                                                 varying_stencils,
+                                                 all_face_varying_stencils,
+                                                 face_varying_width,
+                                                 patch_table,
+                                                 evaluator_cache)
   {
   }
 };
@@ -628,14 +716,10 @@ void CpuEvalOutputAPI::setCoarsePositionsFromBuffer(const void *buffer,
                                                     const int num_vertices)
 {
   // TODO(sergey): Add sanity check on indices.
-  const unsigned char *current_buffer = (unsigned char *)buffer;
-  current_buffer += start_offset;
-  for (int i = 0; i < num_vertices; ++i) {
-    const int current_vertex_index = start_vertex_index + i;
-    implementation_->updateData(
-        reinterpret_cast<const float *>(current_buffer), current_vertex_index, 1);
-    current_buffer += stride;
-  }
+  vector<float> storage;
+  const float *positions = getContiguousData(
+      buffer, start_offset, stride, num_vertices, 3, &storage);
+  implementation_->updateData(positions, start_vertex_index, num_vertices);
 }
 
 void CpuEvalOutputAPI::setVaryingDataFromBuffer(const void *buffer,
@@ -645,14 +729,10 @@ void CpuEvalOutputAPI::setVaryingDataFromBuffer(const void *buffer,
                                                 const int num_vertices)
 {
   // TODO(sergey): Add sanity check on indices.
-  const unsigned char *current_buffer = (unsigned char *)buffer;
-  current_buffer += start_offset;
-  for (int i = 0; i < num_vertices; ++i) {
-    const int current_vertex_index = start_vertex_index + i;
-    implementation_->updateVaryingData(
-        reinterpret_cast<const float *>(current_buffer), current_vertex_index, 1);
-    current_buffer += stride;
-  }
+  vector<float> storage;
+  const float *varying_data = getContiguousData(
+      buffer, start_offset, stride, num_vertices, 3, &storage);
+  implementation_->updateVaryingData(varying_data, start_vertex_index, num_vertices);
 }
 
 void CpuEvalOutputAPI::setFaceVaryingDataFromBuffer(const int face_varying_channel,
@@ -663,16 +743,15 @@ void CpuEvalOutputAPI::setFaceVaryingDataFromBuffer(const int face_varying_chann
                                                     const int num_vertices)
 {
   // TODO(sergey): Add sanity check on indices.
-  const unsigned char *current_buffer = (unsigned char *)buffer;
-  current_buffer += start_offset;
-  for (int i = 0; i < num_vertices; ++i) {
-    const int current_vertex_index = start_vertex_index + i;
-    implementation_->updateFaceVaryingData(face_varying_channel,
-                                           reinterpret_cast<const float *>(current_buffer),
-                                           current_vertex_index,
-                                           1);
-    current_buffer += stride;
-  }
+  vector<float> storage;
+  const float *face_varying_data = getContiguousData(buffer,
+                                                     start_offset,
+                                                     stride,
+                                                     num_vertices,
+                                                     implementation_->getFaceVaryingWidth(),
+                                                     &storage);
+  implementation_->updateFaceVaryingData(
+      face_varying_channel, face_varying_data, start_vertex_index, num_vertices);
 }
 
 void CpuEvalOutputAPI::refine()
@@ -468,9 +468,16 @@ class TOPBAR_MT_file_import(Menu):
                                  text="Collada (Default) (.dae)")
         if bpy.app.build_options.alembic:
             self.layout.operator("wm.alembic_import", text="Alembic (.abc)")
+        if bpy.app.build_options.usd:
+            self.layout.operator(
+                "wm.usd_import", text="Universal Scene Description (.usd, .usdc, .usda)")
 
         self.layout.operator("wm.gpencil_import_svg", text="SVG as Grease Pencil")
 
+        self.layout.operator("wm.obj_import", text="Wavefront (.obj) (experimental)")
+        self.layout.operator("wm.ply_import", text="Stanford (.ply) (experimental)")
+        self.layout.operator("wm.stl_import", text="STL (.stl) (experimental)")
+
 
 class TOPBAR_MT_file_export(Menu):
     bl_idname = "TOPBAR_MT_file_export"
@@ -494,6 +501,10 @@ class TOPBAR_MT_file_export(Menu):
         if bpy.app.build_options.haru:
             self.layout.operator("wm.gpencil_export_pdf", text="Grease Pencil as PDF")
 
+        self.layout.operator("wm.obj_export", text="Wavefront (.obj) (experimental)")
+        self.layout.operator("wm.ply_export", text="Stanford (.ply) (experimental)")
+        self.layout.operator("wm.stl_export", text="STL (.stl) (experimental)")
+
 
 class TOPBAR_MT_file_external_data(Menu):
     bl_label = "External Data"
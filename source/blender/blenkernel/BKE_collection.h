@@ -93,6 +93,9 @@ bool BKE_collection_is_empty(const struct Collection *collection);
 bool BKE_collection_object_add(struct Main *bmain,
                                struct Collection *collection,
                                struct Object *ob);
+bool BKE_collection_object_add_nosync(struct Main *bmain,
+                                      struct Collection *collection,
+                                      struct Object *ob);
 void BKE_collection_object_add_from(struct Main *bmain,
                                     struct Scene *scene,
                                     struct Object *ob_src,
@@ -38,6 +38,7 @@ struct MLoop;
 struct MLoopTri;
 struct MVertTri;
 struct Mesh;
+struct MeshElemMap;
 struct Object;
 struct Scene;
 
@@ -46,6 +47,10 @@ void BKE_mesh_runtime_reset_on_copy(struct Mesh *mesh, const int flag);
 int BKE_mesh_runtime_looptri_len(const struct Mesh *mesh);
 void BKE_mesh_runtime_looptri_recalc(struct Mesh *mesh);
 const struct MLoopTri *BKE_mesh_runtime_looptri_ensure(struct Mesh *mesh);
+const struct MeshElemMap *BKE_mesh_runtime_vert_poly_map_ensure(struct Mesh *mesh);
+const struct MeshElemMap *BKE_mesh_runtime_vert_loop_map_ensure(struct Mesh *mesh);
+const struct MeshElemMap *BKE_mesh_runtime_vert_edge_map_ensure(struct Mesh *mesh);
+const struct MeshElemMap *BKE_mesh_runtime_edge_poly_map_ensure(struct Mesh *mesh);
 bool BKE_mesh_runtime_ensure_edit_data(struct Mesh *mesh);
 bool BKE_mesh_runtime_clear_edit_data(struct Mesh *mesh);
 bool BKE_mesh_runtime_reset_edit_data(struct Mesh *mesh);
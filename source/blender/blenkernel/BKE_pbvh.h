@@ -78,6 +78,8 @@ typedef enum {
 
   PBVH_UpdateTopology = 1 << 13,
   PBVH_UpdateColor = 1 << 14,
+  /* Draw buffers were freed while the node was out of view. */
+  PBVH_DrawBuffersFreed = 1 << 15,
 } PBVHNodeFlags;
 
 typedef struct PBVHFrustumPlanes {
@@ -193,12 +195,12 @@ bool BKE_pbvh_node_find_nearest_to_ray(PBVH *pbvh,
 
 /* Drawing */
 
-void BKE_pbvh_draw_cb(PBVH *pbvh,
-                      bool update_only_visible,
-                      PBVHFrustumPlanes *update_frustum,
-                      PBVHFrustumPlanes *draw_frustum,
-                      void (*draw_fn)(void *user_data, struct GPU_PBVH_Buffers *buffers),
-                      void *user_data);
+bool BKE_pbvh_draw_cb(PBVH *pbvh,
+                     bool update_only_visible,
+                     PBVHFrustumPlanes *update_frustum,
+                     PBVHFrustumPlanes *draw_frustum,
+                     void (*draw_fn)(void *user_data, struct GPU_PBVH_Buffers *buffers),
+                     void *user_data);
 
 void BKE_pbvh_draw_debug_cb(
     PBVH *pbvh,
@@ -67,6 +67,10 @@ extern "C" {
 /* high bits reserved for flags that need to be stored in file */
 #define PTCACHE_TYPEFLAG_COMPRESS (1 << 16)
 #define PTCACHE_TYPEFLAG_EXTRADATA (1 << 17)
+/* Compressed data streams are split into chunks that are (de)compressed independently. Files
+ * with this flag can't be read by older versions, which is why they start with another file
+ * identifier. */
+#define PTCACHE_TYPEFLAG_CHUNKED (1 << 18)
 
 #define PTCACHE_TYPEFLAG_TYPEMASK 0x0000FFFF
 #define PTCACHE_TYPEFLAG_FLAGMASK 0xFFFF0000
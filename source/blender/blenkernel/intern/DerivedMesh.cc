@@ -1891,6 +1891,94 @@ static void mesh_runtime_check_normals_valid(const Mesh *mesh)
   BLI_assert(!(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL));
 }
 
+/**
+ * Detach the evaluated mesh of the previous evaluation from the object, so its draw cache can be
+ * handed over to the new evaluated mesh when only vertex positions change (armature playback for
+ * example). Returns null when the cache can not be reused anyway.
+ */
+static Mesh *mesh_eval_prev_detach_for_reuse(Object *ob)
+{
+  if (!ob->runtime.is_data_eval_owned || ob->runtime.data_eval == nullptr ||
+      GS(ob->runtime.data_eval->name) != ID_ME) {
+    return nullptr;
+  }
+  /* Paint modes modify attributes of the evaluated mesh in place. */
+  if (ob->mode & (OB_MODE_EDIT | OB_MODE_ALL_PAINT)) {
+    return nullptr;
+  }
+  Mesh *mesh_eval_prev = (Mesh *)ob->runtime.data_eval;
+  if (mesh_eval_prev->runtime.batch_cache == nullptr || mesh_eval_prev->edit_mesh != nullptr ||
+      mesh_eval_prev->runtime.subdiv_ccg != nullptr) {
+    return nullptr;
+  }
+  /* Arrays of the copied-on-write mesh are reallocated when it is copied again, the new ones can
+   * end up at the same addresses as the ones the previous evaluated mesh referenced. */
+  const Mesh *mesh_input = (const Mesh *)ob->runtime.data_orig;
+  if (mesh_input == nullptr || (mesh_input->id.recalc & ID_RECALC_COPY_ON_WRITE)) {
+    return nullptr;
+  }
+  ob->runtime.data_eval = nullptr;
+  return mesh_eval_prev;
+}
+
+/**
+ * Layers which are not in \a skip_mask have to be the exact same arrays, which is the case when
+ * both meshes reference the data of the original mesh (deform-only modifier stacks).
+ */
+static bool mesh_customdata_layers_shared(const CustomData *a,
+                                          const CustomData *b,
+                                          const CustomDataMask skip_mask)
+{
+  if (a->totlayer != b->totlayer) {
+    return false;
+  }
+  for (int i = 0; i < a->totlayer; i++) {
+    const CustomDataLayer *layer_a = &a->layers[i];
+    const CustomDataLayer *layer_b = &b->layers[i];
+    if (layer_a->type != layer_b->type) {
+      return false;
+    }
+    if (CD_TYPE_AS_MASK(layer_a->type) & skip_mask) {
+      continue;
+    }
+    if (layer_a->data != layer_b->data || !(layer_a->flag & CD_FLAG_NOFREE)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool mesh_eval_topology_is_shared(const Mesh *mesh_a, const Mesh *mesh_b)
+{
+  if (mesh_a->totvert != mesh_b->totvert || mesh_a->totedge != mesh_b->totedge ||
+      mesh_a->totloop != mesh_b->totloop || mesh_a->totpoly != mesh_b->totpoly ||
+      mesh_a->totcol != mesh_b->totcol || mesh_a->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA ||
+      mesh_b->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+    return false;
+  }
+  /* Positions and normals are expected to change, orco is regenerated on every evaluation. */
+  const CustomDataMask skip_mask = CD_MASK_MVERT | CD_MASK_NORMAL | CD_MASK_ORCO;
+  return mesh_customdata_layers_shared(&mesh_a->vdata, &mesh_b->vdata, skip_mask) &&
+         mesh_customdata_layers_shared(&mesh_a->edata, &mesh_b->edata, 0) &&
+         mesh_customdata_layers_shared(&mesh_a->ldata, &mesh_b->ldata, CD_MASK_NORMAL) &&
+         mesh_customdata_layers_shared(&mesh_a->pdata, &mesh_b->pdata, CD_MASK_NORMAL);
+}
+
+/**
+ * Move the draw cache of the previous evaluated mesh to the new one when the topology did not
+ * change, so only the position dependent buffers are extracted again. Frees the previous mesh.
+ */
+static void mesh_eval_prev_batch_cache_reuse(Mesh *mesh_eval_prev, Mesh *mesh_eval)
+{
+  if (mesh_eval->runtime.batch_cache == nullptr &&
+      mesh_eval_topology_is_shared(mesh_eval_prev, mesh_eval)) {
+    mesh_eval->runtime.batch_cache = mesh_eval_prev->runtime.batch_cache;
+    mesh_eval_prev->runtime.batch_cache = nullptr;
+    BKE_mesh_batch_cache_dirty_tag(mesh_eval, BKE_MESH_BATCH_DIRTY_DEFORM);
+  }
+  BKE_mesh_eval_delete(mesh_eval_prev);
+}
+
 static void mesh_build_data(struct Depsgraph *depsgraph,
                             Scene *scene,
                             Object *ob,
@@ -1903,6 +1991,7 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * they aren't cleaned up properly on mode switch, causing crashes, e.g T58150. */
   BLI_assert(ob->id.tag & LIB_TAG_COPIED_ON_WRITE);
 
+  Mesh *mesh_eval_prev = mesh_eval_prev_detach_for_reuse(ob);
   BKE_object_free_derived_caches(ob);
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
@@ -1942,6 +2031,15 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  if (mesh_eval_prev != nullptr) {
+    if (is_mesh_eval_owned) {
+      mesh_eval_prev_batch_cache_reuse(mesh_eval_prev, mesh_eval);
+    }
+    else {
+      BKE_mesh_eval_delete(mesh_eval_prev);
+    }
+  }
+
   /* Add the final mesh as read-only non-owning component to the geometry set. */
   MeshComponent &mesh_component = geometry_set_eval->get_component_for_write<MeshComponent>();
   mesh_component.replace_mesh_but_keep_vertex_group_names(mesh_eval,
@@ -0,0 +1,194 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_cloth.h"
+
+#include "DNA_cloth_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdopbvh.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+namespace blender::bke::tests {
+
+/* Two layers of cloth on top of each other, the upper one falling onto the lower one. */
+struct ClothCollisionTestContext {
+  ClothSimSettings sim_parms;
+  ClothCollSettings coll_parms;
+  Cloth cloth;
+  ClothModifierData clmd;
+  Array<ClothVertex> verts;
+  Array<MVertTri> tris;
+};
+
+static const float layer_distance = 0.01f;
+static const float grid_spacing = 0.05f;
+static const float fall_velocity = 0.005f;
+
+static BVHTree *test_cloth_bvhtree_build(const ClothCollisionTestContext *ctx, float epsilon)
+{
+  BVHTree *bvhtree = BLI_bvhtree_new(ctx->tris.size(), epsilon, 4, 26);
+  for (const int i : ctx->tris.index_range()) {
+    float co[3][3];
+    for (int j = 0; j < 3; j++) {
+      copy_v3_v3(co[j], ctx->verts[ctx->tris[i].tri[j]].xold);
+    }
+    BLI_bvhtree_insert(bvhtree, i, co[0], 3);
+  }
+  BLI_bvhtree_balance(bvhtree);
+  return bvhtree;
+}
+
+static void test_cloth_collision_init(ClothCollisionTestContext *ctx, const int grid_size)
+{
+  const int layer_verts_num = grid_size * grid_size;
+  const int layer_tris_num = (grid_size - 1) * (grid_size - 1) * 2;
+
+  ctx->verts.reinitialize(layer_verts_num * 2);
+  ctx->tris.reinitialize(layer_tris_num * 2);
+
+  for (const int layer : IndexRange(2)) {
+    for (const int y : IndexRange(grid_size)) {
+      for (const int x : IndexRange(grid_size)) {
+        ClothVertex &vert = ctx->verts[layer * layer_verts_num + y * grid_size + x];
+        memset(&vert, 0, sizeof(vert));
+        vert.mass = 1.0f;
+        vert.txold[0] = x * grid_spacing;
+        vert.txold[1] = y * grid_spacing;
+        vert.txold[2] = layer * layer_distance;
+        vert.tv[2] = layer * -fall_velocity;
+        add_v3_v3v3(vert.tx, vert.txold, vert.tv);
+        copy_v3_v3(vert.xold, vert.txold);
+      }
+    }
+
+    MVertTri *tri = &ctx->tris[layer * layer_tris_num];
+    for (const int y : IndexRange(grid_size - 1)) {
+      for (const int x : IndexRange(grid_size - 1)) {
+        const uint v = layer * layer_verts_num + y * grid_size + x;
+        *tri++ = {{v, v + 1, v + grid_size + 1}};
+        *tri++ = {{v, v + grid_size + 1, v + grid_size}};
+      }
+    }
+  }
+
+  memset(&ctx->sim_parms, 0, sizeof(ctx->sim_parms));
+  ctx->sim_parms.dt = 0.2f;
+  ctx->sim_parms.timescale = 1.0f;
+
+  memset(&ctx->coll_parms, 0, sizeof(ctx->coll_parms));
+  ctx->coll_parms.flags = CLOTH_COLLSETTINGS_FLAG_SELF;
+  ctx->coll_parms.epsilon = 0.015f;
+  ctx->coll_parms.selfepsilon = 0.015f;
+  ctx->coll_parms.self_friction = 5.0f;
+  ctx->coll_parms.loop_count = 2;
+
+  memset(&ctx->cloth, 0, sizeof(ctx->cloth));
+  ctx->cloth.verts = ctx->verts.data();
+  ctx->cloth.mvert_num = ctx->verts.size();
+  ctx->cloth.tri = ctx->tris.data();
+  ctx->cloth.primitive_num = ctx->tris.size();
+  ctx->cloth.bvhtree = test_cloth_bvhtree_build(ctx, ctx->coll_parms.epsilon);
+  ctx->cloth.bvhselftree = test_cloth_bvhtree_build(ctx, ctx->coll_parms.selfepsilon);
+
+  memset(&ctx->clmd, 0, sizeof(ctx->clmd));
+  ctx->clmd.clothObject = &ctx->cloth;
+  ctx->clmd.sim_parms = &ctx->sim_parms;
+  ctx->clmd.coll_parms = &ctx->coll_parms;
+}
+
+static int test_cloth_collision(ClothCollisionTestContext *ctx)
+{
+  return cloth_bvh_collision(nullptr, nullptr, &ctx->clmd, 0.0f, ctx->sim_parms.dt);
+}
+
+/* Run the collision step with the task scheduler set to use `threads_num` threads. */
+static void test_cloth_collision_with_threads(ClothCollisionTestContext *ctx, const int threads_num)
+{
+  BLI_system_num_threads_override_set(threads_num);
+  BLI_task_scheduler_init();
+  test_cloth_collision(ctx);
+  BLI_task_scheduler_exit();
+  BLI_system_num_threads_override_set(0);
+}
+
+static void test_cloth_collision_free(ClothCollisionTestContext *ctx)
+{
+  BLI_bvhtree_free(ctx->cloth.bvhtree);
+  BLI_bvhtree_free(ctx->cloth.bvhselftree);
+}
+
+TEST(cloth_collision, self_collision_layers)
+{
+  const int grid_size = 16;
+  ClothCollisionTestContext ctx;
+  test_cloth_collision_init(&ctx, grid_size);
+  EXPECT_EQ(test_cloth_collision(&ctx), 1);
+
+  /* The layers are pushed apart, slowing down the falling layer. */
+  const int layer_verts_num = grid_size * grid_size;
+  const int center = (grid_size / 2) * grid_size + grid_size / 2;
+  const ClothVertex &lower = ctx.verts[center];
+  const ClothVertex &upper = ctx.verts[layer_verts_num + center];
+  EXPECT_LT(lower.tv[2], 0.0f);
+  EXPECT_GT(upper.tv[2] - lower.tv[2], -fall_velocity);
+  test_cloth_collision_free(&ctx);
+}
+
+TEST(cloth_collision, self_collision_deterministic)
+{
+  const int grid_size = 32;
+  ClothCollisionTestContext ctx_a;
+  ClothCollisionTestContext ctx_b;
+  test_cloth_collision_init(&ctx_a, grid_size);
+  test_cloth_collision_init(&ctx_b, grid_size);
+  test_cloth_collision_with_threads(&ctx_a, 1);
+  /* At least two, so the threaded code paths are used on single core machines as well. */
+  test_cloth_collision_with_threads(&ctx_b, max_ii(BLI_system_thread_count(), 2));
+
+  /* The threaded result has to match the single threaded one exactly. */
+  for (const int i : ctx_a.verts.index_range()) {
+    EXPECT_EQ(ctx_a.verts[i].tv[0], ctx_b.verts[i].tv[0]);
+    EXPECT_EQ(ctx_a.verts[i].tv[1], ctx_b.verts[i].tv[1]);
+    EXPECT_EQ(ctx_a.verts[i].tv[2], ctx_b.verts[i].tv[2]);
+  }
+  test_cloth_collision_free(&ctx_a);
+  test_cloth_collision_free(&ctx_b);
+}
+
+TEST(cloth_collision_performance, self_collision_64)
+{
+  ClothCollisionTestContext ctx;
+  test_cloth_collision_init(&ctx, 64);
+  test_cloth_collision(&ctx);
+  test_cloth_collision_free(&ctx);
+}
+TEST(cloth_collision_performance, self_collision_256)
+{
+  ClothCollisionTestContext ctx;
+  test_cloth_collision_init(&ctx, 256);
+  test_cloth_collision(&ctx);
+  test_cloth_collision_free(&ctx);
+}
+
+}  // namespace blender::bke::tests
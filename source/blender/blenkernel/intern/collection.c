@@ -1125,9 +1125,10 @@ static bool collection_object_remove(Main *bmain,
 }
 
 /**
- * Add object to collection
+ * Add object to collection, without synchronizing the view layers. Used when adding many objects
+ * at once, the caller must call #BKE_main_collection_sync after.
  */
-bool BKE_collection_object_add(Main *bmain, Collection *collection, Object *ob)
+bool BKE_collection_object_add_nosync(Main *bmain, Collection *collection, Object *ob)
 {
   if (ELEM(NULL, collection, ob)) {
     return false;
@@ -1142,10 +1143,19 @@ bool BKE_collection_object_add(Main *bmain, Collection *collection, Object *ob)
     return false;
   }
 
-  if (!collection_object_add(bmain, collection, ob, 0, true)) {
+  return collection_object_add(bmain, collection, ob, 0, true);
+}
+
+/**
+ * Add object to collection
+ */
+bool BKE_collection_object_add(Main *bmain, Collection *collection, Object *ob)
+{
+  if (!BKE_collection_object_add_nosync(bmain, collection, ob)) {
     return false;
   }
 
+  collection = collection_parent_editable_find_recursive(collection);
   if (BKE_collection_is_in_scene(collection)) {
     BKE_main_collection_sync(bmain);
   }
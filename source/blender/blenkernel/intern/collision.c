@@ -35,6 +35,7 @@
 #include "BLI_edgehash.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
@@ -74,6 +75,26 @@ typedef struct SelfColDetectData {
   bool collided;
 } SelfColDetectData;
 
+typedef struct SelfColResponseData {
+  ClothModifierData *clmd;
+  const CollPair *collisions;
+  const int *pair_indices;
+  float clamp_sq;
+  float time_multiplier;
+  float min_distance;
+} SelfColResponseData;
+
+/* Number of groups that self collision pairs are sorted into, one bit each in a vertex mask. */
+#define SELFCOLL_GROUP_NUM 64
+
+typedef struct SelfColPairGroups {
+  /* Indices of the active collision pairs, sorted by group. */
+  int *pair_indices;
+  /* Start of every group in #pair_indices. Pairs of the same group don't share any vertex, except
+   * in the last group, which holds the pairs that didn't fit in any of the others. */
+  int group_offsets[SELFCOLL_GROUP_NUM + 2];
+} SelfColPairGroups;
+
 /***********************************
  * Collision modifier code start
  ***********************************/
@@ -837,107 +858,115 @@ static int cloth_collision_response_static(ClothModifierData *clmd,
   return result;
 }
 
-static int cloth_selfcollision_response_static(ClothModifierData *clmd,
-                                               CollPair *collpair,
-                                               uint collision_count,
-                                               const float dt)
+/* Compute the impulses of a single self collision pair and add them to its vertices. */
+static bool cloth_selfcollision_response_pair(const SelfColResponseData *data,
+                                              const CollPair *collpair)
 {
-  int result = 0;
-  Cloth *cloth = clmd->clothObject;
-  const float clamp_sq = square_f(clmd->coll_parms->self_clamp * dt);
-  const float time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale);
-  const float min_distance = (2.0f * clmd->coll_parms->selfepsilon) * (8.0f / 9.0f);
+  bool result = false;
+  Cloth *cloth = data->clmd->clothObject;
+  float ia[3][3] = {{0.0f}};
+  float ib[3][3] = {{0.0f}};
+  float w1, w2, w3, u1, u2, u3;
+  float v1[3], v2[3], relativeVelocity[3];
+
+  /* Compute barycentric coordinates for both collision points. */
+  collision_compute_barycentric(collpair->pa,
+                                cloth->verts[collpair->ap1].tx,
+                                cloth->verts[collpair->ap2].tx,
+                                cloth->verts[collpair->ap3].tx,
+                                &w1,
+                                &w2,
+                                &w3);
 
-  for (int i = 0; i < collision_count; i++, collpair++) {
-    float ia[3][3] = {{0.0f}};
-    float ib[3][3] = {{0.0f}};
-    float w1, w2, w3, u1, u2, u3;
-    float v1[3], v2[3], relativeVelocity[3];
+  collision_compute_barycentric(collpair->pb,
+                                cloth->verts[collpair->bp1].tx,
+                                cloth->verts[collpair->bp2].tx,
+                                cloth->verts[collpair->bp3].tx,
+                                &u1,
+                                &u2,
+                                &u3);
 
-    /* Only handle static collisions here. */
-    if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
-      continue;
-    }
+  /* Calculate relative "velocity". */
+  collision_interpolateOnTriangle(v1,
+                                  cloth->verts[collpair->ap1].tv,
+                                  cloth->verts[collpair->ap2].tv,
+                                  cloth->verts[collpair->ap3].tv,
+                                  w1,
+                                  w2,
+                                  w3);
+
+  collision_interpolateOnTriangle(v2,
+                                  cloth->verts[collpair->bp1].tv,
+                                  cloth->verts[collpair->bp2].tv,
+                                  cloth->verts[collpair->bp3].tv,
+                                  u1,
+                                  u2,
+                                  u3);
 
-    /* Compute barycentric coordinates for both collision points. */
-    collision_compute_barycentric(collpair->pa,
-                                  cloth->verts[collpair->ap1].tx,
-                                  cloth->verts[collpair->ap2].tx,
-                                  cloth->verts[collpair->ap3].tx,
-                                  &w1,
-                                  &w2,
-                                  &w3);
+  sub_v3_v3v3(relativeVelocity, v2, v1);
 
-    collision_compute_barycentric(collpair->pb,
-                                  cloth->verts[collpair->bp1].tx,
-                                  cloth->verts[collpair->bp2].tx,
-                                  cloth->verts[collpair->bp3].tx,
-                                  &u1,
-                                  &u2,
-                                  &u3);
+  /* Calculate the normal component of the relative velocity
+   * (actually only the magnitude - the direction is stored in 'normal'). */
+  const float magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
+  const float d = data->min_distance - collpair->distance;
 
-    /* Calculate relative "velocity". */
-    collision_interpolateOnTriangle(v1,
-                                    cloth->verts[collpair->ap1].tv,
-                                    cloth->verts[collpair->ap2].tv,
-                                    cloth->verts[collpair->ap3].tv,
-                                    w1,
-                                    w2,
-                                    w3);
+  /* TODO: Impulses should be weighed by mass as this is self col,
+   * this has to be done after mass distribution is implemented. */
 
-    collision_interpolateOnTriangle(v2,
-                                    cloth->verts[collpair->bp1].tv,
-                                    cloth->verts[collpair->bp2].tv,
-                                    cloth->verts[collpair->bp3].tv,
-                                    u1,
-                                    u2,
-                                    u3);
+  /* If magrelVel < 0 the edges are approaching each other. */
+  if (magrelVel > 0.0f) {
+    /* Calculate Impulse magnitude to stop all motion in normal direction. */
+    float magtangent = 0, repulse = 0;
+    double impulse = 0.0;
+    float vrel_t_pre[3];
+    float temp[3];
 
-    sub_v3_v3v3(relativeVelocity, v2, v1);
+    /* Calculate tangential velocity. */
+    copy_v3_v3(temp, collpair->normal);
+    mul_v3_fl(temp, magrelVel);
+    sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
 
-    /* Calculate the normal component of the relative velocity
-     * (actually only the magnitude - the direction is stored in 'normal'). */
-    const float magrelVel = dot_v3v3(relativeVelocity, collpair->normal);
-    const float d = min_distance - collpair->distance;
+    /* Decrease in magnitude of relative tangential velocity due to coulomb friction
+     * in original formula "magrelVel" should be the
+     * "change of relative velocity in normal direction". */
+    magtangent = min_ff(data->clmd->coll_parms->self_friction * 0.01f * magrelVel,
+                        len_v3(vrel_t_pre));
 
-    /* TODO: Impulses should be weighed by mass as this is self col,
-     * this has to be done after mass distribution is implemented. */
+    /* Apply friction impulse. */
+    if (magtangent > ALMOST_ZERO) {
+      normalize_v3(vrel_t_pre);
 
-    /* If magrelVel < 0 the edges are approaching each other. */
-    if (magrelVel > 0.0f) {
-      /* Calculate Impulse magnitude to stop all motion in normal direction. */
-      float magtangent = 0, repulse = 0;
-      double impulse = 0.0;
-      float vrel_t_pre[3];
-      float temp[3];
+      impulse = magtangent / 1.5;
 
-      /* Calculate tangential velocity. */
-      copy_v3_v3(temp, collpair->normal);
-      mul_v3_fl(temp, magrelVel);
-      sub_v3_v3v3(vrel_t_pre, relativeVelocity, temp);
+      VECADDMUL(ia[0], vrel_t_pre, (double)w1 * impulse);
+      VECADDMUL(ia[1], vrel_t_pre, (double)w2 * impulse);
+      VECADDMUL(ia[2], vrel_t_pre, (double)w3 * impulse);
 
-      /* Decrease in magnitude of relative tangential velocity due to coulomb friction
-       * in original formula "magrelVel" should be the
-       * "change of relative velocity in normal direction". */
-      magtangent = min_ff(clmd->coll_parms->self_friction * 0.01f * magrelVel, len_v3(vrel_t_pre));
+      VECADDMUL(ib[0], vrel_t_pre, (double)u1 * -impulse);
+      VECADDMUL(ib[1], vrel_t_pre, (double)u2 * -impulse);
+      VECADDMUL(ib[2], vrel_t_pre, (double)u3 * -impulse);
+    }
 
-      /* Apply friction impulse. */
-      if (magtangent > ALMOST_ZERO) {
-        normalize_v3(vrel_t_pre);
+    /* Apply velocity stopping impulse. */
+    impulse = magrelVel / 3.0f;
 
-        impulse = magtangent / 1.5;
+    VECADDMUL(ia[0], collpair->normal, (double)w1 * impulse);
+    VECADDMUL(ia[1], collpair->normal, (double)w2 * impulse);
+    VECADDMUL(ia[2], collpair->normal, (double)w3 * impulse);
 
-        VECADDMUL(ia[0], vrel_t_pre, (double)w1 * impulse);
-        VECADDMUL(ia[1], vrel_t_pre, (double)w2 * impulse);
-        VECADDMUL(ia[2], vrel_t_pre, (double)w3 * impulse);
+    VECADDMUL(ib[0], collpair->normal, (double)u1 * -impulse);
+    VECADDMUL(ib[1], collpair->normal, (double)u2 * -impulse);
+    VECADDMUL(ib[2], collpair->normal, (double)u3 * -impulse);
 
-        VECADDMUL(ib[0], vrel_t_pre, (double)u1 * -impulse);
-        VECADDMUL(ib[1], vrel_t_pre, (double)u2 * -impulse);
-        VECADDMUL(ib[2], vrel_t_pre, (double)u3 * -impulse);
+    if ((magrelVel < 0.1f * d * data->time_multiplier) && (d > ALMOST_ZERO)) {
+      repulse = MIN2(d / data->time_multiplier, 0.1f * d * data->time_multiplier - magrelVel);
+
+      if (impulse > ALMOST_ZERO) {
+        repulse = min_ff(repulse, 5.0 * impulse);
       }
 
-      /* Apply velocity stopping impulse. */
-      impulse = magrelVel / 3.0f;
+      repulse = max_ff(impulse, repulse);
+      impulse = repulse / 1.5f;
 
       VECADDMUL(ia[0], collpair->normal, (double)w1 * impulse);
       VECADDMUL(ia[1], collpair->normal, (double)w2 * impulse);
@@ -946,53 +975,91 @@ static int cloth_selfcollision_response_static(ClothModifierData *clmd,
       VECADDMUL(ib[0], collpair->normal, (double)u1 * -impulse);
       VECADDMUL(ib[1], collpair->normal, (double)u2 * -impulse);
       VECADDMUL(ib[2], collpair->normal, (double)u3 * -impulse);
+    }
 
-      if ((magrelVel < 0.1f * d * time_multiplier) && (d > ALMOST_ZERO)) {
-        repulse = MIN2(d / time_multiplier, 0.1f * d * time_multiplier - magrelVel);
+    result = true;
+  }
+  else if (d > ALMOST_ZERO) {
+    /* Stay on the safe side and clamp repulse. */
+    float repulse = d * 1.0f / data->time_multiplier;
+    float impulse = repulse / 9.0f;
 
-        if (impulse > ALMOST_ZERO) {
-          repulse = min_ff(repulse, 5.0 * impulse);
-        }
+    VECADDMUL(ia[0], collpair->normal, w1 * impulse);
+    VECADDMUL(ia[1], collpair->normal, w2 * impulse);
+    VECADDMUL(ia[2], collpair->normal, w3 * impulse);
 
-        repulse = max_ff(impulse, repulse);
-        impulse = repulse / 1.5f;
+    VECADDMUL(ib[0], collpair->normal, u1 * -impulse);
+    VECADDMUL(ib[1], collpair->normal, u2 * -impulse);
+    VECADDMUL(ib[2], collpair->normal, u3 * -impulse);
 
-        VECADDMUL(ia[0], collpair->normal, (double)w1 * impulse);
-        VECADDMUL(ia[1], collpair->normal, (double)w2 * impulse);
-        VECADDMUL(ia[2], collpair->normal, (double)w3 * impulse);
+    result = true;
+  }
 
-        VECADDMUL(ib[0], collpair->normal, (double)u1 * -impulse);
-        VECADDMUL(ib[1], collpair->normal, (double)u2 * -impulse);
-        VECADDMUL(ib[2], collpair->normal, (double)u3 * -impulse);
-      }
+  if (result) {
+    cloth_collision_impulse_vert(data->clamp_sq, ia[0], &cloth->verts[collpair->ap1]);
+    cloth_collision_impulse_vert(data->clamp_sq, ia[1], &cloth->verts[collpair->ap2]);
+    cloth_collision_impulse_vert(data->clamp_sq, ia[2], &cloth->verts[collpair->ap3]);
 
-      result = 1;
-    }
-    else if (d > ALMOST_ZERO) {
-      /* Stay on the safe side and clamp repulse. */
-      float repulse = d * 1.0f / time_multiplier;
-      float impulse = repulse / 9.0f;
+    cloth_collision_impulse_vert(data->clamp_sq, ib[0], &cloth->verts[collpair->bp1]);
+    cloth_collision_impulse_vert(data->clamp_sq, ib[1], &cloth->verts[collpair->bp2]);
+    cloth_collision_impulse_vert(data->clamp_sq, ib[2], &cloth->verts[collpair->bp3]);
+  }
 
-      VECADDMUL(ia[0], collpair->normal, w1 * impulse);
-      VECADDMUL(ia[1], collpair->normal, w2 * impulse);
-      VECADDMUL(ia[2], collpair->normal, w3 * impulse);
+  return result;
+}
 
-      VECADDMUL(ib[0], collpair->normal, u1 * -impulse);
-      VECADDMUL(ib[1], collpair->normal, u2 * -impulse);
-      VECADDMUL(ib[2], collpair->normal, u3 * -impulse);
+static void cloth_selfcollision_response(void *__restrict userdata,
+                                         const int index,
+                                         const TaskParallelTLS *__restrict tls)
+{
+  SelfColResponseData *data = (SelfColResponseData *)userdata;
+  const CollPair *collpair = &data->collisions[data->pair_indices[index]];
 
-      result = 1;
-    }
+  if (cloth_selfcollision_response_pair(data, collpair)) {
+    bool *result = (bool *)tls->userdata_chunk;
+    *result = true;
+  }
+}
 
-    if (result) {
-      cloth_collision_impulse_vert(clamp_sq, ia[0], &cloth->verts[collpair->ap1]);
-      cloth_collision_impulse_vert(clamp_sq, ia[1], &cloth->verts[collpair->ap2]);
-      cloth_collision_impulse_vert(clamp_sq, ia[2], &cloth->verts[collpair->ap3]);
+static void cloth_selfcollision_response_reduce(const void *__restrict UNUSED(userdata),
+                                                void *__restrict chunk_join,
+                                                void *__restrict chunk)
+{
+  bool *join = (bool *)chunk_join;
+  *join |= *(const bool *)chunk;
+}
 
-      cloth_collision_impulse_vert(clamp_sq, ib[0], &cloth->verts[collpair->bp1]);
-      cloth_collision_impulse_vert(clamp_sq, ib[1], &cloth->verts[collpair->bp2]);
-      cloth_collision_impulse_vert(clamp_sq, ib[2], &cloth->verts[collpair->bp3]);
-    }
+static int cloth_selfcollision_response_static(ClothModifierData *clmd,
+                                               const CollPair *collisions,
+                                               const SelfColPairGroups *groups,
+                                               const float dt)
+{
+  SelfColResponseData data = {
+      .clmd = clmd,
+      .collisions = collisions,
+      .pair_indices = groups->pair_indices,
+      .clamp_sq = square_f(clmd->coll_parms->self_clamp * dt),
+      .time_multiplier = 1.0f / (clmd->sim_parms->dt * clmd->sim_parms->timescale),
+      .min_distance = (2.0f * clmd->coll_parms->selfepsilon) * (8.0f / 9.0f),
+  };
+  bool result = false;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 64;
+  settings.userdata_chunk = &result;
+  settings.userdata_chunk_size = sizeof(result);
+  settings.func_reduce = cloth_selfcollision_response_reduce;
+
+  /* Groups are resolved one after the other, the pairs within a group write to different
+   * vertices. The pairs that share vertices with pairs of every group are resolved serially. */
+  for (int group = 0; group <= SELFCOLL_GROUP_NUM; group++) {
+    settings.use_threading = (group < SELFCOLL_GROUP_NUM);
+    BLI_task_parallel_range(groups->group_offsets[group],
+                            groups->group_offsets[group + 1],
+                            &data,
+                            cloth_selfcollision_response,
+                            &settings);
   }
 
   return result;
@@ -1492,6 +1559,64 @@ static int cloth_bvh_objcollisions_resolve(ClothModifierData *clmd,
   return ret;
 }
 
+/* Sort the active self collision pairs into groups of pairs that don't share vertices, with
+ * greedy graph coloring. Pairs are colored in order, so the groups don't depend on threading. */
+static void cloth_selfcollision_pair_groups_build(const Cloth *cloth,
+                                                  const CollPair *collisions,
+                                                  const int collision_count,
+                                                  SelfColPairGroups *groups)
+{
+  uint64_t *vert_groups = MEM_calloc_arrayN(cloth->mvert_num, sizeof(*vert_groups), __func__);
+  int *pair_groups = MEM_malloc_arrayN(collision_count, sizeof(*pair_groups), __func__);
+  int group_sizes[SELFCOLL_GROUP_NUM + 1] = {0};
+
+  for (int i = 0; i < collision_count; i++) {
+    const CollPair *collpair = &collisions[i];
+
+    /* Only handle static collisions here. */
+    if (collpair->flag & (COLLISION_IN_FUTURE | COLLISION_INACTIVE)) {
+      pair_groups[i] = -1;
+      continue;
+    }
+
+    const int pair_verts[6] = {
+        collpair->ap1, collpair->ap2, collpair->ap3, collpair->bp1, collpair->bp2, collpair->bp3};
+    uint64_t used_groups = 0;
+    for (int j = 0; j < 6; j++) {
+      used_groups |= vert_groups[pair_verts[j]];
+    }
+
+    int group = SELFCOLL_GROUP_NUM;
+    if (~used_groups != 0) {
+      group = (int)bitscan_forward_uint64(~used_groups);
+      for (int j = 0; j < 6; j++) {
+        vert_groups[pair_verts[j]] |= (uint64_t)1 << group;
+      }
+    }
+
+    pair_groups[i] = group;
+    group_sizes[group]++;
+  }
+
+  int offset = 0;
+  for (int group = 0; group <= SELFCOLL_GROUP_NUM; group++) {
+    groups->group_offsets[group] = offset;
+    offset += group_sizes[group];
+  }
+  groups->group_offsets[SELFCOLL_GROUP_NUM + 1] = offset;
+
+  groups->pair_indices = MEM_malloc_arrayN(max_ii(offset, 1), sizeof(int), __func__);
+  memcpy(group_sizes, groups->group_offsets, sizeof(group_sizes));
+  for (int i = 0; i < collision_count; i++) {
+    if (pair_groups[i] != -1) {
+      groups->pair_indices[group_sizes[pair_groups[i]]++] = i;
+    }
+  }
+
+  MEM_freeN(vert_groups);
+  MEM_freeN(pair_groups);
+}
+
 static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
                                             CollPair *collisions,
                                             int collision_count,
@@ -1502,14 +1627,17 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
   ClothVertex *verts = NULL;
   int ret = 0;
   int result = 0;
+  SelfColPairGroups groups;
 
   mvert_num = clmd->clothObject->mvert_num;
   verts = cloth->verts;
 
+  cloth_selfcollision_pair_groups_build(cloth, collisions, collision_count, &groups);
+
   for (j = 0; j < 2; j++) {
     result = 0;
 
-    result += cloth_selfcollision_response_static(clmd, collisions, collision_count, dt);
+    result += cloth_selfcollision_response_static(clmd, collisions, &groups, dt);
 
     /* Apply impulses in parallel. */
     if (result) {
@@ -1530,6 +1658,9 @@ static int cloth_bvh_selfcollisions_resolve(ClothModifierData *clmd,
       break;
     }
   }
+
+  MEM_freeN(groups.pair_indices);
+
   return ret;
 }
 
@@ -3641,7 +3641,11 @@ void CustomData_bmesh_free_block_data(CustomData *data, void *block)
   }
 }
 
-static void CustomData_bmesh_alloc_block(CustomData *data, void **block)
+/**
+ * Allocate an uninitialized block, this allows creating elements and their blocks up-front,
+ * then filling the blocks from multiple threads (allocating from the memory pool isn't safe).
+ */
+void CustomData_bmesh_alloc_block(CustomData *data, void **block)
 {
   if (*block) {
     CustomData_bmesh_free_block(data, block);
@@ -810,6 +810,7 @@ typedef struct LoopSplitTaskDataCommon {
   int *loop_to_poly;
   const float (*polynors)[3];
 
+  int numVerts;
   int numEdges;
   int numLoops;
   int numPolys;
@@ -1312,54 +1313,25 @@ static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
   }
 }
 
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
-{
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
-
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
-
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
-      break;
-    }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
-  }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
-}
-
 /**
  * Check whether given loop is part of an unknown-so-far cyclic smooth fan, or not.
  * Needed because cyclic smooth fans have no obvious 'entry point',
  * and yet we need to walk them once, and only once.
+ *
+ * \note All loops of a fan use the same vertex, so \a skip_loops is only ever written by the task
+ * owning that vertex, which is why a plain bool array is used here instead of a bitmap.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
+static bool loop_split_check_cyclic_smooth_fan(const MLoop *mloops,
+                                               const MPoly *mpolys,
+                                               const int (*edge_to_loops)[2],
+                                               const int *loop_to_poly,
+                                               const int *e2l_prev,
+                                               bool *skip_loops,
+                                               const MLoop *ml_curr,
+                                               const MLoop *ml_prev,
+                                               const int ml_curr_index,
+                                               const int ml_prev_index,
+                                               const int mp_curr_index)
 {
   const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
   const int *e2lfan_curr;
@@ -1382,8 +1354,8 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  BLI_assert(!BLI_BITMAP_TEST(skip_loops, mlfan_vert_index));
-  BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+  BLI_assert(!skip_loops[mlfan_vert_index]);
+  skip_loops[mlfan_vert_index] = true;
 
   while (true) {
     /* Find next loop of the smooth fan. */
@@ -1404,7 +1376,7 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
       return false;
     }
     /* Smooth loop/edge... */
-    if (BLI_BITMAP_TEST(skip_loops, mlfan_vert_index)) {
+    if (skip_loops[mlfan_vert_index]) {
       if (mlfan_vert_index == ml_curr_index) {
         /* We walked around a whole cyclic smooth fan without finding any already-processed loop,
          * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
@@ -1415,184 +1387,317 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
     }
 
     /* ... we can skip it in future, and keep checking the smooth fan. */
-    BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+    skip_loops[mlfan_vert_index] = true;
   }
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
+/* Parallel smooth fans walking.
+ *
+ * All loops of a smooth fan share the same vertex, so once we have a vertex -> loops mapping,
+ * fans of different vertices can be found and computed fully independently. Loops of each vertex
+ * are handled by increasing index, so that cyclic smooth fans get the same 'entry point' (and
+ * hence the exact same normals) as a serial walk over all polygons would give.
+ *
+ * Lnor spaces have to be allocated from the (non thread-safe) memarena of the spacearr.
+ * When they are needed, a first pass only finds the entry loops of the fans and counts them,
+ * the spaces are then allocated at once, and a second pass does the actual computation. */
+
+/** Number of vertices handled by a single task. */
+#define LOOP_SPLIT_VERT_BLOCK_SIZE 1024
+
+enum {
+  LOOP_SPLIT_FAN_NONE = 0,
+  LOOP_SPLIT_FAN_SINGLE = 1,
+  LOOP_SPLIT_FAN_SMOOTH = 2,
+};
+
+typedef struct LoopSplitVertData {
+  LoopSplitTaskDataCommon *common_data;
+
+  /** Vertex -> loops mapping, loops of a vertex are sorted by index once its block is handled. */
+  int *vert_loops_offset;
+  int *vert_loops_fill;
+  int *vert_loops;
+
+  /** Loops already walked by #loop_split_check_cyclic_smooth_fan. */
+  bool *skip_loops;
+
+  /** Only when computing lnor spaces: the type of fan starting at each loop. */
+  char *loop_fan_type;
+  /** Only when computing lnor spaces: offset of the first space of each block of vertices. */
+  int *block_spaces_offset;
+  MLoopNorSpace *spaces;
+} LoopSplitVertData;
+
+static void loop_split_vert_loops_count_cb(void *__restrict userdata,
+                                           const int ml_index,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
-  float(*loopnors)[3] = common_data->loopnors;
+  LoopSplitVertData *data = userdata;
+  const unsigned int v = data->common_data->mloops[ml_index].v;
+
+  atomic_add_and_fetch_int32(&data->vert_loops_offset[v + 1], 1);
+}
+
+static void loop_split_vert_loops_fill_cb(void *__restrict userdata,
+                                          const int ml_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitVertData *data = userdata;
+  const unsigned int v = data->common_data->mloops[ml_index].v;
+  const int slot = atomic_fetch_and_add_int32(&data->vert_loops_fill[v], 1);
+
+  data->vert_loops[data->vert_loops_offset[v] + slot] = ml_index;
+}
+
+static void loop_split_fan_do(LoopSplitTaskDataCommon *common_data,
+                              const int ml_curr_index,
+                              const char fan_type,
+                              MLoopNorSpace *lnor_space,
+                              BLI_Stack *edge_vectors)
+{
+  const MLoop *mloops = common_data->mloops;
+  const int mp_index = common_data->loop_to_poly[ml_curr_index];
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_prev_index = (ml_curr_index == mp->loopstart) ?
+                                (mp->loopstart + mp->totloop - 1) :
+                                (ml_curr_index - 1);
+
+  LoopSplitTaskData data = {NULL};
+  data.lnor_space = lnor_space;
+  data.ml_curr = &mloops[ml_curr_index];
+  data.ml_prev = &mloops[ml_prev_index];
+  data.ml_curr_index = ml_curr_index;
+  data.mp_index = mp_index;
+  if (fan_type == LOOP_SPLIT_FAN_SINGLE) {
+    data.lnor = &common_data->loopnors[ml_curr_index];
+  }
+  else {
+    data.ml_prev_index = ml_prev_index;
+    data.e2l_prev = common_data->edge_to_loops[mloops[ml_prev_index].e]; /* Tag as 'fan' task. */
+  }
+
+  loop_split_worker_do(common_data, &data, edge_vectors);
+}
 
+/**
+ * Sort the loops of given vertex and find which of them are the entry points of its fans.
+ */
+static void loop_split_vert_fans_find(LoopSplitVertData *data,
+                                      const int v,
+                                      void (*fan_fn)(LoopSplitVertData *data,
+                                                     const int ml_index,
+                                                     const char fan_type,
+                                                     void *userdata),
+                                      void *userdata)
+{
+  LoopSplitTaskDataCommon *common_data = data->common_data;
   const MLoop *mloops = common_data->mloops;
   const MPoly *mpolys = common_data->mpolys;
   const int *loop_to_poly = common_data->loop_to_poly;
   const int(*edge_to_loops)[2] = common_data->edge_to_loops;
-  const int numLoops = common_data->numLoops;
-  const int numPolys = common_data->numPolys;
 
-  const MPoly *mp;
-  int mp_index;
+  int *vert_loops = &data->vert_loops[data->vert_loops_offset[v]];
+  const int vert_loops_len = data->vert_loops_offset[v + 1] - data->vert_loops_offset[v];
 
-  const MLoop *ml_curr;
-  const MLoop *ml_prev;
-  int ml_curr_index;
-  int ml_prev_index;
+  /* Vertices rarely use more than a handful of loops, insertion sort is fine. */
+  for (int i = 1; i < vert_loops_len; i++) {
+    const int ml_index = vert_loops[i];
+    int j = i;
+    for (; j > 0 && vert_loops[j - 1] > ml_index; j--) {
+      vert_loops[j] = vert_loops[j - 1];
+    }
+    vert_loops[j] = ml_index;
+  }
+
+  for (int i = 0; i < vert_loops_len; i++) {
+    const int ml_curr_index = vert_loops[i];
+    const int mp_index = loop_to_poly[ml_curr_index];
+    const MPoly *mp = &mpolys[mp_index];
+    const int ml_prev_index = (ml_curr_index == mp->loopstart) ?
+                                  (mp->loopstart + mp->totloop - 1) :
+                                  (ml_curr_index - 1);
+    const MLoop *ml_curr = &mloops[ml_curr_index];
+    const MLoop *ml_prev = &mloops[ml_prev_index];
+    const int *e2l_curr = edge_to_loops[ml_curr->e];
+    const int *e2l_prev = edge_to_loops[ml_prev->e];
+
+    /* A smooth edge, we have to check for cyclic smooth fan case.
+     * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
+     * as 'entry point', otherwise we can skip it.
+     *
+     * We *do not need* to check/tag other loops as already computed!
+     * Due to the fact a loop only links to one of its two edges,
+     * a same fan *will never be walked more than once!*
+     * Since we consider edges having neighbor polys with inverted
+     * (flipped) normals as sharp, we are sure that no fan will be skipped,
+     * even only considering the case (sharp curr_edge, smooth prev_edge),
+     * and not the alternative (smooth curr_edge, sharp prev_edge).
+     * All this due/thanks to link between normals and loop ordering (i.e. winding). */
+    if (!IS_EDGE_SHARP(e2l_curr) && (data->skip_loops[ml_curr_index] ||
+                                     !loop_split_check_cyclic_smooth_fan(mloops,
+                                                                         mpolys,
+                                                                         edge_to_loops,
+                                                                         loop_to_poly,
+                                                                         e2l_prev,
+                                                                         data->skip_loops,
+                                                                         ml_curr,
+                                                                         ml_prev,
+                                                                         ml_curr_index,
+                                                                         ml_prev_index,
+                                                                         mp_index))) {
+      continue;
+    }
 
-  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
+    const char fan_type = (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) ?
+                              LOOP_SPLIT_FAN_SINGLE :
+                              LOOP_SPLIT_FAN_SMOOTH;
+    fan_fn(data, ml_curr_index, fan_type, userdata);
+  }
+}
 
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
+static void loop_split_vert_fan_compute_fn(LoopSplitVertData *data,
+                                           const int ml_index,
+                                           const char fan_type,
+                                           void *UNUSED(userdata))
+{
+  loop_split_fan_do(data->common_data, ml_index, fan_type, NULL, NULL);
+}
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
+static void loop_split_vert_fan_tag_fn(LoopSplitVertData *data,
+                                       const int ml_index,
+                                       const char fan_type,
+                                       void *userdata)
+{
+  int *spaces_len = userdata;
 
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_generator);
-#endif
+  data->loop_fan_type[ml_index] = fan_type;
+  (*spaces_len)++;
+}
 
-  if (!pool) {
-    if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+static void loop_split_vert_block_find_cb(void *__restrict userdata,
+                                          const int iter,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitVertData *data = userdata;
+  const int v_start = iter * LOOP_SPLIT_VERT_BLOCK_SIZE;
+  const int v_end = min_ii(v_start + LOOP_SPLIT_VERT_BLOCK_SIZE, data->common_data->numVerts);
+
+  if (data->common_data->lnors_spacearr) {
+    /* Only tag the fans, spaces get allocated once all of them are known. */
+    int spaces_len = 0;
+    for (int v = v_start; v < v_end; v++) {
+      loop_split_vert_fans_find(data, v, loop_split_vert_fan_tag_fn, &spaces_len);
+    }
+    data->block_spaces_offset[iter] = spaces_len;
+  }
+  else {
+    for (int v = v_start; v < v_end; v++) {
+      loop_split_vert_fans_find(data, v, loop_split_vert_fan_compute_fn, NULL);
     }
   }
+}
 
-  /* We now know edges that can be smoothed (with their vector, and their two loops),
-   * and edges that will be hard! Now, time to generate the normals.
-   */
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    float(*lnors)[3];
-    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
-    ml_curr_index = mp->loopstart;
-    ml_prev_index = ml_last_index;
+static void loop_split_vert_block_compute_cb(void *__restrict userdata,
+                                             const int iter,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitVertData *data = userdata;
+  LoopSplitTaskDataCommon *common_data = data->common_data;
+  const int v_start = iter * LOOP_SPLIT_VERT_BLOCK_SIZE;
+  const int v_end = min_ii(v_start + LOOP_SPLIT_VERT_BLOCK_SIZE, common_data->numVerts);
+
+  MLoopNorSpace *lnor_space = &data->spaces[data->block_spaces_offset[iter]];
+  /* Temp edge vectors stack, owned by this task. */
+  BLI_Stack *edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+
+  for (int v = v_start; v < v_end; v++) {
+    /* Loops were sorted by the previous pass. */
+    for (int i = data->vert_loops_offset[v]; i < data->vert_loops_offset[v + 1]; i++) {
+      const int ml_index = data->vert_loops[i];
+      const char fan_type = data->loop_fan_type[ml_index];
+      if (fan_type != LOOP_SPLIT_FAN_NONE) {
+        loop_split_fan_do(common_data, ml_index, fan_type, lnor_space++, edge_vectors);
+      }
+    }
+  }
 
-    ml_curr = &mloops[ml_curr_index];
-    ml_prev = &mloops[ml_prev_index];
-    lnors = &loopnors[ml_curr_index];
+  BLI_stack_free(edge_vectors);
+}
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++, lnors++) {
-      const int *e2l_curr = edge_to_loops[ml_curr->e];
-      const int *e2l_prev = edge_to_loops[ml_prev->e];
+static void loop_split_fans_compute(LoopSplitTaskDataCommon *common_data)
+{
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  const int numVerts = common_data->numVerts;
+  const int numLoops = common_data->numLoops;
+  const int blocks_len = (int)divide_ceil_u((uint)numVerts, LOOP_SPLIT_VERT_BLOCK_SIZE);
 
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
+#ifdef DEBUG_TIME
+  TIMEIT_START_AVERAGED(loop_split_fans_compute);
 #endif
 
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
-       * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
-      }
-      else {
-        LoopSplitTaskData *data, data_local;
+  LoopSplitVertData data = {
+      .common_data = common_data,
+      .vert_loops_offset = MEM_calloc_arrayN(
+          (size_t)numVerts + 1, sizeof(*data.vert_loops_offset), __func__),
+      .vert_loops_fill = MEM_calloc_arrayN(
+          (size_t)numVerts, sizeof(*data.vert_loops_fill), __func__),
+      .vert_loops = MEM_malloc_arrayN((size_t)numLoops, sizeof(*data.vert_loops), __func__),
+      .skip_loops = MEM_calloc_arrayN((size_t)numLoops, sizeof(*data.skip_loops), __func__),
+  };
 
-        //              printf("PROCESSING!\n");
+  /* Not enough loops to be worth the whole threading overhead... */
+  const bool use_threading = (numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
 
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
-          }
-          data = &data_buff[data_idx];
-        }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
-        }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = use_threading;
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE;
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
-#endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
+  /* Build the vertex -> loops mapping. */
+  BLI_task_parallel_range(0, numLoops, &data, loop_split_vert_loops_count_cb, &settings);
+  for (int v = 0; v < numVerts; v++) {
+    data.vert_loops_offset[v + 1] += data.vert_loops_offset[v];
+  }
+  BLI_task_parallel_range(0, numLoops, &data, loop_split_vert_loops_fill_cb, &settings);
+  MEM_freeN(data.vert_loops_fill);
 
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
-        }
-      }
+  if (lnors_spacearr) {
+    data.loop_fan_type = MEM_calloc_arrayN(
+        (size_t)numLoops, sizeof(*data.loop_fan_type), __func__);
+    data.block_spaces_offset = MEM_malloc_arrayN(
+        (size_t)blocks_len, sizeof(*data.block_spaces_offset), __func__);
+  }
 
-      ml_prev = ml_curr;
-      ml_prev_index = ml_curr_index;
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, blocks_len, &data, loop_split_vert_block_find_cb, &settings);
+
+  if (lnors_spacearr) {
+    int spaces_len = 0;
+    for (int i = 0; i < blocks_len; i++) {
+      const int block_spaces_len = data.block_spaces_offset[i];
+      data.block_spaces_offset[i] = spaces_len;
+      spaces_len += block_spaces_len;
     }
-  }
 
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-  }
+    if (spaces_len) {
+      data.spaces = BLI_memarena_calloc(lnors_spacearr->mem,
+                                        sizeof(*data.spaces) * (size_t)spaces_len);
+      lnors_spacearr->num_spaces += spaces_len;
 
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
+      BLI_task_parallel_range(0, blocks_len, &data, loop_split_vert_block_compute_cb, &settings);
+    }
+
+    MEM_freeN(data.loop_fan_type);
+    MEM_freeN(data.block_spaces_offset);
   }
-  MEM_freeN(skip_loops);
+
+  MEM_freeN(data.vert_loops_offset);
+  MEM_freeN(data.vert_loops);
+  MEM_freeN(data.skip_loops);
 
 #ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_generator);
+  TIMEIT_END_AVERAGED(loop_split_fans_compute);
 #endif
 }
 
@@ -1602,7 +1707,7 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
  * (splitting edges).
  */
 void BKE_mesh_normals_loop_split(const MVert *mverts,
-                                 const int UNUSED(numVerts),
+                                 const int numVerts,
                                  MEdge *medges,
                                  const int numEdges,
                                  MLoop *mloops,
@@ -1702,6 +1807,7 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
       .edge_to_loops = edge_to_loops,
       .loop_to_poly = loop_to_poly,
       .polynors = polynors,
+      .numVerts = numVerts,
       .numEdges = numEdges,
       .numLoops = numLoops,
       .numPolys = numPolys,
@@ -1710,19 +1816,8 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
   /* This first loop check which edges are actually smooth, and compute edge vectors. */
   mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
-  }
-  else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
-
-    loop_split_generator(task_pool, &common_data);
-
-    BLI_task_pool_work_and_wait(task_pool);
-
-    BLI_task_pool_free(task_pool);
-  }
+  /* Now walk the smooth fans around each vertex, and compute their normals. */
+  loop_split_fans_compute(&common_data);
 
   MEM_freeN(edge_to_loops);
   if (!r_loop_to_poly) {
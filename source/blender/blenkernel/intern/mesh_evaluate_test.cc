@@ -0,0 +1,154 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_math.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+class MeshNormalsLoopSplitTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/* Grid of `size` x `size` smooth quads, with a bit of relief. */
+static Mesh *smooth_grid_mesh_create(const int size)
+{
+  Mesh *mesh = grid_mesh_create(size, true);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    mesh->mpoly[i].flag |= ME_SMOOTH;
+  }
+  return mesh;
+}
+
+/* Tag the edges of the vertical line of vertices at `x` as sharp. */
+static void grid_mesh_sharp_column_tag(Mesh *mesh, const int size, const int x)
+{
+  for (int i = 0; i < mesh->totedge; i++) {
+    MEdge *me = &mesh->medge[i];
+    const int x1 = (int)me->v1 % (size + 1);
+    const int x2 = (int)me->v2 % (size + 1);
+    if (x1 == x && x2 == x) {
+      me->flag |= ME_SHARP;
+    }
+  }
+}
+
+/* Compute the split normals of the mesh, and check each loop got a valid normal and space. */
+static void grid_mesh_normals_loop_split(Mesh *mesh,
+                                         float (*r_loopnors)[3],
+                                         MLoopNorSpaceArray *r_lnors_spacearr)
+{
+  float(*polynors)[3] = (float(*)[3])MEM_malloc_arrayN(
+      (size_t)mesh->totpoly, sizeof(*polynors), __func__);
+  BKE_mesh_calc_normals_poly(mesh->mvert,
+                             nullptr,
+                             mesh->totvert,
+                             mesh->mloop,
+                             mesh->mpoly,
+                             mesh->totloop,
+                             mesh->totpoly,
+                             polynors,
+                             true);
+
+  BKE_mesh_normals_loop_split(mesh->mvert,
+                              mesh->totvert,
+                              mesh->medge,
+                              mesh->totedge,
+                              mesh->mloop,
+                              r_loopnors,
+                              mesh->totloop,
+                              mesh->mpoly,
+                              polynors,
+                              mesh->totpoly,
+                              true,
+                              (float)M_PI,
+                              r_lnors_spacearr,
+                              nullptr,
+                              nullptr);
+
+  for (int i = 0; i < mesh->totloop; i++) {
+    EXPECT_NE(r_lnors_spacearr->lspacearr[i], nullptr);
+    EXPECT_NEAR(len_v3(r_loopnors[i]), 1.0f, 1e-5f);
+  }
+
+  MEM_freeN(polynors);
+}
+
+static void normals_loop_split_test(const int size)
+{
+  Mesh *mesh = smooth_grid_mesh_create(size);
+  const int verts_len = mesh->totvert;
+  float(*loopnors)[3] = (float(*)[3])MEM_malloc_arrayN(
+      (size_t)mesh->totloop, sizeof(*loopnors), __func__);
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+
+  /* Every vertex has a single smooth fan, cyclic or ending at the grid boundary. */
+  grid_mesh_normals_loop_split(mesh, loopnors, &lnors_spacearr);
+  EXPECT_EQ(lnors_spacearr.num_spaces, verts_len);
+  for (int i = 0; i < mesh->totloop; i++) {
+    float vnor[3];
+    normal_short_to_float_v3(vnor, mesh->mvert[mesh->mloop[i].v].no);
+    EXPECT_V3_NEAR(loopnors[i], vnor, 1e-3f);
+  }
+
+  /* Vertices of the sharp column get two fans, split on each side of it. */
+  const int x_sharp = size / 2;
+  grid_mesh_sharp_column_tag(mesh, size, x_sharp);
+  BKE_lnor_spacearr_clear(&lnors_spacearr);
+  grid_mesh_normals_loop_split(mesh, loopnors, &lnors_spacearr);
+  EXPECT_EQ(lnors_spacearr.num_spaces, verts_len + size + 1);
+  for (int y = 0; y < size; y++) {
+    /* Loops of the same vertex, on the left and right of the sharp column. */
+    const int ml_left = mesh->mpoly[y * size + x_sharp - 1].loopstart + 1;
+    const int ml_right = mesh->mpoly[y * size + x_sharp].loopstart;
+    EXPECT_EQ(mesh->mloop[ml_left].v, mesh->mloop[ml_right].v);
+    EXPECT_NE(lnors_spacearr.lspacearr[ml_left], lnors_spacearr.lspacearr[ml_right]);
+  }
+
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+  MEM_freeN(loopnors);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshNormalsLoopSplitTest, SmallGrid)
+{
+  normals_loop_split_test(8);
+}
+
+/* Large enough for the threaded code path. */
+TEST_F(MeshNormalsLoopSplitTest, LargeGrid)
+{
+  normals_loop_split_test(100);
+}
+
+}  // namespace blender::bke::tests
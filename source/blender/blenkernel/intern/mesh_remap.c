@@ -753,13 +753,10 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
     float tmp_co[3], tmp_no[3];
 
     if (mode == MREMAP_MODE_EDGE_VERT_NEAREST) {
-      const int num_verts_src = me_src->totvert;
-      const int num_edges_src = me_src->totedge;
       MEdge *edges_src = me_src->medge;
       float(*vcos_src)[3] = BKE_mesh_vert_coords_alloc(me_src, NULL);
 
-      MeshElemMap *vert_to_edge_src_map;
-      int *vert_to_edge_src_map_mem;
+      const MeshElemMap *vert_to_edge_src_map = BKE_mesh_runtime_vert_edge_map_ensure(me_src);
 
       struct {
         float hit_dist;
@@ -771,12 +768,6 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
         v_dst_to_src_map[i].hit_dist = -1.0f;
       }
 
-      BKE_mesh_vert_edge_map_create(&vert_to_edge_src_map,
-                                    &vert_to_edge_src_map_mem,
-                                    edges_src,
-                                    num_verts_src,
-                                    num_edges_src);
-
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
       nearest.index = -1;
 
@@ -876,8 +867,6 @@ void BKE_mesh_remap_calc_edges_from_mesh(const int mode,
 
       MEM_freeN(vcos_src);
       MEM_freeN(v_dst_to_src_map);
-      MEM_freeN(vert_to_edge_src_map);
-      MEM_freeN(vert_to_edge_src_map_mem);
     }
     else if (mode == MREMAP_MODE_EDGE_NEAREST) {
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
@@ -1073,7 +1062,7 @@ static void mesh_island_to_astar_graph_edge_process(MeshIslandStore *islands,
                                                     MLoop *loops,
                                                     const int edge_idx,
                                                     BLI_bitmap *done_edges,
-                                                    MeshElemMap *edge_to_poly_map,
+                                                    const MeshElemMap *edge_to_poly_map,
                                                     const bool is_edge_innercut,
                                                     const int *poly_island_index_map,
                                                     float (*poly_centers)[3],
@@ -1127,7 +1116,7 @@ static void mesh_island_to_astar_graph_edge_process(MeshIslandStore *islands,
 static void mesh_island_to_astar_graph(MeshIslandStore *islands,
                                        const int island_index,
                                        MVert *verts,
-                                       MeshElemMap *edge_to_poly_map,
+                                       const MeshElemMap *edge_to_poly_map,
                                        const int numedges,
                                        MLoop *loops,
                                        MPoly *polys,
@@ -1317,12 +1306,10 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
 
     float(*poly_cents_src)[3] = NULL;
 
-    MeshElemMap *vert_to_loop_map_src = NULL;
-    int *vert_to_loop_map_src_buff = NULL;
-    MeshElemMap *vert_to_poly_map_src = NULL;
-    int *vert_to_poly_map_src_buff = NULL;
-    MeshElemMap *edge_to_poly_map_src = NULL;
-    int *edge_to_poly_map_src_buff = NULL;
+    /* Owned by the source mesh, see #BKE_mesh_runtime_vert_poly_map_ensure. */
+    const MeshElemMap *vert_to_loop_map_src = NULL;
+    const MeshElemMap *vert_to_poly_map_src = NULL;
+    const MeshElemMap *edge_to_poly_map_src = NULL;
     MeshElemMap *poly_to_looptri_map_src = NULL;
     int *poly_to_looptri_map_src_buff = NULL;
 
@@ -1431,33 +1418,14 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
     }
 
     if (use_from_vert) {
-      BKE_mesh_vert_loop_map_create(&vert_to_loop_map_src,
-                                    &vert_to_loop_map_src_buff,
-                                    polys_src,
-                                    loops_src,
-                                    num_verts_src,
-                                    num_polys_src,
-                                    num_loops_src);
+      vert_to_loop_map_src = BKE_mesh_runtime_vert_loop_map_ensure(me_src);
       if (mode & MREMAP_USE_POLY) {
-        BKE_mesh_vert_poly_map_create(&vert_to_poly_map_src,
-                                      &vert_to_poly_map_src_buff,
-                                      polys_src,
-                                      loops_src,
-                                      num_verts_src,
-                                      num_polys_src,
-                                      num_loops_src);
+        vert_to_poly_map_src = BKE_mesh_runtime_vert_poly_map_ensure(me_src);
       }
     }
 
     /* Needed for islands (or plain mesh) to AStar graph conversion. */
-    BKE_mesh_edge_poly_map_create(&edge_to_poly_map_src,
-                                  &edge_to_poly_map_src_buff,
-                                  edges_src,
-                                  num_edges_src,
-                                  polys_src,
-                                  num_polys_src,
-                                  loops_src,
-                                  num_loops_src);
+    edge_to_poly_map_src = BKE_mesh_runtime_edge_poly_map_ensure(me_src);
     if (use_from_vert) {
       loop_to_poly_map_src = MEM_mallocN(sizeof(*loop_to_poly_map_src) * (size_t)num_loops_src,
                                          __func__);
@@ -1650,7 +1618,7 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
         ml_dst = &loops_dst[mp_dst->loopstart];
         for (plidx_dst = 0; plidx_dst < mp_dst->totloop; plidx_dst++, ml_dst++) {
           if (use_from_vert) {
-            MeshElemMap *vert_to_refelem_map_src = NULL;
+            const MeshElemMap *vert_to_refelem_map_src = NULL;
 
             copy_v3_v3(tmp_co, verts_dst[ml_dst->v].co);
             nearest.index = -1;
@@ -2157,24 +2125,6 @@ void BKE_mesh_remap_calc_loops_from_mesh(const int mode,
     if (vcos_src) {
       MEM_freeN(vcos_src);
     }
-    if (vert_to_loop_map_src) {
-      MEM_freeN(vert_to_loop_map_src);
-    }
-    if (vert_to_loop_map_src_buff) {
-      MEM_freeN(vert_to_loop_map_src_buff);
-    }
-    if (vert_to_poly_map_src) {
-      MEM_freeN(vert_to_poly_map_src);
-    }
-    if (vert_to_poly_map_src_buff) {
-      MEM_freeN(vert_to_poly_map_src_buff);
-    }
-    if (edge_to_poly_map_src) {
-      MEM_freeN(edge_to_poly_map_src);
-    }
-    if (edge_to_poly_map_src_buff) {
-      MEM_freeN(edge_to_poly_map_src_buff);
-    }
     if (poly_to_looptri_map_src) {
       MEM_freeN(poly_to_looptri_map_src);
     }
@@ -30,15 +30,20 @@
 #include "DNA_object_types.h"
 
 #include "BLI_math_geom.h"
+#include "BLI_sort_utils.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_bvhutils.h"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_shrinkwrap.h"
 #include "BKE_subdiv_ccg.h"
 
+static void mesh_adjacency_cache_free(Mesh *mesh);
+
 /* -------------------------------------------------------------------- */
 /** \name Mesh Runtime Struct Utils
  * \{ */
@@ -67,6 +72,7 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   memset(&runtime->looptris, 0, sizeof(runtime->looptris));
   runtime->bvh_cache = NULL;
   runtime->shrinkwrap_data = NULL;
+  runtime->adjacency_cache = NULL;
 
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
@@ -236,6 +242,239 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
     mesh->runtime.subdiv_ccg = NULL;
   }
   BKE_shrinkwrap_discard_boundary_data(mesh);
+  mesh_adjacency_cache_free(mesh);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Adjacency Cache
+ *
+ * Topology maps requested by modifiers and tools, built on first use and kept until the geometry
+ * of the mesh changes (see #BKE_mesh_runtime_clear_geometry).
+ *
+ * Maps are built with a parallel counting sort, indices of each element are then sorted so the
+ * result does not depend on the threads scheduling.
+ * \{ */
+
+typedef enum eMeshAdjacencyType {
+  MESH_ADJACENCY_VERT_POLY = 0,
+  MESH_ADJACENCY_VERT_LOOP,
+  MESH_ADJACENCY_VERT_EDGE,
+  MESH_ADJACENCY_EDGE_POLY,
+} eMeshAdjacencyType;
+#define MESH_ADJACENCY_TOT (MESH_ADJACENCY_EDGE_POLY + 1)
+
+typedef struct MeshAdjacencyCache {
+  ThreadMutex mutex;
+  MeshElemMap *map[MESH_ADJACENCY_TOT];
+  int *map_mem[MESH_ADJACENCY_TOT];
+} MeshAdjacencyCache;
+
+typedef struct MeshAdjacencyBuildData {
+  const Mesh *mesh;
+  eMeshAdjacencyType type;
+  MeshElemMap *map;
+  /** False while counting the indices of each element, true while filling them. */
+  bool do_fill;
+} MeshAdjacencyBuildData;
+
+BLI_INLINE void mesh_adjacency_map_add(MeshAdjacencyBuildData *data,
+                                       const unsigned int elem,
+                                       const int index)
+{
+  MeshElemMap *map_elem = &data->map[elem];
+  if (data->do_fill) {
+    const int slot = atomic_fetch_and_add_int32(&map_elem->count, 1);
+    map_elem->indices[slot] = index;
+  }
+  else {
+    atomic_add_and_fetch_int32(&map_elem->count, 1);
+  }
+}
+
+static void mesh_adjacency_map_build_cb(void *__restrict userdata,
+                                        const int index,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshAdjacencyBuildData *data = userdata;
+  const Mesh *mesh = data->mesh;
+
+  switch (data->type) {
+    case MESH_ADJACENCY_VERT_POLY:
+    case MESH_ADJACENCY_EDGE_POLY: {
+      const MPoly *mp = &mesh->mpoly[index];
+      const MLoop *ml = &mesh->mloop[mp->loopstart];
+      const bool use_verts = (data->type == MESH_ADJACENCY_VERT_POLY);
+      for (int j = 0; j < mp->totloop; j++, ml++) {
+        mesh_adjacency_map_add(data, use_verts ? ml->v : ml->e, index);
+      }
+      break;
+    }
+    case MESH_ADJACENCY_VERT_LOOP:
+      mesh_adjacency_map_add(data, mesh->mloop[index].v, index);
+      break;
+    case MESH_ADJACENCY_VERT_EDGE:
+      mesh_adjacency_map_add(data, mesh->medge[index].v1, index);
+      mesh_adjacency_map_add(data, mesh->medge[index].v2, index);
+      break;
+  }
+}
+
+static void mesh_adjacency_map_sort_cb(void *__restrict userdata,
+                                       const int index,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshAdjacencyBuildData *data = userdata;
+  MeshElemMap *map_elem = &data->map[index];
+  int *indices = map_elem->indices;
+
+  if (map_elem->count > 16) {
+    qsort(indices, (size_t)map_elem->count, sizeof(*indices), BLI_sortutil_cmp_int);
+    return;
+  }
+  /* Most elements only use a handful of others, insertion sort is fine. */
+  for (int i = 1; i < map_elem->count; i++) {
+    const int value = indices[i];
+    int j = i;
+    for (; j > 0 && indices[j - 1] > value; j--) {
+      indices[j] = indices[j - 1];
+    }
+    indices[j] = value;
+  }
+}
+
+static void mesh_adjacency_map_build(const Mesh *mesh,
+                                     const eMeshAdjacencyType type,
+                                     MeshElemMap **r_map,
+                                     int **r_mem)
+{
+  int elem_len, items_len, indices_len;
+  switch (type) {
+    case MESH_ADJACENCY_VERT_POLY:
+    case MESH_ADJACENCY_VERT_LOOP:
+      elem_len = mesh->totvert;
+      items_len = (type == MESH_ADJACENCY_VERT_POLY) ? mesh->totpoly : mesh->totloop;
+      indices_len = mesh->totloop;
+      break;
+    case MESH_ADJACENCY_VERT_EDGE:
+      elem_len = mesh->totvert;
+      items_len = mesh->totedge;
+      indices_len = mesh->totedge * 2;
+      break;
+    case MESH_ADJACENCY_EDGE_POLY:
+    default:
+      elem_len = mesh->totedge;
+      items_len = mesh->totpoly;
+      indices_len = mesh->totloop;
+      break;
+  }
+
+  MeshElemMap *map = MEM_calloc_arrayN((size_t)elem_len, sizeof(*map), __func__);
+  int *mem = MEM_malloc_arrayN((size_t)indices_len, sizeof(*mem), __func__);
+
+  MeshAdjacencyBuildData data = {
+      .mesh = mesh,
+      .type = type,
+      .map = map,
+      .do_fill = false,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  BLI_task_parallel_range(0, items_len, &data, mesh_adjacency_map_build_cb, &settings);
+
+  /* Assign indices mem, and reset 'count' for use as index when filling. */
+  int *mem_iter = mem;
+  for (int i = 0; i < elem_len; i++) {
+    map[i].indices = mem_iter;
+    mem_iter += map[i].count;
+    map[i].count = 0;
+  }
+
+  data.do_fill = true;
+  BLI_task_parallel_range(0, items_len, &data, mesh_adjacency_map_build_cb, &settings);
+  BLI_task_parallel_range(0, elem_len, &data, mesh_adjacency_map_sort_cb, &settings);
+
+  *r_map = map;
+  *r_mem = mem;
+}
+
+static const MeshElemMap *mesh_adjacency_map_ensure(Mesh *mesh, const eMeshAdjacencyType type)
+{
+  MeshAdjacencyCache *cache = mesh->runtime.adjacency_cache;
+  if (cache == NULL) {
+    MeshAdjacencyCache *cache_new = MEM_callocN(sizeof(*cache_new), __func__);
+    BLI_mutex_init(&cache_new->mutex);
+    cache = atomic_cas_ptr((void **)&mesh->runtime.adjacency_cache, NULL, cache_new);
+    if (cache == NULL) {
+      cache = cache_new;
+    }
+    else {
+      /* Another thread was faster. */
+      BLI_mutex_end(&cache_new->mutex);
+      MEM_freeN(cache_new);
+    }
+  }
+
+  BLI_mutex_lock(&cache->mutex);
+  if (cache->map[type] == NULL) {
+    mesh_adjacency_map_build(mesh, type, &cache->map[type], &cache->map_mem[type]);
+  }
+  const MeshElemMap *map = cache->map[type];
+  BLI_mutex_unlock(&cache->mutex);
+
+  return map;
+}
+
+static void mesh_adjacency_cache_free(Mesh *mesh)
+{
+  MeshAdjacencyCache *cache = mesh->runtime.adjacency_cache;
+  if (cache == NULL) {
+    return;
+  }
+  for (int i = 0; i < MESH_ADJACENCY_TOT; i++) {
+    MEM_SAFE_FREE(cache->map[i]);
+    MEM_SAFE_FREE(cache->map_mem[i]);
+  }
+  BLI_mutex_end(&cache->mutex);
+  MEM_freeN(cache);
+  mesh->runtime.adjacency_cache = NULL;
+}
+
+/**
+ * Cached version of #BKE_mesh_vert_poly_map_create, polys of each vertex are sorted by index.
+ * The map is owned by the mesh and stays valid until its geometry changes.
+ */
+const MeshElemMap *BKE_mesh_runtime_vert_poly_map_ensure(Mesh *mesh)
+{
+  return mesh_adjacency_map_ensure(mesh, MESH_ADJACENCY_VERT_POLY);
+}
+
+/**
+ * Cached version of #BKE_mesh_vert_loop_map_create, loops of each vertex are sorted by index.
+ */
+const MeshElemMap *BKE_mesh_runtime_vert_loop_map_ensure(Mesh *mesh)
+{
+  return mesh_adjacency_map_ensure(mesh, MESH_ADJACENCY_VERT_LOOP);
+}
+
+/**
+ * Cached version of #BKE_mesh_vert_edge_map_create, edges of each vertex are sorted by index.
+ */
+const MeshElemMap *BKE_mesh_runtime_vert_edge_map_ensure(Mesh *mesh)
+{
+  return mesh_adjacency_map_ensure(mesh, MESH_ADJACENCY_VERT_EDGE);
+}
+
+/**
+ * Cached version of #BKE_mesh_edge_poly_map_create, polys of each edge are sorted by index.
+ */
+const MeshElemMap *BKE_mesh_runtime_edge_poly_map_ensure(Mesh *mesh)
+{
+  return mesh_adjacency_map_ensure(mesh, MESH_ADJACENCY_EDGE_POLY);
 }
 
 /** \} */
@@ -0,0 +1,103 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
+#include "BKE_mesh_runtime.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+class MeshAdjacencyCacheTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+static void expect_maps_equal(const MeshElemMap *map_cached,
+                              MeshElemMap *map,
+                              int *map_mem,
+                              const int map_len)
+{
+  for (int i = 0; i < map_len; i++) {
+    ASSERT_EQ(map_cached[i].count, map[i].count);
+    for (int j = 0; j < map[i].count; j++) {
+      EXPECT_EQ(map_cached[i].indices[j], map[i].indices[j]);
+    }
+  }
+  MEM_freeN(map);
+  MEM_freeN(map_mem);
+}
+
+TEST_F(MeshAdjacencyCacheTest, MatchesUncachedMaps)
+{
+  /* Polys are stored in reverse order, so the maps are not trivially sorted while being built. */
+  Mesh *mesh = grid_mesh_create(200, false, true);
+  MeshElemMap *map;
+  int *map_mem;
+
+  BKE_mesh_vert_poly_map_create(
+      &map, &map_mem, mesh->mpoly, mesh->mloop, mesh->totvert, mesh->totpoly, mesh->totloop);
+  expect_maps_equal(BKE_mesh_runtime_vert_poly_map_ensure(mesh), map, map_mem, mesh->totvert);
+
+  BKE_mesh_vert_loop_map_create(
+      &map, &map_mem, mesh->mpoly, mesh->mloop, mesh->totvert, mesh->totpoly, mesh->totloop);
+  expect_maps_equal(BKE_mesh_runtime_vert_loop_map_ensure(mesh), map, map_mem, mesh->totvert);
+
+  BKE_mesh_vert_edge_map_create(&map, &map_mem, mesh->medge, mesh->totvert, mesh->totedge);
+  expect_maps_equal(BKE_mesh_runtime_vert_edge_map_ensure(mesh), map, map_mem, mesh->totvert);
+
+  BKE_mesh_edge_poly_map_create(&map,
+                                &map_mem,
+                                mesh->medge,
+                                mesh->totedge,
+                                mesh->mpoly,
+                                mesh->totpoly,
+                                mesh->mloop,
+                                mesh->totloop);
+  expect_maps_equal(BKE_mesh_runtime_edge_poly_map_ensure(mesh), map, map_mem, mesh->totedge);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshAdjacencyCacheTest, ClearedWithGeometry)
+{
+  Mesh *mesh = grid_mesh_create(4);
+
+  const MeshElemMap *map = BKE_mesh_runtime_vert_edge_map_ensure(mesh);
+  EXPECT_EQ(BKE_mesh_runtime_vert_edge_map_ensure(mesh), map);
+  EXPECT_NE(mesh->runtime.adjacency_cache, nullptr);
+
+  BKE_mesh_runtime_clear_geometry(mesh);
+  EXPECT_EQ(mesh->runtime.adjacency_cache, nullptr);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
@@ -30,6 +30,7 @@
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
+#include "DNA_userdef_types.h"
 
 #include "BKE_ccg.h"
 #include "BKE_mesh.h" /* for BKE_mesh_calc_normals */
@@ -51,6 +52,10 @@
 
 #define LEAF_LIMIT 10000
 
+/* Maximum number of nodes which get their freed draw buffers built again per redraw,
+ * so that coming back to a large region of the mesh doesn't stall a single redraw. */
+#define PBVH_DRAW_BUFFERS_REBUILD_MAX 32
+
 //#define PERFCNTRS
 
 #define STACK_FIXED_DEPTH 100
@@ -1333,6 +1338,16 @@ static void pbvh_update_draw_buffer_cb(void *__restrict userdata,
 
 static void pbvh_update_draw_buffers(PBVH *pbvh, PBVHNode **nodes, int totnode, int update_flag)
 {
+  /* Nodes modified after their buffers were freed by #pbvh_free_unused_draw_buffers
+   * are built again once they're back in view, see #pbvh_draw_search_cb. */
+  int totnode_update = 0;
+  for (int n = 0; n < totnode; n++) {
+    if (!(nodes[n]->flag & PBVH_DrawBuffersFreed)) {
+      nodes[totnode_update++] = nodes[n];
+    }
+  }
+  totnode = totnode_update;
+
   if ((update_flag & PBVH_RebuildDrawBuffers) || ELEM(pbvh->type, PBVH_GRIDS, PBVH_BMESH)) {
     /* Free buffers uses OpenGL, so not in parallel. */
     for (int n = 0; n < totnode; n++) {
@@ -2690,6 +2705,10 @@ void BKE_pbvh_face_sets_color_set(PBVH *pbvh, int seed, int color_default)
 typedef struct PBVHDrawSearchData {
   PBVHFrustumPlanes *frustum;
   int accum_update_flag;
+  /* Number of nodes which can still get their freed draw buffers built again. */
+  int rebuild_freed_left;
+  /* Nodes with freed draw buffers were found which are not built again yet. */
+  bool has_freed_left;
 } PBVHDrawSearchData;
 
 static bool pbvh_draw_search_cb(PBVHNode *node, void *data_v)
@@ -2699,27 +2718,85 @@ static bool pbvh_draw_search_cb(PBVHNode *node, void *data_v)
     return false;
   }
 
+  /* Build buffers again for nodes coming back into view, a limited number at a time. */
+  if (node->flag & PBVH_DrawBuffersFreed) {
+    if (data->rebuild_freed_left > 0) {
+      data->rebuild_freed_left--;
+      node->flag &= ~PBVH_DrawBuffersFreed;
+      node->flag |= PBVH_RebuildDrawBuffers | PBVH_UpdateDrawBuffers;
+    }
+    else {
+      data->has_freed_left = true;
+    }
+  }
+
   data->accum_update_flag |= node->flag;
   return true;
 }
 
-void BKE_pbvh_draw_cb(PBVH *pbvh,
-                      bool update_only_visible,
-                      PBVHFrustumPlanes *update_frustum,
-                      PBVHFrustumPlanes *draw_frustum,
-                      void (*draw_fn)(void *user_data, GPU_PBVH_Buffers *buffers),
-                      void *user_data)
+/**
+ * Free draw buffers of leaf nodes that have been outside of the update frustum for a while,
+ * they are built again once the node is in view. Without this every node of a very dense
+ * mesh keeps its buffers after having been in view once, even though only a small part of
+ * the mesh is shown while sculpting details.
+ *
+ * Uses the VBO garbage collection preferences, a time out of 0 keeps all buffers.
+ */
+static void pbvh_free_unused_draw_buffers(PBVH *pbvh, PBVHFrustumPlanes *update_frustum)
+{
+  const int ctime = (int)PIL_check_seconds_timer();
+
+  if (U.vbotimeout == 0 || (ctime - pbvh->draw_buffers_collect_time) < U.vbocollectrate) {
+    return;
+  }
+  pbvh->draw_buffers_collect_time = ctime;
+
+  for (int a = 0; a < pbvh->totnode; a++) {
+    PBVHNode *node = &pbvh->nodes[a];
+    if (!(node->flag & PBVH_Leaf) || node->draw_buffers == NULL) {
+      continue;
+    }
+    if (ctime - node->draw_buffers_lastused <= U.vbotimeout) {
+      continue;
+    }
+    if (BKE_pbvh_node_frustum_contain_AABB(node, update_frustum)) {
+      continue;
+    }
+    /* Free buffers uses OpenGL, so not in parallel. */
+    GPU_pbvh_buffers_free(node->draw_buffers);
+    node->draw_buffers = NULL;
+    node->flag |= PBVH_DrawBuffersFreed;
+  }
+}
+
+/**
+ * Update and draw the nodes of the PBVH.
+ *
+ * \return True when not all visible nodes had their freed draw buffers built again yet,
+ * another redraw is needed to show them.
+ */
+
+bool BKE_pbvh_draw_cb(PBVH *pbvh,
+                     bool update_only_visible,
+                     PBVHFrustumPlanes *update_frustum,
+                     PBVHFrustumPlanes *draw_frustum,
+                     void (*draw_fn)(void *user_data, GPU_PBVH_Buffers *buffers),
+                     void *user_data)
 {
   PBVHNode **nodes;
   int totnode;
   int update_flag = 0;
+  bool has_freed_left = false;
 
   /* Search for nodes that need updates. */
   if (update_only_visible) {
     /* Get visible nodes with draw updates. */
-    PBVHDrawSearchData data = {.frustum = update_frustum, .accum_update_flag = 0};
+    PBVHDrawSearchData data = {.frustum = update_frustum,
+                               .accum_update_flag = 0,
+                               .rebuild_freed_left = PBVH_DRAW_BUFFERS_REBUILD_MAX};
     BKE_pbvh_search_gather(pbvh, pbvh_draw_search_cb, &data, &nodes, &totnode);
     update_flag = data.accum_update_flag;
+    has_freed_left = data.has_freed_left;
   }
   else {
     /* Get all nodes with draw updates, also those outside the view. */
@@ -2735,18 +2812,36 @@ void BKE_pbvh_draw_cb(PBVH *pbvh,
   }
   MEM_SAFE_FREE(nodes);
 
-  /* Draw visible nodes. */
-  PBVHDrawSearchData draw_data = {.frustum = draw_frustum, .accum_update_flag = 0};
+  /* Draw visible nodes. When updating all nodes, visible nodes with freed draw buffers are
+   * flagged here and built again on the next redraw. */
+  const int rebuild_freed_max = update_only_visible ? 0 : PBVH_DRAW_BUFFERS_REBUILD_MAX;
+  PBVHDrawSearchData draw_data = {.frustum = draw_frustum,
+                                  .accum_update_flag = 0,
+                                  .rebuild_freed_left = rebuild_freed_max};
   BKE_pbvh_search_gather(pbvh, pbvh_draw_search_cb, &draw_data, &nodes, &totnode);
+  if (!update_only_visible) {
+    has_freed_left = draw_data.has_freed_left ||
+                     (draw_data.rebuild_freed_left != rebuild_freed_max);
+  }
 
+  const int ctime = (int)PIL_check_seconds_timer();
   for (int i = 0; i < totnode; i++) {
     PBVHNode *node = nodes[i];
+    node->draw_buffers_lastused = ctime;
     if (!(node->flag & PBVH_FullyHidden)) {
       draw_fn(user_data, node->draw_buffers);
     }
   }
 
   MEM_SAFE_FREE(nodes);
+
+  /* Nodes outside the update frustum are only built again once visible, when updating all
+   * nodes the freed buffers would be built again right away. */
+  if (update_only_visible && update_frustum) {
+    pbvh_free_unused_draw_buffers(pbvh, update_frustum);
+  }
+
+  return has_freed_left;
 }
 
 void BKE_pbvh_draw_debug_cb(
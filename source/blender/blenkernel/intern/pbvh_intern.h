@@ -35,6 +35,9 @@ typedef struct {
 struct PBVHNode {
   /* Opaque handle for drawing code */
   struct GPU_PBVH_Buffers *draw_buffers;
+  /* Time in seconds this node was last drawn, draw buffers of nodes that stay out of view
+   * for longer than the VBO time out preference are freed. */
+  int draw_buffers_lastused;
 
   /* Voxel bounds */
   BB vb;
@@ -174,6 +177,9 @@ struct PBVH {
   float planes[6][4];
   int num_planes;
 
+  /* Last time in seconds unused draw buffers were freed. */
+  int draw_buffers_collect_time;
+
   struct BMLog *bm_log;
   struct SubdivCCG *subdiv_ccg;
 };
@@ -47,6 +47,7 @@
 #include "BLI_endian_switch.h"
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -88,6 +89,14 @@
 
 #define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
 
+/* Number of points in each chunk of a compressed data stream, see #PTCACHE_TYPEFLAG_CHUNKED. */
+#define PTCACHE_CHUNK_POINTS 65536
+
+/* Files start with one of these. Files with chunked data streams use another identifier, so that
+ * versions that don't know about chunks refuse to read them instead of reading garbage. */
+#define PTCACHE_FILE_ID "BPHYSICS"
+#define PTCACHE_FILE_ID_CHUNKED "BPHYSIC2"
+
 #ifdef WITH_LZMA
 #  include "LzmaLib.h"
 #endif
@@ -1513,64 +1522,62 @@ static void ptcache_file_close(PTCacheFile *pf)
   }
 }
 
-static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result, unsigned int len)
+/* Decompress `in` into `result`, which is `len` bytes long. */
+static int ptcache_decompress(unsigned char compressed,
+                              const unsigned char *in,
+                              size_t in_len,
+                              const unsigned char *props,
+                              size_t props_len,
+                              unsigned char *result,
+                              unsigned int len)
 {
   int r = 0;
-  unsigned char compressed = 0;
-  size_t in_len;
-#ifdef WITH_LZO
-  size_t out_len = len;
-#endif
-  unsigned char *in;
-  unsigned char *props = MEM_callocN(sizeof(char[16]), "tmp");
 
-  ptcache_file_read(pf, &compressed, 1, sizeof(unsigned char));
-  if (compressed) {
-    unsigned int size;
-    ptcache_file_read(pf, &size, 1, sizeof(unsigned int));
-    in_len = (size_t)size;
-    if (in_len == 0) {
-      /* do nothing */
-    }
-    else {
-      in = (unsigned char *)MEM_callocN(sizeof(unsigned char) * in_len,
-                                        "pointcache_compressed_buffer");
-      ptcache_file_read(pf, in, in_len, sizeof(unsigned char));
+  (void)compressed;
+  (void)in;
+  (void)in_len;
+  (void)props;
+  (void)props_len;
+  (void)result;
+  (void)len; /* unused when building w/o compression */
+
 #ifdef WITH_LZO
-      if (compressed == 1) {
-        r = lzo1x_decompress_safe(in, (lzo_uint)in_len, result, (lzo_uint *)&out_len, NULL);
-      }
+  if (compressed == 1) {
+    size_t out_len = len;
+    r = lzo1x_decompress_safe(in, (lzo_uint)in_len, result, (lzo_uint *)&out_len, NULL);
+  }
 #endif
 #ifdef WITH_LZMA
-      if (compressed == 2) {
-        size_t sizeOfIt;
-        size_t leni = in_len, leno = len;
-        ptcache_file_read(pf, &size, 1, sizeof(unsigned int));
-        sizeOfIt = (size_t)size;
-        ptcache_file_read(pf, props, sizeOfIt, sizeof(unsigned char));
-        r = LzmaUncompress(result, &leno, in, &leni, props, sizeOfIt);
-      }
-#endif
-      MEM_freeN(in);
-    }
-  }
-  else {
-    ptcache_file_read(pf, result, len, sizeof(unsigned char));
+  if (compressed == 2) {
+    size_t leni = in_len, leno = len;
+    r = LzmaUncompress(result, &leno, in, &leni, props, props_len);
   }
-
-  MEM_freeN(props);
+#endif
 
   return r;
 }
-static int ptcache_file_compressed_write(
-    PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode)
+
+/**
+ * Compress `in` into `out`, which has to be large enough for #LZO_OUT_LEN of the input.
+ * Returns the compression that was used, 0 when the data is better stored as is.
+ */
+static unsigned char ptcache_compress(const unsigned char *in,
+                                      unsigned int in_len,
+                                      unsigned char *out,
+                                      size_t *r_out_len,
+                                      unsigned char props[16],
+                                      size_t *r_props_len,
+                                      int mode)
 {
   int r = 0;
   unsigned char compressed = 0;
   size_t out_len = 0;
-  unsigned char *props = MEM_callocN(sizeof(char[16]), "tmp");
   size_t sizeOfIt = 5;
 
+  (void)in;
+  (void)in_len;
+  (void)out;
+  (void)props;
   (void)mode; /* unused when building w/o compression */
 
 #ifdef WITH_LZO
@@ -1589,6 +1596,10 @@ static int ptcache_file_compressed_write(
 #endif
 #ifdef WITH_LZMA
   if (mode == 2) {
+    /* The match finder allocates several times the dictionary size, a dictionary larger than the
+     * input only costs memory. Streams are compressed from multiple tasks at once, so the encoder
+     * doesn't start its own thread. */
+    const unsigned int dict_size = MAX2(MIN2(in_len, 1u << 24), 1u << 12);
 
     r = LzmaCompress(out,
                      &out_len,
@@ -1597,12 +1608,12 @@ static int ptcache_file_compressed_write(
                      props,
                      &sizeOfIt,
                      5,
-                     1 << 24,
+                     dict_size,
                      3,
                      0,
                      2,
                      32,
-                     2);
+                     1);
 
     if (!(r == SZ_OK) || (out_len >= in_len)) {
       compressed = 0;
@@ -1613,6 +1624,98 @@ static int ptcache_file_compressed_write(
   }
 #endif
 
+  (void)r;
+
+  *r_out_len = out_len;
+  *r_props_len = sizeOfIt;
+  return compressed;
+}
+
+/* Read the header of a compressed record, and its compressed data into a new buffer. For stored
+ * records, only the header is read and the returned buffer is NULL. */
+static int ptcache_file_compressed_record_read(PTCacheFile *pf,
+                                               unsigned char *r_compressed,
+                                               unsigned char **r_in,
+                                               size_t *r_in_len,
+                                               unsigned char r_props[16],
+                                               size_t *r_props_len)
+{
+  unsigned char compressed = 0;
+  unsigned int size;
+
+  *r_in = NULL;
+  *r_in_len = 0;
+  *r_props_len = 0;
+
+  if (!ptcache_file_read(pf, &compressed, 1, sizeof(unsigned char))) {
+    return 0;
+  }
+  *r_compressed = compressed;
+  if (!compressed) {
+    return 1;
+  }
+
+  if (!ptcache_file_read(pf, &size, 1, sizeof(unsigned int))) {
+    return 0;
+  }
+  *r_in_len = (size_t)size;
+  if (size == 0) {
+    return 1;
+  }
+
+  *r_in = (unsigned char *)MEM_mallocN(sizeof(unsigned char) * size,
+                                       "pointcache_compressed_buffer");
+  if (!ptcache_file_read(pf, *r_in, size, sizeof(unsigned char))) {
+    return 0;
+  }
+
+  if (compressed == 2) {
+    if (!ptcache_file_read(pf, &size, 1, sizeof(unsigned int)) || size > 16) {
+      return 0;
+    }
+    *r_props_len = (size_t)size;
+    if (!ptcache_file_read(pf, r_props, size, sizeof(unsigned char))) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static int ptcache_file_compressed_read(PTCacheFile *pf, unsigned char *result, unsigned int len)
+{
+  int r = 0;
+  unsigned char compressed = 0;
+  unsigned char *in = NULL;
+  size_t in_len, props_len;
+  unsigned char props[16];
+
+  if (!ptcache_file_compressed_record_read(pf, &compressed, &in, &in_len, props, &props_len)) {
+    /* do nothing */
+  }
+  else if (compressed) {
+    if (in_len != 0) {
+      r = ptcache_decompress(compressed, in, in_len, props, props_len, result, len);
+    }
+  }
+  else {
+    ptcache_file_read(pf, result, len, sizeof(unsigned char));
+  }
+
+  MEM_SAFE_FREE(in);
+
+  return r;
+}
+
+static void ptcache_file_compressed_record_write(PTCacheFile *pf,
+                                                 unsigned char compressed,
+                                                 const unsigned char *in,
+                                                 unsigned int in_len,
+                                                 const unsigned char *out,
+                                                 size_t out_len,
+                                                 const unsigned char *props,
+                                                 size_t props_len)
+{
   ptcache_file_write(pf, &compressed, 1, sizeof(unsigned char));
   if (compressed) {
     unsigned int size = out_len;
@@ -1624,15 +1727,216 @@ static int ptcache_file_compressed_write(
   }
 
   if (compressed == 2) {
-    unsigned int size = sizeOfIt;
-    ptcache_file_write(pf, &sizeOfIt, 1, sizeof(unsigned int));
+    unsigned int size = props_len;
+    ptcache_file_write(pf, &size, 1, sizeof(unsigned int));
     ptcache_file_write(pf, props, size, sizeof(unsigned char));
   }
+}
+
+static int ptcache_file_compressed_write(
+    PTCacheFile *pf, unsigned char *in, unsigned int in_len, unsigned char *out, int mode)
+{
+  size_t out_len, props_len;
+  unsigned char props[16];
+  const unsigned char compressed = ptcache_compress(
+      in, in_len, out, &out_len, props, &props_len, mode);
+
+  ptcache_file_compressed_record_write(
+      pf, compressed, in, in_len, out, out_len, props, props_len);
+
+  return 0;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Chunked Data Streams
+ *
+ * With #PTCACHE_TYPEFLAG_CHUNKED, every data stream is split into chunks of
+ * #PTCACHE_CHUNK_POINTS points. Each chunk is stored as its own compressed record, so that all
+ * chunks of a frame can be compressed and decompressed in parallel. The file layout otherwise
+ * matches the one of compressed caches without chunks.
+ *
+ * Frames with at most #PTCACHE_CHUNK_POINTS points have a single chunk per stream, which is
+ * exactly the layout of compressed caches without chunks. They are written without the flag, so
+ * older versions can still read them, and only their streams are (de)compressed in parallel.
+ * Larger frames can't be read by versions older than the chunks, they are written with
+ * #PTCACHE_FILE_ID_CHUNKED so that those versions don't misread them.
+ * \{ */
+
+typedef struct PTCacheChunk {
+  /* Uncompressed data, pointing into #PTCacheMem.data. */
+  unsigned char *data;
+  unsigned int data_len;
+
+  /* Compression to use when writing. */
+  int mode;
+
+  unsigned char compressed;
+  unsigned char *buffer;
+  size_t buffer_len;
+  unsigned char props[16];
+  size_t props_len;
+} PTCacheChunk;
+
+/* Split all data streams of `pm` into chunks of `chunk_points` points. */
+static PTCacheChunk *ptcache_chunks_create(PTCacheMem *pm,
+                                           const unsigned int chunk_points,
+                                           int *r_totchunk)
+{
+  const unsigned int totchunk_stream = max_ii((pm->totpoint + chunk_points - 1) / chunk_points,
+                                              1);
+  int totchunk = 0;
+
+  for (int i = 0; i < BPHYS_TOT_DATA; i++) {
+    if (pm->data[i]) {
+      totchunk += totchunk_stream;
+    }
+  }
 
-  MEM_freeN(props);
+  PTCacheChunk *chunks = MEM_callocN(sizeof(PTCacheChunk) * max_ii(totchunk, 1),
+                                     "PTCacheChunk");
+  PTCacheChunk *chunk = chunks;
 
-  return r;
+  for (int i = 0; i < BPHYS_TOT_DATA; i++) {
+    if (pm->data[i] == NULL) {
+      continue;
+    }
+    for (unsigned int j = 0; j < totchunk_stream; j++) {
+      const unsigned int start = j * chunk_points;
+      const unsigned int totpoint = min_ii(pm->totpoint - start, chunk_points);
+      chunk->data = (unsigned char *)pm->data[i] + (size_t)start * ptcache_data_size[i];
+      chunk->data_len = totpoint * ptcache_data_size[i];
+      chunk++;
+    }
+  }
+
+  *r_totchunk = totchunk;
+  return chunks;
+}
+
+static void ptcache_chunks_free(PTCacheChunk *chunks, int totchunk)
+{
+  for (int i = 0; i < totchunk; i++) {
+    MEM_SAFE_FREE(chunks[i].buffer);
+  }
+  MEM_freeN(chunks);
 }
+
+/* Run `func` for all chunks, from multiple threads when there is more than one. */
+static void ptcache_chunks_foreach(PTCacheChunk *chunks, int totchunk, TaskRunFunction func)
+{
+  if (totchunk == 1) {
+    func(NULL, &chunks[0]);
+    return;
+  }
+
+  TaskPool *task_pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  for (int i = 0; i < totchunk; i++) {
+    BLI_task_pool_push(task_pool, func, &chunks[i], false, NULL);
+  }
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+}
+
+static void ptcache_chunk_compress_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  PTCacheChunk *chunk = taskdata;
+
+  chunk->buffer = MEM_mallocN(LZO_OUT_LEN(chunk->data_len) * 4, "pointcache_lzo_buffer");
+  chunk->compressed = ptcache_compress(chunk->data,
+                                       chunk->data_len,
+                                       chunk->buffer,
+                                       &chunk->buffer_len,
+                                       chunk->props,
+                                       &chunk->props_len,
+                                       chunk->mode);
+}
+
+static void ptcache_chunk_decompress_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  PTCacheChunk *chunk = taskdata;
+
+  if (chunk->compressed && chunk->buffer_len != 0) {
+    ptcache_decompress(chunk->compressed,
+                       chunk->buffer,
+                       chunk->buffer_len,
+                       chunk->props,
+                       chunk->props_len,
+                       chunk->data,
+                       chunk->data_len);
+  }
+  MEM_SAFE_FREE(chunk->buffer);
+}
+
+static int ptcache_file_chunked_write(PTCacheFile *pf,
+                                      PTCacheMem *pm,
+                                      int mode,
+                                      const unsigned int chunk_points)
+{
+  int totchunk;
+  PTCacheChunk *chunks = ptcache_chunks_create(pm, chunk_points, &totchunk);
+
+  for (int i = 0; i < totchunk; i++) {
+    chunks[i].mode = mode;
+  }
+  if (totchunk > 0) {
+    ptcache_chunks_foreach(chunks, totchunk, ptcache_chunk_compress_task);
+  }
+
+  /* Writing the file is sequential anyway, so it happens on this thread. */
+  for (int i = 0; i < totchunk; i++) {
+    const PTCacheChunk *chunk = &chunks[i];
+    ptcache_file_compressed_record_write(pf,
+                                         chunk->compressed,
+                                         chunk->data,
+                                         chunk->data_len,
+                                         chunk->buffer,
+                                         chunk->buffer_len,
+                                         chunk->props,
+                                         chunk->props_len);
+  }
+
+  ptcache_chunks_free(chunks, totchunk);
+
+  return 1;
+}
+
+static int ptcache_file_chunked_read(PTCacheFile *pf,
+                                     PTCacheMem *pm,
+                                     const unsigned int chunk_points)
+{
+  int totchunk;
+  PTCacheChunk *chunks = ptcache_chunks_create(pm, chunk_points, &totchunk);
+  int error = 0;
+
+  /* Read all compressed records first, so that only the decompression has to wait for the
+   * slowest chunk. */
+  for (int i = 0; i < totchunk && !error; i++) {
+    PTCacheChunk *chunk = &chunks[i];
+    if (!ptcache_file_compressed_record_read(pf,
+                                             &chunk->compressed,
+                                             &chunk->buffer,
+                                             &chunk->buffer_len,
+                                             chunk->props,
+                                             &chunk->props_len)) {
+      error = 1;
+    }
+    else if (!chunk->compressed &&
+             !ptcache_file_read(pf, chunk->data, chunk->data_len, sizeof(unsigned char))) {
+      error = 1;
+    }
+  }
+
+  if (!error && totchunk > 0) {
+    ptcache_chunks_foreach(chunks, totchunk, ptcache_chunk_decompress_task);
+  }
+
+  ptcache_chunks_free(chunks, totchunk);
+
+  return !error;
+}
+
+/** \} */
+
 static int ptcache_file_read(PTCacheFile *pf, void *f, unsigned int tot, unsigned int size)
 {
   return (fread(f, size, tot, pf->fp) == tot);
@@ -1679,7 +1983,8 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
     error = 1;
   }
 
-  if (!error && !STREQLEN(bphysics, "BPHYSICS", 8)) {
+  const bool is_chunked_id = !error && STREQLEN(bphysics, PTCACHE_FILE_ID_CHUNKED, 8);
+  if (!error && !is_chunked_id && !STREQLEN(bphysics, PTCACHE_FILE_ID, 8)) {
     error = 1;
   }
 
@@ -1690,6 +1995,10 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
   pf->type = (typeflag & PTCACHE_TYPEFLAG_TYPEMASK);
   pf->flag = (typeflag & PTCACHE_TYPEFLAG_FLAGMASK);
 
+  if (!error && is_chunked_id && !(pf->flag & PTCACHE_TYPEFLAG_CHUNKED)) {
+    error = 1;
+  }
+
   /* if there was an error set file as it was */
   if (error) {
     BLI_fseek(pf->fp, 0, SEEK_SET);
@@ -1699,7 +2008,8 @@ static int ptcache_file_header_begin_read(PTCacheFile *pf)
 }
 static int ptcache_file_header_begin_write(PTCacheFile *pf)
 {
-  const char *bphysics = "BPHYSICS";
+  const char *bphysics = (pf->flag & PTCACHE_TYPEFLAG_CHUNKED) ? PTCACHE_FILE_ID_CHUNKED :
+                                                                  PTCACHE_FILE_ID;
   unsigned int typeflag = pf->type + pf->flag;
 
   if (fwrite(bphysics, sizeof(char), 8, pf->fp) != 8) {
@@ -1966,12 +2276,15 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 
     ptcache_data_alloc(pm);
 
-    if (pf->flag & PTCACHE_TYPEFLAG_COMPRESS) {
-      for (i = 0; i < BPHYS_TOT_DATA; i++) {
-        unsigned int out_len = pm->totpoint * ptcache_data_size[i];
-        if (pf->data_types & (1 << i)) {
-          ptcache_file_compressed_read(pf, (unsigned char *)(pm->data[i]), out_len);
-        }
+    if (pf->flag & PTCACHE_TYPEFLAG_CHUNKED) {
+      if (!ptcache_file_chunked_read(pf, pm, PTCACHE_CHUNK_POINTS)) {
+        error = 1;
+      }
+    }
+    else if (pf->flag & PTCACHE_TYPEFLAG_COMPRESS) {
+      /* Every stream is a single record, which still allows reading them in parallel. */
+      if (!ptcache_file_chunked_read(pf, pm, max_ii(pm->totpoint, 1))) {
+        error = 1;
       }
     }
     else {
@@ -2057,6 +2370,10 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 
   if (pid->cache->compression) {
     pf->flag |= PTCACHE_TYPEFLAG_COMPRESS;
+    /* Only split streams when there is more than one chunk, see #PTCACHE_FILE_ID_CHUNKED. */
+    if (pm->totpoint > PTCACHE_CHUNK_POINTS) {
+      pf->flag |= PTCACHE_TYPEFLAG_CHUNKED;
+    }
   }
 
   if (!ptcache_file_header_begin_write(pf) || !pid->write_header(pf)) {
@@ -2065,16 +2382,7 @@ static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 
   if (!error) {
     if (pid->cache->compression) {
-      for (i = 0; i < BPHYS_TOT_DATA; i++) {
-        if (pm->data[i]) {
-          unsigned int in_len = pm->totpoint * ptcache_data_size[i];
-          unsigned char *out = (unsigned char *)MEM_callocN(LZO_OUT_LEN(in_len) * 4,
-                                                            "pointcache_lzo_buffer");
-          ptcache_file_compressed_write(
-              pf, (unsigned char *)(pm->data[i]), in_len, out, pid->cache->compression);
-          MEM_freeN(out);
-        }
-      }
+      ptcache_file_chunked_write(pf, pm, pid->cache->compression, PTCACHE_CHUNK_POINTS);
     }
     else {
       void *cur[BPHYS_TOT_DATA];
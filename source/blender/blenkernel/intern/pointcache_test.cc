@@ -0,0 +1,152 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cstdio>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_pointcache.h"
+
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+#include "DNA_pointcache_types.h"
+
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+namespace blender::bke::tests {
+
+class PointCacheTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_tempdir_init(nullptr);
+  }
+
+  static void TearDownTestSuite()
+  {
+    BKE_tempdir_session_purge();
+  }
+
+ protected:
+  Object ob = {};
+  SoftBody sb = {};
+  SoftBody_Shared sb_shared = {};
+  PTCacheID pid;
+
+  void SetUp() override
+  {
+    STRNCPY(ob.id.name, "OBPointCacheTest");
+    sb.shared = &sb_shared;
+    PointCache *cache = BKE_ptcache_add(&sb_shared.ptcaches);
+    sb_shared.pointcache = cache;
+    cache->flag |= PTCACHE_EXTERNAL;
+    cache->index = 0;
+    cache->startframe = cache->endframe = 1;
+    STRNCPY(cache->path, BKE_tempdir_session());
+    STRNCPY(cache->name, "pointcache_test");
+
+    BKE_ptcache_id_from_softbody(&pid, &ob, &sb);
+  }
+
+  void TearDown() override
+  {
+    BKE_ptcache_free_list(&sb_shared.ptcaches);
+  }
+
+  /* Write a frame of `totpoint` points to disk and read it back. */
+  void round_trip(const unsigned int totpoint, const char *file_id)
+  {
+    PTCacheMem *pm = (PTCacheMem *)MEM_callocN(sizeof(PTCacheMem), __func__);
+    pm->frame = 1;
+    pm->totpoint = totpoint;
+    pm->data_types = pid.data_types;
+    float(*location)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * totpoint, __func__);
+    float(*velocity)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * totpoint, __func__);
+    for (unsigned int i = 0; i < totpoint; i++) {
+      location[i][0] = (float)i;
+      location[i][1] = (float)(i % 7);
+      location[i][2] = 1.0f;
+      velocity[i][0] = 0.0f;
+      velocity[i][1] = (float)(i % 13);
+      velocity[i][2] = -(float)i;
+    }
+    pm->data[BPHYS_DATA_LOCATION] = location;
+    pm->data[BPHYS_DATA_VELOCITY] = velocity;
+    BLI_addtail(&pid.cache->mem_cache, pm);
+
+    pid.cache->flag |= PTCACHE_DISK_CACHE;
+    BKE_ptcache_mem_to_disk(&pid);
+    ASSERT_TRUE(pid.cache->flag & PTCACHE_DISK_CACHE);
+
+    char filepath[FILE_MAX];
+    BLI_join_dirfile(filepath,
+                     sizeof(filepath),
+                     BKE_tempdir_session(),
+                     "pointcache_test_000001_00" PTCACHE_EXT);
+    FILE *file = BLI_fopen(filepath, "rb");
+    ASSERT_NE(file, nullptr);
+    char id[8];
+    EXPECT_EQ(fread(id, 1, sizeof(id), file), sizeof(id));
+    fclose(file);
+    EXPECT_EQ(std::string(id, sizeof(id)), file_id);
+
+    /* Reading replaces the memory cache with the frames found on disk. */
+    pid.cache->flag &= ~PTCACHE_DISK_CACHE;
+    BKE_ptcache_disk_to_mem(&pid);
+
+    ASSERT_EQ(BLI_listbase_count(&pid.cache->mem_cache), 1);
+    pm = (PTCacheMem *)pid.cache->mem_cache.first;
+    ASSERT_EQ(pm->totpoint, totpoint);
+    const float(*location_read)[3] = (const float(*)[3])pm->data[BPHYS_DATA_LOCATION];
+    const float(*velocity_read)[3] = (const float(*)[3])pm->data[BPHYS_DATA_VELOCITY];
+    ASSERT_NE(location_read, nullptr);
+    ASSERT_NE(velocity_read, nullptr);
+    unsigned int mismatch_num = 0;
+    for (unsigned int i = 0; i < totpoint; i++) {
+      mismatch_num += location_read[i][0] != (float)i || location_read[i][1] != (float)(i % 7) ||
+                      location_read[i][2] != 1.0f || velocity_read[i][0] != 0.0f ||
+                      velocity_read[i][1] != (float)(i % 13) || velocity_read[i][2] != -(float)i;
+    }
+    EXPECT_EQ(mismatch_num, 0u);
+  }
+};
+
+/* A single chunk per stream, readable by versions from before the chunks. */
+TEST_F(PointCacheTest, RoundTripCompressedSingleChunk)
+{
+  pid.cache->compression = PTCACHE_COMPRESS_LZMA;
+  round_trip(65536, "BPHYSICS");
+}
+
+TEST_F(PointCacheTest, RoundTripCompressedChunked)
+{
+  pid.cache->compression = PTCACHE_COMPRESS_LZMA;
+  round_trip(3 * 65536 + 100, "BPHYSIC2");
+}
+
+TEST_F(PointCacheTest, RoundTripUncompressed)
+{
+  round_trip(3 * 65536 + 100, "BPHYSICS");
+}
+
+}  // namespace blender::bke::tests
@@ -359,7 +359,8 @@ static void *studiolight_multilayer_addlayer(void *base, const char *UNUSED(laye
 /* Convert a multilayer pass to ImBuf channel 4 float buffer.
  * NOTE: Parameter rect will become invalid. Do not use rect after calling this
  * function */
-static float *studiolight_multilayer_convert_pass(ImBuf *ibuf,
+static float *studiolight_multilayer_convert_pass(const int width,
+                                                  const int height,
                                                   float *rect,
                                                   const unsigned int channels)
 {
@@ -367,7 +368,7 @@ static float *studiolight_multilayer_convert_pass(ImBuf *ibuf,
     return rect;
   }
 
-  float *new_rect = MEM_callocN(sizeof(float[4]) * ibuf->x * ibuf->y, __func__);
+  float *new_rect = MEM_callocN(sizeof(float[4]) * width * height, __func__);
 
   IMB_buffer_float_from_float(new_rect,
                               rect,
@@ -375,10 +376,10 @@ static float *studiolight_multilayer_convert_pass(ImBuf *ibuf,
                               IB_PROFILE_LINEAR_RGB,
                               IB_PROFILE_LINEAR_RGB,
                               false,
-                              ibuf->x,
-                              ibuf->y,
-                              ibuf->x,
-                              ibuf->x);
+                              width,
+                              height,
+                              width,
+                              width);
 
   MEM_freeN(rect);
   return new_rect;
@@ -412,58 +413,57 @@ static void studiolight_multilayer_addpass(void *base,
 static void studiolight_load_equirect_image(StudioLight *sl)
 {
   if (sl->flag & STUDIOLIGHT_EXTERNAL_FILE) {
-    ImBuf *ibuf = IMB_loadiffname(sl->path, IB_multilayer, NULL);
+    /* Multilayer OpenEXR files are currently only supported for MATCAPS where
+     * the first found 'diffuse' pass will be used for diffuse lighting
+     * and the first found 'specular' pass will be used for specular lighting.
+     * Other passes are not read from the file. */
+    const char *pass_names[] = {STUDIOLIGHT_PASSNAME_DIFFUSE, STUDIOLIGHT_PASSNAME_SPECULAR};
+    int width, height;
+    void *exrhandle = IMB_exr_read_multilayer_passes(
+        sl->path, pass_names, ARRAY_SIZE(pass_names), &width, &height);
+    ImBuf *ibuf = exrhandle ? NULL : IMB_loadiffname(sl->path, 0, NULL);
     ImBuf *specular_ibuf = NULL;
     ImBuf *diffuse_ibuf = NULL;
-    const bool failed = (ibuf == NULL);
-
-    if (ibuf) {
-      if (ibuf->ftype == IMB_FTYPE_OPENEXR && ibuf->userdata) {
-        /* the read file is a multilayered openexr file (userdata != NULL)
-         * This file is currently only supported for MATCAPS where
-         * the first found 'diffuse' pass will be used for diffuse lighting
-         * and the first found 'specular' pass will be used for specular lighting */
-        MultilayerConvertContext ctx = {0};
-        IMB_exr_multilayer_convert(ibuf->userdata,
-                                   &ctx,
-                                   &studiolight_multilayer_addview,
-                                   &studiolight_multilayer_addlayer,
-                                   &studiolight_multilayer_addpass);
-
-        /* `ctx.diffuse_pass` and `ctx.specular_pass` can be freed inside
-         * `studiolight_multilayer_convert_pass` when conversion happens.
-         * When not converted we move the ownership of the buffer to the
-         * `converted_pass`. We only need to free `converted_pass` as it holds
-         * the unmodified allocation from the `ctx.*_pass` or the converted data.
-         */
-        if (ctx.diffuse_pass != NULL) {
-          float *converted_pass = studiolight_multilayer_convert_pass(
-              ibuf, ctx.diffuse_pass, ctx.num_diffuse_channels);
-          diffuse_ibuf = IMB_allocFromBuffer(
-              NULL, converted_pass, ibuf->x, ibuf->y, ctx.num_diffuse_channels);
-          MEM_freeN(converted_pass);
-        }
-
-        if (ctx.specular_pass != NULL) {
-          float *converted_pass = studiolight_multilayer_convert_pass(
-              ibuf, ctx.specular_pass, ctx.num_specular_channels);
-          specular_ibuf = IMB_allocFromBuffer(
-              NULL, converted_pass, ibuf->x, ibuf->y, ctx.num_specular_channels);
-          MEM_freeN(converted_pass);
-        }
-
-        IMB_exr_close(ibuf->userdata);
-        ibuf->userdata = NULL;
-        IMB_freeImBuf(ibuf);
-        ibuf = NULL;
+    const bool failed = (exrhandle == NULL && ibuf == NULL);
+
+    if (exrhandle) {
+      MultilayerConvertContext ctx = {0};
+      IMB_exr_multilayer_convert(exrhandle,
+                                 &ctx,
+                                 &studiolight_multilayer_addview,
+                                 &studiolight_multilayer_addlayer,
+                                 &studiolight_multilayer_addpass);
+
+      /* `ctx.diffuse_pass` and `ctx.specular_pass` can be freed inside
+       * `studiolight_multilayer_convert_pass` when conversion happens.
+       * When not converted we move the ownership of the buffer to the
+       * `converted_pass`. We only need to free `converted_pass` as it holds
+       * the unmodified allocation from the `ctx.*_pass` or the converted data.
+       */
+      if (ctx.diffuse_pass != NULL) {
+        float *converted_pass = studiolight_multilayer_convert_pass(
+            width, height, ctx.diffuse_pass, ctx.num_diffuse_channels);
+        diffuse_ibuf = IMB_allocFromBuffer(
+            NULL, converted_pass, width, height, ctx.num_diffuse_channels);
+        MEM_freeN(converted_pass);
       }
-      else {
-        /* read file is an single layer openexr file or the read file isn't
-         * an openexr file */
-        IMB_float_from_rect(ibuf);
-        diffuse_ibuf = ibuf;
-        ibuf = NULL;
+
+      if (ctx.specular_pass != NULL) {
+        float *converted_pass = studiolight_multilayer_convert_pass(
+            width, height, ctx.specular_pass, ctx.num_specular_channels);
+        specular_ibuf = IMB_allocFromBuffer(
+            NULL, converted_pass, width, height, ctx.num_specular_channels);
+        MEM_freeN(converted_pass);
       }
+
+      IMB_exr_close(exrhandle);
+    }
+    else if (ibuf) {
+      /* read file is an single layer openexr file or the read file isn't
+       * an openexr file */
+      IMB_float_from_rect(ibuf);
+      diffuse_ibuf = ibuf;
+      ibuf = NULL;
     }
 
     if (diffuse_ibuf == NULL) {
@@ -80,21 +80,32 @@ static void set_coarse_positions(Subdiv *subdiv,
       BLI_BITMAP_ENABLE(vertex_used_map, loop->v);
     }
   }
-  for (int vertex_index = 0, manifold_vertex_index = 0; vertex_index < mesh->totvert;
-       vertex_index++) {
+  /* Upload contiguous runs of used vertices at once, so the evaluator is updated with a single
+   * call for the common case of a mesh without loose vertices. */
+  int manifold_vertex_index = 0;
+  for (int vertex_index = 0; vertex_index < mesh->totvert;) {
     if (!BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
+      vertex_index++;
       continue;
     }
-    const float *vertex_co;
+    const int run_start = vertex_index;
+    while (vertex_index < mesh->totvert && BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
+      vertex_index++;
+    }
+    const int run_len = vertex_index - run_start;
     if (coarse_vertex_cos != NULL) {
-      vertex_co = coarse_vertex_cos[vertex_index];
+      subdiv->evaluator->setCoarsePositions(
+          subdiv->evaluator, coarse_vertex_cos[run_start], manifold_vertex_index, run_len);
     }
     else {
-      const MVert *vertex = &mvert[vertex_index];
-      vertex_co = vertex->co;
+      subdiv->evaluator->setCoarsePositionsFromBuffer(subdiv->evaluator,
+                                                      &mvert[run_start],
+                                                      offsetof(MVert, co),
+                                                      sizeof(MVert),
+                                                      manifold_vertex_index,
+                                                      run_len);
     }
-    subdiv->evaluator->setCoarsePositions(subdiv->evaluator, vertex_co, manifold_vertex_index, 1);
-    manifold_vertex_index++;
+    manifold_vertex_index += run_len;
   }
   MEM_freeN(vertex_used_map);
 }
@@ -1900,8 +1900,12 @@ bool BKE_subdiv_foreach_subdiv_geometry(Subdiv *subdiv,
    * currently are relying on the fact that face/grid callbacks will tag non-
    * loose geometry. */
 
+  /* Faces write the bulk of the subdivided mesh. Splitting them over NUMA nodes makes each node
+   * first touch, and so own, the pages of the output buffers it writes. */
+  parallel_range_settings.use_numa_nodes = true;
   BLI_task_parallel_range(
       0, coarse_mesh->totpoly, &ctx, subdiv_foreach_task, &parallel_range_settings);
+  parallel_range_settings.use_numa_nodes = false;
   if (context->vertex_loose != NULL) {
     BLI_task_parallel_range(0,
                             coarse_mesh->totvert,
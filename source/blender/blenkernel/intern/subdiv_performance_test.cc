@@ -0,0 +1,125 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_lib_id.h"
+#include "BKE_subdiv.h"
+#include "BKE_subdiv_mesh.h"
+
+#include "PIL_time.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+#define DO_PERF_TESTS 0
+
+#if DO_PERF_TESTS
+
+namespace blender::bke::tests {
+
+/* Subdivide an animated grid, as the subdivision surface modifier does for a deforming character.
+ * Compare recreating the topology refiner on every frame with reusing it, in which case only the
+ * coarse positions are uploaded and the stencils are evaluated again. */
+
+#define GRID_SIZE 200
+#define NUM_FRAMES 10
+
+static void subdiv_grid_animate(Mesh *mesh, const int frame)
+{
+  for (int i = 0; i < mesh->totvert; i++) {
+    MVert *mv = &mesh->mvert[i];
+    mv->co[2] = sinf(mv->co[0] * 0.1f + (float)frame * 0.5f);
+  }
+}
+
+static void subdiv_test_do(const char *id, const int level, const bool use_cached_refiner)
+{
+  Mesh *mesh = grid_mesh_create(GRID_SIZE);
+
+  SubdivSettings settings = {};
+  settings.is_simple = false;
+  settings.is_adaptive = false;
+  settings.level = level;
+  settings.use_creases = true;
+  settings.vtx_boundary_interpolation = SUBDIV_VTX_BOUNDARY_EDGE_ONLY;
+  settings.fvar_linear_interpolation = SUBDIV_FVAR_LINEAR_INTERPOLATION_BOUNDARIES;
+
+  SubdivToMeshSettings mesh_settings;
+  mesh_settings.resolution = (1 << level) + 1;
+  mesh_settings.use_optimal_display = false;
+
+  Subdiv *subdiv = nullptr;
+  double time = 0.0;
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    subdiv_grid_animate(mesh, frame);
+
+    const double time_start = PIL_check_seconds_timer();
+    if (use_cached_refiner) {
+      subdiv = BKE_subdiv_update_from_mesh(subdiv, &settings, mesh);
+    }
+    else {
+      subdiv = BKE_subdiv_new_from_mesh(&settings, mesh);
+    }
+    ASSERT_NE(subdiv, nullptr);
+    Mesh *result = BKE_subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+    time += PIL_check_seconds_timer() - time_start;
+
+    ASSERT_NE(result, nullptr);
+    BKE_id_free(nullptr, result);
+    if (!use_cached_refiner) {
+      BKE_subdiv_free(subdiv);
+      subdiv = nullptr;
+    }
+  }
+
+  printf("\t%s, level %d: done in %fs per frame on average over %d frames\n",
+         id,
+         level,
+         time / NUM_FRAMES,
+         NUM_FRAMES);
+
+  if (subdiv != nullptr) {
+    BKE_subdiv_free(subdiv);
+  }
+  BKE_id_free(nullptr, mesh);
+}
+
+class SubdivPerformanceTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    BLI_threadapi_init();
+    BLI_task_scheduler_init();
+    BKE_subdiv_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    BKE_subdiv_exit();
+    BLI_task_scheduler_exit();
+    BLI_threadapi_exit();
+  }
+};
+
+TEST_F(SubdivPerformanceTest, AnimatedGridLevel2)
+{
+  subdiv_test_do("Recreate topology refiner", 2, false);
+  subdiv_test_do("Reuse topology refiner", 2, true);
+}
+
+TEST_F(SubdivPerformanceTest, AnimatedGridLevel3)
+{
+  subdiv_test_do("Recreate topology refiner", 3, false);
+  subdiv_test_do("Reuse topology refiner", 3, true);
+}
+
+}  // namespace blender::bke::tests
+
+#endif
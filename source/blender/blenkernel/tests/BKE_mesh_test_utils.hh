@@ -0,0 +1,56 @@
+/* Apache License, Version 2.0 */
+
+#pragma once
+
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+/**
+ * Grid of `size` x `size` quads in the XY plane, with edges and normals calculated.
+ *
+ * \param use_relief: Offset vertices along Z, so that normals differ per vertex.
+ * \param reverse_polys: Store polygons in reverse order, so that maps built by iterating over
+ * polygons are not trivially sorted.
+ */
+inline Mesh *grid_mesh_create(const int size,
+                              const bool use_relief = false,
+                              const bool reverse_polys = false)
+{
+  const int verts_len = (size + 1) * (size + 1);
+  const int polys_len = size * size;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_len, 0, 0, polys_len * 4, polys_len);
+
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      MVert *mv = &mesh->mvert[y * (size + 1) + x];
+      mv->co[0] = (float)x;
+      mv->co[1] = (float)y;
+      mv->co[2] = use_relief ? (float)((x * 7 + y * 13) % 5) * 0.1f : 0.0f;
+    }
+  }
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int poly_index = reverse_polys ? polys_len - 1 - (y * size + x) : y * size + x;
+      MPoly *mp = &mesh->mpoly[poly_index];
+      mp->loopstart = poly_index * 4;
+      mp->totloop = 4;
+
+      MLoop *ml = &mesh->mloop[mp->loopstart];
+      ml[0].v = y * (size + 1) + x;
+      ml[1].v = y * (size + 1) + x + 1;
+      ml[2].v = (y + 1) * (size + 1) + x + 1;
+      ml[3].v = (y + 1) * (size + 1) + x;
+    }
+  }
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+  return mesh;
+}
+
+}  // namespace blender::bke::tests
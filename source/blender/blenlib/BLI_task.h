@@ -47,6 +47,9 @@ struct BLI_mempool;
 void BLI_task_scheduler_init(void);
 void BLI_task_scheduler_exit(void);
 int BLI_task_scheduler_num_threads(void);
+/* Number of NUMA nodes work can be distributed over, 1 when the system has a single node or
+ * when NUMA support is not available. */
+int BLI_task_scheduler_num_numa_nodes(void);
 
 /* Task Pool
  *
@@ -169,6 +172,12 @@ typedef struct TaskParallelSettings {
    * having a global use_threading switch based on just range size.
    */
   int min_iter_per_thread;
+  /* Split the range over NUMA nodes in contiguous parts, each processed by threads of one node.
+   * The split only depends on the range, so loops over the same range access the same memory
+   * from the same node. Use for memory bound loops over large buffers, together with
+   * BLI_task_parallel_memset() to initialize these buffers.
+   */
+  bool use_numa_nodes;
 } TaskParallelSettings;
 
 BLI_INLINE void BLI_parallel_range_settings_defaults(TaskParallelSettings *settings);
@@ -179,6 +188,11 @@ void BLI_task_parallel_range(const int start,
                              TaskParallelRangeFunc func,
                              const TaskParallelSettings *settings);
 
+/* Fill a buffer of `num_elems` elements with `value`, split over NUMA nodes the same way as
+ * BLI_task_parallel_range() with `use_numa_nodes`. Memory pages are placed on the node of the
+ * thread which touches them first, so this keeps later loops over the buffer node-local. */
+void BLI_task_parallel_memset(void *buffer, int value, size_t elem_size, int num_elems);
+
 /* This data is shared between all tasks, its access needs thread lock or similar protection.
  */
 typedef struct TaskParallelIteratorStateShared {
@@ -41,6 +41,7 @@
 #  endif
 #endif
 
+#include "BLI_function_ref.hh"
 #include "BLI_index_range.hh"
 #include "BLI_utildefines.h"
 
@@ -75,4 +76,12 @@ void parallel_for(IndexRange range, int64_t grain_size, const Function &function
 #endif
 }
 
+/**
+ * Call the function for contiguous parts of the range in parallel, one per NUMA node, with worker
+ * threads pinned to that node. Parts are proportional to the number of threads of each node.
+ * Without multiple NUMA nodes the function is called once for the whole range on node index 0.
+ */
+void parallel_for_numa_nodes(IndexRange range,
+                             FunctionRef<void(int numa_node_index, IndexRange sub_range)> function);
+
 }  // namespace blender
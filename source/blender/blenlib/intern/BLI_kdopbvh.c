@@ -70,6 +70,15 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+/* Number of leafs handled by one task, when the leafs of a single branch are processed in
+ * parallel. */
+#define KDOPBVH_THREAD_BLOCK_SIZE 4096
+
+/* Minimum number of subtrees of the first tree that an overlap query is split into. Splitting
+ * into more tasks than there are threads keeps all threads busy when overlaps are unevenly
+ * distributed over the tree. */
+#define KDOPBVH_OVERLAP_TASK_NUM 64
+
 /* -------------------------------------------------------------------- */
 /** \name Struct Definitions
  * \{ */
@@ -107,6 +116,13 @@ BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
                       (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
                   "over sized")
 
+/* Leaf being sorted into the branches while building the tree. Its bounds along the x, y and z
+ * axis are copied, so that sorting the leafs doesn't read from all over the nodes array. */
+typedef struct BVHSortLeaf {
+  float bv[6];
+  BVHNode *node;
+} BVHSortLeaf;
+
 /* avoid duplicating vars in BVHOverlapData_Thread */
 typedef struct BVHOverlapData_Shared {
   const BVHTree *tree1, *tree2;
@@ -115,6 +131,9 @@ typedef struct BVHOverlapData_Shared {
   /* use for callbacks */
   BVHTree_OverlapCallback callback;
   void *userdata;
+
+  /* Subtrees of the first tree that are traversed by separate tasks. */
+  const BVHNode **task_nodes;
 } BVHOverlapData_Shared;
 
 typedef struct BVHOverlapData_Thread {
@@ -258,14 +277,14 @@ static void node_minmax_init(const BVHTree *tree, BVHNode *node)
 /**
  * Insertion sort algorithm
  */
-static void bvh_insertionsort(BVHNode **a, int lo, int hi, int axis)
+static void bvh_insertionsort(BVHSortLeaf *a, int lo, int hi, int axis)
 {
   int i, j;
-  BVHNode *t;
+  BVHSortLeaf t;
   for (i = lo; i < hi; i++) {
     j = i;
     t = a[i];
-    while ((j != lo) && (t->bv[axis] < (a[j - 1])->bv[axis])) {
+    while ((j != lo) && (t.bv[axis] < a[j - 1].bv[axis])) {
       a[j] = a[j - 1];
       j--;
     }
@@ -273,52 +292,52 @@ static void bvh_insertionsort(BVHNode **a, int lo, int hi, int axis)
   }
 }
 
-static int bvh_partition(BVHNode **a, int lo, int hi, BVHNode *x, int axis)
+static int bvh_partition(BVHSortLeaf *a, int lo, int hi, const float x, int axis)
 {
   int i = lo, j = hi;
   while (1) {
-    while (a[i]->bv[axis] < x->bv[axis]) {
+    while (a[i].bv[axis] < x) {
       i++;
     }
     j--;
-    while (x->bv[axis] < a[j]->bv[axis]) {
+    while (x < a[j].bv[axis]) {
       j--;
     }
     if (!(i < j)) {
       return i;
     }
-    SWAP(BVHNode *, a[i], a[j]);
+    SWAP(BVHSortLeaf, a[i], a[j]);
     i++;
   }
 }
 
 /* returns Sortable */
-static BVHNode *bvh_medianof3(BVHNode **a, int lo, int mid, int hi, int axis)
+static float bvh_medianof3(const BVHSortLeaf *a, int lo, int mid, int hi, int axis)
 {
-  if ((a[mid])->bv[axis] < (a[lo])->bv[axis]) {
-    if ((a[hi])->bv[axis] < (a[mid])->bv[axis]) {
-      return a[mid];
+  if (a[mid].bv[axis] < a[lo].bv[axis]) {
+    if (a[hi].bv[axis] < a[mid].bv[axis]) {
+      return a[mid].bv[axis];
     }
-    if ((a[hi])->bv[axis] < (a[lo])->bv[axis]) {
-      return a[hi];
+    if (a[hi].bv[axis] < a[lo].bv[axis]) {
+      return a[hi].bv[axis];
     }
-    return a[lo];
+    return a[lo].bv[axis];
   }
 
-  if ((a[hi])->bv[axis] < (a[mid])->bv[axis]) {
-    if ((a[hi])->bv[axis] < (a[lo])->bv[axis]) {
-      return a[lo];
+  if (a[hi].bv[axis] < a[mid].bv[axis]) {
+    if (a[hi].bv[axis] < a[lo].bv[axis]) {
+      return a[lo].bv[axis];
     }
-    return a[hi];
+    return a[hi].bv[axis];
   }
-  return a[mid];
+  return a[mid].bv[axis];
 }
 
 /**
  * \note after a call to this function you can expect one of:
  * - every node to left of a[n] are smaller or equal to it
  * - every node to the right of a[n] are greater or equal to it */
-static void partition_nth_element(BVHNode **a, int begin, int end, const int n, const int axis)
+static void partition_nth_element(BVHSortLeaf *a, int begin, int end, const int n, const int axis)
 {
   while (end - begin > 3) {
     const int cut = bvh_partition(
@@ -384,34 +403,78 @@ static void create_kdop_hull(
   }
 }
 
+static void sort_leafs_minmax_join(const BVHSortLeaf *leafs, int start, int end, float bv[6])
+{
+  for (int j = start; j < end; j++) {
+    for (int i = 0; i < 6; i += 2) {
+      bv[i] = min_ff(leafs[j].bv[i], bv[i]);
+      bv[i + 1] = max_ff(leafs[j].bv[i + 1], bv[i + 1]);
+    }
+  }
+}
+
+typedef struct BVHSortLeafsData {
+  BVHSortLeaf *leafs;
+  BVHNode **nodes;
+  int start, end;
+} BVHSortLeafsData;
+
+static void sort_leafs_minmax_task_cb(void *__restrict userdata,
+                                      const int block,
+                                      const TaskParallelTLS *__restrict tls)
+{
+  const BVHSortLeafsData *data = userdata;
+  const int start = data->start + block * KDOPBVH_THREAD_BLOCK_SIZE;
+  const int end = min_ii(start + KDOPBVH_THREAD_BLOCK_SIZE, data->end);
+
+  sort_leafs_minmax_join(data->leafs, start, end, tls->userdata_chunk);
+}
+
+static void sort_leafs_minmax_reduce(const void *__restrict UNUSED(userdata),
+                                     void *__restrict chunk_join,
+                                     void *__restrict chunk)
+{
+  float *bv_join = chunk_join;
+  const float *bv = chunk;
+
+  for (int i = 0; i < 6; i += 2) {
+    bv_join[i] = min_ff(bv[i], bv_join[i]);
+    bv_join[i + 1] = max_ff(bv[i + 1], bv_join[i + 1]);
+  }
+}
+
 /**
- * \note depends on the fact that the BVH's for each face is already built
+ * Bounds along the x, y and z axis of the leafs in the range, used to choose the split axis.
+ * The hull of the branches is computed after the tree is built, from the bottom up.
  */
-static void refit_kdop_hull(const BVHTree *tree, BVHNode *node, int start, int end)
+static void sort_leafs_minmax(BVHSortLeaf *leafs, int start, int end, float r_bv[6])
 {
-  float newmin, newmax;
-  float *__restrict bv = node->bv;
-  int j;
-  axis_t axis_iter;
+  for (int i = 0; i < 6; i += 2) {
+    r_bv[i] = FLT_MAX;
+    r_bv[i + 1] = -FLT_MAX;
+  }
 
-  node_minmax_init(tree, node);
+  /* Branches near the root cover most leafs, while there are only few of them to build in
+   * parallel. Split their leafs into blocks instead. */
+  if (end - start <= KDOPBVH_THREAD_BLOCK_SIZE * 2) {
+    sort_leafs_minmax_join(leafs, start, end, r_bv);
+    return;
+  }
 
-  for (j = start; j < end; j++) {
-    float *__restrict node_bv = tree->nodes[j]->bv;
+  BVHSortLeafsData data = {
+      .leafs = leafs,
+      .start = start,
+      .end = end,
+  };
 
-    /* for all Axes. */
-    for (axis_iter = tree->start_axis; axis_iter < tree->stop_axis; axis_iter++) {
-      newmin = node_bv[(2 * axis_iter)];
-      if ((newmin < bv[(2 * axis_iter)])) {
-        bv[(2 * axis_iter)] = newmin;
-      }
+  const int num_blocks = (end - start + KDOPBVH_THREAD_BLOCK_SIZE - 1) / KDOPBVH_THREAD_BLOCK_SIZE;
 
-      newmax = node_bv[(2 * axis_iter) + 1];
-      if ((newmax > bv[(2 * axis_iter) + 1])) {
-        bv[(2 * axis_iter) + 1] = newmax;
-      }
-    }
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = r_bv;
+  settings.userdata_chunk_size = sizeof(float[6]);
+  settings.func_reduce = sort_leafs_minmax_reduce;
+  BLI_task_parallel_range(0, num_blocks, &data, sort_leafs_minmax_task_cb, &settings);
 }
 
 /**
@@ -439,7 +502,7 @@ static char get_largest_axis(const float *bv)
 /**
  * bottom-up update of bvh node BV
  * join the children on the parent BV */
-static void node_join(BVHTree *tree, BVHNode *node)
+static void node_join(const BVHTree *tree, BVHNode *node)
 {
   int i;
   axis_t axis_iter;
@@ -673,7 +736,7 @@ static int implicit_needed_branches(int tree_type, int leafs)
  *
  * TODO: This can be optimized a bit by doing a specialized nth_element instead of K nth_elements
  */
-static void split_leafs(BVHNode **leafs_array,
+static void split_leafs(BVHSortLeaf *leafs_array,
                         const int nth[],
                         const int partitions,
                         const int split_axis)
@@ -691,7 +754,7 @@ static void split_leafs(BVHNode **leafs_array,
 typedef struct BVHDivNodesData {
   const BVHTree *tree;
   BVHNode *branches_array;
-  BVHNode **leafs_array;
+  BVHSortLeaf *leafs_array;
 
   int tree_type;
   int tree_offset;
@@ -713,6 +776,7 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
   const int parent_level_index = j - data->i;
   BVHNode *parent = &data->branches_array[j];
   int nth_positions[MAX_TREETYPE + 1];
+  float bv[6];
   char split_axis;
 
   int parent_leafs_begin = implicit_leafs_index(data->data, data->depth, parent_level_index);
@@ -720,8 +784,8 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
 
   /* This calculates the bounding box of this branch
    * and chooses the largest axis as the axis to divide leafs */
-  refit_kdop_hull(data->tree, parent, parent_leafs_begin, parent_leafs_end);
-  split_axis = get_largest_axis(parent->bv);
+  sort_leafs_minmax(data->leafs_array, parent_leafs_begin, parent_leafs_end, bv);
+  split_axis = get_largest_axis(bv);
 
   /* Save split axis (this can be used on ray-tracing to speedup the query time) */
   parent->main_axis = split_axis / 2;
@@ -759,7 +823,7 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
       parent->children[k]->parent = parent;
     }
     else if (child_leafs_end - child_leafs_begin == 1) {
-      parent->children[k] = data->leafs_array[child_leafs_begin];
+      parent->children[k] = data->leafs_array[child_leafs_begin].node;
       parent->children[k]->parent = parent;
     }
     else {
@@ -769,6 +833,84 @@ static void non_recursive_bvh_div_nodes_task_cb(void *__restrict userdata,
   parent->totnode = (char)k;
 }
 
+static void sort_leafs_init_task_cb(void *__restrict userdata,
+                                    const int block,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHSortLeafsData *data = userdata;
+  const int start = data->start + block * KDOPBVH_THREAD_BLOCK_SIZE;
+  const int end = min_ii(start + KDOPBVH_THREAD_BLOCK_SIZE, data->end);
+
+  for (int i = start; i < end; i++) {
+    memcpy(data->leafs[i].bv, data->nodes[i]->bv, sizeof(data->leafs[i].bv));
+    data->leafs[i].node = data->nodes[i];
+  }
+}
+
+static void sort_leafs_finish_task_cb(void *__restrict userdata,
+                                      const int block,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHSortLeafsData *data = userdata;
+  const int start = data->start + block * KDOPBVH_THREAD_BLOCK_SIZE;
+  const int end = min_ii(start + KDOPBVH_THREAD_BLOCK_SIZE, data->end);
+
+  for (int i = start; i < end; i++) {
+    data->nodes[i] = data->leafs[i].node;
+  }
+}
+
+typedef struct BVHJoinBranchesData {
+  const BVHTree *tree;
+  BVHNode *branches_array;
+} BVHJoinBranchesData;
+
+static void bvhtree_join_branches_task_cb(void *__restrict userdata,
+                                          const int j,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHJoinBranchesData *data = userdata;
+  node_join(data->tree, &data->branches_array[j]);
+}
+
+/**
+ * Bottom-up update of the bounding volumes of all branches of an implicit tree, see
+ * #non_recursive_bvh_div_nodes for the layout. The branches of a level only depend on the level
+ * below, so each level is updated in parallel.
+ *
+ * \param branches_array: The branches, with the root at index 1.
+ */
+static void bvhtree_join_branches(const BVHTree *tree,
+                                  BVHNode *branches_array,
+                                  const int num_branches)
+{
+  const int tree_type = tree->tree_type;
+  const int tree_offset = 2 - tree->tree_type;
+  int level_begin[32];
+  int levels_num = 0;
+
+  for (int i = 1; i <= num_branches; i = i * tree_type + tree_offset) {
+    level_begin[levels_num++] = i;
+  }
+  level_begin[levels_num] = num_branches + 1;
+
+  BVHJoinBranchesData data = {
+      .tree = tree,
+      .branches_array = branches_array,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.min_iter_per_thread = 1024;
+
+  for (int level = levels_num - 1; level >= 0; level--) {
+    const int i_stop = min_ii(level_begin[level + 1], num_branches + 1);
+    BLI_task_parallel_range(
+        level_begin[level], i_stop, &data, bvhtree_join_branches_task_cb, &settings);
+  }
+}
+
 /**
  * This functions builds an optimal implicit tree from the given leafs.
  * Where optimal stands for:
@@ -811,21 +953,37 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
     /* Most of bvhtree code relies on 1-leaf trees having at least one branch
      * We handle that special case here */
     if (num_leafs == 1) {
-      refit_kdop_hull(tree, root, 0, num_leafs);
-      root->main_axis = get_largest_axis(root->bv) / 2;
       root->totnode = 1;
       root->children[0] = leafs_array[0];
       root->children[0]->parent = root;
+      node_join(tree, root);
+      root->main_axis = get_largest_axis(root->bv) / 2;
       return;
     }
   }
 
   build_implicit_tree_helper(tree, &data);
 
+  /* Sort copies of the leafs bounds, which are next to each other in memory. */
+  BVHSortLeaf *sort_leafs = MEM_malloc_arrayN(
+      (size_t)max_ii(num_leafs, 1), sizeof(*sort_leafs), __func__);
+  BVHSortLeafsData sort_data = {
+      .leafs = sort_leafs,
+      .nodes = leafs_array,
+      .start = 0,
+      .end = num_leafs,
+  };
+  const int num_blocks = (num_leafs + KDOPBVH_THREAD_BLOCK_SIZE - 1) / KDOPBVH_THREAD_BLOCK_SIZE;
+
+  TaskParallelSettings sort_settings;
+  BLI_parallel_range_settings_defaults(&sort_settings);
+  sort_settings.use_threading = (num_blocks > 1);
+  BLI_task_parallel_range(0, num_blocks, &sort_data, sort_leafs_init_task_cb, &sort_settings);
+
   BVHDivNodesData cb_data = {
       .tree = tree,
       .branches_array = branches_array,
-      .leafs_array = leafs_array,
+      .leafs_array = sort_leafs,
       .tree_type = tree_type,
       .tree_offset = tree_offset,
       .data = &data,
@@ -859,6 +1017,11 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
       }
     }
   }
+
+  BLI_task_parallel_range(0, num_blocks, &sort_data, sort_leafs_finish_task_cb, &sort_settings);
+  MEM_freeN(sort_leafs);
+
+  bvhtree_join_branches(tree, branches_array, num_branches);
 }
 
 /** \} */
@@ -1045,14 +1208,8 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
 {
   /* Update bottom=>top
    * TRICKY: the way we build the tree all the children have an index greater than the parent
-   * This allows us todo a bottom up update by starting on the bigger numbered branch. */
-
-  BVHNode **root = tree->nodes + tree->totleaf;
-  BVHNode **index = tree->nodes + tree->totleaf + tree->totbranch - 1;
-
-  for (; index >= root; index--) {
-    node_join(tree, *index);
-  }
+   * This allows us todo a bottom up update by starting on the deepest level of branches. */
+  bvhtree_join_branches(tree, tree->nodearray + (tree->totleaf - 1), tree->totbranch);
 }
 /**
  * Number of times #BLI_bvhtree_insert has been called.
@@ -1264,6 +1421,49 @@ static bool tree_overlap_traverse_num(BVHOverlapData_Thread *data_thread,
   return false;
 }
 
+/**
+ * Find the subtrees that an overlap query of \a tree is split into: the nodes of the first level
+ * with at least #KDOPBVH_OVERLAP_TASK_NUM nodes, along with the leafs above that level.
+ *
+ * \param r_nodes: Receives the subtrees when not NULL,
+ * must fit `KDOPBVH_OVERLAP_TASK_NUM * tree->tree_type` nodes.
+ * \return The number of subtrees.
+ */
+static int bvhtree_overlap_task_nodes(const BVHTree *tree, const BVHNode **r_nodes)
+{
+  const int nodes_len = KDOPBVH_OVERLAP_TASK_NUM * tree->tree_type;
+  const BVHNode **nodes = BLI_array_alloca(nodes, (size_t)nodes_len * 2);
+  const BVHNode **level = nodes;
+  const BVHNode **next_level = nodes + nodes_len;
+  int level_len = 1;
+  bool has_branches = true;
+
+  level[0] = tree->nodes[tree->totleaf];
+
+  while (level_len < KDOPBVH_OVERLAP_TASK_NUM && has_branches) {
+    int next_level_len = 0;
+    has_branches = false;
+    for (int i = 0; i < level_len; i++) {
+      if (level[i]->totnode) {
+        for (int j = 0; j < level[i]->totnode; j++) {
+          next_level[next_level_len++] = level[i]->children[j];
+          has_branches |= (level[i]->children[j]->totnode != 0);
+        }
+      }
+      else {
+        next_level[next_level_len++] = level[i];
+      }
+    }
+    SWAP(const BVHNode **, level, next_level);
+    level_len = next_level_len;
+  }
+
+  if (r_nodes) {
+    memcpy(r_nodes, level, sizeof(*level) * (size_t)level_len);
+  }
+  return level_len;
+}
+
 /**
  * Use to check the total number of threads #BLI_bvhtree_overlap will use.
  *
@@ -1271,7 +1471,7 @@ static bool tree_overlap_traverse_num(BVHOverlapData_Thread *data_thread,
  */
 int BLI_bvhtree_overlap_thread_num(const BVHTree *tree)
 {
-  return (int)MIN2(tree->tree_type, tree->nodes[tree->totleaf]->totnode);
+  return bvhtree_overlap_task_nodes(tree, NULL);
 }
 
 static void bvhtree_overlap_task_cb(void *__restrict userdata,
@@ -1280,21 +1480,16 @@ static void bvhtree_overlap_task_cb(void *__restrict userdata,
 {
   BVHOverlapData_Thread *data = &((BVHOverlapData_Thread *)userdata)[j];
   BVHOverlapData_Shared *data_shared = data->shared;
+  const BVHNode *root2 = data_shared->tree2->nodes[data_shared->tree2->totleaf];
 
   if (data->max_interactions) {
-    tree_overlap_traverse_num(data,
-                              data_shared->tree1->nodes[data_shared->tree1->totleaf]->children[j],
-                              data_shared->tree2->nodes[data_shared->tree2->totleaf]);
+    tree_overlap_traverse_num(data, data_shared->task_nodes[j], root2);
   }
   else if (data_shared->callback) {
-    tree_overlap_traverse_cb(data,
-                             data_shared->tree1->nodes[data_shared->tree1->totleaf]->children[j],
-                             data_shared->tree2->nodes[data_shared->tree2->totleaf]);
+    tree_overlap_traverse_cb(data, data_shared->task_nodes[j], root2);
   }
   else {
-    tree_overlap_traverse(data,
-                          data_shared->tree1->nodes[data_shared->tree1->totleaf]->children[j],
-                          data_shared->tree2->nodes[data_shared->tree2->totleaf]);
+    tree_overlap_traverse(data, data_shared->task_nodes[j], root2);
   }
 }
 
@@ -1315,8 +1510,10 @@ BVHTreeOverlap *BLI_bvhtree_overlap_ex(
   /* 'RETURN_PAIRS' was not implemented without 'max_interactions'. */
   BLI_assert(overlap_pairs || max_interactions);
 
-  const int root_node_len = BLI_bvhtree_overlap_thread_num(tree1);
-  const int thread_num = use_threading ? root_node_len : 1;
+  const BVHNode **task_nodes = BLI_array_alloca(
+      task_nodes, (size_t)(KDOPBVH_OVERLAP_TASK_NUM * tree1->tree_type));
+  const int task_nodes_len = bvhtree_overlap_task_nodes(tree1, task_nodes);
+  const int thread_num = use_threading ? task_nodes_len : 1;
   int j;
   size_t total = 0;
   BVHTreeOverlap *overlap = NULL, *to = NULL;
@@ -1350,6 +1547,7 @@ BVHTreeOverlap *BLI_bvhtree_overlap_ex(
   /* can be NULL */
   data_shared.callback = callback;
   data_shared.userdata = userdata;
+  data_shared.task_nodes = task_nodes;
 
   for (j = 0; j < thread_num; j++) {
     /* init BVHOverlapData_Thread */
@@ -1365,7 +1563,7 @@ BVHTreeOverlap *BLI_bvhtree_overlap_ex(
     TaskParallelSettings settings;
     BLI_parallel_range_settings_defaults(&settings);
     settings.min_iter_per_thread = 1;
-    BLI_task_parallel_range(0, root_node_len, data, bvhtree_overlap_task_cb, &settings);
+    BLI_task_parallel_range(0, task_nodes_len, data, bvhtree_overlap_task_cb, &settings);
   }
   else {
     if (max_interactions) {
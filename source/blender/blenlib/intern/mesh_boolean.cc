@@ -42,6 +42,7 @@
 #  include "BLI_set.hh"
 #  include "BLI_span.hh"
 #  include "BLI_stack.hh"
+#  include "BLI_task.hh"
 #  include "BLI_vector.hh"
 #  include "BLI_vector_set.hh"
 
@@ -857,6 +858,43 @@ static const Vert *find_flap_vert(const Face &tri, const Edge e, bool *r_rev)
   return flapv;
 }
 
+/**
+ * Index of the #orient3d determinant when the input coordinates have index 1,
+ * using the error bound method of Burnikel et al (see mesh_intersect.cc).
+ * Differences have index 2, the cross product coordinates have index 6
+ * and the final dot product has index 11.
+ */
+constexpr int index_orient3d = 11;
+
+/**
+ * Return the sign of `orient3d(a, b, c, d)` calculated with the double coordinates
+ * of the vertices, or 0 if the error bound does not guarantee the sign is the same
+ * as the one of the exact calculation.
+ */
+static int filter_orient3d(const Vert *a, const Vert *b, const Vert *c, const Vert *d)
+{
+  const double3 ad = a->co - d->co;
+  const double3 bd = b->co - d->co;
+  const double3 cd = c->co - d->co;
+  const double det = double3::dot(ad, double3::cross_high_precision(bd, cd));
+  if (det == 0.0) {
+    return 0;
+  }
+  const double3 abs_d = double3::abs(d->co);
+  const double3 abs_ad = double3::abs(a->co) + abs_d;
+  const double3 abs_bd = double3::abs(b->co) + abs_d;
+  const double3 abs_cd = double3::abs(c->co) + abs_d;
+  double3 abs_cross;
+  abs_cross[0] = abs_bd[1] * abs_cd[2] + abs_bd[2] * abs_cd[1];
+  abs_cross[1] = abs_bd[2] * abs_cd[0] + abs_bd[0] * abs_cd[2];
+  abs_cross[2] = abs_bd[0] * abs_cd[1] + abs_bd[1] * abs_cd[0];
+  const double err_bound = double3::dot(abs_ad, abs_cross) * index_orient3d * DBL_EPSILON;
+  if (fabs(det) > err_bound) {
+    return det > 0 ? 1 : -1;
+  }
+  return 0;
+}
+
 /**
  * Triangle \a tri and tri0 share edge e.
  * Classify \a tri with respect to tri0 as described in
@@ -877,9 +915,6 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
   if (dbg_level > 0) {
     std::cout << "classify  e = " << e << "\n";
   }
-  mpq3 a0 = tri0[0]->co_exact;
-  mpq3 a1 = tri0[1]->co_exact;
-  mpq3 a2 = tri0[2]->co_exact;
   bool rev;
   bool rev0;
   const Vert *flapv0 = find_flap_vert(tri0, e, &rev0);
@@ -891,9 +926,12 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
     std::cout << " rev = " << rev << " flapv = " << flapv << "\n";
   }
   BLI_assert(flapv != nullptr && flapv0 != nullptr);
-  const mpq3 flap = flapv->co_exact;
-  /* orient will be positive if flap is below oriented plane of a0,a1,a2. */
-  int orient = orient3d(a0, a1, a2, flap);
+  /* orient will be positive if flap is below oriented plane of tri0.
+   * Only use exact arithmetic when the floating point filter cannot decide. */
+  int orient = filter_orient3d(tri0[0], tri0[1], tri0[2], flapv);
+  if (orient == 0) {
+    orient = orient3d(tri0[0]->co_exact, tri0[1]->co_exact, tri0[2]->co_exact, flapv->co_exact);
+  }
   int ans;
   if (orient > 0) {
     ans = rev0 ? 4 : 3;
@@ -1057,26 +1095,22 @@ static Array<int> sort_tris_around_edge(const IMesh &tm,
 
 /**
  * Find the Cells around edge e.
+ * \a sorted_tris are the triangles of the edge, as sorted by #sort_tris_around_edge.
  * This possibly makes new cells in \a cinfo, and sets up the
  * bipartite graph edges between cells and patches.
  * Will modify \a pinfo and \a cinfo and the patches and cells they contain.
  */
 static void find_cells_from_edge(const IMesh &tm,
-                                 const TriMeshTopology &tmtopo,
                                  PatchesInfo &pinfo,
                                  CellsInfo &cinfo,
-                                 const Edge e)
+                                 const Edge e,
+                                 const Span<int> sorted_tris)
 {
   const int dbg_level = 0;
   if (dbg_level > 0) {
     std::cout << "FIND_CELLS_FROM_EDGE " << e << "\n";
   }
-  const Vector<int> *edge_tris = tmtopo.edge_tris(e);
-  BLI_assert(edge_tris != nullptr);
-  Array<int> sorted_tris = sort_tris_around_edge(
-      tm, tmtopo, e, Span<int>(*edge_tris), (*edge_tris)[0], nullptr);
-
-  int n_edge_tris = edge_tris->size();
+  int n_edge_tris = sorted_tris.size();
   Array<int> edge_patches(n_edge_tris);
   for (int i = 0; i < n_edge_tris; ++i) {
     edge_patches[i] = pinfo.tri_patch(sorted_tris[i]);
@@ -1177,8 +1211,9 @@ static CellsInfo find_cells(const IMesh &tm, const TriMeshTopology &tmtopo, Patc
     std::cout << "\nFIND_CELLS\n";
   }
   CellsInfo cinfo;
-  /* For each unique edge shared between patch pairs, process it. */
+  /* Find each unique edge shared between patch pairs. */
   Set<Edge> processed_edges;
+  Vector<Edge> patch_edges;
   for (const auto item : pinfo.patch_patch_edge_map().items()) {
     int p = item.key.first;
     int q = item.key.second;
@@ -1186,10 +1221,25 @@ static CellsInfo find_cells(const IMesh &tm, const TriMeshTopology &tmtopo, Patc
       const Edge &e = item.value;
       if (!processed_edges.contains(e)) {
         processed_edges.add_new(e);
-        find_cells_from_edge(tm, tmtopo, pinfo, cinfo, e);
+        patch_edges.append(e);
       }
     }
   }
+  /* Sorting the triangles around the edges only reads the mesh, so do it in parallel.
+   * Making the cells from them has to be done in order. */
+  Array<Array<int>> edges_sorted_tris(patch_edges.size());
+  parallel_for(patch_edges.index_range(), 256, [&](IndexRange range) {
+    for (int i : range) {
+      const Edge e = patch_edges[i];
+      const Vector<int> *edge_tris = tmtopo.edge_tris(e);
+      BLI_assert(edge_tris != nullptr);
+      edges_sorted_tris[i] = sort_tris_around_edge(
+          tm, tmtopo, e, Span<int>(*edge_tris), (*edge_tris)[0], nullptr);
+    }
+  });
+  for (int i : patch_edges.index_range()) {
+    find_cells_from_edge(tm, pinfo, cinfo, patch_edges[i], edges_sorted_tris[i]);
+  }
   /* Some patches may have no cells at this point. These are either:
    * (a) a closed manifold patch only incident on itself (sphere, torus, klein bottle, etc.).
    * (b) an open manifold patch only incident on itself (has non-manifold boundaries).
@@ -2546,6 +2596,49 @@ static void raycast_add_flipped(Vector<Face *> &out_faces, Face &tri, IMeshArena
   out_faces.append(flipped_f);
 }
 
+/**
+ * Ray-cast from the triangle with index \a test_t_index, which is in \a shape, to find out
+ * whether it should be removed from the boolean result.
+ * Also return true in *r_do_flip if it is retained but its normal needs to be flipped.
+ * Only reads \a tm and \a tree (and populates the plane of the test triangle),
+ * so it can be called for different test triangles from multiple threads.
+ */
+static bool raycast_test_tri_remove(const IMesh &tm,
+                                    BoolOpType op,
+                                    int nshapes,
+                                    std::function<int(int)> shape_fn,
+                                    int test_t_index,
+                                    int shape,
+                                    BVHTree *tree,
+                                    bool *r_do_flip)
+{
+  constexpr int dbg_level = 0;
+  Array<float> in_shape(nshapes, 0);
+  Array<int> winding(nshapes, 0);
+  test_tri_inside_shapes(tm, shape_fn, nshapes, test_t_index, tree, in_shape);
+  for (int other_shape = 0; other_shape < nshapes; ++other_shape) {
+    if (other_shape == shape) {
+      continue;
+    }
+    /* The in_shape array has a confidence value for "insideness".
+     * For most operations, even a hint of being inside
+     * gives good results, but when shape is a cutter in a Difference
+     * operation, we want to be pretty sure that the point is inside other_shape.
+     * E.g., T75827.
+     * Also, when the operation is intersection, we also want high confidence.
+     */
+    bool need_high_confidence = (op == BoolOpType::Difference && shape != 0) ||
+                                op == BoolOpType::Intersect;
+    bool inside = in_shape[other_shape] >= (need_high_confidence ? 0.5f : 0.1f);
+    if (dbg_level > 0) {
+      std::cout << "test point is " << (inside ? "inside" : "outside") << " other_shape "
+                << other_shape << " val = " << in_shape[other_shape] << "\n";
+    }
+    winding[other_shape] = inside;
+  }
+  return raycast_test_remove(op, winding, shape, r_do_flip);
+}
+
 /**
  * Use the RayCast method for deciding if a triangle of the
  * mesh is supposed to be included or excluded in the boolean result,
@@ -2566,42 +2659,29 @@ static IMesh raycast_tris_boolean(const IMesh &tm,
   }
   IMesh ans;
   BVHTree *tree = raycast_tree(tm);
-  Vector<Face *> out_faces;
-  out_faces.reserve(tm.face_size());
-  Array<float> in_shape(nshapes, 0);
-  Array<int> winding(nshapes, 0);
-  for (int t : tm.face_index_range()) {
-    Face &tri = *tm.face(t);
-    int shape = shape_fn(tri.orig);
-    if (dbg_level > 0) {
-      std::cout << "process triangle " << t << " = " << &tri << "\n";
-      std::cout << "shape = " << shape << "\n";
-    }
-    test_tri_inside_shapes(tm, shape_fn, nshapes, t, tree, in_shape);
-    for (int other_shape = 0; other_shape < nshapes; ++other_shape) {
-      if (other_shape == shape) {
-        continue;
-      }
-      /* The in_shape array has a confidence value for "insideness".
-       * For most operations, even a hint of being inside
-       * gives good results, but when shape is a cutter in a Difference
-       * operation, we want to be pretty sure that the point is inside other_shape.
-       * E.g., T75827.
-       * Also, when the operation is intersection, we also want high confidence.
-       */
-      bool need_high_confidence = (op == BoolOpType::Difference && shape != 0) ||
-                                  op == BoolOpType::Intersect;
-      bool inside = in_shape[other_shape] >= (need_high_confidence ? 0.5f : 0.1f);
+  /* The ray-casts of the triangles are independent, so do them in parallel,
+   * then gather the output faces in triangle order. */
+  Array<bool> tri_remove(tm.face_size());
+  Array<bool> tri_flip(tm.face_size());
+  parallel_for(tm.face_index_range(), 64, [&](IndexRange range) {
+    for (int t : range) {
+      const Face &tri = *tm.face(t);
+      int shape = shape_fn(tri.orig);
       if (dbg_level > 0) {
-        std::cout << "test point is " << (inside ? "inside" : "outside") << " other_shape "
-                  << other_shape << " val = " << in_shape[other_shape] << "\n";
+        std::cout << "process triangle " << t << " = " << &tri << "\n";
+        std::cout << "shape = " << shape << "\n";
       }
-      winding[other_shape] = inside;
+      tri_remove[t] = raycast_test_tri_remove(
+          tm, op, nshapes, shape_fn, t, shape, tree, &tri_flip[t]);
     }
-    bool do_flip;
-    bool do_remove = raycast_test_remove(op, winding, shape, &do_flip);
-    if (!do_remove) {
-      if (!do_flip) {
+  });
+  BLI_bvhtree_free(tree);
+  Vector<Face *> out_faces;
+  out_faces.reserve(tm.face_size());
+  for (int t : tm.face_index_range()) {
+    if (!tri_remove[t]) {
+      Face &tri = *tm.face(t);
+      if (!tri_flip[t]) {
         out_faces.append(&tri);
       }
       else {
@@ -2609,7 +2689,6 @@ static IMesh raycast_tris_boolean(const IMesh &tm,
       }
     }
   }
-  BLI_bvhtree_free(tree);
   ans.set_faces(out_faces);
   return ans;
 }
@@ -2631,55 +2710,48 @@ static IMesh raycast_patches_boolean(const IMesh &tm,
   }
   IMesh ans;
   BVHTree *tree = raycast_tree(tm);
+  /* As for triangles, test the patches in parallel and gather the output faces in order. */
+  Array<bool> patch_remove(pinfo.tot_patch());
+  Array<bool> patch_flip(pinfo.tot_patch());
+  parallel_for(pinfo.index_range(), 8, [&](IndexRange range) {
+    for (int p : range) {
+      const Patch &patch = pinfo.patch(p);
+      /* For test triangle, choose one in the middle of patch list
+       * as the ones near the beginning may be very near other patches. */
+      int test_t_index = patch.tri(patch.tot_tri() / 2);
+      const Face &tri_test = *tm.face(test_t_index);
+      /* Assume all triangles in a patch are in the same shape. */
+      int shape = shape_fn(tri_test.orig);
+      if (dbg_level > 0) {
+        std::cout << "process patch " << p << " = " << patch << "\n";
+        std::cout << "test tri = " << test_t_index << " = " << &tri_test << "\n";
+        std::cout << "shape = " << shape << "\n";
+      }
+      if (shape == -1) {
+        patch_remove[p] = true;
+        continue;
+      }
+      patch_remove[p] = raycast_test_tri_remove(
+          tm, op, nshapes, shape_fn, test_t_index, shape, tree, &patch_flip[p]);
+    }
+  });
+  BLI_bvhtree_free(tree);
   Vector<Face *> out_faces;
   out_faces.reserve(tm.face_size());
-  Array<float> in_shape(nshapes, 0);
-  Array<int> winding(nshapes, 0);
   for (int p : pinfo.index_range()) {
-    const Patch &patch = pinfo.patch(p);
-    /* For test triangle, choose one in the middle of patch list
-     * as the ones near the beginning may be very near other patches. */
-    int test_t_index = patch.tri(patch.tot_tri() / 2);
-    Face &tri_test = *tm.face(test_t_index);
-    /* Assume all triangles in a patch are in the same shape. */
-    int shape = shape_fn(tri_test.orig);
-    if (dbg_level > 0) {
-      std::cout << "process patch " << p << " = " << patch << "\n";
-      std::cout << "test tri = " << test_t_index << " = " << &tri_test << "\n";
-      std::cout << "shape = " << shape << "\n";
-    }
-    if (shape == -1) {
+    if (patch_remove[p]) {
       continue;
     }
-    test_tri_inside_shapes(tm, shape_fn, nshapes, test_t_index, tree, in_shape);
-    for (int other_shape = 0; other_shape < nshapes; ++other_shape) {
-      if (other_shape == shape) {
-        continue;
-      }
-      bool need_high_confidence = (op == BoolOpType::Difference && shape != 0) ||
-                                  op == BoolOpType::Intersect;
-      bool inside = in_shape[other_shape] >= (need_high_confidence ? 0.5f : 0.1f);
-      if (dbg_level > 0) {
-        std::cout << "test point is " << (inside ? "inside" : "outside") << " other_shape "
-                  << other_shape << " val = " << in_shape[other_shape] << "\n";
+    for (int t : pinfo.patch(p).tris()) {
+      Face *f = tm.face(t);
+      if (!patch_flip[p]) {
+        out_faces.append(f);
       }
-      winding[other_shape] = inside;
-    }
-    bool do_flip;
-    bool do_remove = raycast_test_remove(op, winding, shape, &do_flip);
-    if (!do_remove) {
-      for (int t : patch.tris()) {
-        Face *f = tm.face(t);
-        if (!do_flip) {
-          out_faces.append(f);
-        }
-        else {
-          raycast_add_flipped(out_faces, *f, arena);
-        }
+      else {
+        raycast_add_flipped(out_faces, *f, arena);
       }
     }
   }
-  BLI_bvhtree_free(tree);
   ans.set_faces(out_faces);
   return ans;
 }
@@ -27,7 +27,9 @@
 #include "DNA_listBase.h"
 
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 
 #include "atomic_ops.h"
 
@@ -105,6 +107,54 @@ struct RangeTask {
   }
 };
 
+/* Run the range with one root task per NUMA node, reduced together at the end. */
+static void task_parallel_range_numa(const int start,
+                                     const int stop,
+                                     void *userdata,
+                                     TaskParallelRangeFunc func,
+                                     const TaskParallelSettings *settings)
+{
+  const int num_nodes = BLI_task_scheduler_num_numa_nodes();
+  const size_t grainsize = MAX2(settings->min_iter_per_thread, 1);
+
+  blender::Vector<RangeTask *> node_tasks;
+  for (int i = 0; i < num_nodes; i++) {
+    node_tasks.append(OBJECT_GUARDED_NEW(RangeTask, func, userdata, settings));
+  }
+
+  blender::parallel_for_numa_nodes(
+      blender::IndexRange(start, stop - start),
+      [&](const int numa_node_index, const blender::IndexRange sub_range) {
+        if (sub_range.size() == 0) {
+          return;
+        }
+        RangeTask &task = *node_tasks[numa_node_index];
+        const tbb::blocked_range<int> range(
+            (int)sub_range.first(), (int)sub_range.one_after_last(), grainsize);
+        if (settings->func_reduce) {
+          parallel_reduce(range, task);
+        }
+        else {
+          parallel_for(range, task);
+        }
+      });
+
+  if (settings->func_reduce) {
+    for (int i = 1; i < num_nodes; i++) {
+      node_tasks[0]->join(*node_tasks[i]);
+    }
+    if (settings->userdata_chunk) {
+      memcpy(settings->userdata_chunk,
+             node_tasks[0]->userdata_chunk,
+             settings->userdata_chunk_size);
+    }
+  }
+
+  for (RangeTask *task : node_tasks) {
+    OBJECT_GUARDED_DELETE(task, RangeTask);
+  }
+}
+
 #endif
 
 void BLI_task_parallel_range(const int start,
@@ -116,6 +166,11 @@ void BLI_task_parallel_range(const int start,
 #ifdef WITH_TBB
   /* Multithreading. */
   if (settings->use_threading && BLI_task_scheduler_num_threads() > 1) {
+    if (settings->use_numa_nodes && BLI_task_scheduler_num_numa_nodes() > 1) {
+      task_parallel_range_numa(start, stop, userdata, func, settings);
+      return;
+    }
+
     RangeTask task(func, userdata, settings);
     const size_t grainsize = MAX2(settings->min_iter_per_thread, 1);
     const tbb::blocked_range<int> range(start, stop, grainsize);
@@ -145,6 +200,25 @@ void BLI_task_parallel_range(const int start,
   }
 }
 
+void BLI_task_parallel_memset(void *buffer, int value, size_t elem_size, int num_elems)
+{
+#ifdef WITH_TBB
+  if (BLI_task_scheduler_num_numa_nodes() > 1) {
+    char *data = (char *)buffer;
+    blender::parallel_for_numa_nodes(
+        blender::IndexRange(num_elems),
+        [&](const int UNUSED(numa_node_index), const blender::IndexRange sub_range) {
+          blender::parallel_for(sub_range, 4096, [&](const blender::IndexRange elems) {
+            memset(data + elems.first() * elem_size, value, elems.size() * elem_size);
+          });
+        });
+    return;
+  }
+#endif
+
+  memset(buffer, value, elem_size * (size_t)num_elems);
+}
+
 int BLI_task_parallel_thread_id(const TaskParallelTLS *UNUSED(tls))
 {
 #ifdef WITH_TBB
@@ -23,11 +23,17 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 
+#include "numaapi.h"
+
 #ifdef WITH_TBB
 /* Need to include at least one header to get the version define. */
 #  include <tbb/blocked_range.h>
+#  include <tbb/task_arena.h>
+#  include <tbb/task_group.h>
+#  include <tbb/task_scheduler_observer.h>
 #  if TBB_INTERFACE_VERSION_MAJOR >= 10
 #    include <tbb/global_control.h>
 #    define WITH_TBB_GLOBAL_CONTROL
@@ -41,6 +47,105 @@ static int task_scheduler_num_threads = 1;
 static tbb::global_control *task_scheduler_global_control = nullptr;
 #endif
 
+/* NUMA Nodes
+ *
+ * On systems with multiple NUMA nodes every node gets its own task arena. Worker threads are
+ * pinned to the node while they are working in its arena, so work which is split over the nodes
+ * always accesses memory from the same node, as long as that memory was first touched by the
+ * same split. */
+
+#define TASK_SCHEDULER_MAX_NUMA_NODES 64
+
+#ifdef WITH_TBB
+class NumaNodeObserver : public tbb::task_scheduler_observer {
+  int node_;
+
+ public:
+  NumaNodeObserver(tbb::task_arena &arena, int node)
+      : tbb::task_scheduler_observer(arena), node_(node)
+  {
+    observe(true);
+  }
+
+  /* Only pin worker threads, the thread waiting for the work can be the main thread. */
+  void on_scheduler_entry(bool is_worker) override
+  {
+    if (is_worker) {
+      numaAPI_RunThreadOnNode(node_);
+    }
+  }
+
+  void on_scheduler_exit(bool is_worker) override
+  {
+    if (is_worker) {
+      numaAPI_RunThreadOnAllNodes();
+    }
+  }
+};
+
+struct TaskSchedulerNumaNode {
+  int node;
+  int num_threads;
+  tbb::task_arena *arena;
+  NumaNodeObserver *observer;
+};
+
+static TaskSchedulerNumaNode task_scheduler_numa_nodes[TASK_SCHEDULER_MAX_NUMA_NODES];
+#endif
+static int task_scheduler_num_numa_nodes = 1;
+
+static void task_scheduler_numa_init(void)
+{
+#ifdef WITH_TBB
+  /* Respect explicit thread count, it is used for benchmarking and limiting resource usage. */
+  if (BLI_system_num_threads_override_get() > 0 || numaAPI_Initialize() != NUMAAPI_SUCCESS) {
+    return;
+  }
+
+  const int num_nodes = numaAPI_GetNumNodes();
+  int num_used_nodes = 0;
+  for (int node = 0; node < num_nodes && num_used_nodes < TASK_SCHEDULER_MAX_NUMA_NODES; node++) {
+    const int num_threads = numaAPI_GetNumNodeProcessors(node);
+    if (num_threads <= 0) {
+      continue;
+    }
+    TaskSchedulerNumaNode &numa_node = task_scheduler_numa_nodes[num_used_nodes++];
+    numa_node.node = node;
+    numa_node.num_threads = num_threads;
+    numa_node.arena = nullptr;
+    numa_node.observer = nullptr;
+  }
+
+  if (num_used_nodes < 2) {
+    return;
+  }
+
+  for (int i = 0; i < num_used_nodes; i++) {
+    TaskSchedulerNumaNode &numa_node = task_scheduler_numa_nodes[i];
+    numa_node.arena = OBJECT_GUARDED_NEW(tbb::task_arena, numa_node.num_threads);
+    numa_node.observer = OBJECT_GUARDED_NEW(NumaNodeObserver, *numa_node.arena, numa_node.node);
+  }
+  task_scheduler_num_numa_nodes = num_used_nodes;
+#endif
+}
+
+static void task_scheduler_numa_exit(void)
+{
+#ifdef WITH_TBB
+  for (int i = 0; i < task_scheduler_num_numa_nodes; i++) {
+    TaskSchedulerNumaNode &numa_node = task_scheduler_numa_nodes[i];
+    if (numa_node.observer) {
+      numa_node.observer->observe(false);
+      OBJECT_GUARDED_DELETE(numa_node.observer, NumaNodeObserver);
+    }
+    if (numa_node.arena) {
+      OBJECT_GUARDED_DELETE(numa_node.arena, tbb::task_arena);
+    }
+  }
+#endif
+  task_scheduler_num_numa_nodes = 1;
+}
+
 void BLI_task_scheduler_init()
 {
 #ifdef WITH_TBB_GLOBAL_CONTROL
@@ -63,12 +168,17 @@ void BLI_task_scheduler_init()
 #else
   task_scheduler_num_threads = BLI_system_thread_count();
 #endif
+
+  task_scheduler_numa_init();
 }
 
 void BLI_task_scheduler_exit()
 {
+  task_scheduler_numa_exit();
+
 #ifdef WITH_TBB_GLOBAL_CONTROL
   OBJECT_GUARDED_DELETE(task_scheduler_global_control, tbb::global_control);
+  task_scheduler_global_control = nullptr;
 #endif
 }
 
@@ -76,3 +186,51 @@ int BLI_task_scheduler_num_threads()
 {
   return task_scheduler_num_threads;
 }
+
+int BLI_task_scheduler_num_numa_nodes()
+{
+  return task_scheduler_num_numa_nodes;
+}
+
+namespace blender {
+
+void parallel_for_numa_nodes(IndexRange range,
+                             FunctionRef<void(int numa_node_index, IndexRange sub_range)> function)
+{
+#ifdef WITH_TBB
+  const int num_nodes = task_scheduler_num_numa_nodes;
+  if (num_nodes > 1 && range.size() >= num_nodes) {
+    int total_threads = 0;
+    for (int i = 0; i < num_nodes; i++) {
+      total_threads += task_scheduler_numa_nodes[i].num_threads;
+    }
+
+    /* Split the range proportionally to the number of threads of every node. The split only
+     * depends on the range, so the same range is always processed by the same nodes. */
+    tbb::task_group task_groups[TASK_SCHEDULER_MAX_NUMA_NODES];
+    int64_t sub_range_start = range.first();
+    int threads_before = 0;
+    for (int i = 0; i < num_nodes; i++) {
+      threads_before += task_scheduler_numa_nodes[i].num_threads;
+      const int64_t sub_range_end = range.first() + range.size() * threads_before / total_threads;
+      const IndexRange sub_range(sub_range_start, sub_range_end - sub_range_start);
+      sub_range_start = sub_range_end;
+
+      tbb::task_group &task_group = task_groups[i];
+      task_scheduler_numa_nodes[i].arena->execute([&task_group, &function, i, sub_range]() {
+        task_group.run([&function, i, sub_range]() { function(i, sub_range); });
+      });
+    }
+
+    for (int i = 0; i < num_nodes; i++) {
+      tbb::task_group &task_group = task_groups[i];
+      task_scheduler_numa_nodes[i].arena->execute([&task_group]() { task_group.wait(); });
+    }
+    return;
+  }
+#endif
+
+  function(0, range);
+}
+
+}  // namespace blender
@@ -132,3 +132,70 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+static int overlap_count_brute_force(const float (*points)[3], int points_len, float epsilon)
+{
+  int count = 0;
+  for (int i = 0; i < points_len; i++) {
+    for (int j = 0; j < points_len; j++) {
+      if (i != j && fabsf(points[i][0] - points[j][0]) <= 2.0f * epsilon &&
+          fabsf(points[i][1] - points[j][1]) <= 2.0f * epsilon &&
+          fabsf(points[i][2] - points[j][2]) <= 2.0f * epsilon) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+static void overlap_points_test(int points_len, char tree_type, int random_seed)
+{
+  const float epsilon = 0.02f;
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, epsilon, tree_type, 6);
+
+  void *mem = MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*points)[3] = (float(*)[3])mem;
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 100000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  /* Check the overlaps before and after moving all points. */
+  for (int pass = 0; pass < 2; pass++) {
+    uint overlap_len = 0;
+    BVHTreeOverlap *overlap = BLI_bvhtree_overlap(tree, tree, &overlap_len, nullptr, nullptr);
+    EXPECT_EQ(overlap_len, overlap_count_brute_force(points, points_len, epsilon));
+    for (uint i = 0; i < overlap_len; i++) {
+      EXPECT_NE(overlap[i].indexA, overlap[i].indexB);
+      EXPECT_LE(len_v3v3(points[overlap[i].indexA], points[overlap[i].indexB]),
+                2.0f * epsilon * (float)M_SQRT3);
+    }
+    MEM_SAFE_FREE(overlap);
+
+    for (int i = 0; i < points_len; i++) {
+      rng_v3_round(points[i], 3, rng, 100000, 1.0f);
+      BLI_bvhtree_update_node(tree, i, points[i], nullptr, 1);
+    }
+    BLI_bvhtree_update_tree(tree);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+}
+
+TEST(kdopbvh, Overlap_500)
+{
+  overlap_points_test(500, 2, 12);
+}
+TEST(kdopbvh, Overlap_5000)
+{
+  overlap_points_test(5000, 2, 1234);
+}
+TEST(kdopbvh, OverlapQuadTree_5000)
+{
+  overlap_points_test(5000, 4, 123);
+}
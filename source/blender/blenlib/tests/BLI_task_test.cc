@@ -65,6 +65,42 @@ TEST(task, RangeIter)
   BLI_threadapi_exit();
 }
 
+TEST(task, RangeIterNumaNodes)
+{
+  int *data = (int *)MEM_mallocN(sizeof(int) * NUM_ITEMS, __func__);
+  int sum = 0;
+
+  BLI_threadapi_init();
+  BLI_task_scheduler_init();
+
+  BLI_task_parallel_memset(data, 0xff, sizeof(int), NUM_ITEMS);
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    EXPECT_EQ(data[i], -1);
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  settings.use_numa_nodes = true;
+
+  settings.userdata_chunk = &sum;
+  settings.userdata_chunk_size = sizeof(sum);
+  settings.func_reduce = task_range_iter_reduce_func;
+
+  BLI_task_parallel_range(0, NUM_ITEMS, data, task_range_iter_func, &settings);
+
+  int expected_sum = 0;
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    EXPECT_EQ(data[i], i);
+    expected_sum += i;
+  }
+  EXPECT_EQ(sum, expected_sum);
+
+  MEM_freeN(data);
+  BLI_task_scheduler_exit();
+  BLI_threadapi_exit();
+}
+
 /* *** Parallel iterations over mempool items. *** */
 
 static void task_mempool_iter_func(void *userdata, MempoolIterData *item)
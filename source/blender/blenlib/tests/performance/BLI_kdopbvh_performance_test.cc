@@ -0,0 +1,128 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdopbvh.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 10
+
+/* Small random triangles in a unit cube, roughly like the faces of a dense mesh. */
+static float (*kdopbvh_tris_create(const int tris_num))[3][3]
+{
+  float(*tris)[3][3] = (float(*)[3][3])MEM_malloc_arrayN(tris_num, sizeof(*tris), __func__);
+  const float size = 0.5f / cbrtf((float)tris_num);
+  struct RNG *rng = BLI_rng_new(tris_num);
+
+  for (int i = 0; i < tris_num; i++) {
+    const float center[3] = {
+        BLI_rng_get_float(rng), BLI_rng_get_float(rng), BLI_rng_get_float(rng)};
+    for (int j = 0; j < 3; j++) {
+      float offset[3];
+      BLI_rng_get_float_unit_v3(rng, offset);
+      madd_v3_v3v3fl(tris[i][j], center, offset, size);
+    }
+  }
+
+  BLI_rng_free(rng);
+  return tris;
+}
+
+static void kdopbvh_test(const int tris_num, const char tree_type, const char axis)
+{
+  printf("\n========== STARTING BVH tree, %d triangles, tree type %d, %d-DOP ==========\n",
+         tris_num,
+         tree_type,
+         axis);
+
+  BLI_threadapi_init();
+  BLI_task_scheduler_init();
+
+  float(*tris)[3][3] = kdopbvh_tris_create(tris_num);
+  double insert_time = 0.0;
+  double build_time = 0.0;
+  double update_time = 0.0;
+  double overlap_time = 0.0;
+  uint overlap_num = 0;
+
+  for (int run = 0; run < NUM_RUN_AVERAGED; run++) {
+    double time = PIL_check_seconds_timer();
+    BVHTree *tree = BLI_bvhtree_new(tris_num, 0.0f, tree_type, axis);
+    for (int i = 0; i < tris_num; i++) {
+      BLI_bvhtree_insert(tree, i, tris[i][0], 3);
+    }
+    insert_time += PIL_check_seconds_timer() - time;
+
+    time = PIL_check_seconds_timer();
+    BLI_bvhtree_balance(tree);
+    build_time += PIL_check_seconds_timer() - time;
+
+    time = PIL_check_seconds_timer();
+    for (int i = 0; i < tris_num; i++) {
+      BLI_bvhtree_update_node(tree, i, tris[i][0], nullptr, 3);
+    }
+    BLI_bvhtree_update_tree(tree);
+    update_time += PIL_check_seconds_timer() - time;
+
+    time = PIL_check_seconds_timer();
+    BVHTreeOverlap *overlap = BLI_bvhtree_overlap(tree, tree, &overlap_num, nullptr, nullptr);
+    overlap_time += PIL_check_seconds_timer() - time;
+
+    MEM_SAFE_FREE(overlap);
+    BLI_bvhtree_free(tree);
+  }
+
+  printf("\tInsert: done in %fs on average over %d runs\n",
+         insert_time / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tBalance: done in %fs on average over %d runs\n",
+         build_time / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tUpdate: done in %fs on average over %d runs\n",
+         update_time / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tSelf overlap (%u pairs): done in %fs on average over %d runs\n",
+         overlap_num,
+         overlap_time / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  MEM_freeN(tris);
+
+  BLI_task_scheduler_exit();
+  BLI_threadapi_exit();
+
+  printf("========== ENDED BVH tree ==========\n\n");
+}
+
+TEST(kdopbvh, Binary6DOP100k)
+{
+  kdopbvh_test(100000, 2, 6);
+}
+
+TEST(kdopbvh, Binary6DOP1M)
+{
+  kdopbvh_test(1000000, 2, 6);
+}
+
+TEST(kdopbvh, Quad26DOP100k)
+{
+  kdopbvh_test(100000, 4, 26);
+}
+
+TEST(kdopbvh, Quad26DOP1M)
+{
+  kdopbvh_test(1000000, 4, 26);
+}
+
+TEST(kdopbvh, Oct8DOP1M)
+{
+  kdopbvh_test(1000000, 8, 8);
+}
@@ -17,6 +17,11 @@
 
 #include "PIL_time.h"
 
+#ifdef __linux__
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
 #define NUM_RUN_AVERAGED 100
 
 static uint gen_pseudo_random_number(uint num)
@@ -208,3 +213,148 @@ TEST(task, ListBaseIter100k)
 {
   task_listbase_test("ListBase parallel iteration - Threaded - 100000 items", 100000, true);
 }
+
+/* *** Memory bound iterations over a large buffer, with NUMA locality. *** */
+
+/* Elements per iteration, a multiple of the page size. */
+#define NUMA_BLOCK_SIZE (64 * 1024)
+
+typedef struct NumaTestData {
+  float *buffer;
+  /* Accessed blocks which were not on the NUMA node of the accessing CPU. */
+  uint num_remote_blocks;
+  uint num_blocks;
+} NumaTestData;
+
+/* Returns false when the node of the memory or CPU can not be queried. */
+static bool numa_test_is_remote_access(const void *ptr, bool *r_is_remote)
+{
+#ifdef __linux__
+  unsigned int cpu, cpu_node;
+  if (syscall(SYS_getcpu, &cpu, &cpu_node, NULL) != 0) {
+    return false;
+  }
+  void *pages[1] = {(void *)ptr};
+  int page_node = -1;
+  if (syscall(SYS_move_pages, 0, 1, pages, NULL, &page_node, 0) != 0 || page_node < 0) {
+    return false;
+  }
+  *r_is_remote = (unsigned int)page_node != cpu_node;
+  return true;
+#else
+  UNUSED_VARS(ptr, r_is_remote);
+  return false;
+#endif
+}
+
+static void numa_test_sum_func(void *__restrict userdata,
+                               const int iter,
+                               const TaskParallelTLS *__restrict tls)
+{
+  NumaTestData *data = (NumaTestData *)userdata;
+  const float *block = data->buffer + (size_t)iter * NUMA_BLOCK_SIZE;
+
+  float sum = 0.0f;
+  for (int i = 0; i < NUMA_BLOCK_SIZE; i++) {
+    sum += block[i];
+  }
+  *(float *)tls->userdata_chunk += sum;
+}
+
+/* Same iteration as #numa_test_sum_func without the work, the system calls querying the nodes
+ * are too slow to be part of the timing. */
+static void numa_test_locality_func(void *__restrict userdata,
+                                    const int iter,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  NumaTestData *data = (NumaTestData *)userdata;
+  const float *block = data->buffer + (size_t)iter * NUMA_BLOCK_SIZE;
+
+  bool is_remote;
+  if (numa_test_is_remote_access(block, &is_remote)) {
+    atomic_add_and_fetch_uint32(&data->num_blocks, 1);
+    if (is_remote) {
+      atomic_add_and_fetch_uint32(&data->num_remote_blocks, 1);
+    }
+  }
+}
+
+static void numa_test_sum_reduce(const void *__restrict UNUSED(userdata),
+                                 void *__restrict join_v,
+                                 void *__restrict chunk_v)
+{
+  *(float *)join_v += *(float *)chunk_v;
+}
+
+static void numa_test_do(const char *id, const int num_blocks, const bool use_numa_nodes)
+{
+  const size_t num_elems = (size_t)num_blocks * NUMA_BLOCK_SIZE;
+
+  NumaTestData data = {nullptr};
+  data.buffer = (float *)MEM_mallocN(sizeof(float) * num_elems, __func__);
+
+  /* First touch decides on which node the memory is placed. */
+  if (use_numa_nodes) {
+    BLI_task_parallel_memset(data.buffer, 0, sizeof(float) * NUMA_BLOCK_SIZE, num_blocks);
+  }
+  else {
+    memset(data.buffer, 0, sizeof(float) * num_elems);
+  }
+
+  float sum = 0.0f;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_numa_nodes = use_numa_nodes;
+  settings.userdata_chunk = &sum;
+  settings.userdata_chunk_size = sizeof(sum);
+  settings.func_reduce = numa_test_sum_reduce;
+
+  const int num_runs = NUM_RUN_AVERAGED / 10;
+  double averaged_timing = 0.0;
+  for (int i = 0; i < num_runs; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    BLI_task_parallel_range(0, num_blocks, &data, numa_test_sum_func, &settings);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+  averaged_timing /= num_runs;
+  EXPECT_EQ(sum, 0.0f);
+
+  settings.userdata_chunk = nullptr;
+  settings.userdata_chunk_size = 0;
+  settings.func_reduce = nullptr;
+  BLI_task_parallel_range(0, num_blocks, &data, numa_test_locality_func, &settings);
+
+  printf("\t%s: done in %fs on average over %d runs (%.2f GB/s)\n",
+         id,
+         averaged_timing,
+         num_runs,
+         (double)(sizeof(float) * num_elems) / averaged_timing / 1e9);
+  if (data.num_blocks) {
+    printf("\t\tremote node accesses: %.1f%% of %u blocks\n",
+           100.0 * (double)data.num_remote_blocks / (double)data.num_blocks,
+           data.num_blocks);
+  }
+  else {
+    printf("\t\tremote node accesses: unknown\n");
+  }
+
+  MEM_freeN(data.buffer);
+}
+
+TEST(task, RangeIterNumaNodes)
+{
+  printf("\n========== STARTING NUMA range iteration ==========\n");
+
+  BLI_threadapi_init();
+  BLI_task_scheduler_init();
+  printf("\tNUMA nodes: %d\n", BLI_task_scheduler_num_numa_nodes());
+
+  /* 256 MB of floats, much larger than the caches. */
+  numa_test_do("Serial initialization", 1024, false);
+  numa_test_do("NUMA initialization and iteration", 1024, true);
+
+  BLI_task_scheduler_exit();
+  BLI_threadapi_exit();
+
+  printf("========== ENDED NUMA range iteration ==========\n\n");
+}
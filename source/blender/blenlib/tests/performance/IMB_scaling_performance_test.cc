@@ -0,0 +1,141 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "intern/IMB_allocimbuf.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 10
+
+/* A 4K frame, roughly what sequencer render size scaling and proxies work on. */
+#define SOURCE_WIDTH 3840
+#define SOURCE_HEIGHT 2160
+
+static ImBuf *scaling_test_image_create(const bool use_float)
+{
+  ImBuf *ibuf = IMB_allocImBuf(
+      SOURCE_WIDTH, SOURCE_HEIGHT, 32, use_float ? IB_rectfloat : IB_rect);
+
+  for (int y = 0; y < SOURCE_HEIGHT; y++) {
+    for (int x = 0; x < SOURCE_WIDTH; x++) {
+      const size_t offset = 4 * ((size_t)y * SOURCE_WIDTH + x);
+      for (int c = 0; c < 4; c++) {
+        const float value = (float)((x * (c + 1) + y * 3) % 256) / 255.0f;
+        if (use_float) {
+          ibuf->rect_float[offset + c] = value;
+        }
+        else {
+          ((unsigned char *)ibuf->rect)[offset + c] = (unsigned char)(value * 255.0f);
+        }
+      }
+    }
+  }
+  return ibuf;
+}
+
+typedef void (*ImBufScaleFn)(ImBuf *ibuf, int width, int height);
+
+static void scale_box_or_linear(ImBuf *ibuf, int width, int height)
+{
+  IMB_scaleImBuf(ibuf, width, height);
+}
+
+static void scale_nearest(ImBuf *ibuf, int width, int height)
+{
+  IMB_scalefastImBuf(ibuf, width, height);
+}
+
+static void scale_and_filter(ImBuf *ibuf, int width, int height)
+{
+  IMB_filter(ibuf);
+  IMB_scaleImBuf(ibuf, width, height);
+}
+
+static void scaling_test(const char *id,
+                         ImBufScaleFn scale_fn,
+                         const int width,
+                         const int height,
+                         const bool use_float)
+{
+  printf("\n========== STARTING %s, %s ==========\n", id, use_float ? "float" : "byte");
+
+  BLI_threadapi_init();
+  BLI_task_scheduler_init();
+  imb_refcounter_lock_init();
+
+  double time = 0.0;
+  for (int run = 0; run < NUM_RUN_AVERAGED; run++) {
+    ImBuf *ibuf = scaling_test_image_create(use_float);
+    const double time_start = PIL_check_seconds_timer();
+    scale_fn(ibuf, width, height);
+    time += PIL_check_seconds_timer() - time_start;
+    EXPECT_EQ(ibuf->x, width);
+    EXPECT_EQ(ibuf->y, height);
+    IMB_freeImBuf(ibuf);
+  }
+
+  printf("\t%dx%d -> %dx%d: done in %fs on average over %d runs\n",
+         SOURCE_WIDTH,
+         SOURCE_HEIGHT,
+         width,
+         height,
+         time / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+
+  imb_refcounter_lock_exit();
+  BLI_task_scheduler_exit();
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(imbuf_scaling, ScaleDownHalfByte)
+{
+  scaling_test("Box scale down", scale_box_or_linear, 1920, 1080, false);
+}
+
+TEST(imbuf_scaling, ScaleDownHalfFloat)
+{
+  scaling_test("Box scale down", scale_box_or_linear, 1920, 1080, true);
+}
+
+TEST(imbuf_scaling, ScaleDownThumbnailByte)
+{
+  scaling_test("Box scale down", scale_box_or_linear, 256, 144, false);
+}
+
+TEST(imbuf_scaling, ScaleUpByte)
+{
+  scaling_test("Linear scale up", scale_box_or_linear, 5120, 2880, false);
+}
+
+TEST(imbuf_scaling, ScaleUpFloat)
+{
+  scaling_test("Linear scale up", scale_box_or_linear, 5120, 2880, true);
+}
+
+TEST(imbuf_scaling, ScaleNearestByte)
+{
+  scaling_test("Nearest scale", scale_nearest, 1280, 720, false);
+}
+
+TEST(imbuf_scaling, ScaleNearestFloat)
+{
+  scaling_test("Nearest scale", scale_nearest, 1280, 720, true);
+}
+
+TEST(imbuf_scaling, FilterAndScaleDownByte)
+{
+  scaling_test("Filter and scale down", scale_and_filter, 1920, 1080, false);
+}
+
+TEST(imbuf_scaling, FilterAndScaleDownFloat)
+{
+  scaling_test("Filter and scale down", scale_and_filter, 1920, 1080, true);
+}
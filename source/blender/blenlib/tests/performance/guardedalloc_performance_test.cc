@@ -0,0 +1,134 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <stdlib.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+/* Compare the lock-free allocator with and without size classes against the system allocator.
+ * Build with WITH_MEM_JEMALLOC to compare against jemalloc instead of the system one. */
+
+#define NUM_RUN_AVERAGED 10
+#define NUM_TASKS 256
+#define NUM_BLOCKS_PER_TASK 4096
+
+enum {
+  ALLOC_SYSTEM = 0,
+  ALLOC_LOCKFREE = 1,
+  ALLOC_LOCKFREE_SIZE_CLASSES = 2,
+};
+
+typedef struct AllocTestData {
+  int allocator;
+  /* Blocks of every task, freed by another task to exercise cross-thread frees. */
+  void **blocks;
+} AllocTestData;
+
+/* Mimic the sizes of mesh elements, list items and small arrays. */
+static size_t alloc_test_block_size(int index)
+{
+  const uint num = (uint)index * 2654435761u;
+  return 8 + (size_t)((num >> 16) % 248);
+}
+
+static void *alloc_test_malloc(int allocator, size_t len)
+{
+  return (allocator == ALLOC_SYSTEM) ? malloc(len) : MEM_mallocN(len, __func__);
+}
+
+static void alloc_test_free(int allocator, void *ptr)
+{
+  if (allocator == ALLOC_SYSTEM) {
+    free(ptr);
+  }
+  else {
+    MEM_freeN(ptr);
+  }
+}
+
+static void alloc_test_alloc_cb(void *__restrict userdata,
+                                const int iter,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  AllocTestData *data = (AllocTestData *)userdata;
+  void **blocks = &data->blocks[(size_t)iter * NUM_BLOCKS_PER_TASK];
+
+  /* Short lived blocks. */
+  for (int i = 0; i < NUM_BLOCKS_PER_TASK; i++) {
+    void *ptr = alloc_test_malloc(data->allocator, alloc_test_block_size(iter + i));
+    alloc_test_free(data->allocator, ptr);
+  }
+
+  /* Blocks which outlive the task. */
+  for (int i = 0; i < NUM_BLOCKS_PER_TASK; i++) {
+    blocks[i] = alloc_test_malloc(data->allocator, alloc_test_block_size(iter * i));
+  }
+}
+
+static void alloc_test_free_cb(void *__restrict userdata,
+                               const int iter,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  AllocTestData *data = (AllocTestData *)userdata;
+  void **blocks = &data->blocks[(size_t)((iter + 1) % NUM_TASKS) * NUM_BLOCKS_PER_TASK];
+
+  for (int i = 0; i < NUM_BLOCKS_PER_TASK; i++) {
+    alloc_test_free(data->allocator, blocks[i]);
+  }
+}
+
+static void alloc_test_do(const char *id, const int allocator, const bool use_threads)
+{
+  AllocTestData data;
+  data.allocator = allocator;
+  data.blocks = (void **)malloc(sizeof(void *) * NUM_TASKS * NUM_BLOCKS_PER_TASK);
+
+  MEM_enable_lockfree_size_classes(allocator == ALLOC_LOCKFREE_SIZE_CLASSES);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = use_threads;
+
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    BLI_task_parallel_range(0, NUM_TASKS, &data, alloc_test_alloc_cb, &settings);
+    BLI_task_parallel_range(0, NUM_TASKS, &data, alloc_test_free_cb, &settings);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+
+  MEM_enable_lockfree_size_classes(false);
+  free(data.blocks);
+
+  printf("\t%s: done in %fs on average over %d runs\n",
+         id,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+}
+
+static void alloc_test(const bool use_threads)
+{
+  printf("\n========== STARTING %s ==========\n", use_threads ? "threaded" : "single thread");
+
+  alloc_test_do("system malloc", ALLOC_SYSTEM, use_threads);
+  alloc_test_do("MEM lock-free", ALLOC_LOCKFREE, use_threads);
+  alloc_test_do("MEM lock-free size classes", ALLOC_LOCKFREE_SIZE_CLASSES, use_threads);
+
+  printf("========== ENDED %s ==========\n\n", use_threads ? "threaded" : "single thread");
+}
+
+TEST(guardedalloc, SmallBlocksNoThread)
+{
+  alloc_test(false);
+}
+
+TEST(guardedalloc, SmallBlocksThreaded)
+{
+  alloc_test(true);
+}
@@ -81,6 +81,7 @@
 #include "BLI_alloca.h"
 #include "BLI_listbase.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
@@ -176,6 +177,116 @@ static BMFace *bm_face_create_from_mpoly(
   return BM_face_create(bm, verts, edges, mp->totloop, NULL, BM_CREATE_SKIP_CD);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Mesh -> BMesh Custom-Data
+ *
+ * Elements are created in order on a single thread since they're linked into the disk
+ * and radial cycles, their custom-data blocks are allocated at the same time.
+ * Copying the data into those blocks is independent for every element, so it's threaded.
+ * \{ */
+
+typedef struct BMFromMeshData {
+  BMesh *bm;
+  const Mesh *me;
+  BMVert **vtable;
+  BMEdge **etable;
+  /** Faces which failed to be created are NULL. */
+  BMFace **ftable;
+  const float (**shape_key_table)[3];
+  int tot_shape_keys;
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+  int cd_shape_key_offset;
+  int cd_shape_keyindex_offset;
+  bool calc_face_normal;
+} BMFromMeshData;
+
+static void bm_vert_from_mvert_data_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  const MVert *mvert = &me->mvert[i];
+  BMVert *v = data->vtable[i];
+
+  normal_short_to_float_v3(v->no, mvert->no);
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(v, data->cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
+  }
+
+  /* Set shape key original index. */
+  if (data->cd_shape_keyindex_offset != -1) {
+    BM_ELEM_CD_SET_INT(v, data->cd_shape_keyindex_offset, i);
+  }
+
+  /* Set shape-key data. */
+  if (data->tot_shape_keys) {
+    float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, data->cd_shape_key_offset);
+    for (int j = 0; j < data->tot_shape_keys; j++, co_dst++) {
+      copy_v3_v3(*co_dst, data->shape_key_table[j][i]);
+    }
+  }
+}
+
+static void bm_edge_from_medge_data_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  const MEdge *medge = &me->medge[i];
+  BMEdge *e = data->etable[i];
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
+
+  if (data->cd_edge_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+  }
+  if (data->cd_edge_crease_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_crease_offset, (float)medge->crease / 255.0f);
+  }
+}
+
+static void bm_face_from_mpoly_data_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  BMFace *f = data->ftable[i];
+
+  if (f == NULL) {
+    return;
+  }
+
+  int j = me->mpoly[i].loopstart;
+  BMLoop *l_iter, *l_first;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    /* Save index of corresponding #MLoop. */
+    CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+  } while ((l_iter = l_iter->next) != l_first);
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+
+  if (data->calc_face_normal) {
+    BM_face_normal_update(f);
+  }
+}
+
+/** \} */
+
 /**
  * \brief Mesh -> BMesh
  * \param bm: The mesh to write into, while this is typically a newly created BMesh,
@@ -344,32 +455,32 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
       BM_vert_select_set(bm, v, true);
     }
 
-    normal_short_to_float_v3(v->no, mvert->no);
-
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
-
-    if (cd_vert_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
-    }
-
-    /* Set shape key original index. */
-    if (cd_shape_keyindex_offset != -1) {
-      BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
-    }
-
-    /* Set shape-key data. */
-    if (tot_shape_keys) {
-      float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, cd_shape_key_offset);
-      for (int j = 0; j < tot_shape_keys; j++, co_dst++) {
-        copy_v3_v3(*co_dst, shape_key_table[j][i]);
-      }
-    }
+    /* Custom-data is copied in parallel, see #bm_vert_from_mvert_data_cb. */
+    CustomData_bmesh_alloc_block(&bm->vdata, &v->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~BM_VERT; /* Added in order, clear dirty flag. */
   }
 
+  BMFromMeshData data = {
+      .bm = bm,
+      .me = me,
+      .vtable = vtable,
+      .shape_key_table = shape_key_table,
+      .tot_shape_keys = tot_shape_keys,
+      .cd_vert_bweight_offset = cd_vert_bweight_offset,
+      .cd_edge_bweight_offset = cd_edge_bweight_offset,
+      .cd_edge_crease_offset = cd_edge_crease_offset,
+      .cd_shape_key_offset = cd_shape_key_offset,
+      .cd_shape_keyindex_offset = cd_shape_keyindex_offset,
+      .calc_face_normal = params->calc_face_normal,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (me->totvert >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, me->totvert, &data, bm_vert_from_mvert_data_cb, &settings);
+
   etable = MEM_mallocN(sizeof(BMEdge **) * me->totedge, __func__);
 
   medge = me->medge;
@@ -386,24 +497,18 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
       BM_edge_select_set(bm, e, true);
     }
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
-
-    if (cd_edge_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
-    }
-    if (cd_edge_crease_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset, (float)medge->crease / 255.0f);
-    }
+    CustomData_bmesh_alloc_block(&bm->edata, &e->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~BM_EDGE; /* Added in order, clear dirty flag. */
   }
 
-  /* Only needed for selection. */
-  if (me->mselect && me->totselect != 0) {
-    ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
-  }
+  data.etable = etable;
+  settings.use_threading = (me->totedge >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, me->totedge, &data, bm_edge_from_medge_data_cb, &settings);
+
+  /* Also needed for selection, faces which failed to be created are NULL. */
+  ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
 
   mloop = me->mloop;
   mp = me->mpoly;
@@ -411,10 +516,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
     BMLoop *l_iter;
     BMLoop *l_first;
 
-    f = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
-    if (ftable != NULL) {
-      ftable[i] = f;
-    }
+    f = ftable[i] = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
 
     if (UNLIKELY(f == NULL)) {
       printf(
@@ -442,27 +544,24 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
       bm->act_face = f;
     }
 
-    int j = mp->loopstart;
     l_iter = l_first = BM_FACE_FIRST_LOOP(f);
     do {
       /* Don't use 'j' since we may have skipped some faces, hence some loops. */
       BM_elem_index_set(l_iter, totloops++); /* set_ok */
 
-      /* Save index of corresponding #MLoop. */
-      CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+      CustomData_bmesh_alloc_block(&bm->ldata, &l_iter->head.data);
     } while ((l_iter = l_iter->next) != l_first);
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
-
-    if (params->calc_face_normal) {
-      BM_face_normal_update(f);
-    }
+    CustomData_bmesh_alloc_block(&bm->pdata, &f->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
   }
 
+  data.ftable = ftable;
+  settings.use_threading = (me->totpoly >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, me->totpoly, &data, bm_face_from_mpoly_data_cb, &settings);
+
   /* -------------------------------------------------------------------- */
   /* MSelect clears the array elements (avoid adding multiple times).
    *
@@ -499,9 +598,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
 
   MEM_freeN(vtable);
   MEM_freeN(etable);
-  if (ftable) {
-    MEM_freeN(ftable);
-  }
+  MEM_freeN(ftable);
 }
 
 /**
@@ -582,16 +679,130 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name BMesh -> Mesh Elements
+ *
+ * Every element is written at its index in the element tables, so they're converted in parallel.
+ * \{ */
+
+typedef struct BMToMeshData {
+  BMesh *bm;
+  Mesh *me;
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+} BMToMeshData;
+
+static void bm_vert_to_mvert_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMToMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  BMVert *v = bm->vtable[i];
+  MVert *mvert = &me->mvert[i];
+
+  copy_v3_v3(mvert->co, v->co);
+  normal_float_to_short_v3(mvert->no, v->no);
+
+  mvert->flag = BM_vert_flag_to_mflag(v);
+
+  BM_elem_index_set(v, i); /* set_inline */
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, data->cd_vert_bweight_offset);
+  }
+
+  BM_CHECK_ELEMENT(v);
+}
+
+static void bm_edge_to_medge_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMToMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  BMEdge *e = bm->etable[i];
+  MEdge *med = &me->medge[i];
+
+  med->v1 = BM_elem_index_get(e->v1);
+  med->v2 = BM_elem_index_get(e->v2);
+
+  med->flag = BM_edge_flag_to_mflag(e);
+
+  BM_elem_index_set(e, i); /* set_inline */
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
+
+  bmesh_quick_edgedraw_flag(med, e);
+
+  if (data->cd_edge_crease_offset != -1) {
+    med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_crease_offset);
+  }
+  if (data->cd_edge_bweight_offset != -1) {
+    med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_bweight_offset);
+  }
+
+  BM_CHECK_ELEMENT(e);
+}
+
+static void bm_face_to_mpoly_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMToMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  BMFace *f = bm->ftable[i];
+  MPoly *mpoly = &me->mpoly[i];
+
+  /* Set by the caller. */
+  int j = mpoly->loopstart;
+  mpoly->totloop = f->len;
+  mpoly->mat_nr = f->mat_nr;
+  mpoly->flag = BM_face_flag_to_mflag(f);
+
+  BMLoop *l_iter, *l_first;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    MLoop *mloop = &me->mloop[j];
+    mloop->e = BM_elem_index_get(l_iter->e);
+    mloop->v = BM_elem_index_get(l_iter->v);
+
+    /* Copy over custom-data. */
+    CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
+
+    j++;
+    BM_CHECK_ELEMENT(l_iter);
+    BM_CHECK_ELEMENT(l_iter->e);
+    BM_CHECK_ELEMENT(l_iter->v);
+  } while ((l_iter = l_iter->next) != l_first);
+
+  if (f == bm->act_face) {
+    me->act_face = i;
+  }
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
+
+  BM_CHECK_ELEMENT(f);
+}
+
+/** \} */
+
 /**
  *
  * \param bmain: May be NULL in case \a calc_object_remap parameter option is not set.
  */
 void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMeshParams *params)
 {
-  MEdge *med;
-  BMVert *v, *eve;
-  BMEdge *e;
-  BMFace *f;
+  BMVert *eve;
   BMIter iter;
   int i, j;
 
@@ -658,92 +869,35 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
   /* This is called again, 'dotess' arg is used there. */
   BKE_mesh_update_customdata_pointers(me, 0);
 
-  i = 0;
-  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-    copy_v3_v3(mvert->co, v->co);
-    normal_float_to_short_v3(mvert->no, v->no);
-
-    mvert->flag = BM_vert_flag_to_mflag(v);
-
-    BM_elem_index_set(v, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
-
-    if (cd_vert_bweight_offset != -1) {
-      mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-    }
-
-    i++;
-    mvert++;
-
-    BM_CHECK_ELEMENT(v);
-  }
+  /* Elements are written at their index from multiple threads. */
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+  BMToMeshData data = {
+      .bm = bm,
+      .me = me,
+      .cd_vert_bweight_offset = cd_vert_bweight_offset,
+      .cd_edge_bweight_offset = cd_edge_bweight_offset,
+      .cd_edge_crease_offset = cd_edge_crease_offset,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (bm->totvert >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, bm->totvert, &data, bm_vert_to_mvert_cb, &settings);
   bm->elem_index_dirty &= ~BM_VERT;
 
-  med = medge;
-  i = 0;
-  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-    med->v1 = BM_elem_index_get(e->v1);
-    med->v2 = BM_elem_index_get(e->v2);
-
-    med->flag = BM_edge_flag_to_mflag(e);
-
-    BM_elem_index_set(e, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
-
-    bmesh_quick_edgedraw_flag(med, e);
-
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
-    }
-
-    i++;
-    med++;
-    BM_CHECK_ELEMENT(e);
-  }
+  /* Edges read the vertex indices. */
+  settings.use_threading = (bm->totedge >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, bm->totedge, &data, bm_edge_to_medge_cb, &settings);
   bm->elem_index_dirty &= ~BM_EDGE;
 
-  i = 0;
-  j = 0;
-  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    BMLoop *l_iter, *l_first;
-    mpoly->loopstart = j;
-    mpoly->totloop = f->len;
-    mpoly->mat_nr = f->mat_nr;
-    mpoly->flag = BM_face_flag_to_mflag(f);
-
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      mloop->e = BM_elem_index_get(l_iter->e);
-      mloop->v = BM_elem_index_get(l_iter->v);
-
-      /* Copy over custom-data. */
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-      j++;
-      mloop++;
-      BM_CHECK_ELEMENT(l_iter);
-      BM_CHECK_ELEMENT(l_iter->e);
-      BM_CHECK_ELEMENT(l_iter->v);
-    } while ((l_iter = l_iter->next) != l_first);
-
-    if (f == bm->act_face) {
-      me->act_face = i;
-    }
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
-
-    i++;
-    mpoly++;
-    BM_CHECK_ELEMENT(f);
+  /* Loops of each face are written after the loops of the previous faces. */
+  for (i = 0, j = 0; i < bm->totface; i++) {
+    mpoly[i].loopstart = j;
+    j += bm->ftable[i]->len;
   }
+  settings.use_threading = (bm->totface >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, bm->totface, &data, bm_face_to_mpoly_cb, &settings);
 
   /* Patch hook indices and vertex parents. */
   if (params->calc_object_remap && (ototvert > 0)) {
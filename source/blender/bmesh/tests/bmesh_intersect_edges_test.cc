@@ -0,0 +1,76 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_ghash.h"
+#include "BLI_utildefines.h"
+
+#include "bmesh.h"
+
+#include "tools/bmesh_intersect_edges.h"
+
+namespace blender::bmesh::tests {
+
+/* Wire grid of `size` x `size` unit cells, starting at `offset`. */
+static void wire_grid_create(BMesh *bm, const int size, const float offset, const bool select)
+{
+  const int row_len = size + 1;
+  BMVert **verts = (BMVert **)MEM_mallocN(sizeof(*verts) * row_len * row_len, __func__);
+  for (int y = 0; y < row_len; y++) {
+    for (int x = 0; x < row_len; x++) {
+      const float co[3] = {offset + x, offset + y, 0.0f};
+      verts[y * row_len + x] = BM_vert_create(bm, co, nullptr, BM_CREATE_NOP);
+    }
+  }
+  for (int y = 0; y < row_len; y++) {
+    for (int x = 0; x < row_len; x++) {
+      BMVert *v = verts[y * row_len + x];
+      if (x < size) {
+        BM_edge_create(bm, v, verts[y * row_len + x + 1], nullptr, BM_CREATE_NOP);
+      }
+      if (y < size) {
+        BM_edge_create(bm, v, verts[(y + 1) * row_len + x], nullptr, BM_CREATE_NOP);
+      }
+    }
+  }
+  if (select) {
+    for (int i = 0; i < row_len * row_len; i++) {
+      BM_vert_select_set(bm, verts[i], true);
+    }
+  }
+  MEM_freeN(verts);
+}
+
+/* Enough edges for the overlap query to be split into more tasks than the tree type. */
+TEST(bmesh_intersect_edges, ManyEdgesThreaded)
+{
+  const int size = 32;
+
+  BMeshCreateParams bm_params{};
+  bm_params.use_toolflags = true;
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+
+  /* The second grid is offset by half a cell, every interior edge of one grid crosses an edge of
+   * the other one, the vertices of the grids don't touch any edge. */
+  wire_grid_create(bm, size, 0.0f, true);
+  wire_grid_create(bm, size, 0.5f, true);
+  ASSERT_GT(bm->totedge, 2 * 1024);
+  BM_mesh_select_mode_flush(bm);
+
+  const int totvert_prev = bm->totvert;
+  const int crossings_num = 2 * size * size;
+
+  GHash *targetmap = BLI_ghash_ptr_new(__func__);
+  EXPECT_TRUE(BM_mesh_intersect_edges(bm, BM_ELEM_SELECT, 1e-4f, false, targetmap));
+
+  /* Both edges of every crossing are split, one of the new vertices is merged into the other. */
+  EXPECT_EQ(bm->totvert, totvert_prev + 2 * crossings_num);
+  EXPECT_EQ(BLI_ghash_len(targetmap), crossings_num);
+
+  BLI_ghash_free(targetmap, nullptr, nullptr);
+  BM_mesh_free(bm);
+}
+
+}  // namespace blender::bmesh::tests
@@ -0,0 +1,217 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "PIL_time.h"
+
+#include "bmesh.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+#define DO_PERF_TESTS 0
+
+namespace blender::bmesh::tests {
+
+class BMeshConvertTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/* Grid of `size` x `size` quads with UV's, edge creases and a float vertex layer. */
+static Mesh *grid_mesh_with_layers_create(const int size)
+{
+  Mesh *mesh = bke::tests::grid_mesh_create(size);
+
+  for (int i = 0; i < mesh->totvert; i++) {
+    const int x = i % (size + 1);
+    const int y = i / (size + 1);
+    mesh->mvert[i].flag = ((x + y) % 3) ? 0 : SELECT;
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    mesh->mpoly[i].mat_nr = (short)(i % 3);
+  }
+
+  mesh->cd_flag |= ME_CDFLAG_EDGE_CREASE;
+  for (int i = 0; i < mesh->totedge; i++) {
+    mesh->medge[i].crease = (char)(i % 256);
+  }
+
+  MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer(
+      &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop);
+  for (int i = 0; i < mesh->totloop; i++) {
+    const MVert *mv = &mesh->mvert[mesh->mloop[i].v];
+    mloopuv[i].uv[0] = mv->co[0] / (float)size;
+    mloopuv[i].uv[1] = mv->co[1] / (float)size;
+  }
+
+  float *vert_float = (float *)CustomData_add_layer(
+      &mesh->vdata, CD_PROP_FLOAT, CD_CALLOC, nullptr, mesh->totvert);
+  for (int i = 0; i < mesh->totvert; i++) {
+    vert_float[i] = (float)i;
+  }
+
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  return mesh;
+}
+
+static BMesh *bmesh_from_mesh(const Mesh *mesh)
+{
+  const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(mesh);
+  BMeshCreateParams create_params{};
+  create_params.use_toolflags = true;
+  BMesh *bm = BM_mesh_create(&allocsize, &create_params);
+
+  BMeshFromMeshParams convert_params{};
+  convert_params.calc_face_normal = true;
+  BM_mesh_bm_from_me(bm, mesh, &convert_params);
+  return bm;
+}
+
+static Mesh *bmesh_to_mesh(BMesh *bm)
+{
+  Mesh *mesh = (Mesh *)BKE_id_new_nomain(ID_ME, nullptr);
+  BMeshToMeshParams convert_params{};
+  BM_mesh_bm_to_me(nullptr, bm, mesh, &convert_params);
+  return mesh;
+}
+
+/* Large enough for the threaded code path. */
+TEST_F(BMeshConvertTest, RoundTrip)
+{
+  Mesh *mesh = grid_mesh_with_layers_create(150);
+  BMesh *bm = bmesh_from_mesh(mesh);
+
+  EXPECT_EQ(bm->totvert, mesh->totvert);
+  EXPECT_EQ(bm->totedge, mesh->totedge);
+  EXPECT_EQ(bm->totloop, mesh->totloop);
+  EXPECT_EQ(bm->totface, mesh->totpoly);
+
+  const int cd_loop_uv_offset = CustomData_get_offset(&bm->ldata, CD_MLOOPUV);
+  const int cd_edge_crease_offset = CustomData_get_offset(&bm->edata, CD_CREASE);
+  ASSERT_NE(cd_loop_uv_offset, -1);
+  ASSERT_NE(cd_edge_crease_offset, -1);
+
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+  for (int i = 0; i < mesh->totvert; i++) {
+    BMVert *v = BM_vert_at_index(bm, i);
+    EXPECT_V3_NEAR(v->co, mesh->mvert[i].co, 0.0f);
+    EXPECT_EQ(BM_elem_flag_test_bool(v, BM_ELEM_SELECT), (mesh->mvert[i].flag & SELECT) != 0);
+    EXPECT_EQ(BM_elem_float_data_get(&bm->vdata, v, CD_PROP_FLOAT), (float)i);
+  }
+  for (int i = 0; i < mesh->totedge; i++) {
+    BMEdge *e = BM_edge_at_index(bm, i);
+    EXPECT_EQ(BM_elem_index_get(e->v1), mesh->medge[i].v1);
+    EXPECT_EQ(BM_elem_index_get(e->v2), mesh->medge[i].v2);
+    EXPECT_EQ(BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset), mesh->medge[i].crease);
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    BMFace *f = BM_face_at_index(bm, i);
+    EXPECT_EQ(f->mat_nr, mesh->mpoly[i].mat_nr);
+    EXPECT_NEAR(f->no[2], 1.0f, 1e-6f);
+
+    BMLoop *l_iter = BM_FACE_FIRST_LOOP(f);
+    for (int j = mesh->mpoly[i].loopstart; j < mesh->mpoly[i].loopstart + 4; j++) {
+      const MLoopUV *luv = (const MLoopUV *)BM_ELEM_CD_GET_VOID_P(l_iter, cd_loop_uv_offset);
+      EXPECT_EQ(BM_elem_index_get(l_iter->v), mesh->mloop[j].v);
+      EXPECT_V2_NEAR(luv->uv, mesh->mloopuv[j].uv, 0.0f);
+      l_iter = l_iter->next;
+    }
+  }
+
+  Mesh *mesh_result = bmesh_to_mesh(bm);
+  BM_mesh_free(bm);
+
+  ASSERT_EQ(mesh_result->totvert, mesh->totvert);
+  ASSERT_EQ(mesh_result->totedge, mesh->totedge);
+  ASSERT_EQ(mesh_result->totloop, mesh->totloop);
+  ASSERT_EQ(mesh_result->totpoly, mesh->totpoly);
+
+  const float *vert_float = (const float *)CustomData_get_layer(&mesh_result->vdata,
+                                                                CD_PROP_FLOAT);
+  ASSERT_NE(vert_float, nullptr);
+  ASSERT_NE(mesh_result->mloopuv, nullptr);
+  for (int i = 0; i < mesh->totvert; i++) {
+    EXPECT_V3_NEAR(mesh_result->mvert[i].co, mesh->mvert[i].co, 0.0f);
+    EXPECT_EQ(mesh_result->mvert[i].flag & SELECT, mesh->mvert[i].flag & SELECT);
+    EXPECT_EQ(vert_float[i], (float)i);
+  }
+  for (int i = 0; i < mesh->totedge; i++) {
+    EXPECT_EQ(mesh_result->medge[i].v1, mesh->medge[i].v1);
+    EXPECT_EQ(mesh_result->medge[i].v2, mesh->medge[i].v2);
+    EXPECT_EQ(mesh_result->medge[i].crease, mesh->medge[i].crease);
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    EXPECT_EQ(mesh_result->mpoly[i].loopstart, mesh->mpoly[i].loopstart);
+    EXPECT_EQ(mesh_result->mpoly[i].totloop, mesh->mpoly[i].totloop);
+    EXPECT_EQ(mesh_result->mpoly[i].mat_nr, mesh->mpoly[i].mat_nr);
+  }
+  for (int i = 0; i < mesh->totloop; i++) {
+    EXPECT_EQ(mesh_result->mloop[i].v, mesh->mloop[i].v);
+    EXPECT_EQ(mesh_result->mloop[i].e, mesh->mloop[i].e);
+    EXPECT_V2_NEAR(mesh_result->mloopuv[i].uv, mesh->mloopuv[i].uv, 0.0f);
+  }
+
+  BKE_id_free(nullptr, mesh_result);
+  BKE_id_free(nullptr, mesh);
+}
+
+#if DO_PERF_TESTS
+
+/* Time both conversions, increase the grid size to measure meshes of scan resolution. */
+
+#define GRID_SIZE 500
+#define NUM_RUN_AVERAGED 3
+
+TEST_F(BMeshConvertTest, PerformanceGrid)
+{
+  Mesh *mesh = grid_mesh_with_layers_create(GRID_SIZE);
+
+  printf("\n========== STARTING %d faces ==========\n", mesh->totpoly);
+
+  double from_me_timing = 0.0, to_me_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    double init_time = PIL_check_seconds_timer();
+    BMesh *bm = bmesh_from_mesh(mesh);
+    from_me_timing += PIL_check_seconds_timer() - init_time;
+
+    init_time = PIL_check_seconds_timer();
+    Mesh *mesh_result = bmesh_to_mesh(bm);
+    to_me_timing += PIL_check_seconds_timer() - init_time;
+
+    EXPECT_EQ(mesh_result->totpoly, mesh->totpoly);
+
+    BM_mesh_free(bm);
+    BKE_id_free(nullptr, mesh_result);
+  }
+
+  printf("\tBM_mesh_bm_from_me: done in %fs on average over %d runs\n",
+         from_me_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tBM_mesh_bm_to_me: done in %fs on average over %d runs\n",
+         to_me_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("========== ENDED %d faces ==========\n\n", mesh->totpoly);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+#endif
+
+}  // namespace blender::bmesh::tests
@@ -39,7 +39,6 @@
 
 #define KDOP_TREE_TYPE 4
 #define KDOP_AXIS_LEN 14
-#define BLI_STACK_PAIR_LEN (2 * KDOP_TREE_TYPE)
 
 /* -------------------------------------------------------------------- */
 /** \name Weld Linked Wire Edges into Linked Faces
@@ -210,6 +209,15 @@ struct EDBMSplitElem {
 /* -------------------------------------------------------------------- */
 /* Overlap Callbacks */
 
+/**
+ * One stack of pairs for every task of an overlap query. The number of tasks depends on the
+ * tree, see #BLI_bvhtree_overlap_thread_num, so stacks are added as needed.
+ */
+struct EDBMSplitPairStacks {
+  BLI_Stack **stacks;
+  int stacks_len;
+};
+
 struct EDBMSplitData {
   BMesh *bm;
   BLI_Stack **pair_stack;
@@ -450,18 +458,62 @@ static void bm_elemxelem_bvhtree_overlap(const BVHTree *tree1,
                                          const BVHTree *tree2,
                                          BVHTree_OverlapCallback callback,
                                          struct EDBMSplitData *data,
-                                         BLI_Stack **pair_stack)
+                                         struct EDBMSplitPairStacks *pair_stacks)
 {
-  int parallel_tasks_num = BLI_bvhtree_overlap_thread_num(tree1);
+  const int parallel_tasks_num = BLI_bvhtree_overlap_thread_num(tree1);
+  if (pair_stacks->stacks_len < parallel_tasks_num) {
+    if (pair_stacks->stacks) {
+      pair_stacks->stacks = MEM_recallocN(pair_stacks->stacks,
+                                          sizeof(*pair_stacks->stacks) * parallel_tasks_num);
+    }
+    else {
+      pair_stacks->stacks = MEM_callocN(sizeof(*pair_stacks->stacks) * parallel_tasks_num,
+                                        __func__);
+    }
+    pair_stacks->stacks_len = parallel_tasks_num;
+  }
   for (int i = 0; i < parallel_tasks_num; i++) {
-    if (pair_stack[i] == NULL) {
-      pair_stack[i] = BLI_stack_new(sizeof(const struct EDBMSplitElem[2]), __func__);
+    if (pair_stacks->stacks[i] == NULL) {
+      pair_stacks->stacks[i] = BLI_stack_new(sizeof(const struct EDBMSplitElem[2]), __func__);
     }
   }
-  data->pair_stack = pair_stack;
+  data->pair_stack = pair_stacks->stacks;
   BLI_bvhtree_overlap_ex(tree1, tree2, NULL, callback, data, 1, BVH_OVERLAP_USE_THREADING);
 }
 
+static int bm_pair_stacks_count(const struct EDBMSplitPairStacks *pair_stacks)
+{
+  int count = 0;
+  for (int i = 0; i < pair_stacks->stacks_len; i++) {
+    count += (int)BLI_stack_count(pair_stacks->stacks[i]);
+  }
+  return count;
+}
+
+/**
+ * Move the pairs of all stacks into `pair_iter`.
+ * \return the position after the last pair written.
+ */
+static struct EDBMSplitElem (*bm_pair_stacks_pop(struct EDBMSplitPairStacks *pair_stacks,
+                                                 struct EDBMSplitElem (*pair_iter)[2]))[2]
+{
+  for (int i = 0; i < pair_stacks->stacks_len; i++) {
+    uint count = (uint)BLI_stack_count(pair_stacks->stacks[i]);
+    BLI_stack_pop_n_reverse(pair_stacks->stacks[i], pair_iter, count);
+    pair_iter += count;
+  }
+  return pair_iter;
+}
+
+static void bm_pair_stacks_free(struct EDBMSplitPairStacks *pair_stacks)
+{
+  for (int i = 0; i < pair_stacks->stacks_len; i++) {
+    BLI_stack_free(pair_stacks->stacks[i]);
+  }
+  MEM_SAFE_FREE(pair_stacks->stacks);
+  pair_stacks->stacks_len = 0;
+}
+
 /* -------------------------------------------------------------------- */
 /* Callbacks for `BLI_qsort_r` */
 
@@ -496,16 +548,15 @@ bool BM_mesh_intersect_edges(
   struct EDBMSplitElem(*pair_iter)[2], (*pair_array)[2] = NULL;
   int pair_len = 0;
 
-  BLI_Stack *pair_stack[BLI_STACK_PAIR_LEN] = {NULL};
-  BLI_Stack **pair_stack_vertxvert = pair_stack;
-  BLI_Stack **pair_stack_edgexelem = &pair_stack[KDOP_TREE_TYPE];
+  struct EDBMSplitPairStacks pair_stack_vertxvert = {NULL};
+  struct EDBMSplitPairStacks pair_stack_edgexelem = {NULL};
 
   const float dist_sq = square_f(dist);
   const float dist_half = dist / 2;
 
   struct EDBMSplitData data = {
       .bm = bm,
-      .pair_stack = pair_stack,
+      .pair_stack = NULL,
       .cut_edges_len = 0,
       .dist_sq = dist_sq,
       .dist_sq_sq = square_f(dist_sq),
@@ -558,7 +609,7 @@ bool BM_mesh_intersect_edges(
       BLI_bvhtree_balance(tree_verts_act);
       /* First pair search. */
       bm_elemxelem_bvhtree_overlap(
-          tree_verts_act, tree_verts_act, bm_vertxvert_self_isect_cb, &data, pair_stack_vertxvert);
+          tree_verts_act, tree_verts_act, bm_vertxvert_self_isect_cb, &data, &pair_stack_vertxvert);
     }
 
     if (tree_verts_remain) {
@@ -567,15 +618,11 @@ bool BM_mesh_intersect_edges(
 
     if (tree_verts_act && tree_verts_remain) {
       bm_elemxelem_bvhtree_overlap(
-          tree_verts_remain, tree_verts_act, bm_vertxvert_isect_cb, &data, pair_stack_vertxvert);
+          tree_verts_remain, tree_verts_act, bm_vertxvert_isect_cb, &data, &pair_stack_vertxvert);
     }
   }
 
-  for (i = KDOP_TREE_TYPE; i--;) {
-    if (pair_stack_vertxvert[i]) {
-      pair_len += BLI_stack_count(pair_stack_vertxvert[i]);
-    }
-  }
+  pair_len += bm_pair_stacks_count(&pair_stack_vertxvert);
 
 #ifdef INTERSECT_EDGES
   uint vertxvert_pair_len = pair_len;
@@ -665,29 +712,25 @@ bool BM_mesh_intersect_edges(
     if (tree_edges_act) {
       /* Edge x Edge */
       bm_elemxelem_bvhtree_overlap(
-          tree_edges_act, tree_edges_act, bm_edgexedge_self_isect_cb, &data, pair_stack_edgexelem);
+          tree_edges_act, tree_edges_act, bm_edgexedge_self_isect_cb, &data, &pair_stack_edgexelem);
 
       if (tree_edges_remain) {
         bm_elemxelem_bvhtree_overlap(
-            tree_edges_remain, tree_edges_act, bm_edgexedge_isect_cb, &data, pair_stack_edgexelem);
+            tree_edges_remain, tree_edges_act, bm_edgexedge_isect_cb, &data, &pair_stack_edgexelem);
       }
 
-      for (i = KDOP_TREE_TYPE; i--;) {
-        if (pair_stack_edgexelem[i]) {
-          edgexedge_pair_len += BLI_stack_count(pair_stack_edgexelem[i]);
-        }
-      }
+      edgexedge_pair_len = bm_pair_stacks_count(&pair_stack_edgexelem);
 
       if (tree_verts_act) {
         /* Edge v Vert */
         bm_elemxelem_bvhtree_overlap(
-            tree_edges_act, tree_verts_act, bm_edgexvert_isect_cb, &data, pair_stack_edgexelem);
+            tree_edges_act, tree_verts_act, bm_edgexvert_isect_cb, &data, &pair_stack_edgexelem);
       }
 
       if (tree_verts_remain) {
         /* Edge v Vert */
         bm_elemxelem_bvhtree_overlap(
-            tree_edges_act, tree_verts_remain, bm_edgexvert_isect_cb, &data, pair_stack_edgexelem);
+            tree_edges_act, tree_verts_remain, bm_edgexvert_isect_cb, &data, &pair_stack_edgexelem);
       }
 
       BLI_bvhtree_free(tree_edges_act);
@@ -696,17 +739,12 @@ bool BM_mesh_intersect_edges(
     if (tree_verts_act && tree_edges_remain) {
       /* Edge v Vert */
       bm_elemxelem_bvhtree_overlap(
-          tree_edges_remain, tree_verts_act, bm_edgexvert_isect_cb, &data, pair_stack_edgexelem);
+          tree_edges_remain, tree_verts_act, bm_edgexvert_isect_cb, &data, &pair_stack_edgexelem);
     }
 
     BLI_bvhtree_free(tree_edges_remain);
 
-    int edgexelem_pair_len = 0;
-    for (i = KDOP_TREE_TYPE; i--;) {
-      if (pair_stack_edgexelem[i]) {
-        edgexelem_pair_len += BLI_stack_count(pair_stack_edgexelem[i]);
-      }
-    }
+    int edgexelem_pair_len = bm_pair_stacks_count(&pair_stack_edgexelem);
 
     pair_len += edgexelem_pair_len;
     int edgexvert_pair_len = edgexelem_pair_len - edgexedge_pair_len;
@@ -714,14 +752,8 @@ bool BM_mesh_intersect_edges(
     if (edgexelem_pair_len) {
       pair_array = MEM_mallocN(sizeof(*pair_array) * pair_len, __func__);
 
-      pair_iter = pair_array;
-      for (i = 0; i < BLI_STACK_PAIR_LEN; i++) {
-        if (pair_stack[i]) {
-          uint count = (uint)BLI_stack_count(pair_stack[i]);
-          BLI_stack_pop_n_reverse(pair_stack[i], pair_iter, count);
-          pair_iter += count;
-        }
-      }
+      pair_iter = bm_pair_stacks_pop(&pair_stack_vertxvert, pair_array);
+      pair_iter = bm_pair_stacks_pop(&pair_stack_edgexelem, pair_iter);
 
       /* Map intersections per edge. */
       union {
@@ -822,14 +854,8 @@ bool BM_mesh_intersect_edges(
   if (r_targetmap) {
     if (pair_len && pair_array == NULL) {
       pair_array = MEM_mallocN(sizeof(*pair_array) * pair_len, __func__);
-      pair_iter = pair_array;
-      for (i = 0; i < BLI_STACK_PAIR_LEN; i++) {
-        if (pair_stack[i]) {
-          uint count = (uint)BLI_stack_count(pair_stack[i]);
-          BLI_stack_pop_n_reverse(pair_stack[i], pair_iter, count);
-          pair_iter += count;
-        }
-      }
+      pair_iter = bm_pair_stacks_pop(&pair_stack_vertxvert, pair_array);
+      pair_iter = bm_pair_stacks_pop(&pair_stack_edgexelem, pair_iter);
     }
 
     if (pair_array) {
@@ -1045,11 +1071,8 @@ bool BM_mesh_intersect_edges(
     }
   }
 
-  for (i = BLI_STACK_PAIR_LEN; i--;) {
-    if (pair_stack[i]) {
-      BLI_stack_free(pair_stack[i]);
-    }
-  }
+  bm_pair_stacks_free(&pair_stack_vertxvert);
+  bm_pair_stacks_free(&pair_stack_edgexelem);
   if (pair_array) {
     MEM_freeN(pair_array);
   }
@@ -20,5 +20,13 @@
 
 #pragma once
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 bool BM_mesh_intersect_edges(
     BMesh *bm, const char hflag, const float dist, const bool split_faces, GHash *r_targetmap);
+
+#ifdef __cplusplus
+}
+#endif
@@ -794,6 +794,17 @@ BLI_INLINE eMRIterType mesh_extract_iter_type(const MeshExtract *ext)
   return type;
 }
 
+/**
+ * Index buffers filled from multiple threads set their elements in any order,
+ * so the length tracked by the builder can't be relied on.
+ * Only use for buffers where all elements are set.
+ */
+BLI_INLINE void extract_indexbuf_build_in_place_full(GPUIndexBufBuilder *elb, GPUIndexBuf *ibo)
+{
+  elb->index_len = elb->max_index_len;
+  GPU_indexbuf_build_in_place(elb, ibo);
+}
+
 /** \} */
 
 /* ---------------------------------------------------------------------- */
@@ -804,6 +815,9 @@ typedef struct MeshExtract_Tri_Data {
   GPUIndexBufBuilder elb;
   int *tri_mat_start;
   int *tri_mat_end;
+  /** Per polygon, offset from the index of its first loop triangle to its first triangle in the
+   * index buffer. Allows to fill the index buffer from multiple threads. */
+  int *poly_tri_ofs;
 } MeshExtract_Tri_Data;
 
 static void *extract_tris_init(const MeshRenderData *mr,
@@ -815,6 +829,7 @@ static void *extract_tris_init(const MeshRenderData *mr,
   size_t mat_tri_idx_size = sizeof(int) * mr->mat_len;
   data->tri_mat_start = MEM_callocN(mat_tri_idx_size, __func__);
   data->tri_mat_end = MEM_callocN(mat_tri_idx_size, __func__);
+  data->poly_tri_ofs = MEM_mallocN(sizeof(int) * mr->poly_len, __func__);
 
   int *mat_tri_len = data->tri_mat_start;
   /* Count how many triangle for each material. */
@@ -848,25 +863,51 @@ static void *extract_tris_init(const MeshRenderData *mr,
 
   memcpy(data->tri_mat_end, mat_tri_len, mat_tri_idx_size);
 
+  /* Place the triangles of each visible polygon after the ones of the previous polygons with the
+   * same material, loop triangles are stored in polygon order. */
+  int *mat_tri_ofs = data->tri_mat_end;
+  int tri_index = 0;
+  if (mr->extract_type == MR_EXTRACT_BMESH) {
+    BMFace **ftable = mr->bm->ftable;
+    for (int f_index = 0; f_index < mr->poly_len; f_index++) {
+      const BMFace *efa = ftable[f_index];
+      if (!BM_elem_flag_test(efa, BM_ELEM_HIDDEN)) {
+        const int mat = min_ii(efa->mat_nr, mr->mat_len - 1);
+        data->poly_tri_ofs[f_index] = mat_tri_ofs[mat] - tri_index;
+        mat_tri_ofs[mat] += efa->len - 2;
+      }
+      tri_index += efa->len - 2;
+    }
+  }
+  else {
+    const MPoly *mp = mr->mpoly;
+    for (int mp_index = 0; mp_index < mr->poly_len; mp_index++, mp++) {
+      if (!(mr->use_hide && (mp->flag & ME_HIDE))) {
+        const int mat = min_ii(mp->mat_nr, mr->mat_len - 1);
+        data->poly_tri_ofs[mp_index] = mat_tri_ofs[mat] - tri_index;
+        mat_tri_ofs[mat] += mp->totloop - 2;
+      }
+      tri_index += mp->totloop - 2;
+    }
+  }
+
   int visible_tri_tot = ofs;
   GPU_indexbuf_init(&data->elb, GPU_PRIM_TRIS, visible_tri_tot, mr->loop_len);
 
   return data;
 }
 
-static void extract_tris_iter_looptri_bm(const MeshRenderData *mr,
+static void extract_tris_iter_looptri_bm(const MeshRenderData *UNUSED(mr),
                                          const struct ExtractTriBMesh_Params *params,
                                          void *_data)
 {
   MeshExtract_Tri_Data *data = _data;
-  const int mat_last = mr->mat_len - 1;
-  EXTRACT_TRIS_LOOPTRI_FOREACH_BM_BEGIN(elt, _elt_index, params)
+  EXTRACT_TRIS_LOOPTRI_FOREACH_BM_BEGIN(elt, elt_index, params)
   {
-    if (!BM_elem_flag_test(elt[0]->f, BM_ELEM_HIDDEN)) {
-      int *mat_tri_ofs = data->tri_mat_end;
-      const int mat = min_ii(elt[0]->f->mat_nr, mat_last);
+    const BMFace *efa = elt[0]->f;
+    if (!BM_elem_flag_test(efa, BM_ELEM_HIDDEN)) {
       GPU_indexbuf_set_tri_verts(&data->elb,
-                                 mat_tri_ofs[mat]++,
+                                 elt_index + data->poly_tri_ofs[BM_elem_index_get(efa)],
                                  BM_elem_index_get(elt[0]),
                                  BM_elem_index_get(elt[1]),
                                  BM_elem_index_get(elt[2]));
@@ -880,15 +921,15 @@ static void extract_tris_iter_looptri_mesh(const MeshRenderData *mr,
                                            void *_data)
 {
   MeshExtract_Tri_Data *data = _data;
-  const int mat_last = mr->mat_len - 1;
-  EXTRACT_TRIS_LOOPTRI_FOREACH_MESH_BEGIN(mlt, _mlt_index, params)
+  EXTRACT_TRIS_LOOPTRI_FOREACH_MESH_BEGIN(mlt, mlt_index, params)
   {
     const MPoly *mp = &mr->mpoly[mlt->poly];
     if (!(mr->use_hide && (mp->flag & ME_HIDE))) {
-      int *mat_tri_ofs = data->tri_mat_end;
-      const int mat = min_ii(mp->mat_nr, mat_last);
-      GPU_indexbuf_set_tri_verts(
-          &data->elb, mat_tri_ofs[mat]++, mlt->tri[0], mlt->tri[1], mlt->tri[2]);
+      GPU_indexbuf_set_tri_verts(&data->elb,
+                                 mlt_index + data->poly_tri_ofs[mlt->poly],
+                                 mlt->tri[0],
+                                 mlt->tri[1],
+                                 mlt->tri[2]);
     }
   }
   EXTRACT_TRIS_LOOPTRI_FOREACH_MESH_END;
@@ -900,7 +941,7 @@ static void extract_tris_finish(const MeshRenderData *mr,
                                 void *_data)
 {
   MeshExtract_Tri_Data *data = _data;
-  GPU_indexbuf_build_in_place(&data->elb, ibo);
+  extract_indexbuf_build_in_place_full(&data->elb, ibo);
 
   /* Create ibo sub-ranges. Always do this to avoid error when the standard surface batch
    * is created before the surfaces-per-material. */
@@ -922,6 +963,7 @@ static void extract_tris_finish(const MeshRenderData *mr,
   }
   MEM_freeN(data->tri_mat_start);
   MEM_freeN(data->tri_mat_end);
+  MEM_freeN(data->poly_tri_ofs);
   MEM_freeN(data);
 }
 
@@ -931,7 +973,7 @@ static const MeshExtract extract_tris = {
     .iter_looptri_mesh = extract_tris_iter_looptri_mesh,
     .finish = extract_tris_finish,
     .data_flag = 0,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -940,21 +982,41 @@ static const MeshExtract extract_tris = {
 /** \name Extract Edges Indices
  * \{ */
 
+typedef struct MeshExtract_Lines_Data {
+  GPUIndexBufBuilder elb;
+  /** Per edge, the loop it is written from. Edges are shared by polygons which can be extracted
+   * from different threads, only one of them may write the edge. Only used for #Mesh, a #BMesh
+   * edge is written from #BMEdge.l. */
+  int *edge_loop;
+} MeshExtract_Lines_Data;
+
 static void *extract_lines_init(const MeshRenderData *mr,
                                 struct MeshBatchCache *UNUSED(cache),
                                 void *UNUSED(buf))
 {
-  GPUIndexBufBuilder *elb = MEM_mallocN(sizeof(*elb), __func__);
+  MeshExtract_Lines_Data *data = MEM_mallocN(sizeof(*data), __func__);
   /* Put loose edges at the end. */
-  GPU_indexbuf_init(
-      elb, GPU_PRIM_LINES, mr->edge_len + mr->edge_loose_len, mr->loop_len + mr->loop_loose_len);
-  return elb;
+  GPU_indexbuf_init(&data->elb,
+                    GPU_PRIM_LINES,
+                    mr->edge_len + mr->edge_loose_len,
+                    mr->loop_len + mr->loop_loose_len);
+
+  data->edge_loop = NULL;
+  if (mr->extract_type != MR_EXTRACT_BMESH) {
+    data->edge_loop = MEM_mallocN(sizeof(int) * mr->edge_len, __func__);
+    const MLoop *ml = mr->mloop;
+    for (int ml_index = 0; ml_index < mr->loop_len; ml_index++, ml++) {
+      data->edge_loop[ml->e] = ml_index;
+    }
+  }
+  return data;
 }
 
 static void extract_lines_iter_poly_bm(const MeshRenderData *mr,
                                        const ExtractPolyBMesh_Params *params,
-                                       void *elb)
+                                       void *_data)
 {
+  MeshExtract_Lines_Data *data = _data;
   /* Using poly & loop iterator would complicate accessing the adjacent loop. */
   EXTRACT_POLY_FOREACH_BM_BEGIN(f, f_index, params, mr)
   {
@@ -962,14 +1024,17 @@ static void extract_lines_iter_poly_bm(const MeshRenderData *mr,
     /* Use #BMLoop.prev to match mesh order (to avoid minor differences in data extraction). */
     l_iter = l_first = BM_FACE_FIRST_LOOP(f)->prev;
     do {
+      if (l_iter->e->l != l_iter) {
+        continue;
+      }
       if (!BM_elem_flag_test(l_iter->e, BM_ELEM_HIDDEN)) {
-        GPU_indexbuf_set_line_verts(elb,
+        GPU_indexbuf_set_line_verts(&data->elb,
                                     BM_elem_index_get(l_iter->e),
                                     BM_elem_index_get(l_iter),
                                     BM_elem_index_get(l_iter->next));
       }
       else {
-        GPU_indexbuf_set_line_restart(elb, BM_elem_index_get(l_iter->e));
+        GPU_indexbuf_set_line_restart(&data->elb, BM_elem_index_get(l_iter->e));
       }
     } while ((l_iter = l_iter->next) != l_first);
   }
@@ -978,8 +1043,10 @@ static void extract_lines_iter_poly_bm(const MeshRenderData *mr,
 
 static void extract_lines_iter_poly_mesh(const MeshRenderData *mr,
                                          const ExtractPolyMesh_Params *params,
-                                         void *elb)
+                                         void *_data)
 {
+  MeshExtract_Lines_Data *data = _data;
+  const int *edge_loop = data->edge_loop;
   /* Using poly & loop iterator would complicate accessing the adjacent loop. */
   const MLoop *mloop = mr->mloop;
   const MEdge *medge = mr->medge;
@@ -990,14 +1057,17 @@ static void extract_lines_iter_poly_mesh(const MeshRenderData *mr,
       int ml_index = ml_index_last, ml_index_next = mp->loopstart;
       do {
         const MLoop *ml = &mloop[ml_index];
+        if (edge_loop[ml->e] != ml_index) {
+          continue;
+        }
         const MEdge *med = &medge[ml->e];
         if (!((mr->use_hide && (med->flag & ME_HIDE)) ||
               ((mr->extract_type == MR_EXTRACT_MAPPED) && (mr->e_origindex) &&
                (mr->e_origindex[ml->e] == ORIGINDEX_NONE)))) {
-          GPU_indexbuf_set_line_verts(elb, ml->e, ml_index, ml_index_next);
+          GPU_indexbuf_set_line_verts(&data->elb, ml->e, ml_index, ml_index_next);
         }
         else {
-          GPU_indexbuf_set_line_restart(elb, ml->e);
+          GPU_indexbuf_set_line_restart(&data->elb, ml->e);
         }
       } while ((ml_index = ml_index_next++) != ml_index_last);
     }
@@ -1010,7 +1080,9 @@ static void extract_lines_iter_poly_mesh(const MeshRenderData *mr,
       int ml_index = ml_index_last, ml_index_next = mp->loopstart;
       do {
         const MLoop *ml = &mloop[ml_index];
-        GPU_indexbuf_set_line_verts(elb, ml->e, ml_index, ml_index_next);
+        if (edge_loop[ml->e] == ml_index) {
+          GPU_indexbuf_set_line_verts(&data->elb, ml->e, ml_index, ml_index_next);
+        }
       } while ((ml_index = ml_index_next++) != ml_index_last);
     }
     EXTRACT_POLY_FOREACH_MESH_END;
@@ -1019,28 +1091,30 @@ static void extract_lines_iter_poly_mesh(const MeshRenderData *mr,
 
 static void extract_lines_iter_ledge_bm(const MeshRenderData *mr,
                                         const ExtractLEdgeBMesh_Params *params,
-                                        void *elb)
+                                        void *_data)
 {
+  MeshExtract_Lines_Data *data = _data;
   EXTRACT_LEDGE_FOREACH_BM_BEGIN(eed, ledge_index, params)
   {
     const int l_index_offset = mr->edge_len + ledge_index;
     if (!BM_elem_flag_test(eed, BM_ELEM_HIDDEN)) {
       const int l_index = mr->loop_len + ledge_index * 2;
-      GPU_indexbuf_set_line_verts(elb, l_index_offset, l_index, l_index + 1);
+      GPU_indexbuf_set_line_verts(&data->elb, l_index_offset, l_index, l_index + 1);
     }
     else {
-      GPU_indexbuf_set_line_restart(elb, l_index_offset);
+      GPU_indexbuf_set_line_restart(&data->elb, l_index_offset);
     }
     /* Don't render the edge twice. */
-    GPU_indexbuf_set_line_restart(elb, BM_elem_index_get(eed));
+    GPU_indexbuf_set_line_restart(&data->elb, BM_elem_index_get(eed));
   }
   EXTRACT_LEDGE_FOREACH_BM_END;
 }
 
 static void extract_lines_iter_ledge_mesh(const MeshRenderData *mr,
                                           const ExtractLEdgeMesh_Params *params,
-                                          void *elb)
+                                          void *_data)
 {
+  MeshExtract_Lines_Data *data = _data;
   EXTRACT_LEDGE_FOREACH_MESH_BEGIN(med, ledge_index, params, mr)
   {
     const int l_index_offset = mr->edge_len + ledge_index;
@@ -1049,13 +1123,13 @@ static void extract_lines_iter_ledge_mesh(const MeshRenderData *mr,
           ((mr->extract_type == MR_EXTRACT_MAPPED) && (mr->e_origindex) &&
            (mr->e_origindex[e_index] == ORIGINDEX_NONE)))) {
       const int l_index = mr->loop_len + ledge_index * 2;
-      GPU_indexbuf_set_line_verts(elb, l_index_offset, l_index, l_index + 1);
+      GPU_indexbuf_set_line_verts(&data->elb, l_index_offset, l_index, l_index + 1);
     }
     else {
-      GPU_indexbuf_set_line_restart(elb, l_index_offset);
+      GPU_indexbuf_set_line_restart(&data->elb, l_index_offset);
     }
     /* Don't render the edge twice. */
-    GPU_indexbuf_set_line_restart(elb, e_index);
+    GPU_indexbuf_set_line_restart(&data->elb, e_index);
   }
   EXTRACT_LEDGE_FOREACH_MESH_END;
 }
@@ -1063,10 +1137,12 @@ static void extract_lines_iter_ledge_mesh(const MeshRenderData *mr,
 static void extract_lines_finish(const MeshRenderData *UNUSED(mr),
                                  struct MeshBatchCache *UNUSED(cache),
                                  void *ibo,
-                                 void *elb)
+                                 void *_data)
 {
-  GPU_indexbuf_build_in_place(elb, ibo);
-  MEM_freeN(elb);
+  MeshExtract_Lines_Data *data = _data;
+  extract_indexbuf_build_in_place_full(&data->elb, ibo);
+  MEM_SAFE_FREE(data->edge_loop);
+  MEM_freeN(data);
 }
 
 static const MeshExtract extract_lines = {
@@ -1077,7 +1153,7 @@ static const MeshExtract extract_lines = {
     .iter_ledge_mesh = extract_lines_iter_ledge_mesh,
     .finish = extract_lines_finish,
     .data_flag = 0,
-    .use_threading = false,
+    .use_threading = true,
 };
 /** \} */
 
@@ -1099,11 +1175,13 @@ static void extract_lines_loose_subbuffer(const MeshRenderData *mr, struct MeshB
 static void extract_lines_with_lines_loose_finish(const MeshRenderData *mr,
                                                   struct MeshBatchCache *cache,
                                                   void *ibo,
-                                                  void *elb)
+                                                  void *_data)
 {
-  GPU_indexbuf_build_in_place(elb, ibo);
+  MeshExtract_Lines_Data *data = _data;
+  extract_indexbuf_build_in_place_full(&data->elb, ibo);
   extract_lines_loose_subbuffer(mr, cache);
-  MEM_freeN(elb);
+  MEM_SAFE_FREE(data->edge_loop);
+  MEM_freeN(data);
 }
 
 static const MeshExtract extract_lines_with_lines_loose = {
@@ -1114,7 +1192,7 @@ static const MeshExtract extract_lines_with_lines_loose = {
     .iter_ledge_mesh = extract_lines_iter_ledge_mesh,
     .finish = extract_lines_with_lines_loose_finish,
     .data_flag = 0,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -1132,11 +1210,29 @@ static void *extract_points_init(const MeshRenderData *mr,
   return elb;
 }
 
+/**
+ * A vertex is shared by several loops which can be extracted from different threads.
+ * Keep the highest loop index, which matches the last one set by single threaded extraction.
+ */
+BLI_INLINE void vert_set_max(GPUIndexBufBuilder *elb, const int v_index, const int l_index)
+{
+  BLI_assert((uint)v_index < elb->max_index_len);
+  uint32_t *point = &elb->data[v_index];
+  uint32_t point_prev = *point;
+  while (point_prev < (uint32_t)l_index) {
+    const uint32_t point_orig = atomic_cas_uint32(point, point_prev, (uint32_t)l_index);
+    if (point_orig == point_prev) {
+      break;
+    }
+    point_prev = point_orig;
+  }
+}
+
 BLI_INLINE void vert_set_bm(GPUIndexBufBuilder *elb, BMVert *eve, int l_index)
 {
   const int v_index = BM_elem_index_get(eve);
   if (!BM_elem_flag_test(eve, BM_ELEM_HIDDEN)) {
-    GPU_indexbuf_set_point_vert(elb, v_index, l_index);
+    vert_set_max(elb, v_index, l_index);
   }
   else {
     GPU_indexbuf_set_point_restart(elb, v_index);
@@ -1152,7 +1248,7 @@ BLI_INLINE void vert_set_mesh(GPUIndexBufBuilder *elb,
   if (!((mr->use_hide && (mv->flag & ME_HIDE)) ||
         ((mr->extract_type == MR_EXTRACT_MAPPED) && (mr->v_origindex) &&
          (mr->v_origindex[v_index] == ORIGINDEX_NONE)))) {
-    GPU_indexbuf_set_point_vert(elb, v_index, l_index);
+    vert_set_max(elb, v_index, l_index);
   }
   else {
     GPU_indexbuf_set_point_restart(elb, v_index);
@@ -1234,7 +1330,7 @@ static void extract_points_finish(const MeshRenderData *UNUSED(mr),
                                   void *ibo,
                                   void *elb)
 {
-  GPU_indexbuf_build_in_place(elb, ibo);
+  extract_indexbuf_build_in_place_full(elb, ibo);
   MEM_freeN(elb);
 }
 
@@ -1248,7 +1344,7 @@ static const MeshExtract extract_points = {
     .iter_lvert_mesh = extract_points_iter_lvert_mesh,
     .finish = extract_points_finish,
     .data_flag = 0,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -1319,7 +1415,7 @@ static void extract_fdots_finish(const MeshRenderData *UNUSED(mr),
                                  void *ibo,
                                  void *elb)
 {
-  GPU_indexbuf_build_in_place(elb, ibo);
+  extract_indexbuf_build_in_place_full(elb, ibo);
   MEM_freeN(elb);
 }
 
@@ -1329,7 +1425,7 @@ static const MeshExtract extract_fdots = {
     .iter_poly_mesh = extract_fdots_iter_poly_mesh,
     .finish = extract_fdots_finish,
     .data_flag = 0,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -1896,6 +1992,76 @@ static const MeshExtract extract_edituv_fdots = {
 
 /** \} */
 
+/* ---------------------------------------------------------------------- */
+/** \name Vertex Normal Packing
+ *
+ * Extractors reading the vertex normal of every loop convert the normals once per vertex into
+ * an intermediate array. This is done for blocks of contiguous vertices in parallel, using plain
+ * loops without per element branches or indirection so the compiler can vectorize them.
+ * \{ */
+
+#define EXTRACT_VERT_BLOCK_SIZE 4096
+
+typedef struct ExtractVertNormalsPack_Data {
+  const MeshRenderData *mr;
+  GPUNormal *normals;
+  bool use_hq;
+} ExtractVertNormalsPack_Data;
+
+static void extract_vert_normals_pack_block(void *__restrict userdata,
+                                            const int block,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ExtractVertNormalsPack_Data *data = userdata;
+  const MeshRenderData *mr = data->mr;
+  const MVert *mvert = mr->mvert;
+  GPUNormal *normals = data->normals;
+  const int v_start = block * EXTRACT_VERT_BLOCK_SIZE;
+  const int v_end = min_ii(v_start + EXTRACT_VERT_BLOCK_SIZE, mr->vert_len);
+
+  if (data->use_hq) {
+    for (int v = v_start; v < v_end; v++) {
+      copy_v3_v3_short(normals[v].high, mvert[v].no);
+    }
+    return;
+  }
+
+  for (int v = v_start; v < v_end; v++) {
+    normals[v].low = GPU_normal_convert_i10_s3(mvert[v].no);
+  }
+  /* Flag for paint mode overlay, the per face part of it is added while iterating loops. */
+  const int *v_origindex = (mr->extract_type == MR_EXTRACT_MAPPED) ? mr->v_origindex : NULL;
+  for (int v = v_start; v < v_end; v++) {
+    if (mvert[v].flag & ME_HIDE || (v_origindex && v_origindex[v] == ORIGINDEX_NONE)) {
+      normals[v].low.w = -1;
+    }
+    else if (mvert[v].flag & SELECT) {
+      normals[v].low.w = 1;
+    }
+  }
+}
+
+/* Low quality normals also store the paint mode overlay flag of their vertex. */
+static void extract_vert_normals_pack(const MeshRenderData *mr,
+                                      GPUNormal *normals,
+                                      const bool use_hq)
+{
+  ExtractVertNormalsPack_Data data = {
+      .mr = mr,
+      .normals = normals,
+      .use_hq = use_hq,
+  };
+  const int blocks_len = (mr->vert_len + EXTRACT_VERT_BLOCK_SIZE - 1) / EXTRACT_VERT_BLOCK_SIZE;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = blocks_len > 1;
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, blocks_len, &data, extract_vert_normals_pack_block, &settings);
+}
+
+/** \} */
+
 /* ---------------------------------------------------------------------- */
 /** \name Extract Position and Vertex Normal
  * \{ */
@@ -1940,10 +2106,7 @@ static void *extract_pos_nor_init(const MeshRenderData *mr,
     }
   }
   else {
-    const MVert *mv = mr->mvert;
-    for (int v = 0; v < mr->vert_len; v++, mv++) {
-      data->normals[v].low = GPU_normal_convert_i10_s3(mv->no);
-    }
+    extract_vert_normals_pack(mr, data->normals, false);
   }
   return data;
 }
@@ -1969,26 +2132,26 @@ static void extract_pos_nor_iter_poly_mesh(const MeshRenderData *mr,
                                            void *_data)
 {
   MeshExtract_PosNor_Data *data = _data;
-  EXTRACT_POLY_AND_LOOP_FOREACH_MESH_BEGIN(mp, mp_index, ml, ml_index, params, mr)
+  const MVert *mvert = mr->mvert;
+  const MLoop *mloop = mr->mloop;
+  const GPUNormal *normals = data->normals;
+  PosNorLoop *vbo_data = data->vbo_data;
+  EXTRACT_POLY_FOREACH_MESH_BEGIN(mp, mp_index, params, mr)
   {
-    PosNorLoop *vert = &data->vbo_data[ml_index];
-    const MVert *mv = &mr->mvert[ml->v];
-    copy_v3_v3(vert->pos, mv->co);
-    vert->nor = data->normals[ml->v].low;
-    /* Flag for paint mode overlay. */
-    if (mp->flag & ME_HIDE || mv->flag & ME_HIDE ||
-        ((mr->extract_type == MR_EXTRACT_MAPPED) && (mr->v_origindex) &&
-         (mr->v_origindex[ml->v] == ORIGINDEX_NONE))) {
-      vert->nor.w = -1;
-    }
-    else if (mv->flag & SELECT) {
-      vert->nor.w = 1;
-    }
-    else {
-      vert->nor.w = 0;
+    /* The packed normals already contain the vertex part of the paint mode overlay flag. */
+    const int ml_index_end = mp->loopstart + mp->totloop;
+    for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+      const uint v = mloop[ml_index].v;
+      copy_v3_v3(vbo_data[ml_index].pos, mvert[v].co);
+      vbo_data[ml_index].nor = normals[v].low;
+    }
+    if (mp->flag & ME_HIDE) {
+      for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+        vbo_data[ml_index].nor.w = -1;
+      }
     }
   }
-  EXTRACT_POLY_AND_LOOP_FOREACH_MESH_END;
+  EXTRACT_POLY_FOREACH_MESH_END;
 }
 
 static void extract_pos_nor_iter_ledge_bm(const MeshRenderData *mr,
@@ -2021,6 +2184,8 @@ static void extract_pos_nor_iter_ledge_mesh(const MeshRenderData *mr,
     copy_v3_v3(vert[1].pos, mr->mvert[med->v2].co);
     vert[0].nor = data->normals[med->v1].low;
     vert[1].nor = data->normals[med->v2].low;
+    vert[0].nor.w = 0;
+    vert[1].nor.w = 0;
   }
   EXTRACT_LEDGE_FOREACH_MESH_END;
 }
@@ -2054,6 +2219,7 @@ static void extract_pos_nor_iter_lvert_mesh(const MeshRenderData *mr,
     PosNorLoop *vert = &data->vbo_data[ml_index];
     copy_v3_v3(vert->pos, mv->co);
     vert->nor = data->normals[v_index].low;
+    vert->nor.w = 0;
   }
   EXTRACT_LVERT_FOREACH_MESH_END;
 }
@@ -2124,10 +2290,7 @@ static void *extract_pos_nor_hq_init(const MeshRenderData *mr,
     }
   }
   else {
-    const MVert *mv = mr->mvert;
-    for (int v = 0; v < mr->vert_len; v++, mv++) {
-      copy_v3_v3_short(data->normals[v].high, mv->no);
-    }
+    extract_vert_normals_pack(mr, data->normals, true);
   }
   return data;
 }
@@ -2154,6 +2317,7 @@ static void extract_pos_nor_hq_iter_poly_mesh(const MeshRenderData *mr,
                                               void *_data)
 {
   MeshExtract_PosNorHQ_Data *data = _data;
+  const int *v_origindex = (mr->extract_type == MR_EXTRACT_MAPPED) ? mr->v_origindex : NULL;
   EXTRACT_POLY_AND_LOOP_FOREACH_MESH_BEGIN(mp, mp_index, ml, ml_index, params, mr)
   {
     PosNorHQLoop *vert = &data->vbo_data[ml_index];
@@ -2163,8 +2327,7 @@ static void extract_pos_nor_hq_iter_poly_mesh(const MeshRenderData *mr,
 
     /* Flag for paint mode overlay. */
     if (mp->flag & ME_HIDE || mv->flag & ME_HIDE ||
-        ((mr->extract_type == MR_EXTRACT_MAPPED) && (mr->v_origindex) &&
-         (mr->v_origindex[ml->v] == ORIGINDEX_NONE))) {
+        (v_origindex && v_origindex[ml->v] == ORIGINDEX_NONE)) {
       vert->nor[3] = -1;
     }
     else if (mv->flag & SELECT) {
@@ -2417,34 +2580,50 @@ static void extract_lnor_iter_poly_mesh(const MeshRenderData *mr,
                                         const ExtractPolyMesh_Params *params,
                                         void *data)
 {
-  EXTRACT_POLY_AND_LOOP_FOREACH_MESH_BEGIN(mp, mp_index, ml, ml_index, params, mr)
+  GPUPackedNormal *lnor_data = (GPUPackedNormal *)data;
+  const MVert *mvert = mr->mvert;
+  const MLoop *mloop = mr->mloop;
+  const float(*loop_normals)[3] = mr->loop_normals;
+  /* Only use MR_EXTRACT_MAPPED in edit mode where it is used to display the edge-normals.
+   * In paint mode it will use the un-mapped data to draw the wire-frame. */
+  const int *v_origindex = (mr->edit_bmesh && mr->extract_type == MR_EXTRACT_MAPPED) ?
+                               mr->v_origindex :
+                               NULL;
+  EXTRACT_POLY_FOREACH_MESH_BEGIN(mp, mp_index, params, mr)
   {
-    GPUPackedNormal *lnor_data = &((GPUPackedNormal *)data)[ml_index];
-    if (mr->loop_normals) {
-      *lnor_data = GPU_normal_convert_i10_v3(mr->loop_normals[ml_index]);
+    const int ml_index_end = mp->loopstart + mp->totloop;
+    if (loop_normals) {
+      for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+        lnor_data[ml_index] = GPU_normal_convert_i10_v3(loop_normals[ml_index]);
+      }
     }
     else if (mp->flag & ME_SMOOTH) {
-      *lnor_data = GPU_normal_convert_i10_s3(mr->mvert[ml->v].no);
+      for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+        lnor_data[ml_index] = GPU_normal_convert_i10_s3(mvert[mloop[ml_index].v].no);
+      }
     }
     else {
-      *lnor_data = GPU_normal_convert_i10_v3(mr->poly_normals[mp_index]);
+      /* Flat faces, convert the face normal only once. */
+      const GPUPackedNormal poly_nor = GPU_normal_convert_i10_v3(mr->poly_normals[mp_index]);
+      for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+        lnor_data[ml_index] = poly_nor;
+      }
     }
 
-    /* Flag for paint mode overlay.
-     * Only use MR_EXTRACT_MAPPED in edit mode where it is used to display the edge-normals.
-     * In paint mode it will use the un-mapped data to draw the wire-frame. */
-    if (mp->flag & ME_HIDE || (mr->edit_bmesh && mr->extract_type == MR_EXTRACT_MAPPED &&
-                               (mr->v_origindex) && mr->v_origindex[ml->v] == ORIGINDEX_NONE)) {
-      lnor_data->w = -1;
-    }
-    else if (mp->flag & ME_FACE_SEL) {
-      lnor_data->w = 1;
-    }
-    else {
-      lnor_data->w = 0;
+    /* Flag for paint mode overlay. */
+    const int flag = (mp->flag & ME_HIDE) ? -1 : ((mp->flag & ME_FACE_SEL) ? 1 : 0);
+    for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+      lnor_data[ml_index].w = flag;
+    }
+    if (v_origindex && flag != -1) {
+      for (int ml_index = mp->loopstart; ml_index < ml_index_end; ml_index++) {
+        if (v_origindex[mloop[ml_index].v] == ORIGINDEX_NONE) {
+          lnor_data[ml_index].w = -1;
+        }
+      }
     }
   }
-  EXTRACT_POLY_AND_LOOP_FOREACH_MESH_END;
+  EXTRACT_POLY_FOREACH_MESH_END;
 }
 
 static const MeshExtract extract_lnor = {
@@ -3292,6 +3471,18 @@ static const MeshExtract extract_edge_fac = {
     .use_threading = false,
 };
 
+/* Same as #extract_edge_fac, used when the loops per edge don't need to be counted. */
+static const MeshExtract extract_edge_fac_threaded = {
+    .init = extract_edge_fac_init,
+    .iter_poly_bm = extract_edge_fac_iter_poly_bm,
+    .iter_poly_mesh = extract_edge_fac_iter_poly_mesh,
+    .iter_ledge_bm = extract_edge_fac_iter_ledge_bm,
+    .iter_ledge_mesh = extract_edge_fac_iter_ledge_mesh,
+    .finish = extract_edge_fac_finish,
+    .data_flag = MR_DATA_POLY_NOR,
+    .use_threading = true,
+};
+
 /** \} */
 /* ---------------------------------------------------------------------- */
 /** \name Extract Vertex Weight
@@ -3973,8 +4164,6 @@ typedef struct UVStretchAngle {
 typedef struct MeshExtract_StretchAngle_Data {
   UVStretchAngle *vbo_data;
   MLoopUV *luv;
-  float auv[2][2], last_auv[2];
-  float av[2][3], last_av[3];
   int cd_ofs;
 } MeshExtract_StretchAngle_Data;
 
@@ -4053,8 +4242,9 @@ static void extract_edituv_stretch_angle_iter_poly_bm(const MeshRenderData *mr,
                                                       void *_data)
 {
   MeshExtract_StretchAngle_Data *data = _data;
-  float(*auv)[2] = data->auv, *last_auv = data->last_auv;
-  float(*av)[3] = data->av, *last_av = data->last_av;
+  /* Edges of the current face, local since ranges of faces are extracted in parallel. */
+  float auv[2][2] = {{0.0f}}, last_auv[2] = {0.0f};
+  float av[2][3] = {{0.0f}}, last_av[3] = {0.0f};
   EXTRACT_POLY_AND_LOOP_FOREACH_BM_BEGIN(l, l_index, params, mr)
   {
     const MLoopUV *luv, *luv_next;
@@ -4100,11 +4290,12 @@ static void extract_edituv_stretch_angle_iter_poly_mesh(const MeshRenderData *mr
                                                         void *_data)
 {
   MeshExtract_StretchAngle_Data *data = _data;
+  /* Edges of the current face, local since ranges of faces are extracted in parallel. */
+  float auv[2][2] = {{0.0f}}, last_auv[2] = {0.0f};
+  float av[2][3] = {{0.0f}}, last_av[3] = {0.0f};
 
   EXTRACT_POLY_AND_LOOP_FOREACH_MESH_BEGIN(mp, mp_index, ml, ml_index, params, mr)
   {
-    float(*auv)[2] = data->auv, *last_auv = data->last_auv;
-    float(*av)[3] = data->av, *last_av = data->last_av;
     int l_next = ml_index + 1, ml_index_end = mp->loopstart + mp->totloop;
     const MVert *v, *v_next;
     if (ml_index == mp->loopstart) {
@@ -4153,7 +4344,7 @@ static const MeshExtract extract_edituv_stretch_angle = {
     .iter_poly_mesh = extract_edituv_stretch_angle_iter_poly_mesh,
     .finish = extract_edituv_stretch_angle_finish,
     .data_flag = 0,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -4869,63 +5060,65 @@ static void *extract_fdots_nor_init(const MeshRenderData *mr,
   GPU_vertbuf_init_with_format(vbo, &format);
   GPU_vertbuf_data_alloc(vbo, mr->poly_len);
 
-  return NULL;
+  return GPU_vertbuf_get_data(vbo);
 }
 
-static void extract_fdots_nor_finish(const MeshRenderData *mr,
-                                     struct MeshBatchCache *UNUSED(cache),
-                                     void *buf,
-                                     void *UNUSED(data))
+static void extract_fdots_nor_iter_poly_bm(const MeshRenderData *mr,
+                                           const ExtractPolyBMesh_Params *params,
+                                           void *data)
 {
   static float invalid_normal[3] = {0.0f, 0.0f, 0.0f};
-  GPUVertBuf *vbo = buf;
-  GPUPackedNormal *nor = (GPUPackedNormal *)GPU_vertbuf_get_data(vbo);
-  BMFace *efa;
-
-  /* Quicker than doing it for each loop. */
-  if (mr->extract_type == MR_EXTRACT_BMESH) {
-    for (int f = 0; f < mr->poly_len; f++) {
-      efa = BM_face_at_index(mr->bm, f);
-      const bool is_face_hidden = BM_elem_flag_test(efa, BM_ELEM_HIDDEN);
-      if (is_face_hidden || (mr->extract_type == MR_EXTRACT_MAPPED && mr->p_origindex &&
-                             mr->p_origindex[f] == ORIGINDEX_NONE)) {
-        nor[f] = GPU_normal_convert_i10_v3(invalid_normal);
-        nor[f].w = NOR_AND_FLAG_HIDDEN;
-      }
-      else {
-        nor[f] = GPU_normal_convert_i10_v3(bm_face_no_get(mr, efa));
-        /* Select / Active Flag. */
-        nor[f].w = (BM_elem_flag_test(efa, BM_ELEM_SELECT) ?
-                        ((efa == mr->efa_act) ? NOR_AND_FLAG_ACTIVE : NOR_AND_FLAG_SELECT) :
-                        NOR_AND_FLAG_DEFAULT);
-      }
+  GPUPackedNormal *nor = data;
+  EXTRACT_POLY_FOREACH_BM_BEGIN(efa, f, params, mr)
+  {
+    const bool is_face_hidden = BM_elem_flag_test(efa, BM_ELEM_HIDDEN);
+    if (is_face_hidden) {
+      nor[f] = GPU_normal_convert_i10_v3(invalid_normal);
+      nor[f].w = NOR_AND_FLAG_HIDDEN;
+    }
+    else {
+      nor[f] = GPU_normal_convert_i10_v3(bm_face_no_get(mr, efa));
+      /* Select / Active Flag. */
+      nor[f].w = (BM_elem_flag_test(efa, BM_ELEM_SELECT) ?
+                      ((efa == mr->efa_act) ? NOR_AND_FLAG_ACTIVE : NOR_AND_FLAG_SELECT) :
+                      NOR_AND_FLAG_DEFAULT);
     }
   }
-  else {
-    for (int f = 0; f < mr->poly_len; f++) {
-      efa = bm_original_face_get(mr, f);
-      const bool is_face_hidden = efa && BM_elem_flag_test(efa, BM_ELEM_HIDDEN);
-      if (is_face_hidden || (mr->extract_type == MR_EXTRACT_MAPPED && mr->p_origindex &&
-                             mr->p_origindex[f] == ORIGINDEX_NONE)) {
-        nor[f] = GPU_normal_convert_i10_v3(invalid_normal);
-        nor[f].w = NOR_AND_FLAG_HIDDEN;
-      }
-      else {
-        nor[f] = GPU_normal_convert_i10_v3(bm_face_no_get(mr, efa));
-        /* Select / Active Flag. */
-        nor[f].w = (BM_elem_flag_test(efa, BM_ELEM_SELECT) ?
-                        ((efa == mr->efa_act) ? NOR_AND_FLAG_ACTIVE : NOR_AND_FLAG_SELECT) :
-                        NOR_AND_FLAG_DEFAULT);
-      }
+  EXTRACT_POLY_FOREACH_BM_END;
+}
+
+static void extract_fdots_nor_iter_poly_mesh(const MeshRenderData *mr,
+                                             const ExtractPolyMesh_Params *params,
+                                             void *data)
+{
+  static float invalid_normal[3] = {0.0f, 0.0f, 0.0f};
+  GPUPackedNormal *nor = data;
+  EXTRACT_POLY_FOREACH_MESH_BEGIN(mp, f, params, mr)
+  {
+    BMFace *efa = bm_original_face_get(mr, f);
+    const bool is_face_hidden = efa && BM_elem_flag_test(efa, BM_ELEM_HIDDEN);
+    if (is_face_hidden || (mr->extract_type == MR_EXTRACT_MAPPED && mr->p_origindex &&
+                           mr->p_origindex[f] == ORIGINDEX_NONE)) {
+      nor[f] = GPU_normal_convert_i10_v3(invalid_normal);
+      nor[f].w = NOR_AND_FLAG_HIDDEN;
+    }
+    else {
+      nor[f] = GPU_normal_convert_i10_v3(bm_face_no_get(mr, efa));
+      /* Select / Active Flag. */
+      nor[f].w = (BM_elem_flag_test(efa, BM_ELEM_SELECT) ?
+                      ((efa == mr->efa_act) ? NOR_AND_FLAG_ACTIVE : NOR_AND_FLAG_SELECT) :
+                      NOR_AND_FLAG_DEFAULT);
     }
   }
+  EXTRACT_POLY_FOREACH_MESH_END;
 }
 
 static const MeshExtract extract_fdots_nor = {
     .init = extract_fdots_nor_init,
-    .finish = extract_fdots_nor_finish,
+    .iter_poly_bm = extract_fdots_nor_iter_poly_bm,
+    .iter_poly_mesh = extract_fdots_nor_iter_poly_mesh,
     .data_flag = MR_DATA_POLY_NOR,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -4945,63 +5138,65 @@ static void *extract_fdots_nor_hq_init(const MeshRenderData *mr,
   GPU_vertbuf_init_with_format(vbo, &format);
   GPU_vertbuf_data_alloc(vbo, mr->poly_len);
 
-  return NULL;
+  return GPU_vertbuf_get_data(vbo);
 }
 
-static void extract_fdots_nor_hq_finish(const MeshRenderData *mr,
-                                        struct MeshBatchCache *UNUSED(cache),
-                                        void *buf,
-                                        void *UNUSED(data))
+static void extract_fdots_nor_hq_iter_poly_bm(const MeshRenderData *mr,
+                                              const ExtractPolyBMesh_Params *params,
+                                              void *data)
 {
   static float invalid_normal[3] = {0.0f, 0.0f, 0.0f};
-  GPUVertBuf *vbo = buf;
-  short *nor = (short *)GPU_vertbuf_get_data(vbo);
-  BMFace *efa;
-
-  /* Quicker than doing it for each loop. */
-  if (mr->extract_type == MR_EXTRACT_BMESH) {
-    for (int f = 0; f < mr->poly_len; f++) {
-      efa = BM_face_at_index(mr->bm, f);
-      const bool is_face_hidden = BM_elem_flag_test(efa, BM_ELEM_HIDDEN);
-      if (is_face_hidden || (mr->extract_type == MR_EXTRACT_MAPPED && mr->p_origindex &&
-                             mr->p_origindex[f] == ORIGINDEX_NONE)) {
-        normal_float_to_short_v3(&nor[f * 4], invalid_normal);
-        nor[f * 4 + 3] = NOR_AND_FLAG_HIDDEN;
-      }
-      else {
-        normal_float_to_short_v3(&nor[f * 4], bm_face_no_get(mr, efa));
-        /* Select / Active Flag. */
-        nor[f * 4 + 3] = (BM_elem_flag_test(efa, BM_ELEM_SELECT) ?
-                              ((efa == mr->efa_act) ? NOR_AND_FLAG_ACTIVE : NOR_AND_FLAG_SELECT) :
-                              NOR_AND_FLAG_DEFAULT);
-      }
+  short *nor = data;
+  EXTRACT_POLY_FOREACH_BM_BEGIN(efa, f, params, mr)
+  {
+    const bool is_face_hidden = BM_elem_flag_test(efa, BM_ELEM_HIDDEN);
+    if (is_face_hidden) {
+      normal_float_to_short_v3(&nor[f * 4], invalid_normal);
+      nor[f * 4 + 3] = NOR_AND_FLAG_HIDDEN;
+    }
+    else {
+      normal_float_to_short_v3(&nor[f * 4], bm_face_no_get(mr, efa));
+      /* Select / Active Flag. */
+      nor[f * 4 + 3] = (BM_elem_flag_test(efa, BM_ELEM_SELECT) ?
+                            ((efa == mr->efa_act) ? NOR_AND_FLAG_ACTIVE : NOR_AND_FLAG_SELECT) :
+                            NOR_AND_FLAG_DEFAULT);
     }
   }
-  else {
-    for (int f = 0; f < mr->poly_len; f++) {
-      efa = bm_original_face_get(mr, f);
-      const bool is_face_hidden = efa && BM_elem_flag_test(efa, BM_ELEM_HIDDEN);
-      if (is_face_hidden || (mr->extract_type == MR_EXTRACT_MAPPED && mr->p_origindex &&
-                             mr->p_origindex[f] == ORIGINDEX_NONE)) {
-        normal_float_to_short_v3(&nor[f * 4], invalid_normal);
-        nor[f * 4 + 3] = NOR_AND_FLAG_HIDDEN;
-      }
-      else {
-        normal_float_to_short_v3(&nor[f * 4], bm_face_no_get(mr, efa));
-        /* Select / Active Flag. */
-        nor[f * 4 + 3] = (BM_elem_flag_test(efa, BM_ELEM_SELECT) ?
-                              ((efa == mr->efa_act) ? NOR_AND_FLAG_ACTIVE : NOR_AND_FLAG_SELECT) :
-                              NOR_AND_FLAG_DEFAULT);
-      }
+  EXTRACT_POLY_FOREACH_BM_END;
+}
+
+static void extract_fdots_nor_hq_iter_poly_mesh(const MeshRenderData *mr,
+                                                const ExtractPolyMesh_Params *params,
+                                                void *data)
+{
+  static float invalid_normal[3] = {0.0f, 0.0f, 0.0f};
+  short *nor = data;
+  EXTRACT_POLY_FOREACH_MESH_BEGIN(mp, f, params, mr)
+  {
+    BMFace *efa = bm_original_face_get(mr, f);
+    const bool is_face_hidden = efa && BM_elem_flag_test(efa, BM_ELEM_HIDDEN);
+    if (is_face_hidden || (mr->extract_type == MR_EXTRACT_MAPPED && mr->p_origindex &&
+                           mr->p_origindex[f] == ORIGINDEX_NONE)) {
+      normal_float_to_short_v3(&nor[f * 4], invalid_normal);
+      nor[f * 4 + 3] = NOR_AND_FLAG_HIDDEN;
+    }
+    else {
+      normal_float_to_short_v3(&nor[f * 4], bm_face_no_get(mr, efa));
+      /* Select / Active Flag. */
+      nor[f * 4 + 3] = (BM_elem_flag_test(efa, BM_ELEM_SELECT) ?
+                            ((efa == mr->efa_act) ? NOR_AND_FLAG_ACTIVE : NOR_AND_FLAG_SELECT) :
+                            NOR_AND_FLAG_DEFAULT);
     }
   }
+  EXTRACT_POLY_FOREACH_MESH_END;
 }
 
 static const MeshExtract extract_fdots_nor_hq = {
     .init = extract_fdots_nor_hq_init,
-    .finish = extract_fdots_nor_hq_finish,
+    .iter_poly_bm = extract_fdots_nor_hq_iter_poly_bm,
+    .iter_poly_mesh = extract_fdots_nor_hq_iter_poly_mesh,
     .data_flag = MR_DATA_POLY_NOR,
-    .use_threading = false,
+    .use_threading = true,
 };
 
 /** \} */
@@ -5854,6 +6049,11 @@ static void extract_task_create(struct TaskGraph *task_graph,
       extract = &extract_fdots_nor_hq;
     }
   }
+  /* Counting the loops of each edge to detect non-manifold ones depends on the iteration order,
+   * it is only needed when there is no edit-mesh to query. */
+  if (extract == &extract_edge_fac && mr->extract_type != MR_EXTRACT_MESH) {
+    extract = &extract_edge_fac_threaded;
+  }
 
   /* Divide extraction of the VBO/IBO into sensible chunks of works. */
   ExtractTaskData *taskdata = extract_task_data_create_mesh_extract(
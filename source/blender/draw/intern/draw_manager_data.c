@@ -1036,12 +1036,15 @@ static void drw_sculpt_generate_calls(DRWSculptCallbackData *scd)
   Mesh *mesh = scd->ob->data;
   BKE_pbvh_update_normals(pbvh, mesh->runtime.subdiv_ccg);
 
-  BKE_pbvh_draw_cb(pbvh,
-                   update_only_visible,
-                   &update_frustum,
-                   &draw_frustum,
-                   (void (*)(void *, GPU_PBVH_Buffers *))sculpt_draw_cb,
-                   scd);
+  /* Freed draw buffers of nodes coming back into view are built again over multiple redraws. */
+  if (BKE_pbvh_draw_cb(pbvh,
+                       update_only_visible,
+                       &update_frustum,
+                       &draw_frustum,
+                       (void (*)(void *, GPU_PBVH_Buffers *))sculpt_draw_cb,
+                       scd)) {
+    DRW_viewport_request_redraw();
+  }
 
   if (SCULPT_DEBUG_BUFFERS) {
     int debug_node_nr = 0;
@@ -0,0 +1,135 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "GPU_batch.h"
+#include "gpu_testing.hh"
+
+#include "PIL_time.h"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+extern "C" {
+#include "intern/draw_cache_extract.h"
+}
+
+#define DO_PERF_TESTS 0
+
+#if DO_PERF_TESTS
+
+namespace blender::draw {
+
+/* Time every extractor on its own over a grid of 10M quads. */
+
+#define GRID_SIZE 3163
+#define NUM_RUN_AVERAGED 3
+
+/* Grid with a bit of relief and alternating flat and smooth faces. */
+static Mesh *grid_mesh_mixed_smooth_create(const int size)
+{
+  Mesh *mesh = bke::tests::grid_mesh_create(size, true);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    mesh->mpoly[i].flag = (i % 2) ? ME_SMOOTH : 0;
+  }
+  return mesh;
+}
+
+typedef void (*MeshBufferRequestFn)(MeshBufferCache *mbc);
+
+static void extract_test_do(const char *id, Mesh *mesh, MeshBufferRequestFn request_fn)
+{
+  const float obmat[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+  const DRW_MeshCDMask cd_layer_used = {};
+
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    MeshBatchCache cache = {};
+    cache.mat_len = mesh_render_mat_len_get(mesh);
+    MeshBufferCache mbc = {};
+    request_fn(&mbc);
+
+    struct TaskGraph *task_graph = BLI_task_graph_create();
+    const double init_time = PIL_check_seconds_timer();
+    mesh_buffer_cache_create_requested(task_graph,
+                                       &cache,
+                                       mbc,
+                                       mesh,
+                                       false,
+                                       false,
+                                       false,
+                                       obmat,
+                                       true,
+                                       false,
+                                       false,
+                                       &cd_layer_used,
+                                       nullptr,
+                                       nullptr,
+                                       false);
+    BLI_task_graph_work_and_wait(task_graph);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+    BLI_task_graph_free(task_graph);
+
+    GPUVertBuf **vbos = (GPUVertBuf **)&mbc.vbo;
+    GPUIndexBuf **ibos = (GPUIndexBuf **)&mbc.ibo;
+    for (int j = 0; j < (int)(sizeof(mbc.vbo) / sizeof(void *)); j++) {
+      GPU_VERTBUF_DISCARD_SAFE(vbos[j]);
+    }
+    for (int j = 0; j < (int)(sizeof(mbc.ibo) / sizeof(void *)); j++) {
+      GPU_INDEXBUF_DISCARD_SAFE(ibos[j]);
+    }
+  }
+
+  printf("\t%s: done in %fs on average over %d runs\n",
+         id,
+         averaged_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+}
+
+#define EXTRACT_VBO_TEST(mesh, name) \
+  extract_test_do(#name, mesh, [](MeshBufferCache *mbc) { mbc->vbo.name = GPU_vertbuf_calloc(); })
+#define EXTRACT_IBO_TEST(mesh, name) \
+  extract_test_do(#name, mesh, [](MeshBufferCache *mbc) { mbc->ibo.name = GPU_indexbuf_calloc(); })
+
+class DrawExtractMeshPerformanceTest : public blender::gpu::GPUTest {
+};
+
+TEST_F(DrawExtractMeshPerformanceTest, Grid10MFaces)
+{
+  Mesh *mesh = grid_mesh_mixed_smooth_create(GRID_SIZE);
+
+  printf("\n========== STARTING %d faces ==========\n", mesh->totpoly);
+
+  EXTRACT_VBO_TEST(mesh, pos_nor);
+  EXTRACT_VBO_TEST(mesh, lnor);
+  EXTRACT_VBO_TEST(mesh, edge_fac);
+  EXTRACT_VBO_TEST(mesh, weights);
+  EXTRACT_VBO_TEST(mesh, fdots_pos);
+  EXTRACT_VBO_TEST(mesh, poly_idx);
+  EXTRACT_VBO_TEST(mesh, edge_idx);
+  EXTRACT_VBO_TEST(mesh, vert_idx);
+  EXTRACT_IBO_TEST(mesh, tris);
+  EXTRACT_IBO_TEST(mesh, lines);
+  EXTRACT_IBO_TEST(mesh, points);
+  EXTRACT_IBO_TEST(mesh, lines_paint_mask);
+  EXTRACT_IBO_TEST(mesh, lines_adjacency);
+
+  printf("========== ENDED %d faces ==========\n\n", mesh->totpoly);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::draw
+
+#endif
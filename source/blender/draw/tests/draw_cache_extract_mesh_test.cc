@@ -0,0 +1,117 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_vector.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "GPU_batch.h"
+#include "gpu_testing.hh"
+
+#include "tests/BKE_mesh_test_utils.hh"
+
+extern "C" {
+#include "intern/draw_cache_extract.h"
+}
+
+namespace blender::draw::tests {
+
+/* Large enough for the extraction to be split into multiple tasks. */
+#define GRID_SIZE 200
+
+static Vector<uint32_t> extract_lines(Mesh *mesh, const bool use_hide, const int num_threads)
+{
+  BLI_system_num_threads_override_set(num_threads);
+  BLI_task_scheduler_init();
+
+  const float obmat[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+  const DRW_MeshCDMask cd_layer_used = {};
+  Scene scene = {};
+
+  MeshBatchCache cache = {};
+  cache.mat_len = mesh_render_mat_len_get(mesh);
+  MeshBufferCache mbc = {};
+  mbc.ibo.lines = GPU_indexbuf_calloc();
+
+  struct TaskGraph *task_graph = BLI_task_graph_create();
+  mesh_buffer_cache_create_requested(task_graph,
+                                     &cache,
+                                     mbc,
+                                     mesh,
+                                     false,
+                                     false,
+                                     false,
+                                     obmat,
+                                     true,
+                                     false,
+                                     false,
+                                     &cd_layer_used,
+                                     &scene,
+                                     nullptr,
+                                     use_hide);
+  BLI_task_graph_work_and_wait(task_graph);
+  BLI_task_graph_free(task_graph);
+
+  Vector<uint32_t> indices(mesh->totedge * 2);
+  GPU_indexbuf_read(mbc.ibo.lines, indices.data());
+  GPU_INDEXBUF_DISCARD_SAFE(mbc.ibo.lines);
+
+  BLI_task_scheduler_exit();
+  BLI_system_num_threads_override_set(0);
+  return indices;
+}
+
+class DrawExtractMeshTest : public blender::gpu::GPUTest {
+};
+
+TEST_F(DrawExtractMeshTest, LinesThreadedMatchesSingleThreaded)
+{
+  Mesh *mesh = bke::tests::grid_mesh_create(GRID_SIZE);
+
+  const Vector<uint32_t> indices_single = extract_lines(mesh, false, 1);
+  const Vector<uint32_t> indices_threaded = extract_lines(mesh, false, 0);
+  EXPECT_EQ_ARRAY(indices_single.data(), indices_threaded.data(), indices_single.size());
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(DrawExtractMeshTest, LinesHiddenThreadedMatchesSingleThreaded)
+{
+  Mesh *mesh = bke::tests::grid_mesh_create(GRID_SIZE);
+  for (int i = 0; i < mesh->totedge; i += 3) {
+    mesh->medge[i].flag |= ME_HIDE;
+  }
+
+  const Vector<uint32_t> indices_single = extract_lines(mesh, true, 1);
+  const Vector<uint32_t> indices_threaded = extract_lines(mesh, true, 0);
+  EXPECT_EQ_ARRAY(indices_single.data(), indices_threaded.data(), indices_single.size());
+
+  /* Every edge is written exactly once, from the loop owning it. */
+  for (int i = 0; i < mesh->totedge; i++) {
+    const MEdge *med = &mesh->medge[i];
+    const uint32_t l1 = indices_threaded[i * 2];
+    const uint32_t l2 = indices_threaded[i * 2 + 1];
+    if (med->flag & ME_HIDE) {
+      EXPECT_EQ(l1, 0xFFFFFFFF);
+      EXPECT_EQ(l2, 0xFFFFFFFF);
+      continue;
+    }
+    const uint v1 = mesh->mloop[l1].v;
+    const uint v2 = mesh->mloop[l2].v;
+    EXPECT_TRUE((v1 == med->v1 && v2 == med->v2) || (v1 == med->v2 && v2 == med->v1));
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::draw::tests
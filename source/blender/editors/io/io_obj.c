@@ -0,0 +1,303 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup editor/io
+ */
+
+#include "DNA_object_types.h"
+#include "DNA_space_types.h"
+
+#include "BKE_context.h"
+#include "BKE_report.h"
+
+#include "BLI_path_util.h"
+#include "BLI_utildefines.h"
+
+#include "BLT_translation.h"
+
+#include "RNA_access.h"
+#include "RNA_define.h"
+
+#include "UI_interface.h"
+#include "UI_resources.h"
+
+#include "WM_api.h"
+#include "WM_types.h"
+
+#include "DEG_depsgraph.h"
+
+#include "IO_wavefront_obj.h"
+#include "io_obj.h"
+#include "io_utils.h"
+
+static const EnumPropertyItem io_obj_export_evaluation_mode[] = {
+    {DAG_EVAL_RENDER, "DAG_EVAL_RENDER", 0, "Render", "Export objects as they appear in render"},
+    {DAG_EVAL_VIEWPORT,
+     "DAG_EVAL_VIEWPORT",
+     0,
+     "Viewport",
+     "Export objects as they appear in the viewport"},
+    {0, NULL, 0, NULL, NULL},
+};
+
+static void io_obj_scale_def(wmOperatorType *ot)
+{
+  RNA_def_float(ot->srna,
+                "scaling_factor",
+                1.0f,
+                0.001f,
+                10000.0f,
+                "Scale",
+                "Scale all data",
+                0.01f,
+                1000.0f);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Export
+ * \{ */
+
+static int wm_obj_export_invoke(bContext *C, wmOperator *op, const wmEvent *UNUSED(event))
+{
+  io_ui_export_filepath_default_set(C, op, ".obj");
+  WM_event_add_fileselect(C, op);
+
+  return OPERATOR_RUNNING_MODAL;
+}
+
+static int wm_obj_export_exec(bContext *C, wmOperator *op)
+{
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    BKE_report(op->reports, RPT_ERROR, "No filename given");
+    return OPERATOR_CANCELLED;
+  }
+
+  struct OBJExportParams params;
+  RNA_string_get(op->ptr, "filepath", params.filepath);
+  params.export_selected_objects = RNA_boolean_get(op->ptr, "export_selected_objects");
+  params.export_eval_mode = RNA_enum_get(op->ptr, "export_eval_mode");
+  params.forward_axis = RNA_enum_get(op->ptr, "forward_axis");
+  params.up_axis = RNA_enum_get(op->ptr, "up_axis");
+  params.scaling_factor = RNA_float_get(op->ptr, "scaling_factor");
+  params.export_uv = RNA_boolean_get(op->ptr, "export_uv");
+  params.export_normals = RNA_boolean_get(op->ptr, "export_normals");
+  params.export_materials = RNA_boolean_get(op->ptr, "export_materials");
+  params.export_smooth_groups = RNA_boolean_get(op->ptr, "export_smooth_groups");
+
+  WM_cursor_wait(true);
+  const bool ok = OBJ_export(C, &params);
+  WM_cursor_wait(false);
+
+  if (!ok) {
+    BKE_report(op->reports, RPT_ERROR, "Unable to write OBJ file");
+    return OPERATOR_CANCELLED;
+  }
+  return OPERATOR_FINISHED;
+}
+
+static bool wm_obj_export_check(bContext *UNUSED(C), wmOperator *op)
+{
+  const bool axes_changed = io_ui_axes_check(op);
+  const bool filepath_changed = io_ui_filepath_extension_ensure(op, ".obj");
+  return axes_changed || filepath_changed;
+}
+
+static void wm_obj_export_draw(bContext *UNUSED(C), wmOperator *op)
+{
+  uiLayout *layout = op->layout;
+  PointerRNA *ptr = op->ptr;
+  uiLayout *box, *col;
+
+  uiLayoutSetPropSep(layout, true);
+  uiLayoutSetPropDecorate(layout, false);
+
+  box = uiLayoutBox(layout);
+  col = uiLayoutColumn(box, false);
+  uiItemR(col, ptr, "export_selected_objects", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_eval_mode", 0, NULL, ICON_NONE);
+
+  box = uiLayoutBox(layout);
+  col = uiLayoutColumn(box, false);
+  uiItemR(col, ptr, "forward_axis", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "up_axis", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "scaling_factor", 0, NULL, ICON_NONE);
+
+  box = uiLayoutBox(layout);
+  col = uiLayoutColumn(box, true);
+  uiItemR(col, ptr, "export_uv", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_normals", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_materials", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_smooth_groups", 0, NULL, ICON_NONE);
+}
+
+void WM_OT_obj_export(struct wmOperatorType *ot)
+{
+  ot->name = "Export Wavefront OBJ";
+  ot->description = "Save the scene to a Wavefront OBJ file";
+  ot->idname = "WM_OT_obj_export";
+
+  ot->invoke = wm_obj_export_invoke;
+  ot->exec = wm_obj_export_exec;
+  ot->poll = WM_operator_winactive;
+  ot->ui = wm_obj_export_draw;
+  ot->check = wm_obj_export_check;
+
+  WM_operator_properties_filesel(ot,
+                                 FILE_TYPE_FOLDER | FILE_TYPE_OBJECT_IO,
+                                 FILE_BLENDER,
+                                 FILE_SAVE,
+                                 WM_FILESEL_FILEPATH | WM_FILESEL_SHOW_PROPS,
+                                 FILE_DEFAULTDISPLAY,
+                                 FILE_SORT_DEFAULT);
+
+  RNA_def_boolean(ot->srna,
+                  "export_selected_objects",
+                  false,
+                  "Selection Only",
+                  "Only export selected objects");
+  RNA_def_enum(ot->srna,
+               "export_eval_mode",
+               io_obj_export_evaluation_mode,
+               DAG_EVAL_VIEWPORT,
+               "Object Properties",
+               "Use modifier and visibility settings of the render or of the viewport");
+  io_ui_axes_properties_def(ot, OB_NEGZ, OB_POSY);
+  io_obj_scale_def(ot);
+  RNA_def_boolean(ot->srna, "export_uv", true, "Export UVs", "");
+  RNA_def_boolean(ot->srna,
+                  "export_normals",
+                  true,
+                  "Export Normals",
+                  "Export per-face normals if the face is flat-shaded, per-face-per-loop "
+                  "normals if smooth-shaded");
+  RNA_def_boolean(ot->srna,
+                  "export_materials",
+                  true,
+                  "Export Materials",
+                  "Write the material names of the faces with 'usemtl' statements");
+  RNA_def_boolean(ot->srna,
+                  "export_smooth_groups",
+                  false,
+                  "Export Smooth Groups",
+                  "Write 's' statements for smooth and flat shaded faces");
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Import
+ * \{ */
+
+static int wm_obj_import_invoke(bContext *C, wmOperator *op, const wmEvent *UNUSED(event))
+{
+  WM_event_add_fileselect(C, op);
+
+  return OPERATOR_RUNNING_MODAL;
+}
+
+static int wm_obj_import_exec(bContext *C, wmOperator *op)
+{
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    BKE_report(op->reports, RPT_ERROR, "No filename given");
+    return OPERATOR_CANCELLED;
+  }
+
+  struct OBJImportParams params;
+  RNA_string_get(op->ptr, "filepath", params.filepath);
+  params.forward_axis = RNA_enum_get(op->ptr, "forward_axis");
+  params.up_axis = RNA_enum_get(op->ptr, "up_axis");
+  params.scaling_factor = RNA_float_get(op->ptr, "scaling_factor");
+  params.use_split_groups = RNA_boolean_get(op->ptr, "use_split_groups");
+  params.validate_meshes = RNA_boolean_get(op->ptr, "validate_meshes");
+
+  WM_cursor_wait(true);
+  const bool ok = OBJ_import(C, &params);
+  WM_cursor_wait(false);
+
+  if (!ok) {
+    BKE_report(op->reports, RPT_ERROR, "Unable to read OBJ file");
+    return OPERATOR_CANCELLED;
+  }
+
+  WM_event_add_notifier(C, NC_SCENE | ND_OB_ACTIVE, CTX_data_scene(C));
+  return OPERATOR_FINISHED;
+}
+
+static bool wm_obj_import_check(bContext *UNUSED(C), wmOperator *op)
+{
+  return io_ui_axes_check(op);
+}
+
+static void wm_obj_import_draw(bContext *UNUSED(C), wmOperator *op)
+{
+  uiLayout *layout = op->layout;
+  PointerRNA *ptr = op->ptr;
+
+  uiLayoutSetPropSep(layout, true);
+  uiLayoutSetPropDecorate(layout, false);
+
+  uiLayout *box = uiLayoutBox(layout);
+  uiLayout *col = uiLayoutColumn(box, false);
+  uiItemR(col, ptr, "forward_axis", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "up_axis", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "scaling_factor", 0, NULL, ICON_NONE);
+
+  box = uiLayoutBox(layout);
+  col = uiLayoutColumn(box, true);
+  uiItemR(col, ptr, "use_split_groups", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "validate_meshes", 0, NULL, ICON_NONE);
+}
+
+void WM_OT_obj_import(struct wmOperatorType *ot)
+{
+  ot->name = "Import Wavefront OBJ";
+  ot->description = "Load a Wavefront OBJ file";
+  ot->idname = "WM_OT_obj_import";
+
+  ot->invoke = wm_obj_import_invoke;
+  ot->exec = wm_obj_import_exec;
+  ot->poll = WM_operator_winactive;
+  ot->ui = wm_obj_import_draw;
+  ot->check = wm_obj_import_check;
+
+  WM_operator_properties_filesel(ot,
+                                 FILE_TYPE_FOLDER | FILE_TYPE_OBJECT_IO,
+                                 FILE_BLENDER,
+                                 FILE_OPENFILE,
+                                 WM_FILESEL_FILEPATH | WM_FILESEL_SHOW_PROPS,
+                                 FILE_DEFAULTDISPLAY,
+                                 FILE_SORT_DEFAULT);
+
+  io_ui_axes_properties_def(ot, OB_NEGZ, OB_POSY);
+  io_obj_scale_def(ot);
+  RNA_def_boolean(ot->srna,
+                  "use_split_groups",
+                  false,
+                  "Split by Group",
+                  "Create a new object for every group ('g' statement) as well as for every "
+                  "object ('o' statement)");
+  RNA_def_boolean(ot->srna,
+                  "validate_meshes",
+                  false,
+                  "Validate Meshes",
+                  "Check the imported meshes for corrupt data and fix it, slower for large files");
+}
+
+/** \} */
@@ -39,6 +39,9 @@
 
 #include "io_cache.h"
 #include "io_gpencil.h"
+#include "io_obj.h"
+#include "io_ply.h"
+#include "io_stl.h"
 
 void ED_operatortypes_io(void)
 {
@@ -53,6 +56,7 @@ void ED_operatortypes_io(void)
 #endif
 #ifdef WITH_USD
   WM_operatortype_append(WM_OT_usd_export);
+  WM_operatortype_append(WM_OT_usd_import);
 #endif
 
   WM_operatortype_append(WM_OT_gpencil_import_svg);
@@ -65,6 +69,13 @@ void ED_operatortypes_io(void)
   WM_operatortype_append(WM_OT_gpencil_export_pdf);
 #endif
 
+  WM_operatortype_append(WM_OT_obj_export);
+  WM_operatortype_append(WM_OT_obj_import);
+  WM_operatortype_append(WM_OT_ply_export);
+  WM_operatortype_append(WM_OT_ply_import);
+  WM_operatortype_append(WM_OT_stl_export);
+  WM_operatortype_append(WM_OT_stl_import);
+
   WM_operatortype_append(CACHEFILE_OT_open);
   WM_operatortype_append(CACHEFILE_OT_reload);
 }
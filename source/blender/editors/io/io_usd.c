@@ -47,6 +47,10 @@
 
 #  include "DEG_depsgraph.h"
 
+#  include "DNA_object_types.h"
+
+#  include "ED_object.h"
+
 #  include "io_usd.h"
 #  include "usd.h"
 
@@ -120,6 +124,7 @@ static int wm_usd_export_exec(bContext *C, wmOperator *op)
   const bool export_normals = RNA_boolean_get(op->ptr, "export_normals");
   const bool export_materials = RNA_boolean_get(op->ptr, "export_materials");
   const bool use_instancing = RNA_boolean_get(op->ptr, "use_instancing");
+  const bool deduplicate_meshes = RNA_boolean_get(op->ptr, "deduplicate_meshes");
   const bool evaluation_mode = RNA_enum_get(op->ptr, "evaluation_mode");
 
   struct USDExportParams params = {
@@ -131,6 +136,7 @@ static int wm_usd_export_exec(bContext *C, wmOperator *op)
       selected_objects_only,
       visible_objects_only,
       use_instancing,
+      deduplicate_meshes,
       evaluation_mode,
   };
 
@@ -166,6 +172,7 @@ static void wm_usd_export_draw(bContext *UNUSED(C), wmOperator *op)
   box = uiLayoutBox(layout);
   uiItemL(box, IFACE_("Experimental"), ICON_NONE);
   uiItemR(box, ptr, "use_instancing", 0, NULL, ICON_NONE);
+  uiItemR(box, ptr, "deduplicate_meshes", 0, NULL, ICON_NONE);
 }
 
 void WM_OT_usd_export(struct wmOperatorType *ot)
@@ -233,6 +240,13 @@ void WM_OT_usd_export(struct wmOperatorType *ot)
                   "When checked, instanced objects are exported as references in USD. "
                   "When unchecked, instanced objects are exported as real objects");
 
+  RNA_def_boolean(ot->srna,
+                  "deduplicate_meshes",
+                  false,
+                  "Deduplicate Meshes",
+                  "When checked, static meshes with the same data and materials are written once, "
+                  "and referenced by the other objects using them");
+
   RNA_def_enum(ot->srna,
                "evaluation_mode",
                rna_enum_usd_export_evaluation_mode_items,
@@ -242,4 +256,127 @@ void WM_OT_usd_export(struct wmOperatorType *ot)
                "are different settings for viewport and rendering");
 }
 
+static int wm_usd_import_invoke(bContext *C, wmOperator *op, const wmEvent *event)
+{
+  eUSDOperatorOptions *options = MEM_callocN(sizeof(eUSDOperatorOptions), "eUSDOperatorOptions");
+  options->as_background_job = true;
+  op->customdata = options;
+
+  return WM_operator_filesel(C, op, event);
+}
+
+static int wm_usd_import_exec(bContext *C, wmOperator *op)
+{
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    BKE_report(op->reports, RPT_ERROR, "No filename given");
+    return OPERATOR_CANCELLED;
+  }
+
+  char filename[FILE_MAX];
+  RNA_string_get(op->ptr, "filepath", filename);
+
+  eUSDOperatorOptions *options = (eUSDOperatorOptions *)op->customdata;
+  const bool as_background_job = (options != NULL && options->as_background_job);
+  MEM_SAFE_FREE(op->customdata);
+
+  const float scale = RNA_float_get(op->ptr, "scale");
+  const bool use_instancing = RNA_boolean_get(op->ptr, "use_instancing");
+  const bool import_uvmaps = RNA_boolean_get(op->ptr, "import_uvmaps");
+  const bool import_normals = RNA_boolean_get(op->ptr, "import_normals");
+  const bool validate_meshes = RNA_boolean_get(op->ptr, "validate_meshes");
+
+  struct USDImportParams params = {
+      scale,
+      use_instancing,
+      import_uvmaps,
+      import_normals,
+      validate_meshes,
+  };
+
+  /* Switch out of edit mode to avoid being stuck in it (T54326). */
+  Object *obedit = CTX_data_edit_object(C);
+  if (obedit) {
+    ED_object_mode_set(C, OB_MODE_OBJECT);
+  }
+
+  bool ok = USD_import(C, filename, &params, as_background_job);
+
+  return as_background_job || ok ? OPERATOR_FINISHED : OPERATOR_CANCELLED;
+}
+
+static void wm_usd_import_draw(bContext *UNUSED(C), wmOperator *op)
+{
+  uiLayout *layout = op->layout;
+  uiLayout *col;
+  struct PointerRNA *ptr = op->ptr;
+
+  uiLayoutSetPropSep(layout, true);
+
+  uiLayout *box = uiLayoutBox(layout);
+
+  col = uiLayoutColumn(box, true);
+  uiItemR(col, ptr, "scale", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "use_instancing", 0, NULL, ICON_NONE);
+
+  col = uiLayoutColumn(box, true);
+  uiItemR(col, ptr, "import_uvmaps", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "import_normals", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "validate_meshes", 0, NULL, ICON_NONE);
+}
+
+void WM_OT_usd_import(struct wmOperatorType *ot)
+{
+  ot->name = "Import USD";
+  ot->description = "Load a USD file, keeping instanced prims as collection instances";
+  ot->idname = "WM_OT_usd_import";
+  ot->flag = OPTYPE_REGISTER | OPTYPE_UNDO;
+
+  ot->invoke = wm_usd_import_invoke;
+  ot->exec = wm_usd_import_exec;
+  ot->poll = WM_operator_winactive;
+  ot->ui = wm_usd_import_draw;
+
+  WM_operator_properties_filesel(ot,
+                                 FILE_TYPE_FOLDER | FILE_TYPE_USD,
+                                 FILE_BLENDER,
+                                 FILE_OPENFILE,
+                                 WM_FILESEL_FILEPATH | WM_FILESEL_SHOW_PROPS,
+                                 FILE_DEFAULTDISPLAY,
+                                 FILE_SORT_DEFAULT);
+
+  RNA_def_float(
+      ot->srna,
+      "scale",
+      1.0f,
+      0.0001f,
+      1000.0f,
+      "Scale",
+      "Value by which to enlarge or shrink the objects with respect to the world's origin",
+      0.0001f,
+      1000.0f);
+
+  RNA_def_boolean(ot->srna,
+                  "use_instancing",
+                  true,
+                  "Instancing",
+                  "When checked, instanceable prims are imported as instances of a collection "
+                  "holding their prototype. When unchecked, every instance gets its own copy of "
+                  "the prototype. Point instancers always import as collection instances");
+  RNA_def_boolean(ot->srna,
+                  "import_uvmaps",
+                  true,
+                  "UV Maps",
+                  "When checked, texture coordinate primvars are imported as UV maps");
+  RNA_def_boolean(ot->srna,
+                  "import_normals",
+                  true,
+                  "Normals",
+                  "When checked, authored mesh normals are imported as custom normals");
+  RNA_def_boolean(ot->srna,
+                  "validate_meshes",
+                  false,
+                  "Validate Meshes",
+                  "Check imported mesh objects for invalid data (slow)");
+}
+
 #endif /* WITH_USD */
@@ -0,0 +1,99 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup editor/io
+ */
+
+#include "DNA_object_types.h"
+
+#include "BKE_context.h"
+#include "BKE_main.h"
+
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "RNA_access.h"
+#include "RNA_define.h"
+#include "RNA_enum_types.h"
+
+#include "WM_api.h"
+#include "WM_types.h"
+
+#include "io_utils.h"
+
+void io_ui_axes_properties_def(wmOperatorType *ot, const int default_forward, const int default_up)
+{
+  RNA_def_enum(ot->srna,
+               "forward_axis",
+               rna_enum_object_axis_items,
+               default_forward,
+               "Forward Axis",
+               "Axis of the file that points forward in Blender");
+  RNA_def_enum(ot->srna,
+               "up_axis",
+               rna_enum_object_axis_items,
+               default_up,
+               "Up Axis",
+               "Axis of the file that points up in Blender");
+}
+
+bool io_ui_axes_check(wmOperator *op)
+{
+  const int forward = RNA_enum_get(op->ptr, "forward_axis");
+  const int up = RNA_enum_get(op->ptr, "up_axis");
+  if (forward % 3 == up % 3) {
+    RNA_enum_set(op->ptr, "up_axis", (up + 1) % 6);
+    return true;
+  }
+  return false;
+}
+
+void io_ui_export_filepath_default_set(bContext *C, wmOperator *op, const char *extension)
+{
+  if (RNA_struct_property_is_set(op->ptr, "filepath")) {
+    return;
+  }
+  Main *bmain = CTX_data_main(C);
+  char filepath[FILE_MAX];
+  const char *main_blendfile_path = BKE_main_blendfile_path(bmain);
+
+  if (main_blendfile_path[0] == '\0') {
+    BLI_strncpy(filepath, "untitled", sizeof(filepath));
+  }
+  else {
+    BLI_strncpy(filepath, main_blendfile_path, sizeof(filepath));
+  }
+
+  BLI_path_extension_replace(filepath, sizeof(filepath), extension);
+  RNA_string_set(op->ptr, "filepath", filepath);
+}
+
+bool io_ui_filepath_extension_ensure(wmOperator *op, const char *extension)
+{
+  char filepath[FILE_MAX];
+  RNA_string_get(op->ptr, "filepath", filepath);
+  if (BLI_path_extension_check(filepath, extension)) {
+    return false;
+  }
+  BLI_path_extension_ensure(filepath, FILE_MAX, extension);
+  RNA_string_set(op->ptr, "filepath", filepath);
+  return true;
+}
@@ -0,0 +1,43 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup editor/io
+ */
+
+struct bContext;
+struct wmOperator;
+struct wmOperatorType;
+
+/** Forward and up axis properties, for importers and exporters that convert axes. */
+void io_ui_axes_properties_def(struct wmOperatorType *ot, int default_forward, int default_up);
+/**
+ * Forward and up can't use the same axis, change the up axis like the Python add-ons do.
+ * \return True when the up axis changed.
+ */
+bool io_ui_axes_check(struct wmOperator *op);
+
+/** Set the path of the blend file with the extension as default, before invoking exporters. */
+void io_ui_export_filepath_default_set(struct bContext *C,
+                                       struct wmOperator *op,
+                                       const char *extension);
+/** \return True when the extension was added to the file path. */
+bool io_ui_filepath_extension_ensure(struct wmOperator *op, const char *extension);
@@ -81,6 +81,9 @@ void GPU_indexbuf_discard(GPUIndexBuf *elem);
 
 bool GPU_indexbuf_is_init(GPUIndexBuf *elem);
 
+/* Read back indices which are not yet uploaded to the GPU, as 32 bit values. For testing. */
+void GPU_indexbuf_read(GPUIndexBuf *elem, uint32_t *r_data);
+
 int GPU_indexbuf_primitive_len(GPUPrimType prim_type);
 
 /* Macros */
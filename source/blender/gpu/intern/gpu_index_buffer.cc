@@ -31,6 +31,8 @@
 
 #include "gpu_index_buffer_private.hh"
 
+#include <cstring>
+
 #define KEEP_SINGLE_COPY 1
 
 #define RESTART_INDEX 0xFFFFFFFF
@@ -256,6 +258,23 @@ void IndexBuf::init_subrange(IndexBuf *elem_src, uint start, uint length)
   index_type_ = elem_src->index_type_;
 }
 
+/**
+ * Copy the indices to \a r_data, expanded to 32 bit. Only possible as long as the data was not
+ * sent to the GPU, used for testing.
+ */
+void IndexBuf::read(uint32_t *r_data) const
+{
+  BLI_assert(!is_subrange_ && data_ != nullptr);
+  if (index_type_ == GPU_INDEX_U32) {
+    memcpy(r_data, data_, sizeof(uint32_t) * index_len_);
+    return;
+  }
+  const uint16_t *ushort_idx = (const uint16_t *)data_;
+  for (uint i = 0; i < index_len_; i++) {
+    r_data[i] = (ushort_idx[i] == 0xFFFF) ? RESTART_INDEX : ushort_idx[i] + index_base_;
+  }
+}
+
 uint IndexBuf::index_range(uint *r_min, uint *r_max)
 {
   if (index_len_ == 0) {
@@ -361,6 +380,11 @@ bool GPU_indexbuf_is_init(GPUIndexBuf *elem)
   return unwrap(elem)->is_init();
 }
 
+void GPU_indexbuf_read(GPUIndexBuf *elem, uint32_t *r_data)
+{
+  unwrap(elem)->read(r_data);
+}
+
 int GPU_indexbuf_primitive_len(GPUPrimType prim_type)
 {
   return indices_per_primitive(prim_type);
@@ -46,6 +46,7 @@
 #include "BLI_math.h"
 #include "BLI_math_color.h"
 #include "BLI_rect.h"
+#include "BLI_simd.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 
@@ -103,6 +104,8 @@ static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 typedef struct ColormanageProcessor {
   OCIO_ConstCPUProcessorRcPtr *cpu_processor;
   CurveMapping *curve_mapping;
+  /* Baked approximation of cpu_processor, only used for byte display buffers. */
+  struct ColormanageDisplayLUT *display_lut;
   bool is_data_result;
 } ColormanageProcessor;
 
@@ -124,6 +127,8 @@ static struct global_color_picking_state {
   bool failed;
 } global_color_picking_state = {NULL};
 
+static void display_lut_free_all(void);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -729,6 +734,8 @@ void colormanagement_exit(void)
     OCIO_cpuProcessorRelease(global_color_picking_state.cpu_processor_from);
   }
 
+  display_lut_free_all();
+
   memset(&global_gpu_state, 0, sizeof(global_gpu_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
@@ -1416,6 +1423,381 @@ const float *IMB_colormangement_get_xyz_to_rgb()
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Display Transform LUT
+ *
+ * Baked approximation of a display transform, used when converting large float buffers to byte
+ * display buffers. Scene linear values go through a logarithmic shaper into a 3D LUT which is
+ * sampled from the OCIO CPU processor. Baked LUTs are cached per transform and only used when
+ * they match the OCIO processor within #DISPLAY_LUT_TOLERANCE; pixels outside of the shaper
+ * range are still transformed by OCIO.
+ * \{ */
+
+#define DISPLAY_LUT_MIN_SIZE 33
+#define DISPLAY_LUT_MAX_SIZE 65
+#define DISPLAY_LUT_CACHE_LIMIT 8
+#define DISPLAY_LUT_KEY_LEN (4 * MAX_COLORSPACE_NAME + 64)
+
+/* Number of processor evaluations to bake a LUT, the lattice and the center of every cell. Buffers
+ * with fewer pixels are faster to transform with the processor than to bake for. */
+#define DISPLAY_LUT_BAKE_SAMPLES_NUM(size) \
+  ((size_t)(size) * (size) * (size) + (size_t)((size)-1) * ((size)-1) * ((size)-1))
+
+/* Shaper domain, the shaper is roughly linear below epsilon and logarithmic above it. It covers
+ * 24 stops and puts scene linear 1.0 exactly on a lattice point for both LUT sizes, so display
+ * transforms clipping at 1.0 do not have their discontinuity inside of a cell. */
+#define DISPLAY_LUT_SHAPER_MAX (16777215.0f / 262143.0f)
+#define DISPLAY_LUT_SHAPER_EPSILON (1.0f / 262143.0f)
+
+/* Maximum allowed difference from OCIO, half of an 8 bit display step. */
+#define DISPLAY_LUT_TOLERANCE (0.5f / 255.0f)
+
+typedef struct ColormanageDisplayLUT {
+  struct ColormanageDisplayLUT *next, *prev;
+
+  char key[DISPLAY_LUT_KEY_LEN];
+
+  /* Owned by the cache and by every processor using the LUT, protected by processor_lock. */
+  int users;
+
+  /* False when baking did not reach the required accuracy, the entry is then only kept to
+   * avoid baking the same transform again. */
+  bool is_valid;
+
+  int size;
+  float shaper_norm;
+  /* size^3 RGBA entries with unused alpha, red changes fastest. */
+  float *table;
+} ColormanageDisplayLUT;
+
+static ListBase global_display_luts = {NULL, NULL};
+
+BLI_INLINE float display_lut_shaper(const float value, const float shaper_norm)
+{
+  return log2f(1.0f + value * (1.0f / DISPLAY_LUT_SHAPER_EPSILON)) * shaper_norm;
+}
+
+BLI_INLINE float display_lut_shaper_inverse(const float value, const float shaper_norm)
+{
+  return (exp2f(value / shaper_norm) - 1.0f) * DISPLAY_LUT_SHAPER_EPSILON;
+}
+
+BLI_INLINE bool display_lut_in_domain(const float rgb[3])
+{
+  /* Written so NaN values fail the test. */
+  return (rgb[0] >= 0.0f && rgb[0] <= DISPLAY_LUT_SHAPER_MAX) &&
+         (rgb[1] >= 0.0f && rgb[1] <= DISPLAY_LUT_SHAPER_MAX) &&
+         (rgb[2] >= 0.0f && rgb[2] <= DISPLAY_LUT_SHAPER_MAX);
+}
+
+/* Trilinear lookup, rgb is expected to be inside of the shaper domain. */
+BLI_INLINE void display_lut_sample(const ColormanageDisplayLUT *lut,
+                                   const float rgb[3],
+                                   float r_rgb[3])
+{
+  const int size = lut->size;
+  const float scale = (float)(size - 1);
+  int index[3];
+  float fac[3];
+
+  for (int i = 0; i < 3; i++) {
+    const float s = display_lut_shaper(rgb[i], lut->shaper_norm) * scale;
+    index[i] = min_ii((int)s, size - 2);
+    fac[i] = s - (float)index[i];
+  }
+
+  const size_t stride_y = 4 * (size_t)size;
+  const size_t stride_z = stride_y * (size_t)size;
+  const float *t = lut->table + stride_z * index[2] + stride_y * index[1] + 4 * (size_t)index[0];
+
+#ifdef BLI_HAVE_SSE2
+  const __m128 fx = _mm_set1_ps(fac[0]);
+  const __m128 fy = _mm_set1_ps(fac[1]);
+  const __m128 fz = _mm_set1_ps(fac[2]);
+
+  __m128 c00 = _mm_loadu_ps(t);
+  __m128 c10 = _mm_loadu_ps(t + stride_y);
+  __m128 c01 = _mm_loadu_ps(t + stride_z);
+  __m128 c11 = _mm_loadu_ps(t + stride_z + stride_y);
+
+  c00 = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(t + 4), c00), fx));
+  c10 = _mm_add_ps(c10, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(t + stride_y + 4), c10), fx));
+  c01 = _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(t + stride_z + 4), c01), fx));
+  c11 = _mm_add_ps(c11,
+                   _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(t + stride_z + stride_y + 4), c11), fx));
+
+  c00 = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c10, c00), fy));
+  c01 = _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(c11, c01), fy));
+
+  float result[4];
+  _mm_storeu_ps(result, _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c01, c00), fz)));
+  copy_v3_v3(r_rgb, result);
+#else
+  float c00[3], c10[3], c01[3], c11[3];
+
+  interp_v3_v3v3(c00, t, t + 4, fac[0]);
+  interp_v3_v3v3(c10, t + stride_y, t + stride_y + 4, fac[0]);
+  interp_v3_v3v3(c01, t + stride_z, t + stride_z + 4, fac[0]);
+  interp_v3_v3v3(c11, t + stride_z + stride_y, t + stride_z + stride_y + 4, fac[0]);
+
+  interp_v3_v3v3(c00, c00, c10, fac[1]);
+  interp_v3_v3v3(c01, c01, c11, fac[1]);
+
+  interp_v3_v3v3(r_rgb, c00, c01, fac[2]);
+#endif
+}
+
+static void display_lut_cpu_processor_apply(OCIO_ConstCPUProcessorRcPtr *cpu_processor,
+                                            float *buffer,
+                                            int width,
+                                            int height)
+{
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(buffer,
+                                                              width,
+                                                              height,
+                                                              4,
+                                                              sizeof(float),
+                                                              4 * sizeof(float),
+                                                              4 * sizeof(float) * width);
+  OCIO_cpuProcessorApply(cpu_processor, img);
+  OCIO_PackedImageDescRelease(img);
+}
+
+/* Sample the processor on the LUT lattice, then compare the LUT against the processor in the
+ * center of every cell, where trilinear interpolation is least accurate. */
+static bool display_lut_bake(ColormanageDisplayLUT *lut,
+                             OCIO_ConstCPUProcessorRcPtr *cpu_processor,
+                             int size)
+{
+  const int cells = size - 1;
+  const float scale = 1.0f / (float)cells;
+  float *table = MEM_mallocN(sizeof(float[4]) * size * size * size, "display transform LUT");
+  float *samples = MEM_mallocN(sizeof(float[4]) * cells * cells * cells,
+                               "display transform LUT samples");
+  float *fp;
+
+  lut->size = size;
+  lut->shaper_norm = 1.0f / log2f(1.0f + DISPLAY_LUT_SHAPER_MAX / DISPLAY_LUT_SHAPER_EPSILON);
+
+  fp = table;
+  for (int b = 0; b < size; b++) {
+    for (int g = 0; g < size; g++) {
+      for (int r = 0; r < size; r++, fp += 4) {
+        fp[0] = display_lut_shaper_inverse(r * scale, lut->shaper_norm);
+        fp[1] = display_lut_shaper_inverse(g * scale, lut->shaper_norm);
+        fp[2] = display_lut_shaper_inverse(b * scale, lut->shaper_norm);
+        fp[3] = 1.0f;
+      }
+    }
+  }
+
+  fp = samples;
+  for (int b = 0; b < cells; b++) {
+    for (int g = 0; g < cells; g++) {
+      for (int r = 0; r < cells; r++, fp += 4) {
+        fp[0] = display_lut_shaper_inverse((r + 0.5f) * scale, lut->shaper_norm);
+        fp[1] = display_lut_shaper_inverse((g + 0.5f) * scale, lut->shaper_norm);
+        fp[2] = display_lut_shaper_inverse((b + 0.5f) * scale, lut->shaper_norm);
+        fp[3] = 1.0f;
+      }
+    }
+  }
+
+  display_lut_cpu_processor_apply(cpu_processor, table, size * size, size);
+  lut->table = table;
+
+  float *reference = MEM_dupallocN(samples);
+  display_lut_cpu_processor_apply(cpu_processor, reference, cells * cells, cells);
+
+  bool is_valid = true;
+  const size_t tot_samples = (size_t)cells * cells * cells;
+  for (size_t i = 0; i < tot_samples && is_valid; i++) {
+    float rgb[3];
+    display_lut_sample(lut, samples + 4 * i, rgb);
+    for (int c = 0; c < 3; c++) {
+      /* The LUT is only used for byte display buffers, which are clamped to the display range. */
+      const float value = clamp_f(rgb[c], 0.0f, 1.0f);
+      const float expected = clamp_f(reference[4 * i + c], 0.0f, 1.0f);
+      if (!(fabsf(value - expected) <= DISPLAY_LUT_TOLERANCE)) {
+        is_valid = false;
+      }
+    }
+  }
+
+  MEM_freeN(samples);
+  MEM_freeN(reference);
+
+  if (!is_valid) {
+    MEM_freeN(lut->table);
+    lut->table = NULL;
+  }
+
+  return is_valid;
+}
+
+static void display_lut_free(ColormanageDisplayLUT *lut)
+{
+  MEM_SAFE_FREE(lut->table);
+  MEM_freeN(lut);
+}
+
+/* Must be called with processor_lock held. */
+static void display_lut_release_locked(ColormanageDisplayLUT *lut)
+{
+  BLI_assert(lut->users > 0);
+  lut->users--;
+  if (lut->users == 0) {
+    display_lut_free(lut);
+  }
+}
+
+/* Must be called with processor_lock held. Keep recently used transforms at the front, and add
+ * a user when the LUT can be used. */
+static void display_lut_use_locked(ColormanageDisplayLUT *lut)
+{
+  if (global_display_luts.first != lut) {
+    BLI_remlink(&global_display_luts, lut);
+    BLI_addhead(&global_display_luts, lut);
+  }
+  if (lut->is_valid) {
+    lut->users++;
+  }
+}
+
+static void display_lut_release(ColormanageDisplayLUT *lut)
+{
+  BLI_mutex_lock(&processor_lock);
+  display_lut_release_locked(lut);
+  BLI_mutex_unlock(&processor_lock);
+}
+
+/* Get LUT for the given display transform, baking it when it's not in the cache yet.
+ * Returns NULL when the transform can not be approximated accurately enough. */
+static ColormanageDisplayLUT *display_lut_acquire(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings,
+    OCIO_ConstCPUProcessorRcPtr *cpu_processor)
+{
+  char key[DISPLAY_LUT_KEY_LEN];
+  ColormanageDisplayLUT *lut;
+
+  BLI_snprintf(key,
+               sizeof(key),
+               "%s|%s|%s|%s|%.9g|%.9g",
+               view_settings->look,
+               view_settings->view_transform,
+               display_settings->display_device,
+               global_role_scene_linear,
+               view_settings->exposure,
+               view_settings->gamma);
+
+  BLI_mutex_lock(&processor_lock);
+  lut = BLI_findstring(&global_display_luts, key, offsetof(ColormanageDisplayLUT, key));
+  if (lut != NULL) {
+    display_lut_use_locked(lut);
+    lut = lut->is_valid ? lut : NULL;
+    BLI_mutex_unlock(&processor_lock);
+    return lut;
+  }
+  BLI_mutex_unlock(&processor_lock);
+
+  /* Bake without holding the lock, it evaluates the processor hundreds of thousands of times and
+   * other threads need the lock to create their processors. */
+  ColormanageDisplayLUT *lut_new = MEM_callocN(sizeof(ColormanageDisplayLUT),
+                                               "display transform LUT cache");
+  BLI_strncpy(lut_new->key, key, sizeof(lut_new->key));
+  lut_new->users = 1;
+  for (int size = DISPLAY_LUT_MIN_SIZE; size <= DISPLAY_LUT_MAX_SIZE; size = size * 2 - 1) {
+    if (display_lut_bake(lut_new, cpu_processor, size)) {
+      lut_new->is_valid = true;
+      break;
+    }
+  }
+
+  BLI_mutex_lock(&processor_lock);
+
+  /* Another thread may have baked the same transform in the meantime. */
+  lut = BLI_findstring(&global_display_luts, key, offsetof(ColormanageDisplayLUT, key));
+  if (lut != NULL) {
+    display_lut_free(lut_new);
+  }
+  else {
+    lut = lut_new;
+    BLI_addhead(&global_display_luts, lut);
+
+    if (BLI_listbase_count_at_most(&global_display_luts, DISPLAY_LUT_CACHE_LIMIT + 1) >
+        DISPLAY_LUT_CACHE_LIMIT) {
+      ColormanageDisplayLUT *lut_last = global_display_luts.last;
+      BLI_remlink(&global_display_luts, lut_last);
+      display_lut_release_locked(lut_last);
+    }
+  }
+  display_lut_use_locked(lut);
+  lut = lut->is_valid ? lut : NULL;
+
+  BLI_mutex_unlock(&processor_lock);
+
+  return lut;
+}
+
+static void display_lut_apply(const ColormanageDisplayLUT *lut,
+                              OCIO_ConstCPUProcessorRcPtr *cpu_processor,
+                              float *buffer,
+                              size_t num_pixels,
+                              int channels,
+                              bool predivide)
+{
+  BLI_assert(ELEM(channels, 3, 4));
+  predivide = predivide && (channels == 4);
+
+  float *pixel = buffer;
+  for (size_t i = 0; i < num_pixels; i++, pixel += channels) {
+    const float alpha = predivide ? pixel[3] : 1.0f;
+    const bool use_predivide = !ELEM(alpha, 0.0f, 1.0f);
+    float rgb[3];
+
+    if (use_predivide) {
+      mul_v3_v3fl(rgb, pixel, 1.0f / alpha);
+    }
+    else {
+      copy_v3_v3(rgb, pixel);
+    }
+
+    if (!display_lut_in_domain(rgb)) {
+      if (channels == 3) {
+        OCIO_cpuProcessorApplyRGB(cpu_processor, pixel);
+      }
+      else if (predivide) {
+        OCIO_cpuProcessorApplyRGBA_predivide(cpu_processor, pixel);
+      }
+      else {
+        OCIO_cpuProcessorApplyRGBA(cpu_processor, pixel);
+      }
+      continue;
+    }
+
+    display_lut_sample(lut, rgb, pixel);
+
+    if (use_predivide) {
+      mul_v3_fl(pixel, alpha);
+    }
+  }
+}
+
+static void display_lut_free_all(void)
+{
+  ColormanageDisplayLUT *lut, *lut_next;
+
+  for (lut = global_display_luts.first; lut; lut = lut_next) {
+    lut_next = lut->next;
+    display_lut_release_locked(lut);
+  }
+
+  BLI_listbase_clear(&global_display_luts);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Threaded Display Buffer Transform Routines
  * \{ */
@@ -1763,6 +2145,16 @@ static void colormanage_display_buffer_process_ex(
 
   if (skip_transform == false) {
     cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+
+    /* Baking only pays off for buffers with more pixels than the bake evaluates, baking may
+     * need the largest LUT size. */
+    if (ibuf->rect_float && display_buffer == NULL && cm_processor->cpu_processor &&
+        (ibuf->colormanage_flag & IMB_COLORMANAGE_IS_DATA) == 0 &&
+        ELEM(ibuf->channels, 3, 4) &&
+        (size_t)ibuf->x * ibuf->y >= DISPLAY_LUT_BAKE_SAMPLES_NUM(DISPLAY_LUT_MAX_SIZE)) {
+      cm_processor->display_lut = display_lut_acquire(
+          view_settings, display_settings, cm_processor->cpu_processor);
+    }
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -3884,7 +4276,15 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->cpu_processor && channels >= 3) {
+  if (cm_processor->display_lut && ELEM(channels, 3, 4)) {
+    display_lut_apply(cm_processor->display_lut,
+                      cm_processor->cpu_processor,
+                      buffer,
+                      (size_t)width * height,
+                      channels,
+                      predivide);
+  }
+  else if (cm_processor->cpu_processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3930,6 +4330,9 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->curve_mapping) {
     BKE_curvemapping_free(cm_processor->curve_mapping);
   }
+  if (cm_processor->display_lut) {
+    display_lut_release(cm_processor->display_lut);
+  }
   if (cm_processor->cpu_processor) {
     OCIO_cpuProcessorRelease(cm_processor->cpu_processor);
   }
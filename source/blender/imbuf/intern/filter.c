@@ -27,6 +27,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math_base.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "IMB_filter.h"
@@ -116,205 +117,248 @@ static void filtcolumf(float *point, int y, int skip)
   }
 }
 
-void IMB_filtery(struct ImBuf *ibuf)
+/* Below this size threading overhead outweighs the gain. */
+#define FILTER_THREADED_MIN_PIXELS (128 * 128)
+
+static void filter_parallel_settings(TaskParallelSettings *settings, const ImBuf *ibuf)
 {
-  unsigned char *point;
-  float *pointf;
-  int x, y, skip;
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = ((size_t)ibuf->x * ibuf->y) > FILTER_THREADED_MIN_PIXELS;
+}
 
-  point = (unsigned char *)ibuf->rect;
-  pointf = ibuf->rect_float;
+/* The vertical pass is distributed in blocks of columns, so that threads don't write to the same
+ * cache lines. 16 byte pixels fill a 64 byte cache line. */
+#define FILTER_COLUMN_BLOCK_SIZE 16
 
-  x = ibuf->x;
-  y = ibuf->y;
-  skip = x << 2;
+static void filtery_column(ImBuf *ibuf, const int column)
+{
+  const int y = ibuf->y;
+  const int skip = ibuf->x << 2;
 
-  for (; x > 0; x--) {
-    if (point) {
-      if (ibuf->planes > 24) {
-        filtcolum(point, y, skip);
-      }
-      point++;
-      filtcolum(point, y, skip);
-      point++;
-      filtcolum(point, y, skip);
-      point++;
+  if (ibuf->rect) {
+    unsigned char *point = (unsigned char *)ibuf->rect + 4 * (size_t)column;
+    if (ibuf->planes > 24) {
       filtcolum(point, y, skip);
-      point++;
     }
-    if (pointf) {
-      if (ibuf->planes > 24) {
-        filtcolumf(pointf, y, skip);
-      }
-      pointf++;
-      filtcolumf(pointf, y, skip);
-      pointf++;
-      filtcolumf(pointf, y, skip);
-      pointf++;
+    point++;
+    filtcolum(point, y, skip);
+    point++;
+    filtcolum(point, y, skip);
+    point++;
+    filtcolum(point, y, skip);
+  }
+  if (ibuf->rect_float) {
+    float *pointf = ibuf->rect_float + 4 * (size_t)column;
+    if (ibuf->planes > 24) {
       filtcolumf(pointf, y, skip);
-      pointf++;
     }
+    pointf++;
+    filtcolumf(pointf, y, skip);
+    pointf++;
+    filtcolumf(pointf, y, skip);
+    pointf++;
+    filtcolumf(pointf, y, skip);
   }
 }
 
-void imb_filterx(struct ImBuf *ibuf)
+static void filtery_column_block_cb(void *__restrict userdata,
+                                    const int block,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  unsigned char *point;
-  float *pointf;
-  int x, y, skip;
+  ImBuf *ibuf = userdata;
+  const int column_end = min_ii((block + 1) * FILTER_COLUMN_BLOCK_SIZE, ibuf->x);
 
-  point = (unsigned char *)ibuf->rect;
-  pointf = ibuf->rect_float;
+  for (int column = block * FILTER_COLUMN_BLOCK_SIZE; column < column_end; column++) {
+    filtery_column(ibuf, column);
+  }
+}
 
-  x = ibuf->x;
-  y = ibuf->y;
-  skip = (x << 2) - 3;
+void IMB_filtery(struct ImBuf *ibuf)
+{
+  TaskParallelSettings settings;
+  filter_parallel_settings(&settings, ibuf);
+  BLI_task_parallel_range(0,
+                          (int)divide_ceil_u(ibuf->x, FILTER_COLUMN_BLOCK_SIZE),
+                          ibuf,
+                          filtery_column_block_cb,
+                          &settings);
+}
 
-  for (; y > 0; y--) {
-    if (point) {
-      if (ibuf->planes > 24) {
-        filtrow(point, x);
-      }
-      point++;
-      filtrow(point, x);
-      point++;
-      filtrow(point, x);
-      point++;
+static void filterx_row_cb(void *__restrict userdata,
+                           const int row,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ImBuf *ibuf = userdata;
+  const int x = ibuf->x;
+
+  if (ibuf->rect) {
+    unsigned char *point = (unsigned char *)ibuf->rect + 4 * (size_t)row * x;
+    if (ibuf->planes > 24) {
       filtrow(point, x);
-      point += skip;
     }
-    if (pointf) {
-      if (ibuf->planes > 24) {
-        filtrowf(pointf, x);
-      }
-      pointf++;
-      filtrowf(pointf, x);
-      pointf++;
-      filtrowf(pointf, x);
-      pointf++;
+    point++;
+    filtrow(point, x);
+    point++;
+    filtrow(point, x);
+    point++;
+    filtrow(point, x);
+  }
+  if (ibuf->rect_float) {
+    float *pointf = ibuf->rect_float + 4 * (size_t)row * x;
+    if (ibuf->planes > 24) {
       filtrowf(pointf, x);
-      pointf += skip;
     }
+    pointf++;
+    filtrowf(pointf, x);
+    pointf++;
+    filtrowf(pointf, x);
+    pointf++;
+    filtrowf(pointf, x);
   }
 }
 
-static void imb_filterN(ImBuf *out, ImBuf *in)
+void imb_filterx(struct ImBuf *ibuf)
 {
-  BLI_assert(out->channels == in->channels);
-  BLI_assert(out->x == in->x && out->y == in->y);
+  TaskParallelSettings settings;
+  filter_parallel_settings(&settings, ibuf);
+  BLI_task_parallel_range(0, ibuf->y, ibuf, filterx_row_cb, &settings);
+}
 
+typedef struct FilterNData {
+  ImBuf *out;
+  const ImBuf *in;
+} FilterNData;
+
+static void filterN_row_cb(void *__restrict userdata,
+                           const int y,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const FilterNData *data = userdata;
+  ImBuf *out = data->out;
+  const ImBuf *in = data->in;
   const int channels = in->channels;
   const int rowlen = in->x;
 
   if (in->rect && out->rect) {
-    for (int y = 0; y < in->y; y++) {
-      /* setup rows */
-      const char *row2 = (const char *)in->rect + y * channels * rowlen;
-      const char *row1 = (y == 0) ? row2 : row2 - channels * rowlen;
-      const char *row3 = (y == in->y - 1) ? row2 : row2 + channels * rowlen;
+    /* setup rows */
+    const char *row2 = (const char *)in->rect + y * channels * rowlen;
+    const char *row1 = (y == 0) ? row2 : row2 - channels * rowlen;
+    const char *row3 = (y == in->y - 1) ? row2 : row2 + channels * rowlen;
 
-      char *cp = (char *)out->rect + y * channels * rowlen;
+    char *cp = (char *)out->rect + y * channels * rowlen;
 
-      for (int x = 0; x < rowlen; x++) {
-        const char *r11, *r13, *r21, *r23, *r31, *r33;
+    for (int x = 0; x < rowlen; x++) {
+      const char *r11, *r13, *r21, *r23, *r31, *r33;
 
-        if (x == 0) {
-          r11 = row1;
-          r21 = row2;
-          r31 = row3;
-        }
-        else {
-          r11 = row1 - channels;
-          r21 = row2 - channels;
-          r31 = row3 - channels;
-        }
-
-        if (x == rowlen - 1) {
-          r13 = row1;
-          r23 = row2;
-          r33 = row3;
-        }
-        else {
-          r13 = row1 + channels;
-          r23 = row2 + channels;
-          r33 = row3 + channels;
-        }
+      if (x == 0) {
+        r11 = row1;
+        r21 = row2;
+        r31 = row3;
+      }
+      else {
+        r11 = row1 - channels;
+        r21 = row2 - channels;
+        r31 = row3 - channels;
+      }
 
-        cp[0] = (r11[0] + 2 * row1[0] + r13[0] + 2 * r21[0] + 4 * row2[0] + 2 * r23[0] + r31[0] +
-                 2 * row3[0] + r33[0]) >>
-                4;
-        cp[1] = (r11[1] + 2 * row1[1] + r13[1] + 2 * r21[1] + 4 * row2[1] + 2 * r23[1] + r31[1] +
-                 2 * row3[1] + r33[1]) >>
-                4;
-        cp[2] = (r11[2] + 2 * row1[2] + r13[2] + 2 * r21[2] + 4 * row2[2] + 2 * r23[2] + r31[2] +
-                 2 * row3[2] + r33[2]) >>
-                4;
-        cp[3] = (r11[3] + 2 * row1[3] + r13[3] + 2 * r21[3] + 4 * row2[3] + 2 * r23[3] + r31[3] +
-                 2 * row3[3] + r33[3]) >>
-                4;
-        cp += channels;
-        row1 += channels;
-        row2 += channels;
-        row3 += channels;
+      if (x == rowlen - 1) {
+        r13 = row1;
+        r23 = row2;
+        r33 = row3;
+      }
+      else {
+        r13 = row1 + channels;
+        r23 = row2 + channels;
+        r33 = row3 + channels;
       }
+
+      cp[0] = (r11[0] + 2 * row1[0] + r13[0] + 2 * r21[0] + 4 * row2[0] + 2 * r23[0] + r31[0] +
+               2 * row3[0] + r33[0]) >>
+              4;
+      cp[1] = (r11[1] + 2 * row1[1] + r13[1] + 2 * r21[1] + 4 * row2[1] + 2 * r23[1] + r31[1] +
+               2 * row3[1] + r33[1]) >>
+              4;
+      cp[2] = (r11[2] + 2 * row1[2] + r13[2] + 2 * r21[2] + 4 * row2[2] + 2 * r23[2] + r31[2] +
+               2 * row3[2] + r33[2]) >>
+              4;
+      cp[3] = (r11[3] + 2 * row1[3] + r13[3] + 2 * r21[3] + 4 * row2[3] + 2 * r23[3] + r31[3] +
+               2 * row3[3] + r33[3]) >>
+              4;
+      cp += channels;
+      row1 += channels;
+      row2 += channels;
+      row3 += channels;
     }
   }
 
   if (in->rect_float && out->rect_float) {
-    for (int y = 0; y < in->y; y++) {
-      /* setup rows */
-      const float *row2 = (const float *)in->rect_float + y * channels * rowlen;
-      const float *row1 = (y == 0) ? row2 : row2 - channels * rowlen;
-      const float *row3 = (y == in->y - 1) ? row2 : row2 + channels * rowlen;
-
-      float *cp = (float *)out->rect_float + y * channels * rowlen;
+    /* setup rows */
+    const float *row2 = (const float *)in->rect_float + y * channels * rowlen;
+    const float *row1 = (y == 0) ? row2 : row2 - channels * rowlen;
+    const float *row3 = (y == in->y - 1) ? row2 : row2 + channels * rowlen;
 
-      for (int x = 0; x < rowlen; x++) {
-        const float *r11, *r13, *r21, *r23, *r31, *r33;
+    float *cp = (float *)out->rect_float + y * channels * rowlen;
 
-        if (x == 0) {
-          r11 = row1;
-          r21 = row2;
-          r31 = row3;
-        }
-        else {
-          r11 = row1 - channels;
-          r21 = row2 - channels;
-          r31 = row3 - channels;
-        }
+    for (int x = 0; x < rowlen; x++) {
+      const float *r11, *r13, *r21, *r23, *r31, *r33;
 
-        if (x == rowlen - 1) {
-          r13 = row1;
-          r23 = row2;
-          r33 = row3;
-        }
-        else {
-          r13 = row1 + channels;
-          r23 = row2 + channels;
-          r33 = row3 + channels;
-        }
+      if (x == 0) {
+        r11 = row1;
+        r21 = row2;
+        r31 = row3;
+      }
+      else {
+        r11 = row1 - channels;
+        r21 = row2 - channels;
+        r31 = row3 - channels;
+      }
 
-        cp[0] = (r11[0] + 2 * row1[0] + r13[0] + 2 * r21[0] + 4 * row2[0] + 2 * r23[0] + r31[0] +
-                 2 * row3[0] + r33[0]) *
-                (1.0f / 16.0f);
-        cp[1] = (r11[1] + 2 * row1[1] + r13[1] + 2 * r21[1] + 4 * row2[1] + 2 * r23[1] + r31[1] +
-                 2 * row3[1] + r33[1]) *
-                (1.0f / 16.0f);
-        cp[2] = (r11[2] + 2 * row1[2] + r13[2] + 2 * r21[2] + 4 * row2[2] + 2 * r23[2] + r31[2] +
-                 2 * row3[2] + r33[2]) *
-                (1.0f / 16.0f);
-        cp[3] = (r11[3] + 2 * row1[3] + r13[3] + 2 * r21[3] + 4 * row2[3] + 2 * r23[3] + r31[3] +
-                 2 * row3[3] + r33[3]) *
-                (1.0f / 16.0f);
-        cp += channels;
-        row1 += channels;
-        row2 += channels;
-        row3 += channels;
+      if (x == rowlen - 1) {
+        r13 = row1;
+        r23 = row2;
+        r33 = row3;
+      }
+      else {
+        r13 = row1 + channels;
+        r23 = row2 + channels;
+        r33 = row3 + channels;
       }
+
+      cp[0] = (r11[0] + 2 * row1[0] + r13[0] + 2 * r21[0] + 4 * row2[0] + 2 * r23[0] + r31[0] +
+               2 * row3[0] + r33[0]) *
+              (1.0f / 16.0f);
+      cp[1] = (r11[1] + 2 * row1[1] + r13[1] + 2 * r21[1] + 4 * row2[1] + 2 * r23[1] + r31[1] +
+               2 * row3[1] + r33[1]) *
+              (1.0f / 16.0f);
+      cp[2] = (r11[2] + 2 * row1[2] + r13[2] + 2 * r21[2] + 4 * row2[2] + 2 * r23[2] + r31[2] +
+               2 * row3[2] + r33[2]) *
+              (1.0f / 16.0f);
+      cp[3] = (r11[3] + 2 * row1[3] + r13[3] + 2 * r21[3] + 4 * row2[3] + 2 * r23[3] + r31[3] +
+               2 * row3[3] + r33[3]) *
+              (1.0f / 16.0f);
+      cp += channels;
+      row1 += channels;
+      row2 += channels;
+      row3 += channels;
     }
   }
 }
 
+static void imb_filterN(ImBuf *out, ImBuf *in)
+{
+  BLI_assert(out->channels == in->channels);
+  BLI_assert(out->x == in->x && out->y == in->y);
+
+  FilterNData data = {
+      .out = out,
+      .in = in,
+  };
+
+  TaskParallelSettings settings;
+  filter_parallel_settings(&settings, in);
+  BLI_task_parallel_range(0, in->y, &data, filterN_row_cb, &settings);
+}
+
 void IMB_filter(struct ImBuf *ibuf)
 {
   IMB_filtery(ibuf);
@@ -256,6 +256,7 @@ void IMB_moviecache_destruct(void)
 {
   if (limitor) {
     delete_MEM_CacheLimiter(limitor);
+    limitor = NULL;
   }
 }
 
@@ -842,6 +842,25 @@ void IMB_exr_add_channel(void *handle,
   BLI_addtail(&data->channels, echan);
 }
 
+/* Number of scanlines that are compressed together. */
+static int openexr_compression_scanlines(const Compression compression)
+{
+  switch (compression) {
+    case ZIP_COMPRESSION:
+    case PXR24_COMPRESSION:
+      return 16;
+    case PIZ_COMPRESSION:
+    case B44_COMPRESSION:
+    case B44A_COMPRESSION:
+    case DWAA_COMPRESSION:
+      return 32;
+    case DWAB_COMPRESSION:
+      return 256;
+    default:
+      return 1;
+  }
+}
+
 /* used for output files (from RenderResult) (single and multilayer, single and multiview) */
 int IMB_exr_begin_write(void *handle,
                         const char *filename,
@@ -1101,58 +1120,73 @@ void IMB_exr_clear_channels(void *handle)
 void IMB_exr_write_channels(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
-  FrameBuffer frameBuffer;
   ExrChannel *echan;
 
-  if (data->channels.first) {
-    const size_t num_pixels = ((size_t)data->width) * data->height;
-    half *rect_half = nullptr, *current_rect_half = nullptr;
+  if (data->channels.first == nullptr) {
+    printf("Error: attempt to save MultiLayer without layers.\n");
+    return;
+  }
+
+  /* Write scanlines in chunks, so half float channels only need temporary storage for one chunk
+   * instead of the whole image. Chunks hold a compression block for every thread of the OpenEXR
+   * thread pool, so writing a chunk keeps all of them busy. */
+  const int chunk_lines = std::min(
+      data->height,
+      openexr_compression_scanlines(data->ofile->header().compression()) *
+          std::max(1, globalThreadCount()));
+  const size_t chunk_pixels = ((size_t)data->width) * chunk_lines;
+  half *rect_half = nullptr;
 
-    /* We allocate temporary storage for half pixels for all the channels at once. */
-    if (data->num_half_channels != 0) {
-      rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * num_pixels,
-                                      __func__);
-      current_rect_half = rect_half;
-    }
+  if (data->num_half_channels != 0) {
+    rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * chunk_pixels,
+                                    __func__);
+  }
 
-    for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
-      /* Writing starts from last scanline, stride negative. */
-      if (echan->use_half_float) {
-        float *rect = echan->rect;
-        half *cur = current_rect_half;
-        for (size_t i = 0; i < num_pixels; i++, cur++) {
-          *cur = float_to_half_safe(rect[i * echan->xstride]);
+  try {
+    for (int y_start = 0; y_start < data->height; y_start += chunk_lines) {
+      const int y_end = std::min(y_start + chunk_lines, data->height);
+      FrameBuffer frameBuffer;
+      half *current_rect_half = rect_half;
+
+      for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+        if (echan->use_half_float) {
+          half *cur = current_rect_half;
+          for (int y = y_start; y < y_end; y++) {
+            const float *rect = echan->rect + echan->ystride * (data->height - 1L - y);
+            for (int x = 0; x < data->width; x++, cur++) {
+              *cur = float_to_half_safe(rect[x * echan->xstride]);
+            }
+          }
+          /* Chunk buffer is stored top to bottom, offset so file scanline y_start is its first
+           * scanline. */
+          half *rect_to_write = current_rect_half - (size_t)y_start * data->width;
+          frameBuffer.insert(
+              echan->name,
+              Slice(Imf::HALF, (char *)rect_to_write, sizeof(half), data->width * sizeof(half)));
+          current_rect_half += chunk_pixels;
+        }
+        else {
+          /* Writing starts from last scanline, stride negative. */
+          float *rect = echan->rect + echan->xstride * (data->height - 1L) * data->width;
+          frameBuffer.insert(echan->name,
+                             Slice(Imf::FLOAT,
+                                   (char *)rect,
+                                   echan->xstride * sizeof(float),
+                                   -echan->ystride * sizeof(float)));
         }
-        half *rect_to_write = current_rect_half + (data->height - 1L) * data->width;
-        frameBuffer.insert(
-            echan->name,
-            Slice(Imf::HALF, (char *)rect_to_write, sizeof(half), -data->width * sizeof(half)));
-        current_rect_half += num_pixels;
-      }
-      else {
-        float *rect = echan->rect + echan->xstride * (data->height - 1L) * data->width;
-        frameBuffer.insert(echan->name,
-                           Slice(Imf::FLOAT,
-                                 (char *)rect,
-                                 echan->xstride * sizeof(float),
-                                 -echan->ystride * sizeof(float)));
       }
-    }
 
-    data->ofile->setFrameBuffer(frameBuffer);
-    try {
-      data->ofile->writePixels(data->height);
-    }
-    catch (const std::exception &exc) {
-      std::cerr << "OpenEXR-writePixels: ERROR: " << exc.what() << std::endl;
-    }
-    /* Free temporary buffers. */
-    if (rect_half != nullptr) {
-      MEM_freeN(rect_half);
+      data->ofile->setFrameBuffer(frameBuffer);
+      data->ofile->writePixels(y_end - y_start);
     }
   }
-  else {
-    printf("Error: attempt to save MultiLayer without layers.\n");
+  catch (const std::exception &exc) {
+    std::cerr << "OpenEXR-writePixels: ERROR: " << exc.what() << std::endl;
+  }
+
+  /* Free temporary buffers. */
+  if (rect_half != nullptr) {
+    MEM_freeN(rect_half);
   }
 }
 
@@ -1238,6 +1272,7 @@ void IMB_exr_read_channels(void *handle)
     /* Insert all matching channel into frame-buffer. */
     FrameBuffer frameBuffer;
     ExrChannel *echan;
+    int num_channels_read = 0;
 
     for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
       if (echan->m->part_number != i) {
@@ -1269,12 +1304,19 @@ void IMB_exr_read_channels(void *handle)
 
         frameBuffer.insert(echan->m->internal_name,
                            Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+        num_channels_read++;
       }
       else {
-        printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
+        /* Channels without rect are not requested by the caller, skip them. */
+        exr_printf("skip channel with no rect set %s\n", echan->m->internal_name.c_str());
       }
     }
 
+    /* Parts without any requested channel are not decoded at all. */
+    if (num_channels_read == 0) {
+      continue;
+    }
+
     /* Read pixels. */
     try {
       in.setFrameBuffer(frameBuffer);
@@ -1324,6 +1366,10 @@ void IMB_exr_multilayer_convert(void *handle,
     void *laybase = addlayer(base, lay->name);
     if (laybase) {
       for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
+        /* Passes that were not requested when reading have no buffer. */
+        if (pass->rect == nullptr) {
+          continue;
+        }
         addpass(base,
                 laybase,
                 pass->internal_name,
@@ -1528,11 +1574,31 @@ static ExrPass *imb_exr_get_pass(ListBase *lb, char *passname)
   return pass;
 }
 
+/* Passes named in `pass_names` are matched on their name without layer and view. */
+static bool imb_exr_pass_is_requested(const ExrPass *pass,
+                                      const char *const *pass_names,
+                                      const int pass_names_num)
+{
+  if (pass_names == nullptr) {
+    return true;
+  }
+  for (int i = 0; i < pass_names_num; i++) {
+    if (STREQ(pass->internal_name, pass_names[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
 /* creates channels, makes a hierarchy and assigns memory to channels */
+/* Only passes in `pass_names` get a buffer, or all passes when it is null. Channels of other
+ * passes have no rect, so #IMB_exr_read_channels does not read them. */
 static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
                                          MultiPartInputFile &file,
                                          int width,
-                                         int height)
+                                         int height,
+                                         const char *const *pass_names,
+                                         const int pass_names_num)
 {
   ExrLayer *lay;
   ExrPass *pass;
@@ -1602,7 +1668,7 @@ static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
   /* with some heuristics, try to merge the channels in buffers */
   for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
     for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
-      if (pass->totchan) {
+      if (pass->totchan && imb_exr_pass_is_requested(pass, pass_names, pass_names_num)) {
         pass->rect = (float *)MEM_callocN(width * height * pass->totchan * sizeof(float),
                                           "pass rect");
         if (pass->totchan == 1) {
@@ -1898,6 +1964,49 @@ bool IMB_exr_has_multilayer(void *handle)
   return imb_exr_is_multi(*data->ifile);
 }
 
+void *IMB_exr_read_multilayer_passes(const char *filepath,
+                                     const char *const *pass_names,
+                                     int pass_names_num,
+                                     int *r_width,
+                                     int *r_height)
+{
+  IStream *file_stream = nullptr;
+  MultiPartInputFile *file = nullptr;
+
+  /* 32 is arbitrary, but zero length files crashes exr. */
+  if (!(BLI_exists(filepath) && BLI_file_size(filepath) > 32)) {
+    return nullptr;
+  }
+
+  try {
+    file_stream = new IFileStream(filepath);
+    file = new MultiPartInputFile(*file_stream);
+  }
+  catch (const std::exception &) {
+    delete file;
+    delete file_stream;
+    return nullptr;
+  }
+
+  if (!imb_exr_is_multi(*file)) {
+    delete file;
+    delete file_stream;
+    return nullptr;
+  }
+
+  Box2i dw = file->header(0).dataWindow();
+  *r_width = dw.max.x - dw.min.x + 1;
+  *r_height = dw.max.y - dw.min.y + 1;
+
+  /* The handle owns the file from here on. */
+  ExrHandle *handle = imb_exr_begin_read_mem(
+      *file_stream, *file, *r_width, *r_height, pass_names, pass_names_num);
+  if (handle) {
+    IMB_exr_read_channels(handle);
+  }
+  return handle;
+}
+
 struct ImBuf *imb_load_openexr(const unsigned char *mem,
                                size_t size,
                                int flags,
@@ -1972,7 +2081,8 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
         /* Only enters with IB_multilayer flag set. */
         if (is_multi && ((flags & IB_thumbnail) == 0)) {
           /* constructs channels for reading, allocates memory in channels */
-          ExrHandle *handle = imb_exr_begin_read_mem(*membuf, *file, width, height);
+          ExrHandle *handle = imb_exr_begin_read_mem(
+              *membuf, *file, width, height, nullptr, 0);
           if (handle) {
             IMB_exr_read_channels(handle);
             ibuf->userdata = handle; /* potential danger, the caller has to check for this! */
@@ -95,6 +95,17 @@ void IMB_exr_add_view(void *handle, const char *name);
 
 bool IMB_exr_has_multilayer(void *handle);
 
+/**
+ * Read a multilayer file, only allocating and decoding the passes named in `pass_names` (names
+ * without layer and view, like "Combined"). Other passes are left out of
+ * #IMB_exr_multilayer_convert. Returns NULL when the file is not a multilayer EXR.
+ */
+void *IMB_exr_read_multilayer_passes(const char *filepath,
+                                     const char *const *pass_names,
+                                     int pass_names_num,
+                                     int *r_width,
+                                     int *r_height);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -128,3 +128,12 @@ bool IMB_exr_has_multilayer(void * /*handle*/)
 {
   return false;
 }
+
+void *IMB_exr_read_multilayer_passes(const char * /*filepath*/,
+                                     const char *const * /*pass_names*/,
+                                     int /*pass_names_num*/,
+                                     int * /*r_width*/,
+                                     int * /*r_height*/)
+{
+  return nullptr;
+}
@@ -24,8 +24,10 @@
 
 #include <math.h>
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -37,6 +39,13 @@
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
+/* Below this size threading overhead outweighs the gain, e.g. for icons and small thumbnails. */
+#define SCALE_THREADED_MIN_PIXELS (128 * 128)
+
+/* Vertical passes are distributed in blocks of columns, so that threads don't write to the same
+ * cache lines. 16 byte pixels fill a 64 byte cache line. */
+#define SCALE_COLUMN_BLOCK_SIZE 16
+
 static void imb_half_x_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
   uchar *p1, *_p1, *dest;
@@ -908,22 +917,145 @@ static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
   return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+/* Rows (for scaling along x) or columns (for scaling along y) are scaled independently from each
+ * other, so they are distributed over threads. */
+typedef struct ScaleLinesData {
+  const uchar *rect;
+  uchar *newrect;
+  const float *rectf;
+  float *newrectf;
+  /* Size of the source image. */
+  int x, y;
+  /* Size of the scaled axis after scaling. */
+  int newsize;
+  float add;
+} ScaleLinesData;
+
+static void scale_lines_settings(TaskParallelSettings *settings, const ImBuf *ibuf)
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
+  BLI_parallel_range_settings_defaults(settings);
+  settings->use_threading = ((size_t)ibuf->x * ibuf->y) > SCALE_THREADED_MIN_PIXELS;
+}
 
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
+static int scale_column_blocks_num(const ImBuf *ibuf)
+{
+  return (int)divide_ceil_u(ibuf->x, SCALE_COLUMN_BLOCK_SIZE);
+}
 
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
+static void scaledownx_line_cb(void *__restrict userdata,
+                               const int line,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleLinesData *data = userdata;
+  const int newx = data->newsize;
+  const float add = data->add;
+  const uchar *rect = NULL;
+  const float *rectf = NULL;
+  uchar *newrect = NULL;
+  float *newrectf = NULL;
+  float sample, val[4], nval[4], valf[4], nvalf[4];
+  int x;
+
+  if (data->rect) {
+    rect = data->rect + (size_t)line * data->x * 4;
+    newrect = data->newrect + (size_t)line * newx * 4;
+  }
+  if (data->rectf) {
+    rectf = data->rectf + (size_t)line * data->x * 4;
+    newrectf = data->newrectf + (size_t)line * newx * 4;
+  }
+
+  const uchar *rect_begin = rect;
+  const float *rectf_begin = rectf;
+  UNUSED_VARS_NDEBUG(rect_begin, rectf_begin);
+
+  sample = 0.0f;
+  val[0] = val[1] = val[2] = val[3] = 0.0f;
+  valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
   nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
   nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
 
+  for (x = newx; x > 0; x--) {
+    if (rect) {
+      nval[0] = -val[0] * sample;
+      nval[1] = -val[1] * sample;
+      nval[2] = -val[2] * sample;
+      nval[3] = -val[3] * sample;
+    }
+    if (rectf) {
+      nvalf[0] = -valf[0] * sample;
+      nvalf[1] = -valf[1] * sample;
+      nvalf[2] = -valf[2] * sample;
+      nvalf[3] = -valf[3] * sample;
+    }
+
+    sample += add;
+
+    while (sample >= 1.0f) {
+      sample -= 1.0f;
+
+      if (rect) {
+        nval[0] += rect[0];
+        nval[1] += rect[1];
+        nval[2] += rect[2];
+        nval[3] += rect[3];
+        rect += 4;
+      }
+      if (rectf) {
+        nvalf[0] += rectf[0];
+        nvalf[1] += rectf[1];
+        nvalf[2] += rectf[2];
+        nvalf[3] += rectf[3];
+        rectf += 4;
+      }
+    }
+
+    if (rect) {
+      val[0] = rect[0];
+      val[1] = rect[1];
+      val[2] = rect[2];
+      val[3] = rect[3];
+      rect += 4;
+
+      newrect[0] = roundf((nval[0] + sample * val[0]) / add);
+      newrect[1] = roundf((nval[1] + sample * val[1]) / add);
+      newrect[2] = roundf((nval[2] + sample * val[2]) / add);
+      newrect[3] = roundf((nval[3] + sample * val[3]) / add);
+
+      newrect += 4;
+    }
+    if (rectf) {
+
+      valf[0] = rectf[0];
+      valf[1] = rectf[1];
+      valf[2] = rectf[2];
+      valf[3] = rectf[3];
+      rectf += 4;
+
+      newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
+      newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
+      newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
+      newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+
+      newrectf += 4;
+    }
+
+    sample -= 1.0f;
+  }
+
+  /* See bug T26502. */
+  BLI_assert(rect == NULL || rect - rect_begin == (size_t)data->x * 4);
+  BLI_assert(rectf == NULL || rectf - rectf_begin == (size_t)data->x * 4);
+}
+
+static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+{
+  const int do_rect = (ibuf->rect != NULL);
+  const int do_float = (ibuf->rect_float != NULL);
+
+  uchar *_newrect = NULL;
+  float *_newrectf = NULL;
+
   if (!do_rect && !do_float) {
     return ibuf;
   }
@@ -944,126 +1076,159 @@ static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
     }
   }
 
-  add = (ibuf->x - 0.01) / newx;
+  ScaleLinesData data = {
+      .rect = (const uchar *)ibuf->rect,
+      .newrect = _newrect,
+      .rectf = ibuf->rect_float,
+      .newrectf = _newrectf,
+      .x = ibuf->x,
+      .y = ibuf->y,
+      .newsize = newx,
+      .add = (ibuf->x - 0.01) / newx,
+  };
+
+  TaskParallelSettings settings;
+  scale_lines_settings(&settings, ibuf);
+  BLI_task_parallel_range(0, ibuf->y, &data, scaledownx_line_cb, &settings);
 
   if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = (unsigned int *)_newrect;
   }
   if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = _newrectf;
   }
 
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+  ibuf->x = newx;
+  return ibuf;
+}
 
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
+static void scaledowny_column(const ScaleLinesData *data, const int column)
+{
+  const int newy = data->newsize;
+  const float add = data->add;
+  const int skipx = 4 * data->x;
+  const uchar *rect = NULL;
+  const float *rectf = NULL;
+  uchar *newrect = NULL;
+  float *newrectf = NULL;
+  float sample, val[4], nval[4], valf[4], nvalf[4];
+  int y;
+
+  if (data->rect) {
+    rect = data->rect + 4 * column;
+    newrect = data->newrect + 4 * column;
+  }
+  if (data->rectf) {
+    rectf = data->rectf + 4 * column;
+    newrectf = data->newrectf + 4 * column;
+  }
+
+  const uchar *rect_begin = rect;
+  const float *rectf_begin = rectf;
+  UNUSED_VARS_NDEBUG(rect_begin, rectf_begin);
+
+  sample = 0.0f;
+  val[0] = val[1] = val[2] = val[3] = 0.0f;
+  valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
+  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
 
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
+  for (y = newy; y > 0; y--) {
+    if (rect) {
+      nval[0] = -val[0] * sample;
+      nval[1] = -val[1] * sample;
+      nval[2] = -val[2] * sample;
+      nval[3] = -val[3] * sample;
+    }
+    if (rectf) {
+      nvalf[0] = -valf[0] * sample;
+      nvalf[1] = -valf[1] * sample;
+      nvalf[2] = -valf[2] * sample;
+      nvalf[3] = -valf[3] * sample;
+    }
 
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
+    sample += add;
 
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
+    while (sample >= 1.0f) {
+      sample -= 1.0f;
 
-        newrect += 4;
+      if (rect) {
+        nval[0] += rect[0];
+        nval[1] += rect[1];
+        nval[2] += rect[2];
+        nval[3] += rect[3];
+        rect += skipx;
       }
-      if (do_float) {
+      if (rectf) {
+        nvalf[0] += rectf[0];
+        nvalf[1] += rectf[1];
+        nvalf[2] += rectf[2];
+        nvalf[3] += rectf[3];
+        rectf += skipx;
+      }
+    }
 
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
+    if (rect) {
+      val[0] = rect[0];
+      val[1] = rect[1];
+      val[2] = rect[2];
+      val[3] = rect[3];
+      rect += skipx;
 
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+      newrect[0] = roundf((nval[0] + sample * val[0]) / add);
+      newrect[1] = roundf((nval[1] + sample * val[1]) / add);
+      newrect[2] = roundf((nval[2] + sample * val[2]) / add);
+      newrect[3] = roundf((nval[3] + sample * val[3]) / add);
 
-        newrectf += 4;
-      }
+      newrect += skipx;
+    }
+    if (rectf) {
 
-      sample -= 1.0f;
+      valf[0] = rectf[0];
+      valf[1] = rectf[1];
+      valf[2] = rectf[2];
+      valf[3] = rectf[3];
+      rectf += skipx;
+
+      newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
+      newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
+      newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
+      newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+
+      newrectf += skipx;
     }
-  }
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
+    sample -= 1.0f;
   }
-  (void)rect_size; /* UNUSED in release builds */
 
-  ibuf->x = newx;
-  return ibuf;
+  /* See bug T26502. */
+  BLI_assert(rect == NULL || rect - rect_begin == (size_t)data->y * skipx);
+  BLI_assert(rectf == NULL || rectf - rectf_begin == (size_t)data->y * skipx);
+}
+
+static void scaledowny_column_block_cb(void *__restrict userdata,
+                                       const int block,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleLinesData *data = userdata;
+  const int column_end = min_ii((block + 1) * SCALE_COLUMN_BLOCK_SIZE, data->x);
+
+  for (int column = block * SCALE_COLUMN_BLOCK_SIZE; column < column_end; column++) {
+    scaledowny_column(data, column);
+  }
 }
 
 static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
 {
   const int do_rect = (ibuf->rect != NULL);
   const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
 
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+  uchar *_newrect = NULL;
+  float *_newrectf = NULL;
 
   if (!do_rect && !do_float) {
     return ibuf;
@@ -1085,117 +1250,48 @@ static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
     }
   }
 
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
-    }
-
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
-        }
-      }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
+  ScaleLinesData data = {
+      .rect = (const uchar *)ibuf->rect,
+      .newrect = _newrect,
+      .rectf = ibuf->rect_float,
+      .newrectf = _newrectf,
+      .x = ibuf->x,
+      .y = ibuf->y,
+      .newsize = newy,
+      .add = (ibuf->y - 0.01) / newy,
+  };
 
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += skipx;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
-      }
-
-      sample -= 1.0f;
-    }
-  }
+  TaskParallelSettings settings;
+  scale_lines_settings(&settings, ibuf);
+  BLI_task_parallel_range(
+      0, scale_column_blocks_num(ibuf), &data, scaledowny_column_block_cb, &settings);
 
   if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
     ibuf->rect = (unsigned int *)_newrect;
   }
   if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
     ibuf->rect_float = (float *)_newrectf;
   }
-  (void)rect_size; /* UNUSED in release builds */
 
   ibuf->y = newy;
   return ibuf;
 }
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+/* Shared by scaleupx and scaleupy, `skip` is the distance between two pixels of the line. */
+BLI_INLINE void scaleup_line(const ScaleLinesData *data,
+                             const uchar *rect,
+                             uchar *newrect,
+                             const float *rectf,
+                             float *newrectf,
+                             const int skip)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
+  const int newsize = data->newsize;
+  const float add = data->add;
+  float sample;
   float val_a, nval_a, diff_a;
   float val_b, nval_b, diff_b;
   float val_g, nval_g, diff_g;
@@ -1204,13 +1300,142 @@ static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
   float val_bf, nval_bf, diff_bf;
   float val_gf, nval_gf, diff_gf;
   float val_rf, nval_rf, diff_rf;
-  int x, y;
-  bool do_rect = false, do_float = false;
+  int i;
 
   val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
   val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
   val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
   val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
+
+  sample = 0;
+
+  if (rect) {
+    val_a = rect[0];
+    nval_a = rect[skip];
+    diff_a = nval_a - val_a;
+    val_a += 0.5f;
+
+    val_b = rect[1];
+    nval_b = rect[skip + 1];
+    diff_b = nval_b - val_b;
+    val_b += 0.5f;
+
+    val_g = rect[2];
+    nval_g = rect[skip + 2];
+    diff_g = nval_g - val_g;
+    val_g += 0.5f;
+
+    val_r = rect[3];
+    nval_r = rect[skip + 3];
+    diff_r = nval_r - val_r;
+    val_r += 0.5f;
+
+    rect += 2 * skip;
+  }
+  if (rectf) {
+    val_af = rectf[0];
+    nval_af = rectf[skip];
+    diff_af = nval_af - val_af;
+
+    val_bf = rectf[1];
+    nval_bf = rectf[skip + 1];
+    diff_bf = nval_bf - val_bf;
+
+    val_gf = rectf[2];
+    nval_gf = rectf[skip + 2];
+    diff_gf = nval_gf - val_gf;
+
+    val_rf = rectf[3];
+    nval_rf = rectf[skip + 3];
+    diff_rf = nval_rf - val_rf;
+
+    rectf += 2 * skip;
+  }
+
+  for (i = newsize; i > 0; i--) {
+    if (sample >= 1.0f) {
+      sample -= 1.0f;
+
+      if (rect) {
+        val_a = nval_a;
+        nval_a = rect[0];
+        diff_a = nval_a - val_a;
+        val_a += 0.5f;
+
+        val_b = nval_b;
+        nval_b = rect[1];
+        diff_b = nval_b - val_b;
+        val_b += 0.5f;
+
+        val_g = nval_g;
+        nval_g = rect[2];
+        diff_g = nval_g - val_g;
+        val_g += 0.5f;
+
+        val_r = nval_r;
+        nval_r = rect[3];
+        diff_r = nval_r - val_r;
+        val_r += 0.5f;
+        rect += skip;
+      }
+      if (rectf) {
+        val_af = nval_af;
+        nval_af = rectf[0];
+        diff_af = nval_af - val_af;
+
+        val_bf = nval_bf;
+        nval_bf = rectf[1];
+        diff_bf = nval_bf - val_bf;
+
+        val_gf = nval_gf;
+        nval_gf = rectf[2];
+        diff_gf = nval_gf - val_gf;
+
+        val_rf = nval_rf;
+        nval_rf = rectf[3];
+        diff_rf = nval_rf - val_rf;
+        rectf += skip;
+      }
+    }
+    if (rect) {
+      newrect[0] = val_a + sample * diff_a;
+      newrect[1] = val_b + sample * diff_b;
+      newrect[2] = val_g + sample * diff_g;
+      newrect[3] = val_r + sample * diff_r;
+      newrect += skip;
+    }
+    if (rectf) {
+      newrectf[0] = val_af + sample * diff_af;
+      newrectf[1] = val_bf + sample * diff_bf;
+      newrectf[2] = val_gf + sample * diff_gf;
+      newrectf[3] = val_rf + sample * diff_rf;
+      newrectf += skip;
+    }
+    sample += add;
+  }
+}
+
+static void scaleupx_line_cb(void *__restrict userdata,
+                             const int line,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleLinesData *data = userdata;
+  const size_t offset = (size_t)line * data->x * 4;
+  const size_t new_offset = (size_t)line * data->newsize * 4;
+
+  scaleup_line(data,
+               data->rect ? data->rect + offset : NULL,
+               data->rect ? data->newrect + new_offset : NULL,
+               data->rectf ? data->rectf + offset : NULL,
+               data->rectf ? data->newrectf + new_offset : NULL,
+               4);
+}
+
+static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+{
+  uchar *_newrect = NULL;
+  float *_newrectf = NULL;
+
   if (ibuf == NULL) {
     return NULL;
   }
@@ -1219,14 +1444,12 @@ static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
   }
 
   if (ibuf->rect) {
-    do_rect = true;
     _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
     if (_newrect == NULL) {
       return ibuf;
     }
   }
   if (ibuf->rect_float) {
-    do_float = true;
     _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf");
     if (_newrectf == NULL) {
       if (_newrect) {
@@ -1236,128 +1459,27 @@ static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
     }
   }
 
-  add = (ibuf->x - 1.001) / (newx - 1.0);
+  ScaleLinesData data = {
+      .rect = (const uchar *)ibuf->rect,
+      .newrect = _newrect,
+      .rectf = ibuf->rect_float,
+      .newrectf = _newrectf,
+      .x = ibuf->x,
+      .y = ibuf->y,
+      .newsize = newx,
+      .add = (ibuf->x - 1.001) / (newx - 1.0),
+  };
 
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (y = ibuf->y; y > 0; y--) {
-
-    sample = 0;
-
-    if (do_rect) {
-      val_a = rect[0];
-      nval_a = rect[4];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[5];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[6];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[7];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 8;
-    }
-    if (do_float) {
-      val_af = rectf[0];
-      nval_af = rectf[4];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[5];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[6];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[7];
-      diff_rf = nval_rf - val_rf;
-
-      rectf += 8;
-    }
-    for (x = newx; x > 0; x--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += 4;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += 4;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += 4;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += 4;
-      }
-      sample += add;
-    }
-  }
+  TaskParallelSettings settings;
+  scale_lines_settings(&settings, ibuf);
+  BLI_task_parallel_range(0, ibuf->y, &data, scaleupx_line_cb, &settings);
 
-  if (do_rect) {
+  if (_newrect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
     ibuf->rect = (unsigned int *)_newrect;
   }
-  if (do_float) {
+  if (_newrectf) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
     ibuf->rect_float = (float *)_newrectf;
@@ -1367,26 +1489,29 @@ static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
   return ibuf;
 }
 
+static void scaleupy_column_block_cb(void *__restrict userdata,
+                                     const int block,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleLinesData *data = userdata;
+  const int column_end = min_ii((block + 1) * SCALE_COLUMN_BLOCK_SIZE, data->x);
+
+  for (int column = block * SCALE_COLUMN_BLOCK_SIZE; column < column_end; column++) {
+    const size_t offset = (size_t)column * 4;
+    scaleup_line(data,
+                 data->rect ? data->rect + offset : NULL,
+                 data->rect ? data->newrect + offset : NULL,
+                 data->rectf ? data->rectf + offset : NULL,
+                 data->rectf ? data->newrectf + offset : NULL,
+                 4 * data->x);
+  }
+}
+
 static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
+  uchar *_newrect = NULL;
+  float *_newrectf = NULL;
 
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
   if (ibuf == NULL) {
     return NULL;
   }
@@ -1395,14 +1520,12 @@ static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
   }
 
   if (ibuf->rect) {
-    do_rect = true;
     _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
     if (_newrect == NULL) {
       return ibuf;
     }
   }
   if (ibuf->rect_float) {
-    do_float = true;
     _newrectf = MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf");
     if (_newrectf == NULL) {
       if (_newrect) {
@@ -1412,135 +1535,28 @@ static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
     }
   }
 
-  add = (ibuf->y - 1.001) / (newy - 1.0);
-  skipx = 4 * ibuf->x;
+  ScaleLinesData data = {
+      .rect = (const uchar *)ibuf->rect,
+      .newrect = _newrect,
+      .rectf = ibuf->rect_float,
+      .newrectf = _newrectf,
+      .x = ibuf->x,
+      .y = ibuf->y,
+      .newsize = newy,
+      .add = (ibuf->y - 1.001) / (newy - 1.0),
+  };
 
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (x = ibuf->x; x > 0; x--) {
-
-    sample = 0;
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-      newrect = _newrect + 4 * (x - 1);
-
-      val_a = rect[0];
-      nval_a = rect[skipx];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[skipx + 1];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[skipx + 2];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[skipx + 3];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 2 * skipx;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + 4 * (x - 1);
-      newrectf = _newrectf + 4 * (x - 1);
-
-      val_af = rectf[0];
-      nval_af = rectf[skipx];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[skipx + 1];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[skipx + 2];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[skipx + 3];
-      diff_rf = nval_rf - val_rf;
-
-      rectf += 2 * skipx;
-    }
-
-    for (y = newy; y > 0; y--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += skipx;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += skipx;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += skipx;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += skipx;
-      }
-      sample += add;
-    }
-  }
+  TaskParallelSettings settings;
+  scale_lines_settings(&settings, ibuf);
+  BLI_task_parallel_range(
+      0, scale_column_blocks_num(ibuf), &data, scaleupy_column_block_cb, &settings);
 
-  if (do_rect) {
+  if (_newrect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
     ibuf->rect = (unsigned int *)_newrect;
   }
-  if (do_float) {
+  if (_newrectf) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
     ibuf->rect_float = (float *)_newrectf;
@@ -1661,23 +1677,57 @@ struct imbufRGBA {
   float r, g, b, a;
 };
 
+typedef struct ScaleFastData {
+  const ImBuf *ibuf;
+  unsigned int *newrect;
+  struct imbufRGBA *newrectf;
+  int newx;
+  size_t stepx, stepy;
+} ScaleFastData;
+
+static void scalefast_line_cb(void *__restrict userdata,
+                              const int line,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleFastData *data = userdata;
+  const ImBuf *ibuf = data->ibuf;
+  const size_t ofsy = 32768 + line * data->stepy;
+  size_t ofsx;
+  int x;
+
+  if (data->newrect) {
+    const unsigned int *rect = ibuf->rect + (ofsy >> 16) * ibuf->x;
+    unsigned int *newrect = data->newrect + (size_t)line * data->newx;
+    ofsx = 32768;
+
+    for (x = data->newx; x > 0; x--, ofsx += data->stepx) {
+      *newrect++ = rect[ofsx >> 16];
+    }
+  }
+
+  if (data->newrectf) {
+    const struct imbufRGBA *rectf = (const struct imbufRGBA *)ibuf->rect_float +
+                                    (ofsy >> 16) * ibuf->x;
+    struct imbufRGBA *newrectf = data->newrectf + (size_t)line * data->newx;
+    ofsx = 32768;
+
+    for (x = data->newx; x > 0; x--, ofsx += data->stepx) {
+      *newrectf++ = rectf[ofsx >> 16];
+    }
+  }
+}
+
 /**
  * Return true if \a ibuf is modified.
  */
 bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-  unsigned int *rect, *_newrect, *newrect;
-  struct imbufRGBA *rectf, *_newrectf, *newrectf;
-  int x, y;
+  unsigned int *_newrect;
+  struct imbufRGBA *_newrectf;
   bool do_float = false, do_rect = false;
-  size_t ofsx, ofsy, stepx, stepy;
 
-  rect = NULL;
   _newrect = NULL;
-  newrect = NULL;
-  rectf = NULL;
   _newrectf = NULL;
-  newrectf = NULL;
 
   if (ibuf == NULL) {
     return false;
@@ -1701,7 +1751,6 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
     if (_newrect == NULL) {
       return false;
     }
-    newrect = _newrect;
   }
 
   if (do_float) {
@@ -1712,34 +1761,21 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
       }
       return false;
     }
-    newrectf = _newrectf;
   }
 
-  stepx = round(65536.0 * (ibuf->x - 1.0) / (newx - 1.0));
-  stepy = round(65536.0 * (ibuf->y - 1.0) / (newy - 1.0));
-  ofsy = 32768;
-
-  for (y = newy; y > 0; y--, ofsy += stepy) {
-    if (do_rect) {
-      rect = ibuf->rect;
-      rect += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newrect++ = rect[ofsx >> 16];
-      }
-    }
+  ScaleFastData data = {
+      .ibuf = ibuf,
+      .newrect = _newrect,
+      .newrectf = _newrectf,
+      .newx = newx,
+      .stepx = round(65536.0 * (ibuf->x - 1.0) / (newx - 1.0)),
+      .stepy = round(65536.0 * (ibuf->y - 1.0) / (newy - 1.0)),
+  };
 
-    if (do_float) {
-      rectf = (struct imbufRGBA *)ibuf->rect_float;
-      rectf += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newrectf++ = rectf[ofsx >> 16];
-      }
-    }
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = ((size_t)newx * newy) > SCALE_THREADED_MIN_PIXELS;
+  BLI_task_parallel_range(0, newy, &data, scalefast_line_cb, &settings);
 
   if (do_rect) {
     imb_freerectImBuf(ibuf);
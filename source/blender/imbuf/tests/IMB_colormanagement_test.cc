@@ -0,0 +1,108 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#include "MEM_guardedalloc.h"
+
+#include "CLG_log.h"
+
+#include "BKE_appdir.h"
+#include "BKE_colortools.h"
+
+#include "DNA_color_types.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
+
+/* More pixels than evaluating the processor for the largest display LUT takes, so the display
+ * buffer is converted through the baked LUT. */
+static const int image_width = 1024;
+static const int image_height = 576;
+
+class ImBufColormanagementTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_appdir_init();
+    IMB_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    /* The display buffer cache creates the cache limiter on first use. */
+    IMB_moviecache_destruct();
+    IMB_exit();
+    BKE_appdir_exit();
+    CLG_exit();
+  }
+};
+
+/* Scene linear colors spanning the range of the LUT shaper, with some pixels outside of it. */
+static ImBuf *create_test_image()
+{
+  ImBuf *ibuf = IMB_allocImBuf(image_width, image_height, 32, IB_rectfloat);
+  float *rectf = ibuf->rect_float;
+
+  for (int y = 0; y < image_height; y++) {
+    for (int x = 0; x < image_width; x++) {
+      float *pixel = rectf + 4 * ((size_t)y * image_width + x);
+      pixel[0] = exp2f(-16.0f + 22.0f * x / (image_width - 1));
+      pixel[1] = exp2f(-16.0f + 22.0f * y / (image_height - 1));
+      pixel[2] = (float)((x * 7 + y * 13) % 256) / 64.0f;
+      pixel[3] = 1.0f;
+      if (x % 97 == 0) {
+        pixel[0] = -0.25f;
+      }
+      if (y % 89 == 0) {
+        pixel[1] = 100.0f;
+      }
+    }
+  }
+
+  return ibuf;
+}
+
+TEST_F(ImBufColormanagementTest, DisplayBufferMatchesProcessor)
+{
+  ImBuf *ibuf = create_test_image();
+
+  ColorManagedDisplaySettings display_settings;
+  ColorManagedViewSettings view_settings;
+  BKE_color_managed_display_settings_init(&display_settings);
+  BKE_color_managed_view_settings_init_render(&view_settings, &display_settings, nullptr);
+
+  void *cache_handle;
+  const unsigned char *display_buffer = IMB_display_buffer_acquire(
+      ibuf, &view_settings, &display_settings, &cache_handle);
+  ASSERT_NE(display_buffer, nullptr);
+
+  /* Directly through the processor, without the LUT. */
+  unsigned char *expected = (unsigned char *)MEM_mallocN(
+      sizeof(unsigned char[4]) * image_width * image_height, __func__);
+  IMB_display_buffer_transform_apply(expected,
+                                     ibuf->rect_float,
+                                     image_width,
+                                     image_height,
+                                     4,
+                                     &view_settings,
+                                     &display_settings,
+                                     false);
+
+  /* The LUT is accurate to half of a display step, rounding can differ by one step. */
+  int mismatch_num = 0;
+  for (size_t i = 0; i < sizeof(unsigned char[4]) * image_width * image_height; i++) {
+    mismatch_num += abs(display_buffer[i] - expected[i]) > 1;
+  }
+  EXPECT_EQ(mismatch_num, 0);
+
+  MEM_freeN(expected);
+  IMB_display_buffer_release(cache_handle);
+  BKE_color_managed_view_settings_free(&view_settings);
+  IMB_freeImBuf(ibuf);
+}
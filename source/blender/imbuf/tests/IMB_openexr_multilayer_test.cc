@@ -0,0 +1,186 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <string>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "DNA_scene_types.h"
+
+#include "intern/openexr/openexr_multi.h"
+
+using blender::Vector;
+
+static const int image_width = 256;
+static const int image_height = 128;
+
+class ImBufOpenEXRMultilayerTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    BKE_tempdir_init(nullptr);
+  }
+
+  static void TearDownTestSuite()
+  {
+    BKE_tempdir_session_purge();
+  }
+};
+
+struct PassInfo {
+  const char *name;
+  const char *channels;
+};
+
+/* A render like file with passes of different channel counts in one layer. */
+static const PassInfo test_passes[] = {
+    {"Combined", "RGBA"},
+    {"Depth", "Z"},
+    {"Normal", "XYZ"},
+    {"Emit", "RGB"},
+};
+
+static float test_pass_value(const int pass_index, const int channel, const int pixel)
+{
+  return (float)(pass_index * 10 + channel) + (float)(pixel % 97) * 0.25f;
+}
+
+static std::string write_test_file()
+{
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "multilayer.exr");
+
+  const int pixels_num = image_width * image_height;
+  void *handle = IMB_exr_get_handle();
+  float *rects[ARRAY_SIZE(test_passes)];
+
+  for (int i = 0; i < (int)ARRAY_SIZE(test_passes); i++) {
+    const int channels_num = strlen(test_passes[i].channels);
+    rects[i] = (float *)MEM_malloc_arrayN(pixels_num * channels_num, sizeof(float), __func__);
+    for (int pixel = 0; pixel < pixels_num; pixel++) {
+      for (int c = 0; c < channels_num; c++) {
+        rects[i][pixel * channels_num + c] = test_pass_value(i, c, pixel);
+      }
+    }
+    for (int c = 0; c < channels_num; c++) {
+      char passname[EXR_PASS_MAXNAME];
+      BLI_snprintf(
+          passname, sizeof(passname), "%s.%c", test_passes[i].name, test_passes[i].channels[c]);
+      IMB_exr_add_channel(handle,
+                          "ViewLayer",
+                          passname,
+                          "",
+                          channels_num,
+                          channels_num * image_width,
+                          rects[i] + c,
+                          false);
+    }
+  }
+
+  EXPECT_TRUE(IMB_exr_begin_write(
+      handle, filepath, image_width, image_height, R_IMF_EXR_CODEC_ZIP, nullptr));
+  IMB_exr_write_channels(handle);
+  IMB_exr_close(handle);
+
+  for (int i = 0; i < (int)ARRAY_SIZE(test_passes); i++) {
+    MEM_freeN(rects[i]);
+  }
+  return filepath;
+}
+
+struct ReadPasses {
+  Vector<std::string> names;
+  Vector<float *> rects;
+  Vector<int> channels_num;
+};
+
+static void *read_passes_addview(void * /*base*/, const char * /*view_name*/)
+{
+  return nullptr;
+}
+
+static void *read_passes_addlayer(void *base, const char * /*layer_name*/)
+{
+  return base;
+}
+
+static void read_passes_addpass(void *base,
+                                void * /*lay*/,
+                                const char *pass_name,
+                                float *rect,
+                                int channels_num,
+                                const char * /*chan_id*/,
+                                const char * /*view_name*/)
+{
+  ReadPasses *passes = (ReadPasses *)base;
+  passes->names.append(pass_name);
+  passes->rects.append(rect);
+  passes->channels_num.append(channels_num);
+}
+
+TEST_F(ImBufOpenEXRMultilayerTest, ReadRequestedPasses)
+{
+  const std::string filepath = write_test_file();
+  const int pixels_num = image_width * image_height;
+
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  const char *pass_names[] = {"Normal"};
+  int width, height;
+  void *handle = IMB_exr_read_multilayer_passes(
+      filepath.c_str(), pass_names, ARRAY_SIZE(pass_names), &width, &height);
+  ASSERT_NE(handle, nullptr);
+  EXPECT_EQ(width, image_width);
+  EXPECT_EQ(height, image_height);
+
+  /* Only the requested pass got a buffer, unrequested passes are not allocated. */
+  EXPECT_NE(IMB_exr_channel_rect(handle, "ViewLayer", "Normal.X", nullptr), nullptr);
+  EXPECT_EQ(IMB_exr_channel_rect(handle, "ViewLayer", "Combined.R", nullptr), nullptr);
+  EXPECT_EQ(IMB_exr_channel_rect(handle, "ViewLayer", "Depth.Z", nullptr), nullptr);
+  EXPECT_EQ(IMB_exr_channel_rect(handle, "ViewLayer", "Emit.G", nullptr), nullptr);
+  EXPECT_LT(MEM_get_memory_in_use() - mem_in_use, pixels_num * sizeof(float[4]));
+
+  ReadPasses passes;
+  IMB_exr_multilayer_convert(
+      handle, &passes, read_passes_addview, read_passes_addlayer, read_passes_addpass);
+  IMB_exr_close(handle);
+
+  ASSERT_EQ(passes.names.size(), 1);
+  EXPECT_EQ(passes.names[0], "Normal");
+  ASSERT_EQ(passes.channels_num[0], 3);
+  for (int pixel = 0; pixel < pixels_num; pixel++) {
+    for (int c = 0; c < 3; c++) {
+      EXPECT_EQ(passes.rects[0][pixel * 3 + c], test_pass_value(2, c, pixel));
+    }
+  }
+  MEM_freeN(passes.rects[0]);
+}
+
+TEST_F(ImBufOpenEXRMultilayerTest, ReadAllPasses)
+{
+  const std::string filepath = write_test_file();
+
+  const char *pass_names[] = {"Combined", "Depth", "Normal", "Emit"};
+  int width, height;
+  void *handle = IMB_exr_read_multilayer_passes(
+      filepath.c_str(), pass_names, ARRAY_SIZE(pass_names), &width, &height);
+  ASSERT_NE(handle, nullptr);
+
+  ReadPasses passes;
+  IMB_exr_multilayer_convert(
+      handle, &passes, read_passes_addview, read_passes_addlayer, read_passes_addpass);
+  IMB_exr_close(handle);
+
+  EXPECT_EQ(passes.names.size(), ARRAY_SIZE(test_passes));
+  for (float *rect : passes.rects) {
+    MEM_freeN(rect);
+  }
+}
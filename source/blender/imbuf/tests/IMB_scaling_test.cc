@@ -0,0 +1,137 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "intern/IMB_allocimbuf.h"
+
+/* Large enough for the scaling and filter functions to use threads. */
+static const int source_width = 512;
+static const int source_height = 384;
+
+/* Only the reference counting lock is needed, #IMB_init would also initialize color management. */
+class ImBufScalingTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    imb_refcounter_lock_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    imb_refcounter_lock_exit();
+  }
+};
+
+static ImBuf *create_test_image(bool gradient)
+{
+  ImBuf *ibuf = IMB_allocImBuf(source_width, source_height, 32, IB_rect | IB_rectfloat);
+  unsigned char *rect = (unsigned char *)ibuf->rect;
+  float *rectf = ibuf->rect_float;
+
+  for (int y = 0; y < source_height; y++) {
+    for (int x = 0; x < source_width; x++) {
+      const float value = gradient ? (float)x / (source_width - 1) : 0.5f;
+      const size_t offset = 4 * ((size_t)y * source_width + x);
+      for (int c = 0; c < 4; c++) {
+        rectf[offset + c] = value;
+        rect[offset + c] = (unsigned char)(value * 255.0f + 0.5f);
+      }
+    }
+  }
+
+  return ibuf;
+}
+
+static void expect_constant(const ImBuf *ibuf, float value, float tolerance)
+{
+  const unsigned char byte_value = (unsigned char)(value * 255.0f + 0.5f);
+  const size_t num_components = 4 * (size_t)ibuf->x * ibuf->y;
+
+  for (size_t i = 0; i < num_components; i++) {
+    EXPECT_NEAR(ibuf->rect_float[i], value, tolerance);
+    EXPECT_NEAR(((unsigned char *)ibuf->rect)[i], byte_value, 1);
+  }
+}
+
+/* Rows of a horizontal gradient have to stay identical and keep increasing. */
+static void expect_horizontal_gradient(const ImBuf *ibuf)
+{
+  const unsigned char *rect = (const unsigned char *)ibuf->rect;
+  const float *rectf = ibuf->rect_float;
+
+  for (int y = 0; y < ibuf->y; y++) {
+    for (int x = 0; x < ibuf->x; x++) {
+      const size_t offset = 4 * ((size_t)y * ibuf->x + x);
+      EXPECT_FLOAT_EQ(rectf[offset], rectf[4 * (size_t)x]);
+      EXPECT_EQ(rect[offset], rect[4 * (size_t)x]);
+      if (x > 0) {
+        EXPECT_GE(rectf[offset], rectf[offset - 4]);
+        EXPECT_GE(rect[offset], rect[offset - 4]);
+      }
+    }
+  }
+}
+
+TEST_F(ImBufScalingTest, ScaleDownConstant)
+{
+  ImBuf *ibuf = create_test_image(false);
+  EXPECT_TRUE(IMB_scaleImBuf(ibuf, 200, 150));
+  EXPECT_EQ(ibuf->x, 200);
+  EXPECT_EQ(ibuf->y, 150);
+  expect_constant(ibuf, 0.5f, 1e-5f);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImBufScalingTest, ScaleUpConstant)
+{
+  ImBuf *ibuf = create_test_image(false);
+  EXPECT_TRUE(IMB_scaleImBuf(ibuf, 1000, 700));
+  EXPECT_EQ(ibuf->x, 1000);
+  EXPECT_EQ(ibuf->y, 700);
+  expect_constant(ibuf, 0.5f, 1e-5f);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImBufScalingTest, ScaleGradient)
+{
+  ImBuf *ibuf = create_test_image(true);
+  EXPECT_TRUE(IMB_scaleImBuf(ibuf, 300, 200));
+  expect_horizontal_gradient(ibuf);
+  EXPECT_NEAR(ibuf->rect_float[0], 0.0f, 0.01f);
+  EXPECT_NEAR(ibuf->rect_float[4 * (ibuf->x - 1)], 1.0f, 0.01f);
+
+  EXPECT_TRUE(IMB_scaleImBuf(ibuf, 900, 600));
+  expect_horizontal_gradient(ibuf);
+  EXPECT_NEAR(ibuf->rect_float[0], 0.0f, 0.01f);
+  EXPECT_NEAR(ibuf->rect_float[4 * (ibuf->x - 1)], 1.0f, 0.01f);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImBufScalingTest, ScaleFastNearest)
+{
+  ImBuf *ibuf = create_test_image(true);
+  EXPECT_TRUE(IMB_scalefastImBuf(ibuf, 256, 192));
+  EXPECT_EQ(ibuf->x, 256);
+  EXPECT_EQ(ibuf->y, 192);
+  expect_horizontal_gradient(ibuf);
+
+  /* Nearest neighbor keeps the exact source values. */
+  for (int x = 0; x < ibuf->x; x++) {
+    const float value = ibuf->rect_float[4 * x];
+    const float source_x = value * (source_width - 1);
+    EXPECT_NEAR(source_x, std::round(source_x), 1e-3f);
+  }
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(ImBufScalingTest, FilterConstant)
+{
+  ImBuf *ibuf = create_test_image(false);
+  IMB_filter(ibuf);
+  expect_constant(ibuf, 0.5f, 1e-5f);
+  IMB_freeImBuf(ibuf);
+}
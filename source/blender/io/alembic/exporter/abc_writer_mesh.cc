@@ -115,6 +115,7 @@ void ABCGenericMeshWriter::create_alembic_objects(const HierarchyContext *contex
 
 ABCGenericMeshWriter::~ABCGenericMeshWriter()
 {
+  free_deferred_sample();
 }
 
 Alembic::Abc::OObject ABCGenericMeshWriter::get_alembic_object() const
@@ -176,32 +177,64 @@ void ABCGenericMeshWriter::do_write(HierarchyContext &context)
   Object *object = context.object;
   bool needsfree = false;
 
+  /* Not every type of object can create its export mesh from multiple threads, so only gathering
+   * the data of the mesh is deferred. */
   Mesh *mesh = get_export_mesh(object, needsfree);
 
   if (mesh == nullptr) {
     return;
   }
 
-  if (args_.export_params->triangulate) {
-    const bool tag_only = false;
-    const int quad_method = args_.export_params->quad_method;
-    const int ngon_method = args_.export_params->ngon_method;
+  free_deferred_sample();
+  deferred_sample_ = std::make_unique<DeferredSample>();
+  deferred_sample_->object = object;
+  deferred_sample_->mesh = mesh;
+  deferred_sample_->mesh_needs_free = needsfree;
+  deferred_sample_->is_first_frame = !frame_has_been_written_;
+}
 
-    struct BMeshCreateParams bmcp = {false};
-    struct BMeshFromMeshParams bmfmp = {true, false, false, 0};
-    BMesh *bm = BKE_mesh_to_bmesh_ex(mesh, &bmcp, &bmfmp);
+bool ABCGenericMeshWriter::has_deferred_sample() const
+{
+  return deferred_sample_ != nullptr;
+}
 
-    BM_mesh_triangulate(bm, quad_method, ngon_method, 4, tag_only, nullptr, nullptr, nullptr);
+void ABCGenericMeshWriter::triangulate_deferred_mesh()
+{
+  DeferredSample &sample = *deferred_sample_;
+  const bool tag_only = false;
+  const int quad_method = args_.export_params->quad_method;
+  const int ngon_method = args_.export_params->ngon_method;
 
-    Mesh *triangulated_mesh = BKE_mesh_from_bmesh_for_eval_nomain(bm, nullptr, mesh);
-    BM_mesh_free(bm);
+  struct BMeshCreateParams bmcp = {false};
+  struct BMeshFromMeshParams bmfmp = {true, false, false, 0};
+  BMesh *bm = BKE_mesh_to_bmesh_ex(sample.mesh, &bmcp, &bmfmp);
 
-    if (needsfree) {
-      free_export_mesh(mesh);
-    }
-    mesh = triangulated_mesh;
-    needsfree = true;
+  BM_mesh_triangulate(bm, quad_method, ngon_method, 4, tag_only, nullptr, nullptr, nullptr);
+
+  Mesh *triangulated_mesh = BKE_mesh_from_bmesh_for_eval_nomain(bm, nullptr, sample.mesh);
+  BM_mesh_free(bm);
+
+  if (sample.mesh_needs_free) {
+    free_export_mesh(sample.mesh);
   }
+  sample.mesh = triangulated_mesh;
+  sample.mesh_needs_free = true;
+}
+
+void ABCGenericMeshWriter::prepare_deferred_sample()
+{
+  DeferredSample &sample = *deferred_sample_;
+
+  if (args_.export_params->triangulate) {
+    triangulate_deferred_mesh();
+  }
+  else if (args_.export_params->normals && !is_subd_ && !sample.mesh_needs_free) {
+    /* Computing split normals adds a layer to the mesh, the evaluated mesh can be shared with
+     * other writers. A shallow copy owns its layers while referencing the data. */
+    sample.mesh = BKE_mesh_copy_for_eval(sample.mesh, true);
+    sample.mesh_needs_free = true;
+  }
+  Mesh *mesh = sample.mesh;
 
   m_custom_data_config.pack_uvs = args_.export_params->packuv;
   m_custom_data_config.mpoly = mesh->mpoly;
@@ -210,24 +243,54 @@ void ABCGenericMeshWriter::do_write(HierarchyContext &context)
   m_custom_data_config.totloop = mesh->totloop;
   m_custom_data_config.totvert = mesh->totvert;
 
+  get_vertices(mesh, sample.points);
+  get_topology(mesh, sample.poly_verts, sample.loop_counts, sample.has_flat_shaded_poly);
+
+  if (sample.is_first_frame && args_.export_params->uvs) {
+    sample.uv_source_name = get_uv_sample(
+        sample.uvs_and_indices, m_custom_data_config, &mesh->ldata);
+  }
+
+  if (is_subd_) {
+    get_creases(mesh, sample.crease_indices, sample.crease_lengths, sample.crease_sharpness);
+    return;
+  }
+
+  if (args_.export_params->normals) {
+    get_loop_normals(mesh, sample.normals, sample.has_flat_shaded_poly);
+  }
+
+  if (liquid_sim_modifier_ != nullptr) {
+    get_velocities(mesh, sample.velocities);
+  }
+}
+
+void ABCGenericMeshWriter::write_deferred_sample()
+{
   try {
     if (is_subd_) {
-      write_subd(context, mesh);
+      write_subd(*deferred_sample_);
     }
     else {
-      write_mesh(context, mesh);
-    }
-
-    if (needsfree) {
-      free_export_mesh(mesh);
+      write_mesh(*deferred_sample_);
     }
   }
   catch (...) {
-    if (needsfree) {
-      free_export_mesh(mesh);
-    }
+    free_deferred_sample();
     throw;
   }
+  free_deferred_sample();
+}
+
+void ABCGenericMeshWriter::free_deferred_sample()
+{
+  if (deferred_sample_ == nullptr) {
+    return;
+  }
+  if (deferred_sample_->mesh_needs_free) {
+    free_export_mesh(deferred_sample_->mesh);
+  }
+  deferred_sample_.reset();
 }
 
 void ABCGenericMeshWriter::free_export_mesh(Mesh *mesh)
@@ -235,27 +298,21 @@ void ABCGenericMeshWriter::free_export_mesh(Mesh *mesh)
   BKE_id_free(nullptr, mesh);
 }
 
-void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
+void ABCGenericMeshWriter::write_mesh(DeferredSample &sample)
 {
-  std::vector<Imath::V3f> points, normals;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<Imath::V3f> velocities;
-  bool has_flat_shaded_poly = false;
-
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, has_flat_shaded_poly);
+  Mesh *mesh = sample.mesh;
 
-  if (!frame_has_been_written_ && args_.export_params->face_sets) {
-    write_face_sets(context.object, mesh, abc_poly_mesh_schema_);
+  if (sample.is_first_frame && args_.export_params->face_sets) {
+    write_face_sets(sample.object, mesh, abc_poly_mesh_schema_);
   }
 
   OPolyMeshSchema::Sample mesh_sample = OPolyMeshSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
-
-  UVSample uvs_and_indices;
+      V3fArraySample(sample.points),
+      Int32ArraySample(sample.poly_verts),
+      Int32ArraySample(sample.loop_counts));
 
-  if (!frame_has_been_written_ && args_.export_params->uvs) {
-    const char *name = get_uv_sample(uvs_and_indices, m_custom_data_config, &mesh->ldata);
+  if (sample.is_first_frame && args_.export_params->uvs) {
+    const UVSample &uvs_and_indices = sample.uvs_and_indices;
 
     if (!uvs_and_indices.indices.empty() && !uvs_and_indices.uvs.empty()) {
       OV2fGeomParam::Sample uv_sample;
@@ -263,7 +320,7 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
       uv_sample.setIndices(UInt32ArraySample(uvs_and_indices.indices));
       uv_sample.setScope(kFacevaryingScope);
 
-      abc_poly_mesh_schema_.setUVSourceName(name);
+      abc_poly_mesh_schema_.setUVSourceName(sample.uv_source_name);
       mesh_sample.setUVs(uv_sample);
     }
 
@@ -272,60 +329,49 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
   }
 
   if (args_.export_params->normals) {
-    get_loop_normals(mesh, normals, has_flat_shaded_poly);
-
     ON3fGeomParam::Sample normals_sample;
-    if (!normals.empty()) {
+    if (!sample.normals.empty()) {
       normals_sample.setScope(kFacevaryingScope);
-      normals_sample.setVals(V3fArraySample(normals));
+      normals_sample.setVals(V3fArraySample(sample.normals));
     }
 
     mesh_sample.setNormals(normals_sample);
   }
 
   if (liquid_sim_modifier_ != nullptr) {
-    get_velocities(mesh, velocities);
-    mesh_sample.setVelocities(V3fArraySample(velocities));
+    mesh_sample.setVelocities(V3fArraySample(sample.velocities));
   }
 
-  update_bounding_box(context.object);
+  update_bounding_box(sample.object);
   mesh_sample.setSelfBounds(bounding_box_);
 
   abc_poly_mesh_schema_.set(mesh_sample);
 
-  write_arb_geo_params(mesh);
+  write_arb_geo_params(sample);
 }
 
-void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *mesh)
+void ABCGenericMeshWriter::write_subd(DeferredSample &sample)
 {
-  std::vector<float> crease_sharpness;
-  std::vector<Imath::V3f> points;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<int32_t> crease_indices, crease_lengths;
-  bool has_flat_poly = false;
-
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, has_flat_poly);
-  get_creases(mesh, crease_indices, crease_lengths, crease_sharpness);
+  Mesh *mesh = sample.mesh;
 
-  if (!frame_has_been_written_ && args_.export_params->face_sets) {
-    write_face_sets(context.object, mesh, abc_subdiv_schema_);
+  if (sample.is_first_frame && args_.export_params->face_sets) {
+    write_face_sets(sample.object, mesh, abc_subdiv_schema_);
   }
 
-  OSubDSchema::Sample subdiv_sample = OSubDSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+  OSubDSchema::Sample subdiv_sample = OSubDSchema::Sample(V3fArraySample(sample.points),
+                                                          Int32ArraySample(sample.poly_verts),
+                                                          Int32ArraySample(sample.loop_counts));
 
-  UVSample sample;
-  if (!frame_has_been_written_ && args_.export_params->uvs) {
-    const char *name = get_uv_sample(sample, m_custom_data_config, &mesh->ldata);
+  if (sample.is_first_frame && args_.export_params->uvs) {
+    const UVSample &uvs_and_indices = sample.uvs_and_indices;
 
-    if (!sample.indices.empty() && !sample.uvs.empty()) {
+    if (!uvs_and_indices.indices.empty() && !uvs_and_indices.uvs.empty()) {
       OV2fGeomParam::Sample uv_sample;
-      uv_sample.setVals(V2fArraySample(sample.uvs));
-      uv_sample.setIndices(UInt32ArraySample(sample.indices));
+      uv_sample.setVals(V2fArraySample(uvs_and_indices.uvs));
+      uv_sample.setIndices(UInt32ArraySample(uvs_and_indices.indices));
       uv_sample.setScope(kFacevaryingScope);
 
-      abc_subdiv_schema_.setUVSourceName(name);
+      abc_subdiv_schema_.setUVSourceName(sample.uv_source_name);
       subdiv_sample.setUVs(uv_sample);
     }
 
@@ -333,17 +379,17 @@ void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *me
         abc_subdiv_schema_.getArbGeomParams(), m_custom_data_config, &mesh->ldata, CD_MLOOPUV);
   }
 
-  if (!crease_indices.empty()) {
-    subdiv_sample.setCreaseIndices(Int32ArraySample(crease_indices));
-    subdiv_sample.setCreaseLengths(Int32ArraySample(crease_lengths));
-    subdiv_sample.setCreaseSharpnesses(FloatArraySample(crease_sharpness));
+  if (!sample.crease_indices.empty()) {
+    subdiv_sample.setCreaseIndices(Int32ArraySample(sample.crease_indices));
+    subdiv_sample.setCreaseLengths(Int32ArraySample(sample.crease_lengths));
+    subdiv_sample.setCreaseSharpnesses(FloatArraySample(sample.crease_sharpness));
   }
 
-  update_bounding_box(context.object);
+  update_bounding_box(sample.object);
   subdiv_sample.setSelfBounds(bounding_box_);
   abc_subdiv_schema_.set(subdiv_sample);
 
-  write_arb_geo_params(mesh);
+  write_arb_geo_params(sample);
 }
 
 template<typename Schema>
@@ -361,14 +407,14 @@ void ABCGenericMeshWriter::write_face_sets(Object *object, struct Mesh *mesh, Sc
   }
 }
 
-void ABCGenericMeshWriter::write_arb_geo_params(struct Mesh *me)
+void ABCGenericMeshWriter::write_arb_geo_params(const DeferredSample &sample)
 {
   if (liquid_sim_modifier_ != nullptr) {
     /* We don't need anything more for liquid meshes. */
     return;
   }
 
-  if (frame_has_been_written_ || !args_.export_params->vcolors) {
+  if (!sample.is_first_frame || !args_.export_params->vcolors) {
     return;
   }
 
@@ -379,7 +425,7 @@ void ABCGenericMeshWriter::write_arb_geo_params(struct Mesh *me)
   else {
     arb_geom_params = abc_poly_mesh_.getSchema().getArbGeomParams();
   }
-  write_custom_data(arb_geom_params, m_custom_data_config, &me->ldata, CD_MLOOPCOL);
+  write_custom_data(arb_geom_params, m_custom_data_config, &sample.mesh->ldata, CD_MLOOPCOL);
 }
 
 void ABCGenericMeshWriter::get_velocities(struct Mesh *mesh, std::vector<Imath::V3f> &vels)
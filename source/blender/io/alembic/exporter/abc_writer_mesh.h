@@ -25,6 +25,10 @@
 #include <Alembic/AbcGeom/OPolyMesh.h>
 #include <Alembic/AbcGeom/OSubD.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 struct ModifierData;
 
 namespace blender::io::alembic {
@@ -49,6 +53,28 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
 
   CDStreamConfig m_custom_data_config;
 
+  /* Data of the sample of the current frame,
+   * see AbstractHierarchyWriter::has_deferred_sample(). */
+  struct DeferredSample {
+    Object *object = nullptr;
+    Mesh *mesh = nullptr;
+    bool mesh_needs_free = false;
+    /* Copied from frame_has_been_written_, which is already set by the time the sample is
+     * written. */
+    bool is_first_frame = false;
+
+    std::vector<Imath::V3f> points;
+    std::vector<int32_t> poly_verts, loop_counts;
+    bool has_flat_shaded_poly = false;
+    std::vector<Imath::V3f> normals;
+    std::vector<Imath::V3f> velocities;
+    std::vector<int32_t> crease_indices, crease_lengths;
+    std::vector<float> crease_sharpness;
+    UVSample uvs_and_indices;
+    std::string uv_source_name;
+  };
+  std::unique_ptr<DeferredSample> deferred_sample_;
+
  public:
   explicit ABCGenericMeshWriter(const ABCWriterConstructorArgs &args);
   virtual ~ABCGenericMeshWriter();
@@ -57,6 +83,10 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
   virtual Alembic::Abc::OObject get_alembic_object() const override;
   Alembic::Abc::OCompoundProperty abc_prop_for_custom_props() override;
 
+  virtual bool has_deferred_sample() const override;
+  virtual void prepare_deferred_sample() override;
+  virtual void write_deferred_sample() override;
+
  protected:
   virtual bool is_supported(const HierarchyContext *context) const override;
   virtual void do_write(HierarchyContext &context) override;
@@ -67,13 +97,15 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
   virtual bool export_as_subdivision_surface(Object *ob_eval) const;
 
  private:
-  void write_mesh(HierarchyContext &context, Mesh *mesh);
-  void write_subd(HierarchyContext &context, Mesh *mesh);
+  void triangulate_deferred_mesh();
+  void free_deferred_sample();
+  void write_mesh(DeferredSample &sample);
+  void write_subd(DeferredSample &sample);
   template<typename Schema> void write_face_sets(Object *object, Mesh *mesh, Schema &schema);
 
   ModifierData *get_liquid_sim_modifier(Scene *scene_eval, Object *ob_eval);
 
-  void write_arb_geo_params(Mesh *me);
+  void write_arb_geo_params(const DeferredSample &sample);
   void get_velocities(Mesh *mesh, std::vector<Imath::V3f> &vels);
   void get_geo_groups(Object *object,
                       Mesh *mesh,
@@ -27,11 +27,14 @@
 
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #ifdef WIN32
 #  include "utfconv.h"
 #endif
 
+#include <algorithm>
 #include <fstream>
 
 using Alembic::Abc::ErrorHandler;
@@ -41,6 +44,15 @@ using Alembic::Abc::kWrapExisting;
 
 namespace blender::io::alembic {
 
+/* Prefetch tasks run on all threads of the task scheduler, a stream for each of them lets every
+ * thread read at the same time. Capped since every stream keeps a file handle open. */
+static const int max_archive_streams = 16;
+
+static int num_archive_streams()
+{
+  return std::min(BLI_system_thread_count(), max_archive_streams);
+}
+
 static IArchive open_archive(const std::string &filename,
                              const std::vector<std::istream *> &input_streams)
 {
@@ -76,26 +88,55 @@ static IArchive open_archive(const std::string &filename,
   return IArchive();
 }
 
-ArchiveReader::ArchiveReader(struct Main *bmain, const char *filename)
+ArchiveReader::ArchiveReader(struct Main *bmain, const char *filename) : m_prefetch_pool(nullptr)
 {
   char abs_filename[FILE_MAX];
   BLI_strncpy(abs_filename, filename, FILE_MAX);
   BLI_path_abs(abs_filename, BKE_main_blendfile_path(bmain));
 
+  const int streams_num = num_archive_streams();
+  for (int i = 0; i < streams_num; i++) {
+    std::unique_ptr<std::ifstream> infile = std::make_unique<std::ifstream>();
 #ifdef WIN32
-  UTF16_ENCODE(abs_filename);
-  std::wstring wstr(abs_filename_16);
-  m_infile.open(wstr.c_str(), std::ios::in | std::ios::binary);
-  UTF16_UN_ENCODE(abs_filename);
+    UTF16_ENCODE(abs_filename);
+    std::wstring wstr(abs_filename_16);
+    infile->open(wstr.c_str(), std::ios::in | std::ios::binary);
+    UTF16_UN_ENCODE(abs_filename);
 #else
-  m_infile.open(abs_filename, std::ios::in | std::ios::binary);
+    infile->open(abs_filename, std::ios::in | std::ios::binary);
 #endif
-
-  m_streams.push_back(&m_infile);
+    if (!infile->is_open() && !m_streams.empty()) {
+      /* Out of file handles, read with the streams that could be opened. */
+      break;
+    }
+    m_streams.push_back(infile.get());
+    m_infiles.push_back(std::move(infile));
+  }
 
   m_archive = open_archive(abs_filename, m_streams);
 }
 
+ArchiveReader::~ArchiveReader()
+{
+  if (m_prefetch_pool != nullptr) {
+    BLI_task_pool_cancel(m_prefetch_pool);
+    BLI_task_pool_free(m_prefetch_pool);
+  }
+}
+
+TaskPool *ArchiveReader::prefetch_pool()
+{
+  /* Cache readers are opened while evaluating modifiers of different objects in parallel. */
+  std::lock_guard<std::mutex> lock(m_prefetch_pool_mutex);
+  if (m_prefetch_pool == nullptr) {
+    /* Scheduled by TBB like a regular pool, so tasks run on all threads. Unlike a regular pool it
+     * falls back to a single worker thread instead of running tasks as they're pushed when there
+     * is only one thread, so playback never waits for samples it didn't ask for. */
+    m_prefetch_pool = BLI_task_pool_create_background(nullptr, TASK_PRIORITY_LOW);
+  }
+  return m_prefetch_pool;
+}
+
 bool ArchiveReader::valid() const
 {
   return m_archive.valid();
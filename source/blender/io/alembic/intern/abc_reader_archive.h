@@ -26,8 +26,11 @@
 #include <Alembic/AbcCoreOgawa/All.h>
 
 #include <fstream>
+#include <memory>
+#include <mutex>
 
 struct Main;
+struct TaskPool;
 
 namespace blender::io::alembic {
 
@@ -38,15 +41,25 @@ namespace blender::io::alembic {
 
 class ArchiveReader {
   Alembic::Abc::IArchive m_archive;
-  std::ifstream m_infile;
+  /* Ogawa reads from a stream that isn't in use by another thread, multiple streams allow samples
+   * to be read concurrently. */
+  std::vector<std::unique_ptr<std::ifstream>> m_infiles;
   std::vector<std::istream *> m_streams;
 
+  /* Tasks reading samples ahead of playback for the cache readers of this archive. Created on
+   * first use, and waited for before the streams are closed. */
+  TaskPool *m_prefetch_pool;
+  std::mutex m_prefetch_pool_mutex;
+
  public:
   ArchiveReader(struct Main *bmain, const char *filename);
+  ~ArchiveReader();
 
   bool valid() const;
 
   Alembic::Abc::IObject getTop();
+
+  TaskPool *prefetch_pool();
 };
 
 }  // namespace blender::io::alembic
@@ -20,10 +20,14 @@
 
 #include "abc_reader_mesh.h"
 #include "abc_axis_conversion.h"
+#include "abc_reader_archive.h"
 #include "abc_reader_transform.h"
 #include "abc_util.h"
 
 #include <algorithm>
+#include <map>
+#include <mutex>
+#include <set>
 
 #include "MEM_guardedalloc.h"
 
@@ -35,6 +39,7 @@
 #include "BLI_compiler_compat.h"
 #include "BLI_listbase.h"
 #include "BLI_math_geom.h"
+#include "BLI_task.h"
 
 #include "BKE_main.h"
 #include "BKE_material.h"
@@ -56,6 +61,7 @@ using Alembic::AbcGeom::IPolyMesh;
 using Alembic::AbcGeom::IPolyMeshSchema;
 using Alembic::AbcGeom::ISampleSelector;
 using Alembic::AbcGeom::ISubD;
+using Alembic::AbcGeom::index_t;
 using Alembic::AbcGeom::ISubDSchema;
 using Alembic::AbcGeom::IV2fGeomParam;
 using Alembic::AbcGeom::kWrapExisting;
@@ -319,14 +325,13 @@ static void process_vertex_normals(CDStreamConfig &config,
 
 static void process_normals(CDStreamConfig &config,
                             const IN3fGeomParam &normals,
-                            const ISampleSelector &selector)
+                            const IN3fGeomParam::Sample &normsamp)
 {
   if (!normals.valid()) {
     process_no_normals(config);
     return;
   }
 
-  IN3fGeomParam::Sample normsamp = normals.getExpandedValue(selector);
   Alembic::AbcGeom::GeometryScope scope = normals.getScope();
 
   switch (scope) {
@@ -412,25 +417,114 @@ static void get_weight_and_index(CDStreamConfig &config,
   config.ceil_index = i1;
 }
 
+/* Data of a sample that changes on every frame of an animated mesh. The topology, UV's and other
+ * attributes are read from the schema when needed. */
+struct MeshSampleData {
+  IPolyMeshSchema::Sample sample;
+  IN3fGeomParam::Sample normals;
+};
+
+static std::shared_ptr<const MeshSampleData> read_sample_data(const IPolyMeshSchema &schema,
+                                                              const index_t index)
+{
+  std::shared_ptr<MeshSampleData> data = std::make_shared<MeshSampleData>();
+  const ISampleSelector selector(index);
+  schema.get(data->sample, selector);
+
+  const IN3fGeomParam normals = schema.getNormalsParam();
+  if (normals.valid()) {
+    data->normals = normals.getExpandedValue(selector);
+  }
+  return data;
+}
+
+/* Number of samples following the current one that are read ahead of playback. */
+static const index_t prefetch_samples_num = 8;
+
+/* Samples read ahead of playback by the prefetch tasks of the archive. Shared with the tasks, so
+ * that the reader can be freed while they are still running. */
+struct MeshSampleCache {
+  IPolyMeshSchema schema;
+
+  std::mutex mutex;
+  std::map<index_t, std::shared_ptr<const MeshSampleData>> samples;
+  std::set<index_t> samples_in_flight;
+};
+
+struct PrefetchTaskData {
+  std::shared_ptr<MeshSampleCache> cache;
+  index_t index;
+};
+
+static void prefetch_sample_task(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  const PrefetchTaskData *task_data = static_cast<PrefetchTaskData *>(taskdata);
+  MeshSampleCache &cache = *task_data->cache;
+
+  std::shared_ptr<const MeshSampleData> data;
+  try {
+    data = read_sample_data(cache.schema, task_data->index);
+  }
+  catch (Alembic::Util::Exception & /*ex*/) {
+    /* The error is reported when the sample is read again for the frame that needs it. */
+  }
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.samples_in_flight.erase(task_data->index);
+  if (data) {
+    cache.samples[task_data->index] = data;
+  }
+}
+
+static void prefetch_sample_task_free(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  delete static_cast<PrefetchTaskData *>(taskdata);
+}
+
+/* The polygons of the mesh are the same as those in the sample, so only positions and normals
+ * need to be updated. */
+bool mesh_topology_matches(const Mesh *mesh, const IPolyMeshSchema::Sample &sample)
+{
+  const Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
+  const Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
+  if (face_counts->size() != mesh->totpoly || face_indices->size() != mesh->totloop) {
+    return false;
+  }
+
+  int abc_index = 0;
+  for (int i = 0; i < mesh->totpoly; i++) {
+    const MPoly &poly = mesh->mpoly[i];
+    if (poly.totloop != (*face_counts)[i]) {
+      return false;
+    }
+    /* NOTE: Alembic data is stored in the reverse order. */
+    for (int j = poly.totloop - 1; j >= 0; j--, abc_index++) {
+      if (int(mesh->mloop[poly.loopstart + j].v) != (*face_indices)[abc_index]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 static void read_mesh_sample(const std::string &iobject_full_name,
                              ImportSettings *settings,
                              const IPolyMeshSchema &schema,
                              const ISampleSelector &selector,
+                             const MeshSampleData &sample_data,
+                             const MeshSampleData *ceil_sample_data,
+                             const bool read_topology,
                              CDStreamConfig &config)
 {
-  const IPolyMeshSchema::Sample sample = schema.getValue(selector);
+  const IPolyMeshSchema::Sample &sample = sample_data.sample;
 
   AbcMeshData abc_mesh_data;
   abc_mesh_data.face_counts = sample.getFaceCounts();
   abc_mesh_data.face_indices = sample.getFaceIndices();
   abc_mesh_data.positions = sample.getPositions();
 
-  get_weight_and_index(config, schema.getTimeSampling(), schema.getNumSamples());
-
-  if (config.weight != 0.0f) {
-    Alembic::AbcGeom::IPolyMeshSchema::Sample ceil_sample;
-    schema.get(ceil_sample, Alembic::Abc::ISampleSelector(config.ceil_index));
-    abc_mesh_data.ceil_positions = ceil_sample.getPositions();
+  if (ceil_sample_data != nullptr) {
+    abc_mesh_data.ceil_positions = ceil_sample_data->sample.getPositions();
   }
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_UV) != 0) {
@@ -442,8 +536,10 @@ static void read_mesh_sample(const std::string &iobject_full_name,
   }
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_POLY) != 0) {
-    read_mpolys(config, abc_mesh_data);
-    process_normals(config, schema.getNormalsParam(), selector);
+    if (read_topology) {
+      read_mpolys(config, abc_mesh_data);
+    }
+    process_normals(config, schema.getNormalsParam(), sample_data.normals);
   }
 
   if ((settings->read_flag & (MOD_MESHSEQ_READ_UV | MOD_MESHSEQ_READ_COLOR)) != 0) {
@@ -473,7 +569,7 @@ CDStreamConfig get_config(Mesh *mesh, const bool use_vertex_interpolation)
 /* ************************************************************************** */
 
 AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
-    : AbcObjectReader(object, settings)
+    : AbcObjectReader(object, settings), m_prefetch_pool(nullptr)
 {
   m_settings->read_flag |= MOD_MESHSEQ_READ_ALL;
 
@@ -593,11 +689,24 @@ bool AbcMeshReader::accepts_object_type(
   return true;
 }
 
+static bool sample_topology_changed(const Mesh *existing_mesh,
+                                    const IPolyMeshSchema::Sample &sample)
+{
+  const P3fArraySamplePtr &positions = sample.getPositions();
+  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
+  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
+
+  return positions->size() != existing_mesh->totvert ||
+         face_counts->size() != existing_mesh->totpoly ||
+         face_indices->size() != existing_mesh->totloop;
+}
+
 bool AbcMeshReader::topology_changed(Mesh *existing_mesh, const ISampleSelector &sample_sel)
 {
-  IPolyMeshSchema::Sample sample;
+  std::shared_ptr<const MeshSampleData> sample_data;
   try {
-    sample = m_schema.getValue(sample_sel);
+    sample_data = get_sample_data(
+        sample_sel.getIndex(m_schema.getTimeSampling(), m_schema.getNumSamples()));
   }
   catch (Alembic::Util::Exception &ex) {
     printf("Alembic: error reading mesh sample for '%s/%s' at time %f: %s\n",
@@ -609,13 +718,75 @@ bool AbcMeshReader::topology_changed(Mesh *existing_mesh, const ISampleSelector
     return false;
   }
 
-  const P3fArraySamplePtr &positions = sample.getPositions();
-  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
-  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
+  return sample_topology_changed(existing_mesh, sample_data->sample);
+}
 
-  return positions->size() != existing_mesh->totvert ||
-         face_counts->size() != existing_mesh->totpoly ||
-         face_indices->size() != existing_mesh->totloop;
+void AbcMeshReader::enable_prefetch(ArchiveReader &archive)
+{
+  if (m_schema.isConstant() || m_schema.getNumSamples() < 2) {
+    return;
+  }
+
+  m_sample_cache = std::make_shared<MeshSampleCache>();
+  m_sample_cache->schema = m_schema;
+  m_prefetch_pool = archive.prefetch_pool();
+}
+
+std::shared_ptr<const MeshSampleData> AbcMeshReader::get_sample_data(const index_t index)
+{
+  if (!m_sample_cache) {
+    return read_sample_data(m_schema, index);
+  }
+
+  std::shared_ptr<const MeshSampleData> data;
+  {
+    MeshSampleCache &cache = *m_sample_cache;
+    std::lock_guard<std::mutex> lock(cache.mutex);
+
+    /* Keep the previous sample for interpolation, drop samples that playback moved away from. */
+    cache.samples.erase(cache.samples.begin(), cache.samples.lower_bound(index - 1));
+    cache.samples.erase(cache.samples.upper_bound(index + prefetch_samples_num),
+                        cache.samples.end());
+
+    const auto found = cache.samples.find(index);
+    if (found != cache.samples.end()) {
+      data = found->second;
+    }
+  }
+
+  if (!data) {
+    data = read_sample_data(m_schema, index);
+  }
+  prefetch_samples_after(index);
+  return data;
+}
+
+bool AbcMeshReader::sample_is_prefetched(const index_t index) const
+{
+  if (!m_sample_cache) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(m_sample_cache->mutex);
+  return m_sample_cache->samples.count(index) != 0;
+}
+
+void AbcMeshReader::prefetch_samples_after(const index_t index)
+{
+  MeshSampleCache &cache = *m_sample_cache;
+  const index_t last_index = std::min<index_t>(index + prefetch_samples_num,
+                                               m_schema.getNumSamples() - 1);
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  for (index_t prefetch_index = index + 1; prefetch_index <= last_index; prefetch_index++) {
+    if (cache.samples.count(prefetch_index) || cache.samples_in_flight.count(prefetch_index)) {
+      continue;
+    }
+    cache.samples_in_flight.insert(prefetch_index);
+
+    PrefetchTaskData *task_data = new PrefetchTaskData{m_sample_cache, prefetch_index};
+    BLI_task_pool_push(
+        m_prefetch_pool, prefetch_sample_task, task_data, true, prefetch_sample_task_free);
+  }
 }
 
 Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
@@ -623,9 +794,10 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
                                int read_flag,
                                const char **err_str)
 {
-  IPolyMeshSchema::Sample sample;
+  std::shared_ptr<const MeshSampleData> sample_data;
   try {
-    sample = m_schema.getValue(sample_sel);
+    sample_data = get_sample_data(
+        sample_sel.getIndex(m_schema.getTimeSampling(), m_schema.getNumSamples()));
   }
   catch (Alembic::Util::Exception &ex) {
     if (err_str != nullptr) {
@@ -639,6 +811,7 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
     return existing_mesh;
   }
 
+  const IPolyMeshSchema::Sample &sample = sample_data->sample;
   const P3fArraySamplePtr &positions = sample.getPositions();
   const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
   const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
@@ -659,12 +832,13 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
   }
 
   Mesh *new_mesh = nullptr;
+  bool read_topology = true;
 
   /* Only read point data when streaming meshes, unless we need to create new ones. */
   ImportSettings settings;
   settings.read_flag |= read_flag;
 
-  if (topology_changed(existing_mesh, sample_sel)) {
+  if (sample_topology_changed(existing_mesh, sample)) {
     new_mesh = BKE_mesh_new_nomain_from_template(
         existing_mesh, positions->size(), 0, 0, face_indices->size(), face_counts->size());
 
@@ -684,6 +858,17 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
             " mesh. Only vertices will be read!";
       }
     }
+    else if (m_schema.getTopologyVariance() != Alembic::AbcGeom::kHeterogeneousTopology &&
+             mesh_topology_matches(existing_mesh, sample)) {
+      /* The existing mesh already has the polygons, edges and (unless animated) UV's and colors,
+       * only update positions and normals. */
+      read_topology = false;
+      const IV2fGeomParam uvs = m_schema.getUVsParam();
+      if (!(uvs.valid() && !uvs.isConstant()) &&
+          !has_animated_geom_params(m_schema.getArbGeomParams())) {
+        settings.read_flag &= ~(MOD_MESHSEQ_READ_UV | MOD_MESHSEQ_READ_COLOR);
+      }
+    }
   }
 
   Mesh *mesh_to_export = new_mesh ? new_mesh : existing_mesh;
@@ -692,7 +877,30 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
   config.time = sample_sel.getRequestedTime();
   config.modifier_error_message = err_str;
 
-  read_mesh_sample(m_iobject.getFullName(), &settings, m_schema, sample_sel, config);
+  get_weight_and_index(config, m_schema.getTimeSampling(), m_schema.getNumSamples());
+
+  std::shared_ptr<const MeshSampleData> ceil_sample_data;
+  if (config.weight != 0.0f && use_vertex_interpolation) {
+    try {
+      ceil_sample_data = get_sample_data(config.ceil_index);
+    }
+    catch (Alembic::Util::Exception &ex) {
+      printf("Alembic: error reading mesh sample for '%s/%s' at time %f: %s\n",
+             m_iobject.getFullName().c_str(),
+             m_schema.getName().c_str(),
+             sample_sel.getRequestedTime(),
+             ex.what());
+    }
+  }
+
+  read_mesh_sample(m_iobject.getFullName(),
+                   &settings,
+                   m_schema,
+                   sample_sel,
+                   *sample_data,
+                   ceil_sample_data.get(),
+                   read_topology,
+                   config);
 
   if (new_mesh) {
     /* Here we assume that the number of materials doesn't change, i.e. that
@@ -22,15 +22,25 @@
 #include "abc_customdata.h"
 #include "abc_reader_object.h"
 
+#include <memory>
+
 struct Mesh;
+struct TaskPool;
 
 namespace blender::io::alembic {
 
+struct MeshSampleData;
+struct MeshSampleCache;
+
 class AbcMeshReader : public AbcObjectReader {
   Alembic::AbcGeom::IPolyMeshSchema m_schema;
 
   CDStreamConfig m_mesh_data;
 
+  /* Samples read ahead of playback, only used by cache readers of animated meshes. */
+  std::shared_ptr<MeshSampleCache> m_sample_cache;
+  TaskPool *m_prefetch_pool;
+
  public:
   AbcMeshReader(const Alembic::Abc::IObject &object, ImportSettings &settings);
 
@@ -46,8 +56,17 @@ class AbcMeshReader : public AbcObjectReader {
                          const char **err_str) override;
   bool topology_changed(Mesh *existing_mesh,
                         const Alembic::Abc::ISampleSelector &sample_sel) override;
+  void enable_prefetch(ArchiveReader &archive) override;
+
+  /* Whether the sample was read ahead of playback and is still cached, used by tests. */
+  bool sample_is_prefetched(Alembic::AbcGeom::index_t index) const;
 
  private:
+  /* Get the sample from the prefetched samples, or read it when it wasn't prefetched. Starts
+   * reading the samples that follow it when prefetching is enabled. */
+  std::shared_ptr<const MeshSampleData> get_sample_data(Alembic::AbcGeom::index_t index);
+  void prefetch_samples_after(Alembic::AbcGeom::index_t index);
+
   void readFaceSetsSample(Main *bmain,
                           Mesh *mesh,
                           const Alembic::AbcGeom::ISampleSelector &sample_sel);
@@ -83,4 +102,7 @@ void read_mverts(MVert *mverts,
 
 CDStreamConfig get_config(struct Mesh *mesh, bool use_vertex_interpolation);
 
+bool mesh_topology_matches(const struct Mesh *mesh,
+                           const Alembic::AbcGeom::IPolyMeshSchema::Sample &sample);
+
 }  // namespace blender::io::alembic
@@ -184,6 +184,11 @@ bool AbcObjectReader::topology_changed(Mesh * /*existing_mesh*/,
   return false;
 }
 
+void AbcObjectReader::enable_prefetch(ArchiveReader & /*archive*/)
+{
+  /* Only readers of animated data read ahead. */
+}
+
 void AbcObjectReader::setupObjectTransform(const float time)
 {
   bool is_constant = false;
@@ -33,6 +33,8 @@ using Alembic::AbcCoreAbstract::chrono_t;
 
 namespace blender::io::alembic {
 
+class ArchiveReader;
+
 struct ImportSettings {
   bool do_convert_mat;
   float conversion_mat[4][4];
@@ -146,6 +148,10 @@ class AbcObjectReader {
   virtual bool topology_changed(Mesh *existing_mesh,
                                 const Alembic::Abc::ISampleSelector &sample_sel);
 
+  /* Read samples ahead of playback with the prefetch tasks of the archive, which outlives the
+   * reader. */
+  virtual void enable_prefetch(ArchiveReader &archive);
+
   /** Reads the object matrix and sets up an object transform if animated. */
   void setupObjectTransform(const float time);
 
@@ -857,6 +857,7 @@ CacheReader *CacheReader_open_alembic_object(AbcArchiveHandle *handle,
     return nullptr;
   }
   abc_reader->object(object);
+  abc_reader->enable_prefetch(*archive);
   abc_reader->incref();
 
   return reinterpret_cast<CacheReader *>(abc_reader);
@@ -0,0 +1,202 @@
+#include "testing/testing.h"
+
+/* Keep first since utildefines defines AT which conflicts with STL */
+#include "intern/abc_reader_archive.h"
+#include "intern/abc_reader_mesh.h"
+
+#include <Alembic/AbcCoreOgawa/All.h>
+#include <Alembic/AbcGeom/All.h>
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BLI_path_util.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+
+using namespace Alembic::AbcGeom;
+
+namespace blender::io::alembic {
+
+/* Grid of `grid_size` x `grid_size` quads, its vertices move along Z over the samples. */
+static const int grid_size = 4;
+static const int samples_num = 32;
+
+static float sample_vertex_z(const int sample_index, const int vertex_index)
+{
+  return 0.1f * sample_index + 0.01f * vertex_index;
+}
+
+class AlembicReaderMeshTest : public testing::Test {
+ protected:
+  Main *bmain;
+  char filepath[FILE_MAX];
+
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+    BKE_tempdir_init(nullptr);
+  }
+
+  static void TearDownTestSuite()
+  {
+    BKE_tempdir_session_purge();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "grid.abc");
+    write_grid_archive();
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+  }
+
+  void write_grid_archive()
+  {
+    OArchive archive(Alembic::AbcCoreOgawa::WriteArchive(), filepath);
+    const uint32_t time_sampling = archive.addTimeSampling(TimeSampling(1.0 / 24.0, 0.0));
+    OPolyMesh grid(OObject(archive, kTop), "grid", time_sampling);
+    OPolyMeshSchema &schema = grid.getSchema();
+
+    const int row_len = grid_size + 1;
+    std::vector<int32_t> face_counts(grid_size * grid_size, 4);
+    std::vector<int32_t> face_indices;
+    for (int y = 0; y < grid_size; y++) {
+      for (int x = 0; x < grid_size; x++) {
+        face_indices.push_back(y * row_len + x);
+        face_indices.push_back((y + 1) * row_len + x);
+        face_indices.push_back((y + 1) * row_len + x + 1);
+        face_indices.push_back(y * row_len + x + 1);
+      }
+    }
+
+    for (int sample_index = 0; sample_index < samples_num; sample_index++) {
+      std::vector<V3f> positions;
+      for (int i = 0; i < row_len * row_len; i++) {
+        positions.emplace_back(
+            float(i % row_len), float(i / row_len), sample_vertex_z(sample_index, i));
+      }
+      schema.set(OPolyMeshSchema::Sample(V3fArraySample(positions),
+                                         Int32ArraySample(face_indices),
+                                         Int32ArraySample(face_counts)));
+    }
+  }
+
+  /* Read the first sample into a new mesh. */
+  static Mesh *read_first_sample(AbcMeshReader &reader)
+  {
+    Mesh *empty_mesh = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+    Mesh *mesh = reader.read_mesh(
+        empty_mesh, ISampleSelector(index_t(0)), MOD_MESHSEQ_READ_ALL, nullptr);
+    EXPECT_NE(mesh, empty_mesh);
+    BKE_id_free(nullptr, empty_mesh);
+    return mesh;
+  }
+};
+
+TEST_F(AlembicReaderMeshTest, TopologyMatches)
+{
+  ArchiveReader archive(bmain, filepath);
+  ASSERT_TRUE(archive.valid());
+  IObject grid = archive.getTop().getChild("grid");
+  ImportSettings settings;
+  AbcMeshReader reader(grid, settings);
+  Mesh *mesh = read_first_sample(reader);
+  ASSERT_EQ(mesh->totpoly, grid_size * grid_size);
+
+  IPolyMeshSchema::Sample sample;
+  const IPolyMeshSchema schema = IPolyMesh(grid, kWrapExisting).getSchema();
+  schema.get(sample, ISampleSelector(index_t(samples_num - 1)));
+  EXPECT_TRUE(mesh_topology_matches(mesh, sample));
+
+  /* Same counts, different vertices. */
+  SWAP(unsigned int, mesh->mloop[0].v, mesh->mloop[1].v);
+  EXPECT_FALSE(mesh_topology_matches(mesh, sample));
+  SWAP(unsigned int, mesh->mloop[0].v, mesh->mloop[1].v);
+
+  /* Same vertices, different polygon sizes. */
+  mesh->mpoly[0].totloop--;
+  mesh->mpoly[1].loopstart--;
+  mesh->mpoly[1].totloop++;
+  EXPECT_FALSE(mesh_topology_matches(mesh, sample));
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(AlembicReaderMeshTest, UpdatePositionsInPlace)
+{
+  ArchiveReader archive(bmain, filepath);
+  ASSERT_TRUE(archive.valid());
+  ImportSettings settings;
+  AbcMeshReader reader(archive.getTop().getChild("grid"), settings);
+  Mesh *mesh = read_first_sample(reader);
+  const MPoly *mpoly = mesh->mpoly;
+  const MLoop *mloop = mesh->mloop;
+
+  const int sample_index = 5;
+  const char *err_str = nullptr;
+  Mesh *result = reader.read_mesh(mesh,
+                                  ISampleSelector(index_t(sample_index)),
+                                  MOD_MESHSEQ_READ_VERT | MOD_MESHSEQ_READ_POLY,
+                                  &err_str);
+
+  /* The topology is unchanged, so the mesh and its polygons are re-used. */
+  EXPECT_EQ(result, mesh);
+  EXPECT_EQ(err_str, nullptr);
+  EXPECT_EQ(mesh->mpoly, mpoly);
+  EXPECT_EQ(mesh->mloop, mloop);
+  for (int i = 0; i < mesh->totvert; i++) {
+    /* Alembic is Y-up, Blender's Z is Alembic's Y. */
+    EXPECT_FLOAT_EQ(mesh->mvert[i].co[1], -sample_vertex_z(sample_index, i));
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(AlembicReaderMeshTest, PrefetchedSamplesAreTrimmed)
+{
+  ArchiveReader archive(bmain, filepath);
+  ASSERT_TRUE(archive.valid());
+  ImportSettings settings;
+  AbcMeshReader reader(archive.getTop().getChild("grid"), settings);
+  reader.enable_prefetch(archive);
+  Mesh *mesh = read_first_sample(reader);
+  BLI_task_pool_work_and_wait(archive.prefetch_pool());
+
+  /* The samples following the one that was read. */
+  EXPECT_FALSE(reader.sample_is_prefetched(0));
+  for (int i = 1; i <= 8; i++) {
+    EXPECT_TRUE(reader.sample_is_prefetched(i)) << "sample " << i;
+  }
+  EXPECT_FALSE(reader.sample_is_prefetched(9));
+
+  /* Jumping ahead drops the samples that playback moved away from. */
+  const int sample_index = 20;
+  mesh = reader.read_mesh(
+      mesh, ISampleSelector(index_t(sample_index)), MOD_MESHSEQ_READ_VERT, nullptr);
+  BLI_task_pool_work_and_wait(archive.prefetch_pool());
+  for (int i = 0; i < samples_num; i++) {
+    const bool is_prefetched = i > sample_index && i <= sample_index + 8;
+    EXPECT_EQ(reader.sample_is_prefetched(i), is_prefetched) << "sample " << i;
+  }
+
+  /* Samples past the end aren't requested. */
+  mesh = reader.read_mesh(
+      mesh, ISampleSelector(index_t(samples_num - 2)), MOD_MESHSEQ_READ_VERT, nullptr);
+  BLI_task_pool_work_and_wait(archive.prefetch_pool());
+  EXPECT_TRUE(reader.sample_is_prefetched(samples_num - 1));
+  EXPECT_FALSE(reader.sample_is_prefetched(sample_index + 1));
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::io::alembic
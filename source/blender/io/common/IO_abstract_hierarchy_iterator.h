@@ -128,6 +128,18 @@ class AbstractHierarchyWriter {
   /* TODO(Sybren): add function like absent() that's called when a writer was previously created,
    * but wasn't used while exporting the current frame (for example, a particle-instanced mesh of
    * which the particle is no longer alive). */
+
+  /* Writers can defer the expensive part of write(), gathering the data of the sample, until
+   * after the whole hierarchy has been iterated. AbstractHierarchyIterator then prepares the
+   * deferred samples of many writers from multiple threads, and writes them to the file one at a
+   * time.
+   *
+   * prepare_deferred_sample() is called from a worker thread. It must not write to the file, nor
+   * modify data that can be shared with other writers (like evaluated meshes). */
+  virtual bool has_deferred_sample() const;
+  virtual void prepare_deferred_sample();
+  virtual void write_deferred_sample();
+
  protected:
   /* Return true if the data written by this writer changes over time.
    * Note that this function assumes this is an object data writer. Transform writers should not
@@ -269,6 +281,8 @@ class AbstractHierarchyIterator {
   void connect_loose_objects();
   void export_graph_prune();
   void export_graph_clear();
+  /* Prepare and write the samples that writers deferred while iterating the hierarchy. */
+  void write_deferred_samples();
 
   void visit_object(Object *object, Object *export_parent, bool weak_export);
   void visit_dupli_object(DupliObject *dupli_object,
@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup io
+ */
+
+#include "BLI_array.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_utility_mixins.hh"
+
+struct BLI_mmap_file;
+
+namespace blender::io {
+
+/**
+ * Read-only view of a whole file for importers, memory-mapped when the platform and file system
+ * allow it and read into memory otherwise. Parsers can access the data from multiple threads
+ * without copying it into a buffer first.
+ */
+class MappedFile : NonCopyable, NonMovable {
+ private:
+  int file_ = -1;
+  BLI_mmap_file *mmap_file_ = nullptr;
+  /** Used when memory-mapping fails. */
+  Array<char> buffer_;
+  StringRef data_;
+  bool is_open_ = false;
+
+ public:
+  explicit MappedFile(const char *filepath);
+  ~MappedFile();
+
+  bool is_open() const
+  {
+    return is_open_;
+  }
+
+  /** Contents of the file, empty for empty files. Not null-terminated. */
+  StringRef data() const
+  {
+    return data_;
+  }
+};
+
+}  // namespace blender::io
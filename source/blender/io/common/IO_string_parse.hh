@@ -0,0 +1,40 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup io
+ */
+
+#include "BLI_string_ref.hh"
+
+namespace blender::io {
+
+/**
+ * Parse a floating point number at the start of \a str, like `strtod` in the "C" locale.
+ * Text files always use '.' as decimal separator, while `strtod` and `strtof` depend on the
+ * locale of the process. Accepts an optional sign, digits with an optional fraction and
+ * exponent, as well as `inf` and `nan`. Characters after the number are ignored.
+ *
+ * \return False when \a str doesn't start with a number, \a r_value is zero then.
+ */
+bool parse_double(StringRef str, double &r_value);
+
+}  // namespace blender::io
@@ -0,0 +1,155 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup io
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "BLI_array.hh"
+#include "BLI_index_range.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+namespace blender::io {
+
+/**
+ * Growable buffer of text or binary records, filled independently by every thread formatting a
+ * part of the file.
+ */
+class FormatBuffer {
+ private:
+  Vector<char> buffer_;
+
+ public:
+  StringRef str() const
+  {
+    return StringRef(buffer_.data(), buffer_.size());
+  }
+
+  void clear()
+  {
+    buffer_.clear();
+  }
+
+  void append(const char c)
+  {
+    buffer_.append(c);
+  }
+
+  void append(StringRef str)
+  {
+    buffer_.extend(str.data(), str.size());
+  }
+
+  /** Append the bytes of a value, for binary formats. */
+  template<typename T> void append_binary(const T &value)
+  {
+    buffer_.extend(reinterpret_cast<const char *>(&value), int64_t(sizeof(T)));
+  }
+
+  void append_int(const int64_t value)
+  {
+    char digits[24];
+    int len = 0;
+    uint64_t abs_value = value < 0 ? uint64_t(-(value + 1)) + 1 : uint64_t(value);
+    do {
+      digits[len++] = char('0' + abs_value % 10);
+      abs_value /= 10;
+    } while (abs_value != 0);
+    if (value < 0) {
+      buffer_.append('-');
+    }
+    while (len > 0) {
+      buffer_.append(digits[--len]);
+    }
+  }
+
+  /**
+   * Same output as `printf("%.*f", precision, value)`, without parsing a format string and
+   * without the locale handling of the C library. Floats scaled by `10^precision` are exact in
+   * a double for the precisions used here, so rounding (half to even) matches as well.
+   */
+  void append_float(const float value, const int precision)
+  {
+    BLI_assert(precision >= 0 && precision <= 6);
+    static const int64_t pow10[7] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    const double abs_value = std::fabs(double(value));
+    if (!(abs_value < 1e9)) {
+      /* Large values, infinity and NaN. */
+      char str[64];
+      const int len = snprintf(str, sizeof(str), "%.*f", precision, double(value));
+      this->append(StringRef(str, std::min(len, int(sizeof(str)) - 1)));
+      return;
+    }
+    const int64_t scaled = int64_t(std::nearbyint(abs_value * double(pow10[precision])));
+    if (std::signbit(value)) {
+      buffer_.append('-');
+    }
+    this->append_int(scaled / pow10[precision]);
+    if (precision == 0) {
+      return;
+    }
+    buffer_.append('.');
+    int64_t fraction = scaled % pow10[precision];
+    char digits[6];
+    for (int i = precision - 1; i >= 0; i--) {
+      digits[i] = char('0' + fraction % 10);
+      fraction /= 10;
+    }
+    buffer_.extend(digits, precision);
+  }
+};
+
+/**
+ * Format `size` elements with `format_range` from multiple threads and write the text to the file
+ * in order. Only a limited number of chunks is formatted at once to bound memory usage.
+ */
+template<typename FormatFn>
+void write_formatted_chunks(FILE *file, const int64_t size, const FormatFn &format_range)
+{
+  const int64_t chunk_size = 16 * 1024;
+  const int64_t chunks_per_batch = 64;
+  const int64_t chunks_len = (size + chunk_size - 1) / chunk_size;
+
+  Array<FormatBuffer> buffers(std::min(chunks_len, chunks_per_batch));
+  for (int64_t batch_start = 0; batch_start < chunks_len; batch_start += chunks_per_batch) {
+    const int64_t batch_len = std::min(chunks_per_batch, chunks_len - batch_start);
+    parallel_for(IndexRange(batch_len), 1, [&](IndexRange batch_range) {
+      for (const int64_t i : batch_range) {
+        const int64_t start = (batch_start + i) * chunk_size;
+        FormatBuffer &buffer = buffers[i];
+        buffer.clear();
+        format_range(buffer, IndexRange(start, std::min(chunk_size, size - start)));
+      }
+    });
+    for (const int64_t i : IndexRange(batch_len)) {
+      const StringRef str = buffers[i].str();
+      fwrite(str.data(), 1, size_t(str.size()), file);
+    }
+  }
+}
+
+}  // namespace blender::io
@@ -19,6 +19,7 @@
 #include "IO_abstract_hierarchy_iterator.h"
 #include "dupli_parent_finder.hh"
 
+#include <algorithm>
 #include <climits>
 #include <cstdio>
 #include <iostream>
@@ -34,6 +35,8 @@
 #include "BLI_assert.h"
 #include "BLI_listbase.h"
 #include "BLI_math_matrix.h"
+#include "BLI_task.h"
+#include "BLI_vector.hh"
 
 #include "DNA_ID.h"
 #include "DNA_layer_types.h"
@@ -141,6 +144,19 @@ AbstractHierarchyWriter::~AbstractHierarchyWriter()
 {
 }
 
+bool AbstractHierarchyWriter::has_deferred_sample() const
+{
+  return false;
+}
+
+void AbstractHierarchyWriter::prepare_deferred_sample()
+{
+}
+
+void AbstractHierarchyWriter::write_deferred_sample()
+{
+}
+
 bool AbstractHierarchyWriter::check_is_animated(const HierarchyContext &context) const
 {
   const Object *object = context.object;
@@ -204,6 +220,7 @@ void AbstractHierarchyIterator::iterate_and_write()
   determine_export_paths(HierarchyContext::root());
   determine_duplication_references(HierarchyContext::root(), "");
   make_writers(HierarchyContext::root());
+  write_deferred_samples();
   export_graph_clear();
 }
 
@@ -625,6 +642,59 @@ void AbstractHierarchyIterator::make_writers(const HierarchyContext *parent_cont
    */
 }
 
+static void prepare_deferred_sample_task(TaskPool *__restrict /*pool*/, void *taskdata)
+{
+  AbstractHierarchyWriter *writer = static_cast<AbstractHierarchyWriter *>(taskdata);
+  writer->prepare_deferred_sample();
+}
+
+void AbstractHierarchyIterator::write_deferred_samples()
+{
+  Vector<AbstractHierarchyWriter *> deferred_writers;
+  for (const WriterMap::value_type &it : writers_) {
+    AbstractHierarchyWriter *writer = it.second;
+    if (writer != nullptr && writer->has_deferred_sample()) {
+      deferred_writers.append(writer);
+    }
+  }
+  if (deferred_writers.is_empty()) {
+    return;
+  }
+
+  /* Samples are gathered in batches from multiple threads. While one batch is being prepared, the
+   * previous one is written, as files can only be written from one thread. Working in batches
+   * limits the memory used by gathered samples in scenes with many objects. */
+  const int64_t batch_size = 256;
+  TaskPool *task_pool = BLI_task_pool_create(nullptr, TASK_PRIORITY_HIGH);
+  IndexRange prepared_batch;
+
+  try {
+    for (int64_t start = 0; start < deferred_writers.size(); start += batch_size) {
+      const IndexRange batch(start, std::min(batch_size, deferred_writers.size() - start));
+      for (const int64_t i : batch) {
+        BLI_task_pool_push(
+            task_pool, prepare_deferred_sample_task, deferred_writers[i], false, nullptr);
+      }
+      for (const int64_t i : prepared_batch) {
+        deferred_writers[i]->write_deferred_sample();
+      }
+      BLI_task_pool_work_and_wait(task_pool);
+      prepared_batch = batch;
+    }
+    for (const int64_t i : prepared_batch) {
+      deferred_writers[i]->write_deferred_sample();
+    }
+  }
+  catch (...) {
+    /* Tasks still running would use the writers after they are released. */
+    BLI_task_pool_work_and_wait(task_pool);
+    BLI_task_pool_free(task_pool);
+    throw;
+  }
+
+  BLI_task_pool_free(task_pool);
+}
+
 HierarchyContext AbstractHierarchyIterator::context_for_object_data(
     const HierarchyContext *object_context) const
 {
@@ -0,0 +1,87 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup io
+ */
+
+#include <algorithm>
+#include <fcntl.h> /* For open flags (O_BINARY, O_RDONLY). */
+
+#ifndef WIN32
+#  include <unistd.h> /* For read and close. */
+#else
+#  include <io.h>
+#endif
+
+#include "BLI_fileops.h"
+#include "BLI_mmap.h"
+
+#include "IO_mapped_file.hh"
+
+namespace blender::io {
+
+MappedFile::MappedFile(const char *filepath)
+{
+  file_ = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+  if (file_ == -1) {
+    return;
+  }
+  const size_t size = BLI_file_descriptor_size(file_);
+  if (size == size_t(-1)) {
+    return;
+  }
+  is_open_ = true;
+  if (size == 0) {
+    return;
+  }
+
+  mmap_file_ = BLI_mmap_open(file_);
+  if (mmap_file_ != nullptr) {
+    data_ = StringRef(static_cast<const char *>(BLI_mmap_get_pointer(mmap_file_)), int64_t(size));
+    return;
+  }
+
+  buffer_.reinitialize(int64_t(size));
+  if (BLI_lseek(file_, 0, SEEK_SET) != 0) {
+    is_open_ = false;
+    return;
+  }
+  for (int64_t offset = 0; offset < buffer_.size();) {
+    const int read_len = int(std::min<int64_t>(buffer_.size() - offset, 1 << 30));
+    if (read(file_, buffer_.data() + offset, read_len) != read_len) {
+      is_open_ = false;
+      return;
+    }
+    offset += read_len;
+  }
+  data_ = StringRef(buffer_.data(), buffer_.size());
+}
+
+MappedFile::~MappedFile()
+{
+  if (mmap_file_ != nullptr) {
+    BLI_mmap_free(mmap_file_);
+  }
+  if (file_ != -1) {
+    close(file_);
+  }
+}
+
+}  // namespace blender::io
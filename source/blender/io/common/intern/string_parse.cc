@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup io
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "BLI_string.h"
+
+#include "IO_string_parse.hh"
+
+namespace blender::io {
+
+static bool is_digit(const char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static bool skip_word(const char *&p, const char *end, const char *word)
+{
+  const int64_t len = int64_t(strlen(word));
+  if (end - p >= len && BLI_strncasecmp(p, word, size_t(len)) == 0) {
+    p += len;
+    return true;
+  }
+  return false;
+}
+
+bool parse_double(StringRef str, double &r_value)
+{
+  r_value = 0.0;
+  const char *p = str.begin();
+  const char *end = str.end();
+
+  bool negative = false;
+  if (p < end && (*p == '+' || *p == '-')) {
+    negative = *p == '-';
+    p++;
+  }
+
+  if (skip_word(p, end, "inf")) {
+    r_value = negative ? -std::numeric_limits<double>::infinity() :
+                         std::numeric_limits<double>::infinity();
+    return true;
+  }
+  if (skip_word(p, end, "nan")) {
+    r_value = std::numeric_limits<double>::quiet_NaN();
+    return true;
+  }
+
+  /* Collect up to 18 significant digits, so the mantissa can't overflow. Digits after those
+   * only affect the exponent, they are below the precision of a double anyway. */
+  const uint64_t mantissa_max = 100000000000000000ull;
+  uint64_t mantissa = 0;
+  int64_t exponent = 0;
+  bool has_digits = false;
+  for (; p < end && is_digit(*p); p++) {
+    has_digits = true;
+    if (mantissa < mantissa_max) {
+      mantissa = mantissa * 10 + uint64_t(*p - '0');
+    }
+    else {
+      exponent++;
+    }
+  }
+  if (p < end && *p == '.') {
+    p++;
+    for (; p < end && is_digit(*p); p++) {
+      has_digits = true;
+      if (mantissa < mantissa_max) {
+        mantissa = mantissa * 10 + uint64_t(*p - '0');
+        exponent--;
+      }
+    }
+  }
+  if (!has_digits) {
+    return false;
+  }
+
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char *exp_p = p + 1;
+    bool exp_negative = false;
+    if (exp_p < end && (*exp_p == '+' || *exp_p == '-')) {
+      exp_negative = *exp_p == '-';
+      exp_p++;
+    }
+    /* Without digits the 'e' is not part of the number. */
+    if (exp_p < end && is_digit(*exp_p)) {
+      int64_t exp_value = 0;
+      for (; exp_p < end && is_digit(*exp_p); exp_p++) {
+        /* Anything larger over- or underflows a double. */
+        if (exp_value < 100000) {
+          exp_value = exp_value * 10 + (*exp_p - '0');
+        }
+      }
+      exponent += exp_negative ? -exp_value : exp_value;
+    }
+  }
+
+  double value = double(mantissa);
+  if (mantissa != 0 && exponent != 0) {
+    /* Powers of ten up to 1e22 are exact, dividing by them keeps the result correctly rounded
+     * for the common case of short decimal fractions. */
+    if (exponent < 0) {
+      /* Split the division for many digits of a tiny number, 1e-308 and below are not normal. */
+      if (exponent < -300) {
+        value /= 1e300;
+        exponent += 300;
+      }
+      value /= std::pow(10.0, double(-exponent));
+    }
+    else {
+      value *= std::pow(10.0, double(exponent));
+    }
+  }
+  r_value = negative ? -value : value;
+  return true;
+}
+
+}  // namespace blender::io
@@ -0,0 +1,107 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include <clocale>
+#include <cmath>
+#include <string>
+
+#include "IO_string_parse.hh"
+
+namespace blender::io::tests {
+
+static double parse(const char *str)
+{
+  double value = -1.0;
+  EXPECT_TRUE(parse_double(str, value)) << str;
+  return value;
+}
+
+TEST(string_parse, Numbers)
+{
+  EXPECT_EQ(parse("0"), 0.0);
+  EXPECT_EQ(parse("42"), 42.0);
+  EXPECT_EQ(parse("-7"), -7.0);
+  EXPECT_EQ(parse("+7"), 7.0);
+  EXPECT_EQ(parse("0.5"), 0.5);
+  EXPECT_EQ(parse(".25"), 0.25);
+  EXPECT_EQ(parse("3."), 3.0);
+  EXPECT_EQ(parse("0.1"), 0.1);
+  EXPECT_EQ(parse("-123.456"), -123.456);
+  EXPECT_EQ(parse("1e3"), 1000.0);
+  EXPECT_EQ(parse("1.5E-2"), 0.015);
+  EXPECT_EQ(parse("-2.5e+1"), -25.0);
+  EXPECT_EQ(parse("3.4028235e38"), 3.4028235e38);
+  EXPECT_EQ(parse("1e-320"), 1e-320);
+  EXPECT_EQ(parse("1e400"), INFINITY);
+  EXPECT_EQ(parse("1e-400"), 0.0);
+  EXPECT_TRUE(std::signbit(parse("-0")));
+}
+
+TEST(string_parse, FloatPrecision)
+{
+  /* Values written with enough digits to round trip a float. */
+  for (const float value : {0.1f, 1.0f / 3.0f, -12345.678f, 6.02214e23f, 1.17549435e-38f}) {
+    char str[64];
+    snprintf(str, sizeof(str), "%.9g", value);
+    EXPECT_EQ(float(parse(str)), value) << str;
+  }
+  EXPECT_EQ(parse("0.30000000000000004"), 0.30000000000000004);
+  EXPECT_EQ(parse("123456789012345678901234567890"), 123456789012345678901234567890.0);
+}
+
+TEST(string_parse, SpecialValues)
+{
+  EXPECT_EQ(parse("inf"), INFINITY);
+  EXPECT_EQ(parse("-Infinity"), -INFINITY);
+  EXPECT_TRUE(std::isnan(parse("NaN")));
+}
+
+TEST(string_parse, Trailing)
+{
+  EXPECT_EQ(parse("1.5 2.5"), 1.5);
+  EXPECT_EQ(parse("2e"), 2.0);
+  EXPECT_EQ(parse("2e+x"), 2.0);
+  EXPECT_EQ(parse("4,5"), 4.0);
+}
+
+TEST(string_parse, Invalid)
+{
+  double value = 1.0;
+  EXPECT_FALSE(parse_double("", value));
+  EXPECT_EQ(value, 0.0);
+  EXPECT_FALSE(parse_double("-", value));
+  EXPECT_FALSE(parse_double(".", value));
+  EXPECT_FALSE(parse_double("abc", value));
+  EXPECT_FALSE(parse_double("e5", value));
+}
+
+TEST(string_parse, IgnoresLocale)
+{
+  /* Locales with a decimal comma are not installed everywhere, only test when available. */
+  const std::string old_locale = setlocale(LC_NUMERIC, nullptr);
+  if (setlocale(LC_NUMERIC, "de_DE.UTF-8") == nullptr) {
+    return;
+  }
+  EXPECT_EQ(parse("1.5"), 1.5);
+  setlocale(LC_NUMERIC, old_locale.c_str());
+}
+
+}  // namespace blender::io::tests
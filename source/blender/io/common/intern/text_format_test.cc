@@ -0,0 +1,106 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include <cstdio>
+#include <string>
+
+#include "IO_text_format.hh"
+
+namespace blender::io::tests {
+
+static std::string format_float(const float value, const int precision)
+{
+  FormatBuffer buffer;
+  buffer.append_float(value, precision);
+  return buffer.str();
+}
+
+static std::string printf_float(const float value, const int precision)
+{
+  char str[64];
+  snprintf(str, sizeof(str), "%.*f", precision, double(value));
+  return str;
+}
+
+TEST(io_text_format, append_float_matches_printf)
+{
+  const float values[] = {0.0f,
+                          -0.0f,
+                          1.0f,
+                          -1.0f,
+                          0.5f,
+                          0.0078125f,
+                          -0.0078125f,
+                          0.00005f,
+                          0.12345678f,
+                          -3.1415927f,
+                          123456.789f,
+                          999999.9999f,
+                          1e-7f,
+                          -1e-7f,
+                          2.5e9f,
+                          1e20f};
+  for (const float value : values) {
+    for (const int precision : {0, 1, 4, 6}) {
+      EXPECT_EQ(format_float(value, precision), printf_float(value, precision))
+          << value << " with precision " << precision;
+    }
+  }
+}
+
+TEST(io_text_format, append_int)
+{
+  FormatBuffer buffer;
+  buffer.append_int(0);
+  buffer.append(' ');
+  buffer.append_int(-42);
+  buffer.append(' ');
+  buffer.append_int(INT64_MIN);
+  buffer.append(' ');
+  buffer.append_int(INT64_MAX);
+  EXPECT_EQ(std::string(buffer.str()),
+            "0 -42 -9223372036854775808 9223372036854775807");
+}
+
+TEST(io_text_format, write_formatted_chunks)
+{
+  FILE *file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  const int64_t size = 100000;
+  write_formatted_chunks(file, size, [](FormatBuffer &buffer, IndexRange range) {
+    for (const int64_t i : range) {
+      buffer.append_int(i);
+      buffer.append('\n');
+    }
+  });
+
+  std::string expected;
+  for (int64_t i = 0; i < size; i++) {
+    expected += std::to_string(i) + "\n";
+  }
+  std::string result(expected.size() + 1, '\0');
+  rewind(file);
+  result.resize(fread(result.data(), 1, result.size(), file));
+  fclose(file);
+  EXPECT_EQ(result, expected);
+}
+
+}  // namespace blender::io::tests
@@ -0,0 +1,72 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup ply
+ */
+
+#include "BLI_path_util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bContext;
+
+struct PLYImportParams {
+  /** Full path to the source PLY file. */
+  char filepath[FILE_MAX];
+
+  /** Axes of the file, converted to Blender's Y forward and Z up (`OB_POSX` .. `OB_NEGZ`). */
+  int forward_axis;
+  int up_axis;
+  float global_scale;
+
+  bool validate_meshes;
+};
+
+struct PLYExportParams {
+  /** Full path to the destination PLY file. */
+  char filepath[FILE_MAX];
+
+  /** Axes of the file, converted from Blender's Y forward and Z up (`OB_POSX` .. `OB_NEGZ`). */
+  int forward_axis;
+  int up_axis;
+  float global_scale;
+
+  bool export_selected_objects;
+  /** Export the evaluated meshes instead of the original ones. */
+  bool apply_modifiers;
+  /** Write the text format instead of the binary one. */
+  bool ascii_format;
+
+  /** Vertices are split where the exported normals, UV's or colors of their corners differ. */
+  bool export_normals;
+  bool export_uv;
+  bool export_colors;
+};
+
+bool PLY_import(struct bContext *C, const struct PLYImportParams *import_params);
+bool PLY_export(struct bContext *C, const struct PLYExportParams *export_params);
+
+#ifdef __cplusplus
+}
+#endif
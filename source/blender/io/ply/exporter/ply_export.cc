@@ -0,0 +1,223 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "BKE_context.h"
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_array.hh"
+#include "BLI_float4x4.hh"
+#include "BLI_map.hh"
+#include "BLI_math.h"
+#include "BLI_task.hh"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "ply_export.hh"
+#include "ply_export_file_writer.hh"
+
+namespace blender::io::ply {
+
+namespace {
+/** Exported attributes of a corner, corners with equal keys share a vertex in the file. */
+struct CornerKey {
+  int vert;
+  float3 normal;
+  float2 uv;
+  std::array<uint8_t, 4> color;
+
+  uint64_t hash() const
+  {
+    uint32_t bits[5];
+    memcpy(bits, &normal, sizeof(float[3]));
+    memcpy(bits + 3, &uv, sizeof(float[2]));
+    uint32_t color_bits;
+    memcpy(&color_bits, color.data(), sizeof(color_bits));
+    uint64_t hash = uint64_t(vert) * 0x9E3779B97F4A7C15ull ^ color_bits;
+    for (const uint32_t value : bits) {
+      hash = (hash ^ value) * 0x100000001B3ull;
+    }
+    return hash;
+  }
+
+  friend bool operator==(const CornerKey &a, const CornerKey &b)
+  {
+    return a.vert == b.vert && a.normal == b.normal && a.uv.x == b.uv.x && a.uv.y == b.uv.y &&
+           a.color == b.color;
+  }
+};
+}  // namespace
+
+void append_mesh_to_ply(PLYData &r_data,
+                        Mesh *mesh,
+                        const float transform[4][4],
+                        const PLYExportAttributes &attributes)
+{
+  const float4x4 vert_transform(transform);
+  const float4x4 normal_transform = vert_transform.inverted_transposed_affine();
+  const bool flip_winding = is_negative_m4(transform);
+  const int vert_offset = int(r_data.vertices.size());
+
+  const MLoopUV *mloopuv = attributes.uv ? static_cast<const MLoopUV *>(
+                                               CustomData_get_layer(&mesh->ldata, CD_MLOOPUV)) :
+                                           nullptr;
+  const MLoopCol *mloopcol = attributes.colors ?
+                                 static_cast<const MLoopCol *>(
+                                     CustomData_get_layer(&mesh->ldata, CD_MLOOPCOL)) :
+                                 nullptr;
+  const float(*loop_normals)[3] = nullptr;
+  if (attributes.normals) {
+    BKE_mesh_calc_normals_split(mesh);
+    loop_normals = static_cast<const float(*)[3]>(CustomData_get_layer(&mesh->ldata, CD_NORMAL));
+  }
+
+  /* Vertex in the file of every corner. */
+  Array<int> loop_verts(mesh->totloop);
+  if (!attributes.normals && !attributes.uv && !attributes.colors) {
+    r_data.vertices.resize(vert_offset + mesh->totvert);
+    parallel_for(IndexRange(mesh->totvert), 16 * 1024, [&](IndexRange range) {
+      for (const int i : range) {
+        r_data.vertices[vert_offset + i] = vert_transform * float3(mesh->mvert[i].co);
+      }
+    });
+    parallel_for(IndexRange(mesh->totloop), 16 * 1024, [&](IndexRange range) {
+      for (const int i : range) {
+        loop_verts[i] = vert_offset + int(mesh->mloop[i].v);
+      }
+    });
+  }
+  else {
+    /* PLY only has vertex attributes, split vertices where the corner attributes differ. */
+    Map<CornerKey, int> corner_verts;
+    for (const int i : IndexRange(mesh->totloop)) {
+      CornerKey key;
+      key.vert = int(mesh->mloop[i].v);
+      key.normal = float3(0.0f);
+      key.uv = float2(0.0f);
+      key.color = {255, 255, 255, 255};
+      if (loop_normals) {
+        key.normal = normal_transform.ref_3x3() * float3(loop_normals[i]);
+        normalize_v3(key.normal);
+      }
+      if (mloopuv) {
+        key.uv = float2(mloopuv[i].uv);
+      }
+      if (mloopcol) {
+        key.color = {mloopcol[i].r, mloopcol[i].g, mloopcol[i].b, mloopcol[i].a};
+      }
+      loop_verts[i] = corner_verts.lookup_or_add_cb(key, [&]() {
+        r_data.vertices.append(vert_transform * float3(mesh->mvert[key.vert].co));
+        if (attributes.normals) {
+          r_data.vertex_normals.append(key.normal);
+        }
+        if (attributes.uv) {
+          r_data.uv_coords.append(key.uv);
+        }
+        if (attributes.colors) {
+          r_data.vertex_colors.append(key.color);
+        }
+        return int(r_data.vertices.size()) - 1;
+      });
+    }
+  }
+
+  for (const int i : IndexRange(mesh->totpoly)) {
+    const MPoly &mpoly = mesh->mpoly[i];
+    for (const int j : IndexRange(mpoly.totloop)) {
+      const int corner = flip_winding ? mpoly.totloop - 1 - j : j;
+      r_data.face_vertices.append(loop_verts[mpoly.loopstart + corner]);
+    }
+    r_data.face_offsets.append(int(r_data.face_vertices.size()));
+  }
+}
+
+bool exporter_main(bContext *C, const PLYExportParams &export_params)
+{
+  float axes_transform[3][3];
+  unit_m3(axes_transform);
+  mat3_from_axis_conversion(
+      OB_POSY, OB_POSZ, export_params.forward_axis, export_params.up_axis, axes_transform);
+  mul_m3_fl(axes_transform, export_params.global_scale);
+  float axes_transform_4x4[4][4];
+  copy_m4_m3(axes_transform_4x4, axes_transform);
+
+  /* Copies of the meshes, with the transform of their object. */
+  Vector<std::pair<Mesh *, float4x4>> meshes;
+  Depsgraph *depsgraph = CTX_data_ensure_evaluated_depsgraph(C);
+  DEG_OBJECT_ITER_BEGIN (depsgraph,
+                         object,
+                         DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
+                             DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET | DEG_ITER_OBJECT_FLAG_VISIBLE |
+                             DEG_ITER_OBJECT_FLAG_DUPLI) {
+    if (export_params.export_selected_objects && !(object->base_flag & BASE_SELECTED)) {
+      continue;
+    }
+    if (object->type != OB_MESH) {
+      continue;
+    }
+    Mesh *mesh = export_params.apply_modifiers ?
+                     BKE_object_get_evaluated_mesh(object) :
+                     static_cast<Mesh *>(DEG_get_original_object(object)->data);
+    if (mesh == nullptr) {
+      continue;
+    }
+    float4x4 transform;
+    mul_m4_m4m4(transform.values, axes_transform_4x4, object->obmat);
+    meshes.append({BKE_mesh_copy_for_eval(mesh, true), transform});
+  }
+  DEG_OBJECT_ITER_END;
+
+  PLYExportAttributes attributes;
+  attributes.normals = export_params.export_normals;
+  for (const std::pair<Mesh *, float4x4> &item : meshes) {
+    const Mesh *mesh = item.first;
+    attributes.uv |= export_params.export_uv && CustomData_has_layer(&mesh->ldata, CD_MLOOPUV);
+    attributes.colors |= export_params.export_colors &&
+                         CustomData_has_layer(&mesh->ldata, CD_MLOOPCOL);
+  }
+
+  PLYData data;
+  for (const std::pair<Mesh *, float4x4> &item : meshes) {
+    append_mesh_to_ply(data, item.first, item.second.values, attributes);
+    BKE_id_free(nullptr, item.first);
+  }
+
+  if (!write_ply_file(export_params.filepath, data, export_params.ascii_format)) {
+    fprintf(stderr, "Error: cannot open file '%s' for writing\n", export_params.filepath);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace blender::io::ply
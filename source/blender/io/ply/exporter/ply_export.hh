@@ -0,0 +1,59 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup ply
+ */
+
+#include "IO_ply.h"
+
+#include "ply_data.hh"
+
+struct bContext;
+struct Mesh;
+
+namespace blender::io::ply {
+
+/** Attributes written for every vertex, only for attributes that exist in one of the meshes. */
+struct PLYExportAttributes {
+  bool normals = false;
+  bool uv = false;
+  bool colors = false;
+};
+
+/**
+ * Append the vertices and faces of a mesh. Loop normals are calculated on the mesh when
+ * exported, so it should be a copy owned by the exporter.
+ *
+ * \param transform: World space, axis conversion and scale.
+ */
+void append_mesh_to_ply(PLYData &r_data,
+                        Mesh *mesh,
+                        const float transform[4][4],
+                        const PLYExportAttributes &attributes);
+
+/**
+ * Write all visible mesh objects to a single PLY file.
+ * \return False when the file can't be written.
+ */
+bool exporter_main(bContext *C, const PLYExportParams &export_params);
+
+}  // namespace blender::io::ply
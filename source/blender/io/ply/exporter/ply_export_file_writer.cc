@@ -0,0 +1,173 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <cstdio>
+
+#include "BKE_blender_version.h"
+#include "BKE_global.h"
+
+#include "BLI_endian_switch.h"
+#include "BLI_fileops.h"
+#include "BLI_math.h"
+
+#include "IO_text_format.hh"
+
+#include "ply_export_file_writer.hh"
+
+namespace blender::io::ply {
+
+static void append_binary_float(FormatBuffer &buffer, float value)
+{
+  if (ENDIAN_ORDER == B_ENDIAN) {
+    BLI_endian_switch_float(&value);
+  }
+  buffer.append_binary(value);
+}
+
+static void append_binary_uint(FormatBuffer &buffer, uint32_t value)
+{
+  if (ENDIAN_ORDER == B_ENDIAN) {
+    BLI_endian_switch_uint32(&value);
+  }
+  buffer.append_binary(value);
+}
+
+static void write_header(FILE *file, const PLYData &data, const bool ascii_format, bool wide_count)
+{
+  fprintf(file,
+          "ply\n"
+          "format %s 1.0\n"
+          "comment Created by Blender %s - www.blender.org\n"
+          "element vertex %d\n"
+          "property float x\n"
+          "property float y\n"
+          "property float z\n",
+          ascii_format ? "ascii" : "binary_little_endian",
+          BKE_blender_version_string(),
+          int(data.vertices.size()));
+  if (!data.vertex_normals.is_empty()) {
+    fputs("property float nx\nproperty float ny\nproperty float nz\n", file);
+  }
+  if (!data.uv_coords.is_empty()) {
+    fputs("property float s\nproperty float t\n", file);
+  }
+  if (!data.vertex_colors.is_empty()) {
+    fputs(
+        "property uchar red\nproperty uchar green\nproperty uchar blue\nproperty uchar alpha\n",
+        file);
+  }
+  fprintf(file,
+          "element face %d\n"
+          "property list %s uint vertex_indices\n"
+          "end_header\n",
+          int(data.faces_num()),
+          wide_count ? "uint" : "uchar");
+}
+
+bool write_ply_file(const char *filepath, const PLYData &data, const bool ascii_format)
+{
+  FILE *file = BLI_fopen(filepath, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  /* Use a byte for the corner count like most writers, unless there are larger faces. */
+  bool wide_count = false;
+  for (const int face : IndexRange(data.faces_num())) {
+    wide_count |= data.face_offsets[face + 1] - data.face_offsets[face] > 255;
+  }
+  write_header(file, data, ascii_format, wide_count);
+
+  write_formatted_chunks(file, data.vertices.size(), [&](FormatBuffer &buffer, IndexRange range) {
+    for (const int64_t i : range) {
+      float values[8];
+      int values_num = 0;
+      copy_v3_v3(values, data.vertices[i]);
+      values_num += 3;
+      if (!data.vertex_normals.is_empty()) {
+        copy_v3_v3(values + values_num, data.vertex_normals[i]);
+        values_num += 3;
+      }
+      if (!data.uv_coords.is_empty()) {
+        copy_v2_v2(values + values_num, data.uv_coords[i]);
+        values_num += 2;
+      }
+
+      if (ascii_format) {
+        for (const int j : IndexRange(values_num)) {
+          if (j > 0) {
+            buffer.append(' ');
+          }
+          buffer.append_float(values[j], 6);
+        }
+        if (!data.vertex_colors.is_empty()) {
+          for (const uint8_t channel : data.vertex_colors[i]) {
+            buffer.append(' ');
+            buffer.append_int(channel);
+          }
+        }
+        buffer.append('\n');
+      }
+      else {
+        for (const int j : IndexRange(values_num)) {
+          append_binary_float(buffer, values[j]);
+        }
+        if (!data.vertex_colors.is_empty()) {
+          buffer.append_binary(data.vertex_colors[i]);
+        }
+      }
+    }
+  });
+
+  write_formatted_chunks(file, data.faces_num(), [&](FormatBuffer &buffer, IndexRange range) {
+    for (const int64_t face : range) {
+      const int start = data.face_offsets[face];
+      const int size = data.face_offsets[face + 1] - start;
+      const Span<int> face_verts = data.face_vertices.as_span().slice(start, size);
+      if (ascii_format) {
+        buffer.append_int(size);
+        for (const int vert : face_verts) {
+          buffer.append(' ');
+          buffer.append_int(vert);
+        }
+        buffer.append('\n');
+      }
+      else {
+        if (wide_count) {
+          append_binary_uint(buffer, uint32_t(size));
+        }
+        else {
+          buffer.append_binary(uint8_t(size));
+        }
+        for (const int vert : face_verts) {
+          append_binary_uint(buffer, uint32_t(vert));
+        }
+      }
+    }
+  });
+
+  fclose(file);
+  return true;
+}
+
+}  // namespace blender::io::ply
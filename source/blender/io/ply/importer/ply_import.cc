@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <cstdio>
+
+#include "BKE_collection.h"
+#include "BKE_layer.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_math.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "DNA_collection_types.h"
+#include "DNA_layer_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "ply_import.hh"
+#include "ply_import_file_reader.hh"
+#include "ply_import_mesh.hh"
+
+namespace blender::io::ply {
+
+bool importer_main(Main *bmain,
+                   Scene *scene,
+                   ViewLayer *view_layer,
+                   const PLYImportParams &import_params)
+{
+  PLYData data;
+  if (!read_ply_file(import_params.filepath, data)) {
+    fprintf(stderr, "Cannot read from PLY file: '%s'\n", import_params.filepath);
+    return false;
+  }
+
+  float axes_transform[3][3];
+  unit_m3(axes_transform);
+  mat3_from_axis_conversion(
+      import_params.forward_axis, import_params.up_axis, OB_POSY, OB_POSZ, axes_transform);
+
+  char name[FILE_MAX];
+  BLI_strncpy(name, BLI_path_basename(import_params.filepath), sizeof(name));
+  BLI_path_extension_replace(name, sizeof(name), "");
+
+  Mesh *mesh = BKE_mesh_add(bmain, name);
+  fill_mesh_from_ply(
+      mesh, data, axes_transform, import_params.global_scale, import_params.validate_meshes);
+
+  Object *ob = BKE_object_add_only_object(bmain, OB_MESH, name);
+  ob->data = mesh;
+
+  BKE_view_layer_base_deselect_all(view_layer);
+  LayerCollection *lc = BKE_layer_collection_get_active(view_layer);
+  BKE_collection_object_add(bmain, lc->collection, ob);
+  Base *base = BKE_view_layer_base_find(view_layer, ob);
+  BKE_view_layer_base_select_and_set_active(view_layer, base);
+
+  DEG_id_tag_update(&lc->collection->id, ID_RECALC_COPY_ON_WRITE);
+  DEG_id_tag_update_ex(
+      bmain, &ob->id, ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY | ID_RECALC_BASE_FLAGS);
+  DEG_id_tag_update(&scene->id, ID_RECALC_BASE_FLAGS);
+  DEG_relations_tag_update(bmain);
+  return true;
+}
+
+}  // namespace blender::io::ply
@@ -0,0 +1,570 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "BKE_global.h"
+
+#include "BLI_array.hh"
+#include "BLI_endian_switch.h"
+#include "BLI_task.hh"
+
+#include "IO_mapped_file.hh"
+#include "IO_string_parse.hh"
+
+#include "ply_import_file_reader.hh"
+
+namespace blender::io::ply {
+
+namespace {
+/** Vertex properties that are imported. */
+enum VertexSlot {
+  SlotX = 0,
+  SlotY,
+  SlotZ,
+  SlotNX,
+  SlotNY,
+  SlotNZ,
+  SlotU,
+  SlotV,
+  SlotRed,
+  SlotGreen,
+  SlotBlue,
+  SlotAlpha,
+  SlotsNum,
+};
+
+/** Where the properties of an element end up in #PLYData. */
+struct ElementLayout {
+  bool is_vertex = false;
+  bool is_face = false;
+  /** Vertex slot of every property, -1 for properties that are skipped. */
+  Vector<int> vertex_slots;
+  /** Factor from the stored value to 0..255 for color properties. */
+  Vector<double> color_scales;
+  /** Property with the vertex indices of faces, -1 when there is none. */
+  int face_list = -1;
+};
+}  // namespace
+
+static bool is_whitespace(const char c)
+{
+  return ELEM(c, ' ', '\t', '\r', '\n', '\v', '\f');
+}
+
+static StringRef next_token(const char *&p, const char *end)
+{
+  while (p < end && is_whitespace(*p)) {
+    p++;
+  }
+  const char *start = p;
+  while (p < end && !is_whitespace(*p)) {
+    p++;
+  }
+  return StringRef(start, p);
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Header
+ * \{ */
+
+static bool parse_data_type(StringRef name, PLYDataType &r_type)
+{
+  static const struct {
+    const char *name;
+    PLYDataType type;
+  } types[] = {
+      {"char", PLYDataType::Char},     {"int8", PLYDataType::Char},
+      {"uchar", PLYDataType::UChar},   {"uint8", PLYDataType::UChar},
+      {"short", PLYDataType::Short},   {"int16", PLYDataType::Short},
+      {"ushort", PLYDataType::UShort}, {"uint16", PLYDataType::UShort},
+      {"int", PLYDataType::Int},       {"int32", PLYDataType::Int},
+      {"uint", PLYDataType::UInt},     {"uint32", PLYDataType::UInt},
+      {"float", PLYDataType::Float},   {"float32", PLYDataType::Float},
+      {"double", PLYDataType::Double}, {"float64", PLYDataType::Double},
+  };
+  for (const auto &type : types) {
+    if (name == type.name) {
+      r_type = type.type;
+      return true;
+    }
+  }
+  return false;
+}
+
+static int64_t data_type_size(const PLYDataType type)
+{
+  switch (type) {
+    case PLYDataType::Char:
+    case PLYDataType::UChar:
+      return 1;
+    case PLYDataType::Short:
+    case PLYDataType::UShort:
+      return 2;
+    case PLYDataType::Int:
+    case PLYDataType::UInt:
+    case PLYDataType::Float:
+      return 4;
+    case PLYDataType::Double:
+      return 8;
+  }
+  BLI_assert_unreachable();
+  return 0;
+}
+
+bool parse_ply_header(StringRef data, PLYHeader &r_header)
+{
+  const char *p = data.begin();
+  const char *end = data.end();
+  if (next_token(p, end) != "ply") {
+    return false;
+  }
+
+  while (p < end) {
+    const char *line_end = std::find(p, end, '\n');
+    Vector<StringRef> tokens;
+    for (StringRef token = next_token(p, line_end); !token.is_empty();
+         token = next_token(p, line_end)) {
+      tokens.append(token);
+    }
+    p = std::min(line_end + 1, end);
+
+    if (tokens.is_empty()) {
+      continue;
+    }
+    if (tokens[0] == "format" && tokens.size() >= 2) {
+      if (tokens[1] == "ascii") {
+        r_header.format = PLYFormat::ASCII;
+      }
+      else if (tokens[1] == "binary_little_endian") {
+        r_header.format = PLYFormat::BinaryLittleEndian;
+      }
+      else if (tokens[1] == "binary_big_endian") {
+        r_header.format = PLYFormat::BinaryBigEndian;
+      }
+      else {
+        return false;
+      }
+    }
+    else if (tokens[0] == "element" && tokens.size() >= 3) {
+      PLYElement element;
+      element.name = tokens[1];
+      element.count = std::strtoll(std::string(tokens[2]).c_str(), nullptr, 10);
+      if (element.count < 0) {
+        return false;
+      }
+      r_header.elements.append(std::move(element));
+    }
+    else if (tokens[0] == "property" && !r_header.elements.is_empty()) {
+      PLYProperty property;
+      if (tokens.size() >= 5 && tokens[1] == "list") {
+        property.is_list = true;
+        if (!parse_data_type(tokens[2], property.count_type) ||
+            !parse_data_type(tokens[3], property.type)) {
+          return false;
+        }
+        property.name = tokens[4];
+      }
+      else if (tokens.size() >= 3) {
+        if (!parse_data_type(tokens[1], property.type)) {
+          return false;
+        }
+        property.name = tokens[2];
+      }
+      else {
+        return false;
+      }
+      r_header.elements.last().properties.append(std::move(property));
+    }
+    else if (tokens[0] == "end_header") {
+      r_header.data_offset = p - data.begin();
+      return true;
+    }
+    /* Skip `comment` and `obj_info` lines. */
+  }
+  return false;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Data
+ * \{ */
+
+static int vertex_slot(StringRef name)
+{
+  static const struct {
+    const char *name;
+    int slot;
+  } slots[] = {
+      {"x", SlotX},           {"y", SlotY},         {"z", SlotZ},
+      {"nx", SlotNX},         {"ny", SlotNY},       {"nz", SlotNZ},
+      {"s", SlotU},           {"t", SlotV},         {"u", SlotU},
+      {"v", SlotV},           {"texture_u", SlotU}, {"texture_v", SlotV},
+      {"texture_s", SlotU},   {"texture_t", SlotV}, {"red", SlotRed},
+      {"green", SlotGreen},   {"blue", SlotBlue},   {"alpha", SlotAlpha},
+      {"diffuse_red", SlotRed}, {"diffuse_green", SlotGreen}, {"diffuse_blue", SlotBlue},
+  };
+  for (const auto &slot : slots) {
+    if (name == slot.name) {
+      return slot.slot;
+    }
+  }
+  return -1;
+}
+
+static double color_scale(const PLYDataType type)
+{
+  switch (type) {
+    case PLYDataType::Float:
+    case PLYDataType::Double:
+      return 255.0;
+    case PLYDataType::Short:
+    case PLYDataType::UShort:
+      return 255.0 / 65535.0;
+    default:
+      return 1.0;
+  }
+}
+
+/**
+ * Check that the element count from the header can fit in the remaining data, before any
+ * arrays are allocated for it. A corrupt or malicious header could ask for billions of records.
+ *
+ * \param min_record_size: The smallest size a single record can have in the file.
+ */
+static bool element_count_fits(const PLYElement &element,
+                               const int64_t min_record_size,
+                               const int64_t available)
+{
+  if (element.count > available / std::max<int64_t>(min_record_size, 1)) {
+    fprintf(stderr,
+            "PLY element '%s' has %lld records, more than the file can contain\n",
+            element.name.c_str(),
+            (long long)element.count);
+    return false;
+  }
+  return true;
+}
+
+static ElementLayout element_layout(const PLYElement &element, PLYData &r_data)
+{
+  ElementLayout layout;
+  layout.is_vertex = element.name == "vertex";
+  layout.is_face = element.name == "face";
+  bool has_slot[SlotsNum] = {false};
+  for (const int i : element.properties.index_range()) {
+    const PLYProperty &property = element.properties[i];
+    const int slot = (layout.is_vertex && !property.is_list) ? vertex_slot(property.name) : -1;
+    layout.vertex_slots.append(slot);
+    layout.color_scales.append(color_scale(property.type));
+    if (slot != -1) {
+      has_slot[slot] = true;
+    }
+    if (layout.is_face && property.is_list &&
+        ELEM(property.name, "vertex_indices", "vertex_index")) {
+      layout.face_list = i;
+    }
+  }
+
+  if (layout.is_vertex) {
+    r_data.vertices.resize(element.count, float3(0.0f));
+    if (has_slot[SlotNX] && has_slot[SlotNY] && has_slot[SlotNZ]) {
+      r_data.vertex_normals.resize(element.count);
+    }
+    if (has_slot[SlotU] && has_slot[SlotV]) {
+      r_data.uv_coords.resize(element.count);
+    }
+    if (has_slot[SlotRed] && has_slot[SlotGreen] && has_slot[SlotBlue]) {
+      r_data.vertex_colors.resize(element.count);
+    }
+  }
+  return layout;
+}
+
+static void store_vertex(PLYData &r_data, const int64_t index, const double values[SlotsNum])
+{
+  r_data.vertices[index] = float3(values[SlotX], values[SlotY], values[SlotZ]);
+  if (!r_data.vertex_normals.is_empty()) {
+    r_data.vertex_normals[index] = float3(values[SlotNX], values[SlotNY], values[SlotNZ]);
+  }
+  if (!r_data.uv_coords.is_empty()) {
+    r_data.uv_coords[index] = float2(values[SlotU], values[SlotV]);
+  }
+  if (!r_data.vertex_colors.is_empty()) {
+    for (const int i : IndexRange(4)) {
+      const double value = std::round(values[SlotRed + i]);
+      r_data.vertex_colors[index][i] = uint8_t(std::min(std::max(value, 0.0), 255.0));
+    }
+  }
+}
+
+static void init_vertex_values(double values[SlotsNum])
+{
+  std::fill_n(values, int(SlotsNum), 0.0);
+  values[SlotAlpha] = 255.0;
+}
+
+template<typename T> static T read_binary(const char *p, const bool swap)
+{
+  T value;
+  memcpy(&value, p, sizeof(T));
+  if (swap && sizeof(T) > 1) {
+    char *bytes = reinterpret_cast<char *>(&value);
+    std::reverse(bytes, bytes + sizeof(T));
+  }
+  return value;
+}
+
+static double read_binary_value(const char *p, const PLYDataType type, const bool swap)
+{
+  switch (type) {
+    case PLYDataType::Char:
+      return read_binary<int8_t>(p, swap);
+    case PLYDataType::UChar:
+      return read_binary<uint8_t>(p, swap);
+    case PLYDataType::Short:
+      return read_binary<int16_t>(p, swap);
+    case PLYDataType::UShort:
+      return read_binary<uint16_t>(p, swap);
+    case PLYDataType::Int:
+      return read_binary<int32_t>(p, swap);
+    case PLYDataType::UInt:
+      return read_binary<uint32_t>(p, swap);
+    case PLYDataType::Float:
+      return read_binary<float>(p, swap);
+    case PLYDataType::Double:
+      return read_binary<double>(p, swap);
+  }
+  BLI_assert_unreachable();
+  return 0.0;
+}
+
+static bool parse_binary_element(const char *&p,
+                                 const char *end,
+                                 const PLYElement &element,
+                                 const bool swap,
+                                 PLYData &r_data)
+{
+  const Span<PLYProperty> properties = element.properties;
+  const int64_t count = element.count;
+  const int64_t available = end - p;
+
+  bool has_lists = false;
+  int64_t record_size = 0;
+  /* Lists can be empty, only their size is always stored. */
+  int64_t min_record_size = 0;
+  for (const PLYProperty &property : properties) {
+    has_lists |= property.is_list;
+    record_size += data_type_size(property.type);
+    min_record_size += data_type_size(property.is_list ? property.count_type : property.type);
+  }
+  if (!element_count_fits(element, min_record_size, available)) {
+    return false;
+  }
+  const ElementLayout layout = element_layout(element, r_data);
+
+  /* Records with lists have varying sizes, find where every record starts first. This only
+   * reads the list sizes, the values are decoded from multiple threads after. */
+  Array<int64_t> record_offsets;
+  Array<int> face_sizes;
+  int64_t total_size = record_size * count;
+  if (has_lists) {
+    record_offsets.reinitialize(count + 1);
+    if (layout.face_list != -1) {
+      face_sizes.reinitialize(count);
+    }
+    int64_t offset = 0;
+    for (const int64_t i : IndexRange(count)) {
+      record_offsets[i] = offset;
+      for (const int prop_index : properties.index_range()) {
+        const PLYProperty &property = properties[prop_index];
+        if (!property.is_list) {
+          offset += data_type_size(property.type);
+          continue;
+        }
+        const int64_t count_size = data_type_size(property.count_type);
+        if (offset + count_size > available) {
+          return false;
+        }
+        const double items_num = read_binary_value(p + offset, property.count_type, swap);
+        if (items_num < 0) {
+          return false;
+        }
+        if (prop_index == layout.face_list) {
+          face_sizes[i] = int(items_num);
+        }
+        offset += count_size + int64_t(items_num) * data_type_size(property.type);
+      }
+    }
+    record_offsets[count] = offset;
+    total_size = offset;
+  }
+  if (total_size > available) {
+    return false;
+  }
+
+  if (layout.face_list != -1) {
+    r_data.face_offsets.resize(count + 1);
+    r_data.face_offsets[0] = 0;
+    for (const int64_t i : IndexRange(count)) {
+      r_data.face_offsets[i + 1] = r_data.face_offsets[i] + face_sizes[i];
+    }
+    r_data.face_vertices.resize(r_data.face_offsets.last());
+  }
+
+  if (layout.is_vertex || layout.face_list != -1) {
+    parallel_for(IndexRange(count), 8 * 1024, [&](IndexRange range) {
+      double values[SlotsNum];
+      for (const int64_t i : range) {
+        const char *record = p + (has_lists ? record_offsets[i] : i * record_size);
+        init_vertex_values(values);
+        for (const int prop_index : properties.index_range()) {
+          const PLYProperty &property = properties[prop_index];
+          const int64_t type_size = data_type_size(property.type);
+          if (property.is_list) {
+            const int items_num = int(read_binary_value(record, property.count_type, swap));
+            record += data_type_size(property.count_type);
+            if (prop_index == layout.face_list) {
+              int *face_verts = &r_data.face_vertices[r_data.face_offsets[i]];
+              for (const int j : IndexRange(items_num)) {
+                face_verts[j] = int(
+                    read_binary_value(record + j * type_size, property.type, swap));
+              }
+            }
+            record += items_num * type_size;
+            continue;
+          }
+          const int slot = layout.vertex_slots[prop_index];
+          if (slot != -1) {
+            values[slot] = read_binary_value(record, property.type, swap);
+            if (slot >= SlotRed) {
+              values[slot] *= layout.color_scales[prop_index];
+            }
+          }
+          record += type_size;
+        }
+        if (layout.is_vertex) {
+          store_vertex(r_data, i, values);
+        }
+      }
+    });
+  }
+
+  p += total_size;
+  return true;
+}
+
+static bool parse_ascii_value(const char *&p, const char *end, double &r_value)
+{
+  const StringRef token = next_token(p, end);
+  if (token.is_empty()) {
+    return false;
+  }
+  /* Not #strtod, which depends on the locale for the decimal separator. */
+  parse_double(token, r_value);
+  return true;
+}
+
+static bool parse_ascii_element(const char *&p,
+                                const char *end,
+                                const PLYElement &element,
+                                PLYData &r_data)
+{
+  /* Every value takes at least one character and a separator, the last one may be missing. */
+  const int64_t min_record_size = 2 * element.properties.size();
+  if (!element_count_fits(element, min_record_size, end - p + 1)) {
+    return false;
+  }
+  const ElementLayout layout = element_layout(element, r_data);
+  double values[SlotsNum];
+  for (const int64_t i : IndexRange(element.count)) {
+    init_vertex_values(values);
+    for (const int prop_index : element.properties.index_range()) {
+      const PLYProperty &property = element.properties[prop_index];
+      double value;
+      if (!parse_ascii_value(p, end, value)) {
+        return false;
+      }
+      if (property.is_list) {
+        const int items_num = int(value);
+        for (int j = 0; j < items_num; j++) {
+          if (!parse_ascii_value(p, end, value)) {
+            return false;
+          }
+          if (prop_index == layout.face_list) {
+            r_data.face_vertices.append(int(value));
+          }
+        }
+        if (prop_index == layout.face_list) {
+          r_data.face_offsets.append(int(r_data.face_vertices.size()));
+        }
+        continue;
+      }
+      const int slot = layout.vertex_slots[prop_index];
+      if (slot != -1) {
+        values[slot] = value * (slot >= SlotRed ? layout.color_scales[prop_index] : 1.0);
+      }
+    }
+    if (layout.is_vertex) {
+      store_vertex(r_data, i, values);
+    }
+  }
+  return true;
+}
+
+bool parse_ply_data(StringRef data, const PLYHeader &header, PLYData &r_data)
+{
+  const char *p = data.begin() + header.data_offset;
+  const char *end = data.end();
+  const bool swap = (header.format == PLYFormat::BinaryBigEndian) != (ENDIAN_ORDER == B_ENDIAN);
+  for (const PLYElement &element : header.elements) {
+    const bool ok = header.format == PLYFormat::ASCII ?
+                        parse_ascii_element(p, end, element, r_data) :
+                        parse_binary_element(p, end, element, swap, r_data);
+    if (!ok) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** \} */
+
+bool read_ply_file(const char *filepath, PLYData &r_data)
+{
+  MappedFile file(filepath);
+  if (!file.is_open()) {
+    return false;
+  }
+  PLYHeader header;
+  if (!parse_ply_header(file.data(), header)) {
+    return false;
+  }
+  return parse_ply_data(file.data(), header, r_data);
+}
+
+}  // namespace blender::io::ply
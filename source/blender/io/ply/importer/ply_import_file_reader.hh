@@ -0,0 +1,86 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <string>
+
+#include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+
+#include "ply_data.hh"
+
+namespace blender::io::ply {
+
+enum class PLYFormat {
+  ASCII,
+  BinaryLittleEndian,
+  BinaryBigEndian,
+};
+
+enum class PLYDataType {
+  Char,
+  UChar,
+  Short,
+  UShort,
+  Int,
+  UInt,
+  Float,
+  Double,
+};
+
+struct PLYProperty {
+  std::string name;
+  PLYDataType type;
+  bool is_list = false;
+  /** Type of the item count of list properties. */
+  PLYDataType count_type = PLYDataType::UChar;
+};
+
+struct PLYElement {
+  std::string name;
+  int64_t count = 0;
+  Vector<PLYProperty> properties;
+};
+
+struct PLYHeader {
+  PLYFormat format = PLYFormat::ASCII;
+  Vector<PLYElement> elements;
+  /** Offset of the data after `end_header`. */
+  int64_t data_offset = 0;
+};
+
+/** \return False when the data doesn't start with a valid header. */
+bool parse_ply_header(StringRef data, PLYHeader &r_header);
+
+/**
+ * Read the `vertex` and `face` elements, other elements are skipped. Binary elements are
+ * decoded from multiple threads, elements with lists are scanned once to find the records first.
+ * \return False when the data ends early.
+ */
+bool parse_ply_data(StringRef data, const PLYHeader &header, PLYData &r_data);
+
+/** \return False when the file can't be read or is not a valid PLY file. */
+bool read_ply_file(const char *filepath, PLYData &r_data);
+
+}  // namespace blender::io::ply
@@ -0,0 +1,143 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup ply
+ */
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+
+#include "BLI_array.hh"
+#include "BLI_math.h"
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "ply_import_mesh.hh"
+
+namespace blender::io::ply {
+
+static bool face_is_valid(const PLYData &data, const int face)
+{
+  const int start = data.face_offsets[face];
+  const int size = data.face_offsets[face + 1] - start;
+  if (size < 3) {
+    return false;
+  }
+  for (const int vert : data.face_vertices.as_span().slice(start, size)) {
+    if (vert < 0 || vert >= data.vertices.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void fill_mesh_from_ply(Mesh *mesh,
+                        const PLYData &data,
+                        const float axes_transform[3][3],
+                        const float global_scale,
+                        const bool validate)
+{
+  Vector<int> faces;
+  Vector<int> loop_starts;
+  int tot_loops = 0;
+  for (const int face : IndexRange(data.faces_num())) {
+    if (face_is_valid(data, face)) {
+      faces.append(face);
+      loop_starts.append(tot_loops);
+      tot_loops += data.face_offsets[face + 1] - data.face_offsets[face];
+    }
+  }
+
+  mesh->totvert = int(data.vertices.size());
+  mesh->totpoly = int(faces.size());
+  mesh->totloop = tot_loops;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+
+  const bool use_vertex_normals = !data.vertex_normals.is_empty() && mesh->totpoly > 0;
+
+  MLoopUV *mloopuv = nullptr;
+  if (!data.uv_coords.is_empty() && mesh->totloop > 0) {
+    mloopuv = static_cast<MLoopUV *>(CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop, "UVMap"));
+  }
+  MLoopCol *mloopcol = nullptr;
+  if (!data.vertex_colors.is_empty() && mesh->totloop > 0) {
+    mloopcol = static_cast<MLoopCol *>(CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPCOL, CD_CALLOC, nullptr, mesh->totloop, "Col"));
+  }
+  BKE_mesh_update_customdata_pointers(mesh, false);
+
+  parallel_for(IndexRange(mesh->totvert), 16 * 1024, [&](IndexRange range) {
+    for (const int i : range) {
+      MVert &mvert = mesh->mvert[i];
+      mul_v3_m3v3(mvert.co, axes_transform, data.vertices[i]);
+      mul_v3_fl(mvert.co, global_scale);
+    }
+  });
+
+  parallel_for(faces.index_range(), 8 * 1024, [&](IndexRange range) {
+    for (const int i : range) {
+      const int face = faces[i];
+      const int start = data.face_offsets[face];
+      MPoly &mpoly = mesh->mpoly[i];
+      mpoly.loopstart = loop_starts[i];
+      mpoly.totloop = data.face_offsets[face + 1] - start;
+      mpoly.flag = use_vertex_normals ? ME_SMOOTH : 0;
+      for (const int j : IndexRange(mpoly.totloop)) {
+        const int loop = mpoly.loopstart + j;
+        const int vert = data.face_vertices[start + j];
+        mesh->mloop[loop].v = uint(vert);
+        if (mloopuv) {
+          copy_v2_v2(mloopuv[loop].uv, data.uv_coords[vert]);
+        }
+        if (mloopcol) {
+          const std::array<uint8_t, 4> &color = data.vertex_colors[vert];
+          mloopcol[loop] = {color[0], color[1], color[2], color[3]};
+        }
+      }
+    }
+  });
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+
+  if (use_vertex_normals) {
+    Array<float3> vert_normals(mesh->totvert);
+    parallel_for(IndexRange(mesh->totvert), 16 * 1024, [&](IndexRange range) {
+      for (const int i : range) {
+        mul_v3_m3v3(vert_normals[i], axes_transform, data.vertex_normals[i]);
+        normalize_v3(vert_normals[i]);
+      }
+    });
+    mesh->flag |= ME_AUTOSMOOTH;
+    BKE_mesh_set_custom_normals_from_vertices(mesh,
+                                              reinterpret_cast<float(*)[3]>(vert_normals.data()));
+  }
+
+  if (validate) {
+    BKE_mesh_validate(mesh, false, false);
+  }
+}
+
+}  // namespace blender::io::ply
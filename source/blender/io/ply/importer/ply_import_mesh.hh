@@ -0,0 +1,44 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup ply
+ */
+
+#include "ply_data.hh"
+
+struct Mesh;
+
+namespace blender::io::ply {
+
+/**
+ * Fill the arrays of an empty mesh. Faces with less than three corners or vertex indices out of
+ * range are skipped, files without faces become a point cloud of loose vertices.
+ *
+ * \param axes_transform: Conversion from the axes of the file to Blender's axes.
+ */
+void fill_mesh_from_ply(Mesh *mesh,
+                        const PLYData &data,
+                        const float axes_transform[3][3],
+                        float global_scale,
+                        bool validate);
+
+}  // namespace blender::io::ply
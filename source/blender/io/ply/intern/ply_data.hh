@@ -0,0 +1,55 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup ply
+ */
+
+#include <array>
+
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+#include "BLI_vector.hh"
+
+namespace blender::io::ply {
+
+/**
+ * Vertices and faces of a PLY file, the same for import and export. PLY stores UV's, normals and
+ * colors per vertex, optional arrays are empty when not in the file.
+ */
+struct PLYData {
+  Vector<float3> vertices;
+  Vector<float3> vertex_normals;
+  Vector<float2> uv_coords;
+  /** RGBA in 0..255. */
+  Vector<std::array<uint8_t, 4>> vertex_colors;
+
+  /** Start of every face in #face_vertices, with the total size as last element. */
+  Vector<int> face_offsets = {0};
+  Vector<int> face_vertices;
+
+  int64_t faces_num() const
+  {
+    return face_offsets.size() - 1;
+  }
+};
+
+}  // namespace blender::io::ply
@@ -0,0 +1,294 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <string>
+
+#include "BKE_appdir.h"
+#include "BKE_customdata.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+
+#include "BLI_fileops.h"
+#include "BLI_math.h"
+#include "BLI_path_util.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "PIL_time.h"
+
+#include "ply_export_file_writer.hh"
+#include "ply_import_file_reader.hh"
+#include "ply_import_mesh.hh"
+
+#define DO_PERF_TESTS 0
+
+namespace blender::io::ply::tests {
+
+class PLYImporterTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+    BKE_tempdir_init(nullptr);
+  }
+
+  static void TearDownTestSuite()
+  {
+    BKE_tempdir_session_purge();
+  }
+};
+
+/* Grid of `size` x `size` vertices with normals and colors, like the output of a 3D scanner. */
+static PLYData scan_data_create(const int size, const bool with_faces)
+{
+  PLYData data;
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      data.vertices.append(float3(x * 0.5f, y * 0.25f, float((x * y) % 7)));
+      data.vertex_normals.append(float3(0.0f, 0.0f, (x + y) % 2 ? 1.0f : -1.0f));
+      data.vertex_colors.append({uint8_t(x), uint8_t(y), uint8_t(x + y), 255});
+    }
+  }
+  if (with_faces) {
+    for (int y = 0; y + 1 < size; y++) {
+      for (int x = 0; x + 1 < size; x++) {
+        const int v = y * size + x;
+        data.face_vertices.extend({v, v + 1, v + size + 1, v + size});
+        data.face_offsets.append(int(data.face_vertices.size()));
+      }
+    }
+  }
+  return data;
+}
+
+static void expect_data_eq(const PLYData &a, const PLYData &b)
+{
+  EXPECT_EQ(a.vertices.as_span(), b.vertices.as_span());
+  EXPECT_EQ(a.vertex_normals.as_span(), b.vertex_normals.as_span());
+  EXPECT_EQ(a.uv_coords.size(), b.uv_coords.size());
+  EXPECT_EQ(a.vertex_colors.as_span(), b.vertex_colors.as_span());
+  EXPECT_EQ(a.face_offsets.as_span(), b.face_offsets.as_span());
+  EXPECT_EQ(a.face_vertices.as_span(), b.face_vertices.as_span());
+}
+
+static std::string temp_filepath(const char *filename)
+{
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), filename);
+  return filepath;
+}
+
+TEST_F(PLYImporterTest, RoundTrip)
+{
+  const PLYData data = scan_data_create(20, true);
+  for (const bool ascii_format : {false, true}) {
+    const std::string filepath = temp_filepath("round_trip.ply");
+    ASSERT_TRUE(write_ply_file(filepath.c_str(), data, ascii_format));
+
+    PLYData result;
+    ASSERT_TRUE(read_ply_file(filepath.c_str(), result));
+    expect_data_eq(data, result);
+    BLI_delete(filepath.c_str(), false, false);
+  }
+}
+
+TEST_F(PLYImporterTest, BinaryBigEndian)
+{
+  std::string file =
+      "ply\r\n"
+      "format binary_big_endian 1.0\r\n"
+      "comment test\r\n"
+      "element vertex 3\r\n"
+      "property double x\r\n"
+      "property float y\r\n"
+      "property short z\r\n"
+      "property ushort red\r\n"
+      "property uchar green\r\n"
+      "property float blue\r\n"
+      "element face 1\r\n"
+      "property uchar flags\r\n"
+      "property list ushort int vertex_indices\r\n"
+      "end_header\r\n";
+  auto append_big_endian = [&](const void *value, const size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      file += static_cast<const char *>(value)[ENDIAN_ORDER == B_ENDIAN ? i : size - 1 - i];
+    }
+  };
+  for (int i = 0; i < 3; i++) {
+    const double x = i + 0.5;
+    const float y = -i;
+    const int16_t z = int16_t(-300 * i);
+    const uint16_t red = 65535;
+    const uint8_t green = 128;
+    const float blue = 0.5f;
+    append_big_endian(&x, sizeof(x));
+    append_big_endian(&y, sizeof(y));
+    append_big_endian(&z, sizeof(z));
+    append_big_endian(&red, sizeof(red));
+    append_big_endian(&green, sizeof(green));
+    append_big_endian(&blue, sizeof(blue));
+  }
+  const uint8_t flags = 7;
+  const uint16_t corners = 3;
+  append_big_endian(&flags, sizeof(flags));
+  append_big_endian(&corners, sizeof(corners));
+  for (const int32_t vert : {2, 1, 0}) {
+    append_big_endian(&vert, sizeof(vert));
+  }
+
+  PLYHeader header;
+  ASSERT_TRUE(parse_ply_header(file, header));
+  EXPECT_EQ(header.format, PLYFormat::BinaryBigEndian);
+  ASSERT_EQ(header.elements.size(), 2);
+  EXPECT_EQ(header.elements[1].properties[1].count_type, PLYDataType::UShort);
+
+  PLYData data;
+  ASSERT_TRUE(parse_ply_data(file, header, data));
+  ASSERT_EQ(data.vertices.size(), 3);
+  EXPECT_EQ(data.vertices[2], float3(2.5f, -2.0f, -600.0f));
+  EXPECT_TRUE(data.vertex_normals.is_empty());
+  ASSERT_EQ(data.vertex_colors.size(), 3);
+  EXPECT_EQ(data.vertex_colors[1][0], 255);
+  EXPECT_EQ(data.vertex_colors[1][1], 128);
+  EXPECT_EQ(data.vertex_colors[1][2], 128);
+  EXPECT_EQ(data.vertex_colors[1][3], 255);
+  EXPECT_EQ(data.face_vertices.as_span(), Span<int>({2, 1, 0}));
+
+  /* Truncated data. */
+  PLYData truncated_data;
+  file.pop_back();
+  EXPECT_FALSE(parse_ply_data(file, header, truncated_data));
+}
+
+TEST_F(PLYImporterTest, CountLargerThanFile)
+{
+  for (const char *format : {"binary_little_endian", "ascii"}) {
+    const std::string file = std::string("ply\nformat ") + format +
+                             " 1.0\n"
+                             "element vertex 4000000000000\n"
+                             "property float x\n"
+                             "property float y\n"
+                             "property float z\n"
+                             "end_header\n"
+                             "0 0 0\n";
+    PLYHeader header;
+    ASSERT_TRUE(parse_ply_header(file, header));
+    PLYData data;
+    EXPECT_FALSE(parse_ply_data(file, header, data));
+    EXPECT_TRUE(data.vertices.is_empty());
+  }
+}
+
+TEST_F(PLYImporterTest, ASCIIIgnoresLocale)
+{
+  const std::string file =
+      "ply\n"
+      "format ascii 1.0\n"
+      "element vertex 1\n"
+      "property float x\n"
+      "property float y\n"
+      "property float z\n"
+      "end_header\n"
+      "0.5 -1.25 2e-1\n";
+  PLYHeader header;
+  ASSERT_TRUE(parse_ply_header(file, header));
+  PLYData data;
+  ASSERT_TRUE(parse_ply_data(file, header, data));
+  ASSERT_EQ(data.vertices.size(), 1);
+  EXPECT_EQ(data.vertices[0], float3(0.5f, -1.25f, 0.2f));
+}
+
+TEST_F(PLYImporterTest, MeshSkipsInvalidFaces)
+{
+  PLYData data = scan_data_create(3, false);
+  data.face_vertices = {0, 1, 4, 3, 1, 2, 0, 1, 9, 4, 5, 8};
+  data.face_offsets = {0, 4, 6, 9, 12};
+  float axes_transform[3][3];
+  unit_m3(axes_transform);
+  Mesh *mesh = static_cast<Mesh *>(BKE_id_new_nomain(ID_ME, nullptr));
+  fill_mesh_from_ply(mesh, data, axes_transform, 2.0f, false);
+
+  EXPECT_EQ(mesh->totvert, 9);
+  ASSERT_EQ(mesh->totpoly, 2);
+  EXPECT_EQ(mesh->totloop, 7);
+  EXPECT_EQ(mesh->mloop[4].v, 4);
+  EXPECT_EQ(float3(mesh->mvert[4].co), data.vertices[4] * 2.0f);
+  EXPECT_TRUE(CustomData_has_layer(&mesh->ldata, CD_MLOOPCOL));
+  EXPECT_TRUE(mesh->flag & ME_AUTOSMOOTH);
+  BKE_id_free(nullptr, mesh);
+}
+
+#if DO_PERF_TESTS
+
+/* Time parsing and creating the mesh for binary and text files, increase the grid size to
+ * measure meshes of scan resolution. */
+
+#define GRID_SIZE 500
+#define NUM_RUN_AVERAGED 3
+
+TEST_F(PLYImporterTest, PerformanceScan)
+{
+  const PLYData data = scan_data_create(GRID_SIZE, true);
+
+  printf("\n========== STARTING %d vertices ==========\n", GRID_SIZE * GRID_SIZE);
+
+  for (const bool ascii_format : {false, true}) {
+    const std::string filepath = temp_filepath("scan.ply");
+    ASSERT_TRUE(write_ply_file(filepath.c_str(), data, ascii_format));
+    const double megabytes = double(BLI_file_size(filepath.c_str())) / (1024.0 * 1024.0);
+
+    double read_timing = 0.0, mesh_timing = 0.0;
+    for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+      double init_time = PIL_check_seconds_timer();
+      PLYData result;
+      EXPECT_TRUE(read_ply_file(filepath.c_str(), result));
+      read_timing += PIL_check_seconds_timer() - init_time;
+
+      init_time = PIL_check_seconds_timer();
+      float axes_transform[3][3];
+      unit_m3(axes_transform);
+      Mesh *mesh = static_cast<Mesh *>(BKE_id_new_nomain(ID_ME, nullptr));
+      fill_mesh_from_ply(mesh, result, axes_transform, 1.0f, false);
+      mesh_timing += PIL_check_seconds_timer() - init_time;
+
+      EXPECT_EQ(mesh->totpoly, (GRID_SIZE - 1) * (GRID_SIZE - 1));
+      BKE_id_free(nullptr, mesh);
+    }
+    BLI_delete(filepath.c_str(), false, false);
+
+    printf("\t%s, %.1f MB\n", ascii_format ? "ascii" : "binary", megabytes);
+    printf("\tread_ply_file: done in %fs on average over %d runs (%.1f MB/s)\n",
+           read_timing / NUM_RUN_AVERAGED,
+           NUM_RUN_AVERAGED,
+           megabytes * NUM_RUN_AVERAGED / read_timing);
+    printf("\tfill_mesh_from_ply: done in %fs on average over %d runs\n",
+           mesh_timing / NUM_RUN_AVERAGED,
+           NUM_RUN_AVERAGED);
+  }
+  printf("========== ENDED %d vertices ==========\n\n", GRID_SIZE * GRID_SIZE);
+}
+
+#endif
+
+}  // namespace blender::io::ply::tests
@@ -0,0 +1,40 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup stl
+ */
+
+#include "BKE_context.h"
+
+#include "IO_stl.h"
+
+#include "stl_export.hh"
+#include "stl_import.hh"
+
+bool STL_import(bContext *C, const STLImportParams *import_params)
+{
+  return blender::io::stl::importer_main(
+      CTX_data_main(C), CTX_data_scene(C), CTX_data_view_layer(C), *import_params);
+}
+
+bool STL_export(bContext *C, const STLExportParams *export_params)
+{
+  return blender::io::stl::exporter_main(C, *export_params);
+}
@@ -0,0 +1,201 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup stl
+ */
+
+#include <cstdio>
+
+#include "BKE_blender_version.h"
+#include "BKE_context.h"
+#include "BKE_global.h"
+#include "BKE_mesh_runtime.h"
+#include "BKE_object.h"
+
+#include "BLI_endian_switch.h"
+#include "BLI_fileops.h"
+#include "BLI_float4x4.hh"
+#include "BLI_math.h"
+#include "BLI_string.h"
+#include "BLI_vector.hh"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "IO_text_format.hh"
+
+#include "stl_export.hh"
+
+namespace blender::io::stl {
+
+namespace {
+struct ExportMesh {
+  const Mesh *mesh;
+  Span<MLoopTri> looptris;
+  /** World space, axis conversion and scale. */
+  float4x4 transform;
+  /** Keep triangles facing outwards for negatively scaled objects. */
+  bool flip_winding;
+};
+}  // namespace
+
+static Vector<ExportMesh> collect_meshes(Depsgraph *depsgraph,
+                                         const STLExportParams &export_params)
+{
+  float axes_transform[3][3];
+  unit_m3(axes_transform);
+  mat3_from_axis_conversion(
+      OB_POSY, OB_POSZ, export_params.forward_axis, export_params.up_axis, axes_transform);
+  mul_m3_fl(axes_transform, export_params.global_scale);
+  float axes_transform_4x4[4][4];
+  copy_m4_m3(axes_transform_4x4, axes_transform);
+
+  Vector<ExportMesh> meshes;
+  DEG_OBJECT_ITER_BEGIN (depsgraph,
+                         object,
+                         DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
+                             DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET | DEG_ITER_OBJECT_FLAG_VISIBLE |
+                             DEG_ITER_OBJECT_FLAG_DUPLI) {
+    if (export_params.export_selected_objects && !(object->base_flag & BASE_SELECTED)) {
+      continue;
+    }
+    if (object->type != OB_MESH) {
+      continue;
+    }
+    Mesh *mesh = export_params.apply_modifiers ?
+                     BKE_object_get_evaluated_mesh(object) :
+                     static_cast<Mesh *>(DEG_get_original_object(object)->data);
+    if (mesh == nullptr) {
+      continue;
+    }
+    ExportMesh export_mesh;
+    export_mesh.mesh = mesh;
+    export_mesh.looptris = Span<MLoopTri>(BKE_mesh_runtime_looptri_ensure(mesh),
+                                          BKE_mesh_runtime_looptri_len(mesh));
+    mul_m4_m4m4(export_mesh.transform.values, axes_transform_4x4, object->obmat);
+    export_mesh.flip_winding = is_negative_m4(export_mesh.transform.values);
+    meshes.append(export_mesh);
+  }
+  DEG_OBJECT_ITER_END;
+  return meshes;
+}
+
+static void append_binary_floats(FormatBuffer &buffer, float values[], const int len)
+{
+  if (ENDIAN_ORDER == B_ENDIAN) {
+    BLI_endian_switch_float_array(values, len);
+  }
+  for (const int i : IndexRange(len)) {
+    buffer.append_binary(values[i]);
+  }
+}
+
+static void write_triangles(FILE *file, const ExportMesh &export_mesh, const bool ascii_format)
+{
+  const Span<MLoopTri> looptris = export_mesh.looptris;
+  const Mesh &mesh = *export_mesh.mesh;
+  write_formatted_chunks(file, looptris.size(), [&](FormatBuffer &buffer, IndexRange range) {
+    for (const MLoopTri &looptri : looptris.slice(range)) {
+      float3 co[3];
+      for (const int i : IndexRange(3)) {
+        const int corner = export_mesh.flip_winding ? 2 - i : i;
+        co[i] = export_mesh.transform * float3(mesh.mvert[mesh.mloop[looptri.tri[corner]].v].co);
+      }
+      float3 normal;
+      normal_tri_v3(normal, co[0], co[1], co[2]);
+
+      if (ascii_format) {
+        buffer.append("facet normal ");
+        for (const int axis : IndexRange(3)) {
+          buffer.append_float(normal[axis], 6);
+          buffer.append(axis == 2 ? '\n' : ' ');
+        }
+        buffer.append("outer loop\n");
+        for (const float3 &vert : co) {
+          buffer.append("vertex ");
+          for (const int axis : IndexRange(3)) {
+            buffer.append_float(vert[axis], 6);
+            buffer.append(axis == 2 ? '\n' : ' ');
+          }
+        }
+        buffer.append("endloop\nendfacet\n");
+      }
+      else {
+        float values[12];
+        copy_v3_v3(values, normal);
+        copy_v3_v3(values + 3, co[0]);
+        copy_v3_v3(values + 6, co[1]);
+        copy_v3_v3(values + 9, co[2]);
+        append_binary_floats(buffer, values, 12);
+        const uint16_t attribute_byte_count = 0;
+        buffer.append_binary(attribute_byte_count);
+      }
+    }
+  });
+}
+
+bool exporter_main(bContext *C, const STLExportParams &export_params)
+{
+  Depsgraph *depsgraph = CTX_data_ensure_evaluated_depsgraph(C);
+  const Vector<ExportMesh> meshes = collect_meshes(depsgraph, export_params);
+
+  FILE *file = BLI_fopen(export_params.filepath, "wb");
+  if (file == nullptr) {
+    fprintf(stderr, "Error: cannot open file '%s' for writing\n", export_params.filepath);
+    return false;
+  }
+
+  char name[80];
+  BLI_snprintf(name, sizeof(name), "Exported from Blender-%s", BKE_blender_version_string());
+
+  if (export_params.ascii_format) {
+    fprintf(file, "solid %s\n", name);
+  }
+  else {
+    uint32_t tris_num = 0;
+    for (const ExportMesh &export_mesh : meshes) {
+      tris_num += uint32_t(export_mesh.looptris.size());
+    }
+    if (ENDIAN_ORDER == B_ENDIAN) {
+      BLI_endian_switch_uint32(&tris_num);
+    }
+    char header[80] = {0};
+    memcpy(header, name, strlen(name));
+    fwrite(header, 1, sizeof(header), file);
+    fwrite(&tris_num, 1, sizeof(tris_num), file);
+  }
+
+  for (const ExportMesh &export_mesh : meshes) {
+    write_triangles(file, export_mesh, export_params.ascii_format);
+  }
+
+  if (export_params.ascii_format) {
+    fprintf(file, "endsolid %s\n", name);
+  }
+  fclose(file);
+  return true;
+}
+
+}  // namespace blender::io::stl
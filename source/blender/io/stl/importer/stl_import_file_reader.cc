@@ -0,0 +1,205 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup stl
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "BKE_global.h"
+
+#include "BLI_endian_switch.h"
+#include "BLI_task.hh"
+
+#include "IO_mapped_file.hh"
+#include "IO_string_parse.hh"
+
+#include "stl_import_file_reader.hh"
+
+namespace blender::io::stl {
+
+static constexpr int64_t binary_header_size = 84;
+static constexpr int64_t binary_record_size = 50;
+
+static bool is_whitespace(const char c)
+{
+  return ELEM(c, ' ', '\t', '\r', '\n', '\v', '\f');
+}
+
+static uint32_t binary_triangle_count(StringRef data)
+{
+  uint32_t count;
+  memcpy(&count, data.data() + 80, sizeof(count));
+  if (ENDIAN_ORDER == B_ENDIAN) {
+    BLI_endian_switch_uint32(&count);
+  }
+  return count;
+}
+
+bool is_binary_stl(StringRef data)
+{
+  if (data.size() < binary_header_size) {
+    return false;
+  }
+  const uint64_t count = binary_triangle_count(data);
+  if (binary_header_size + count * binary_record_size == uint64_t(data.size())) {
+    return true;
+  }
+  if (!data.startswith("solid")) {
+    return true;
+  }
+  /* Binary files with a `solid` header are common, tell them apart by the control characters
+   * that binary data contains, most often the zero bytes of small integers and padding. */
+  const int64_t check_size = std::min<int64_t>(data.size(), binary_header_size + 512);
+  for (const char c : data.substr(0, check_size)) {
+    if ((uint8_t(c) < 0x20 && !is_whitespace(c)) || uint8_t(c) == 0x7f) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parse_stl_binary(StringRef data, STLTriangles &r_triangles)
+{
+  if (data.size() < binary_header_size) {
+    return false;
+  }
+  const int64_t expected_count = binary_triangle_count(data);
+  const int64_t count = std::min<int64_t>(expected_count,
+                                          (data.size() - binary_header_size) /
+                                              binary_record_size);
+  const char *records = data.data() + binary_header_size;
+  r_triangles.corners.resize(count * 3);
+  r_triangles.facet_normals.resize(count);
+  MutableSpan<float3> corners = r_triangles.corners;
+  MutableSpan<float3> facet_normals = r_triangles.facet_normals;
+
+  parallel_for(IndexRange(count), 16 * 1024, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      /* Records are not aligned, copy them. */
+      float values[12];
+      memcpy(values, records + i * binary_record_size, sizeof(values));
+      if (ENDIAN_ORDER == B_ENDIAN) {
+        BLI_endian_switch_float_array(values, 12);
+      }
+      facet_normals[i] = float3(values);
+      corners[i * 3] = float3(values + 3);
+      corners[i * 3 + 1] = float3(values + 6);
+      corners[i * 3 + 2] = float3(values + 9);
+    }
+  });
+  return count == expected_count;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name ASCII
+ * \{ */
+
+static StringRef next_token(const char *&p, const char *end)
+{
+  while (p < end && is_whitespace(*p)) {
+    p++;
+  }
+  const char *start = p;
+  while (p < end && !is_whitespace(*p)) {
+    p++;
+  }
+  return StringRef(start, p);
+}
+
+static void skip_line(const char *&p, const char *end)
+{
+  while (p < end && *p != '\n') {
+    p++;
+  }
+}
+
+static float3 parse_float3(const char *&p, const char *end)
+{
+  float3 value(0.0f);
+  for (int i = 0; i < 3; i++) {
+    /* Not #strtof, which depends on the locale for the decimal separator. */
+    double component;
+    parse_double(next_token(p, end), component);
+    value[i] = float(component);
+  }
+  return value;
+}
+
+void parse_stl_ascii(StringRef data, STLTriangles &r_triangles)
+{
+  const char *p = data.begin();
+  const char *end = data.end();
+  Vector<float3> facet_corners;
+  float3 facet_normal(0.0f);
+
+  while (p < end) {
+    const StringRef token = next_token(p, end);
+    if (token == "vertex") {
+      facet_corners.append(parse_float3(p, end));
+    }
+    else if (token == "normal") {
+      facet_normal = parse_float3(p, end);
+    }
+    else if (token == "facet") {
+      facet_corners.clear();
+      facet_normal = float3(0.0f);
+    }
+    else if (token == "endfacet") {
+      for (int64_t i = 2; i < facet_corners.size(); i++) {
+        r_triangles.corners.append(facet_corners[0]);
+        r_triangles.corners.append(facet_corners[i - 1]);
+        r_triangles.corners.append(facet_corners[i]);
+        r_triangles.facet_normals.append(facet_normal);
+      }
+      facet_corners.clear();
+    }
+    else if (ELEM(token, "solid", "endsolid")) {
+      /* The rest of the line is the name. */
+      skip_line(p, end);
+    }
+  }
+}
+
+/** \} */
+
+bool read_stl_file(const char *filepath, STLTriangles &r_triangles)
+{
+  MappedFile file(filepath);
+  if (!file.is_open()) {
+    return false;
+  }
+  if (is_binary_stl(file.data())) {
+    if (!parse_stl_binary(file.data(), r_triangles)) {
+      fprintf(stderr,
+              "STL file '%s' is truncated, only %lld triangles could be read\n",
+              filepath,
+              (long long)r_triangles.facet_normals.size());
+    }
+  }
+  else {
+    parse_stl_ascii(file.data(), r_triangles);
+  }
+  return true;
+}
+
+}  // namespace blender::io::stl
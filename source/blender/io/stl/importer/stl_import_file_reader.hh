@@ -0,0 +1,59 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup stl
+ */
+
+#include "BLI_float3.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+
+namespace blender::io::stl {
+
+/** Triangle soup read from a file, STL stores the positions of every corner. */
+struct STLTriangles {
+  /** Three corners per triangle, in file order. */
+  Vector<float3> corners;
+  Vector<float3> facet_normals;
+};
+
+/**
+ * Binary files start with an 80 byte header that can also start with `solid`, so check if the
+ * file size matches the triangle count first. When it doesn't, the file is truncated or padded,
+ * and only treated as ASCII when it starts with `solid` and the beginning of it is text.
+ */
+bool is_binary_stl(StringRef data);
+
+/**
+ * Decode all records from multiple threads, the record size is fixed.
+ * \return False when the file holds fewer records than its triangle count, the complete
+ * records are still decoded then.
+ */
+bool parse_stl_binary(StringRef data, STLTriangles &r_triangles);
+
+/** Facets with more than three corners are triangulated as a fan. */
+void parse_stl_ascii(StringRef data, STLTriangles &r_triangles);
+
+/** \return False when the file can't be read. */
+bool read_stl_file(const char *filepath, STLTriangles &r_triangles);
+
+}  // namespace blender::io::stl
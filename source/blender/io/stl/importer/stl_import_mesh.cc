@@ -0,0 +1,198 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup stl
+ */
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+
+#include "BLI_map.hh"
+#include "BLI_math.h"
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "stl_import_mesh.hh"
+
+namespace blender::io::stl {
+
+namespace {
+/** Position with its hash, computed once from multiple threads. */
+struct PositionKey {
+  float3 co;
+  uint64_t hash_value;
+
+  uint64_t hash() const
+  {
+    return hash_value;
+  }
+
+  friend bool operator==(const PositionKey &a, const PositionKey &b)
+  {
+    return a.co == b.co;
+  }
+};
+}  // namespace
+
+static uint64_t position_hash(const float3 &co)
+{
+  /* Adding zero turns negative zero into positive zero, they compare equal. */
+  uint32_t bits[3];
+  const float values[3] = {co.x + 0.0f, co.y + 0.0f, co.z + 0.0f};
+  memcpy(bits, values, sizeof(bits));
+  uint64_t hash = uint64_t(bits[0]) * 0x9E3779B97F4A7C15ull ^
+                  uint64_t(bits[1]) * 0xC2B2AE3D27D4EB4Full ^
+                  uint64_t(bits[2]) * 0x165667B19E3779F9ull;
+  return hash ^ (hash >> 29);
+}
+
+STLVertexMap deduplicate_vertices(Span<float3> corners)
+{
+  const int corners_num = int(corners.size());
+  Array<uint64_t> hashes(corners_num);
+  parallel_for(IndexRange(corners_num), 16 * 1024, [&](IndexRange range) {
+    for (const int i : range) {
+      hashes[i] = position_hash(corners[i]);
+    }
+  });
+
+  /* Sort corners into buckets by the high bits of the hash, keeping file order in a bucket.
+   * Equal positions always end up in the same bucket. */
+  const int bucket_bits = 8;
+  const int buckets_num = 1 << bucket_bits;
+  auto bucket_of = [&](const int corner) { return int(hashes[corner] >> (64 - bucket_bits)); };
+  Array<int> bucket_offsets(buckets_num + 1, 0);
+  for (const int i : IndexRange(corners_num)) {
+    bucket_offsets[bucket_of(i) + 1]++;
+  }
+  for (const int bucket : IndexRange(buckets_num)) {
+    bucket_offsets[bucket + 1] += bucket_offsets[bucket];
+  }
+  Array<int> bucket_corners(corners_num);
+  {
+    Array<int> bucket_fill(bucket_offsets.as_span().drop_back(1));
+    for (const int i : IndexRange(corners_num)) {
+      bucket_corners[bucket_fill[bucket_of(i)]++] = i;
+    }
+  }
+
+  /* First corner with the same position for every corner, never after the corner itself. */
+  Array<int> first_corners(corners_num);
+  parallel_for(IndexRange(buckets_num), 1, [&](IndexRange range) {
+    Map<PositionKey, int> first_corner_map;
+    for (const int bucket : range) {
+      const IndexRange bucket_range(bucket_offsets[bucket],
+                                    bucket_offsets[bucket + 1] - bucket_offsets[bucket]);
+      first_corner_map.clear();
+      first_corner_map.reserve(bucket_range.size());
+      for (const int corner : bucket_corners.as_span().slice(bucket_range)) {
+        first_corners[corner] = first_corner_map.lookup_or_add(
+            {corners[corner], hashes[corner]}, corner);
+      }
+    }
+  });
+
+  STLVertexMap vertex_map;
+  vertex_map.corner_verts.reinitialize(corners_num);
+  for (const int i : IndexRange(corners_num)) {
+    if (first_corners[i] == i) {
+      vertex_map.corner_verts[i] = int(vertex_map.vert_corners.size());
+      vertex_map.vert_corners.append(i);
+    }
+    else {
+      vertex_map.corner_verts[i] = vertex_map.corner_verts[first_corners[i]];
+    }
+  }
+  return vertex_map;
+}
+
+void fill_mesh_from_triangles(Mesh *mesh,
+                              const STLTriangles &triangles,
+                              const STLVertexMap &vertex_map,
+                              const float axes_transform[3][3],
+                              const float global_scale,
+                              const bool use_facet_normal,
+                              const bool validate)
+{
+  const Span<int> corner_verts = vertex_map.corner_verts;
+  Vector<int> tris;
+  tris.reserve(triangles.facet_normals.size());
+  for (const int i : triangles.facet_normals.index_range()) {
+    const int v1 = corner_verts[i * 3];
+    const int v2 = corner_verts[i * 3 + 1];
+    const int v3 = corner_verts[i * 3 + 2];
+    if (v1 != v2 && v2 != v3 && v3 != v1) {
+      tris.append(i);
+    }
+  }
+
+  mesh->totvert = int(vertex_map.vert_corners.size());
+  mesh->totpoly = int(tris.size());
+  mesh->totloop = mesh->totpoly * 3;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+
+  parallel_for(IndexRange(mesh->totvert), 16 * 1024, [&](IndexRange range) {
+    for (const int i : range) {
+      MVert &mvert = mesh->mvert[i];
+      mul_v3_m3v3(mvert.co, axes_transform, triangles.corners[vertex_map.vert_corners[i]]);
+      mul_v3_fl(mvert.co, global_scale);
+    }
+  });
+
+  parallel_for(tris.index_range(), 16 * 1024, [&](IndexRange range) {
+    for (const int i : range) {
+      MPoly &mpoly = mesh->mpoly[i];
+      mpoly.loopstart = i * 3;
+      mpoly.totloop = 3;
+      for (const int j : IndexRange(3)) {
+        mesh->mloop[i * 3 + j].v = uint(corner_verts[tris[i] * 3 + j]);
+      }
+    }
+  });
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+
+  if (use_facet_normal) {
+    Array<float3> loop_normals(mesh->totloop);
+    parallel_for(tris.index_range(), 16 * 1024, [&](IndexRange range) {
+      for (const int i : range) {
+        float3 normal;
+        mul_v3_m3v3(normal, axes_transform, triangles.facet_normals[tris[i]]);
+        normalize_v3(normal);
+        mesh->mpoly[i].flag |= ME_SMOOTH;
+        loop_normals.as_mutable_span().slice(i * 3, 3).fill(normal);
+      }
+    });
+    mesh->flag |= ME_AUTOSMOOTH;
+    BKE_mesh_set_custom_normals(mesh, reinterpret_cast<float(*)[3]>(loop_normals.data()));
+  }
+
+  if (validate) {
+    BKE_mesh_validate(mesh, false, false);
+  }
+}
+
+}  // namespace blender::io::stl
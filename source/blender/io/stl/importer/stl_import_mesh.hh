@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup stl
+ */
+
+#include "BLI_array.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+#include "stl_import_file_reader.hh"
+
+struct Mesh;
+
+namespace blender::io::stl {
+
+/** Vertices shared by the triangles, STL files don't store connectivity. */
+struct STLVertexMap {
+  /** Vertex of every corner. */
+  Array<int> corner_verts;
+  /** First corner of every vertex, vertices are numbered in order of first use. */
+  Vector<int> vert_corners;
+};
+
+/**
+ * Merge corners with bit-wise equal positions (positive and negative zero are equal).
+ * Positions are hashed from multiple threads, then every bucket of hashes is de-duplicated by a
+ * single thread, so the result doesn't depend on the number of threads.
+ */
+STLVertexMap deduplicate_vertices(Span<float3> corners);
+
+/**
+ * Fill the arrays of an empty mesh. Triangles that collapse after merging vertices are skipped.
+ *
+ * \param axes_transform: Conversion from the axes of the file to Blender's axes.
+ */
+void fill_mesh_from_triangles(Mesh *mesh,
+                              const STLTriangles &triangles,
+                              const STLVertexMap &vertex_map,
+                              const float axes_transform[3][3],
+                              float global_scale,
+                              bool use_facet_normal,
+                              bool validate);
+
+}  // namespace blender::io::stl
@@ -0,0 +1,216 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <string>
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+
+#include "BLI_math.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "PIL_time.h"
+
+#include "stl_import_file_reader.hh"
+#include "stl_import_mesh.hh"
+
+#define DO_PERF_TESTS 0
+
+namespace blender::io::stl::tests {
+
+class STLImporterTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/* Binary STL of a height field of `size` x `size` quads, like the output of a 3D scanner. */
+static std::string binary_height_field_create(const int size)
+{
+  const uint32_t tris_num = uint32_t(size * size * 2);
+  std::string data(84 + size_t(tris_num) * 50, '\0');
+  memcpy(&data[80], &tris_num, sizeof(tris_num));
+
+  auto height = [](const int x, const int y) { return sinf(x * 0.1f) * cosf(y * 0.1f); };
+  char *record = &data[84];
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const float3 quad[4] = {float3(x, y, height(x, y)),
+                              float3(x + 1, y, height(x + 1, y)),
+                              float3(x + 1, y + 1, height(x + 1, y + 1)),
+                              float3(x, y + 1, height(x, y + 1))};
+      const int tris[2][3] = {{0, 1, 2}, {0, 2, 3}};
+      for (const int(&tri)[3] : tris) {
+        float values[12];
+        normal_tri_v3(values, quad[tri[0]], quad[tri[1]], quad[tri[2]]);
+        copy_v3_v3(values + 3, quad[tri[0]]);
+        copy_v3_v3(values + 6, quad[tri[1]]);
+        copy_v3_v3(values + 9, quad[tri[2]]);
+        memcpy(record, values, sizeof(values));
+        record += 50;
+      }
+    }
+  }
+  return data;
+}
+
+static Mesh *mesh_from_triangles(const STLTriangles &triangles, const bool use_facet_normal)
+{
+  float axes_transform[3][3];
+  unit_m3(axes_transform);
+  Mesh *mesh = static_cast<Mesh *>(BKE_id_new_nomain(ID_ME, nullptr));
+  const STLVertexMap vertex_map = deduplicate_vertices(triangles.corners);
+  fill_mesh_from_triangles(
+      mesh, triangles, vertex_map, axes_transform, 1.0f, use_facet_normal, false);
+  return mesh;
+}
+
+TEST_F(STLImporterTest, Binary)
+{
+  const std::string data = binary_height_field_create(10);
+  ASSERT_TRUE(is_binary_stl(data));
+
+  STLTriangles triangles;
+  EXPECT_TRUE(parse_stl_binary(data, triangles));
+  ASSERT_EQ(triangles.facet_normals.size(), 200);
+  EXPECT_EQ(triangles.corners[3], float3(0, 0, 0));
+  EXPECT_EQ(triangles.corners[4], float3(1, 1, sinf(0.1f) * cosf(0.1f)));
+
+  Mesh *mesh = mesh_from_triangles(triangles, true);
+  EXPECT_EQ(mesh->totvert, 11 * 11);
+  EXPECT_EQ(mesh->totpoly, 200);
+  EXPECT_EQ(mesh->totedge, 10 * 11 * 2 + 10 * 10);
+  /* Vertices are numbered in order of first use. */
+  EXPECT_EQ(float3(mesh->mvert[1].co), float3(triangles.corners[1]));
+  EXPECT_EQ(mesh->mloop[3].v, 0);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(STLImporterTest, ASCII)
+{
+  const std::string data =
+      "solid test\n"
+      "facet normal 0 0 1\n"
+      " outer loop\n"
+      "  vertex 0 0 0\n"
+      "  vertex 1 0 0\n"
+      "  vertex 1 1 0\n"
+      "  vertex 0 1 0\n"
+      " endloop\n"
+      "endfacet\n"
+      "facet normal 0 0 -1\n"
+      " outer loop\n"
+      "  vertex -0 0 0\n"
+      "  vertex 0 1 0\n"
+      "  vertex 0 1 0\n"
+      " endloop\n"
+      "endfacet\n"
+      "endsolid test\n";
+  ASSERT_FALSE(is_binary_stl(data));
+
+  STLTriangles triangles;
+  parse_stl_ascii(data, triangles);
+  ASSERT_EQ(triangles.facet_normals.size(), 3);
+  EXPECT_EQ(triangles.facet_normals[2], float3(0, 0, -1));
+  EXPECT_EQ(triangles.corners[5], float3(0, 1, 0));
+
+  /* Negative zero is merged, the last triangle collapses and is skipped. */
+  Mesh *mesh = mesh_from_triangles(triangles, false);
+  EXPECT_EQ(mesh->totvert, 4);
+  EXPECT_EQ(mesh->totpoly, 2);
+  EXPECT_EQ(mesh->totedge, 5);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(STLImporterTest, BinaryTruncatedWithSolidHeader)
+{
+  std::string data = binary_height_field_create(4);
+  /* Only the triangle count and the records contain binary data. */
+  data.replace(0, 80, 80, ' ');
+  memcpy(&data[0], "solid exported", 14);
+  data.resize(data.size() - 20);
+  EXPECT_TRUE(is_binary_stl(data));
+
+  STLTriangles triangles;
+  EXPECT_FALSE(parse_stl_binary(data, triangles));
+  EXPECT_EQ(triangles.facet_normals.size(), 31);
+}
+
+#if DO_PERF_TESTS
+
+/* Time parsing, merging vertices and creating the mesh, increase the grid size to measure
+ * meshes of scan resolution. */
+
+#define GRID_SIZE 500
+#define NUM_RUN_AVERAGED 3
+
+TEST_F(STLImporterTest, PerformanceScan)
+{
+  const std::string data = binary_height_field_create(GRID_SIZE);
+
+  printf("\n========== STARTING %d triangles ==========\n", GRID_SIZE * GRID_SIZE * 2);
+
+  double parse_timing = 0.0, dedup_timing = 0.0, mesh_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    double init_time = PIL_check_seconds_timer();
+    STLTriangles triangles;
+    parse_stl_binary(data, triangles);
+    parse_timing += PIL_check_seconds_timer() - init_time;
+
+    init_time = PIL_check_seconds_timer();
+    const STLVertexMap vertex_map = deduplicate_vertices(triangles.corners);
+    dedup_timing += PIL_check_seconds_timer() - init_time;
+
+    init_time = PIL_check_seconds_timer();
+    float axes_transform[3][3];
+    unit_m3(axes_transform);
+    Mesh *mesh = static_cast<Mesh *>(BKE_id_new_nomain(ID_ME, nullptr));
+    fill_mesh_from_triangles(mesh, triangles, vertex_map, axes_transform, 1.0f, false, false);
+    mesh_timing += PIL_check_seconds_timer() - init_time;
+
+    EXPECT_EQ(mesh->totvert, (GRID_SIZE + 1) * (GRID_SIZE + 1));
+    BKE_id_free(nullptr, mesh);
+  }
+
+  const double megabytes = double(data.size()) / (1024.0 * 1024.0);
+  printf("\tparse_stl_binary: done in %fs on average over %d runs (%.1f MB/s)\n",
+         parse_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED,
+         megabytes * NUM_RUN_AVERAGED / parse_timing);
+  printf("\tdeduplicate_vertices: done in %fs on average over %d runs\n",
+         dedup_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\tfill_mesh_from_triangles: done in %fs on average over %d runs\n",
+         mesh_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+  printf("\ttotal: %.1f MB/s\n",
+         megabytes * NUM_RUN_AVERAGED / (parse_timing + dedup_timing + mesh_timing));
+  printf("========== ENDED %d triangles ==========\n\n", GRID_SIZE * GRID_SIZE * 2);
+}
+
+#endif
+
+}  // namespace blender::io::stl::tests
@@ -19,30 +19,47 @@
 
 #include "usd.h"
 #include "usd_hierarchy_iterator.h"
+#include "usd_reader_stage.h"
 
 #include <pxr/base/plug/registry.h>
 #include <pxr/pxr.h>
 #include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/metrics.h>
 #include <pxr/usd/usdGeom/tokens.h>
 
+#include <memory>
+#include <vector>
+
 #include "MEM_guardedalloc.h"
 
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_query.h"
 
+#include "DNA_collection_types.h"
+#include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
 #include "BKE_appdir.h"
 #include "BKE_blender_version.h"
+#include "BKE_collection.h"
 #include "BKE_context.h"
 #include "BKE_global.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
 #include "BKE_scene.h"
 
 #include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_rotation.h"
 #include "BLI_path_util.h"
+#include "BLI_set.hh"
 #include "BLI_string.h"
 
+#include "ED_undo.h"
+
 #include "WM_api.h"
 #include "WM_types.h"
 
@@ -183,6 +200,215 @@ static void export_endjob(void *customdata)
   WM_set_locked_interface(data->wm, false);
 }
 
+struct ImportJobData {
+  bContext *C;
+  Main *bmain;
+  Scene *scene;
+  ViewLayer *view_layer;
+  wmWindowManager *wm;
+
+  char filename[FILE_MAX];
+  USDImportParams params;
+
+  std::unique_ptr<USDImporterContext> context;
+  std::unique_ptr<USDStageReader> stage_reader;
+
+  bool stage_open_failed;
+  bool was_cancelled;
+  bool import_ok;
+  bool is_background_job;
+};
+
+/* Conversion from the up axis and units of the stage to Blender's Z-up axis and the scene's
+ * units. */
+static void stage_root_transform(const pxr::UsdStageRefPtr &stage,
+                                 const Scene *scene,
+                                 const float scale,
+                                 float r_mat[4][4])
+{
+  unit_m4(r_mat);
+  if (pxr::UsdGeomGetStageUpAxis(stage) == pxr::UsdGeomTokens->y) {
+    axis_angle_to_mat4_single(r_mat, 'X', M_PI_2);
+  }
+
+  const float unit_scale = static_cast<float>(pxr::UsdGeomGetStageMetersPerUnit(stage)) /
+                           scene->unit.scale_length;
+  float scale_mat[4][4];
+  scale_m4_fl(scale_mat, unit_scale * scale);
+  mul_m4_m4m4(r_mat, scale_mat, r_mat);
+}
+
+static void import_startjob(void *customdata, short *stop, short *do_update, float *progress)
+{
+  ImportJobData *data = static_cast<ImportJobData *>(customdata);
+
+  WM_set_locked_interface(data->wm, true);
+
+  pxr::UsdStageRefPtr stage = pxr::UsdStage::Open(data->filename);
+  if (!stage) {
+    data->stage_open_failed = true;
+    return;
+  }
+
+  data->context = std::make_unique<USDImporterContext>(
+      USDImporterContext{data->bmain, data->params});
+  stage_root_transform(stage, data->scene, data->params.scale, data->context->root_transform);
+  data->stage_reader = std::make_unique<USDStageReader>(stage, *data->context);
+
+  *progress = 0.05f;
+  *do_update = true;
+
+  /* Find the prims to import, from multiple threads. */
+  data->stage_reader->collect_readers();
+
+  if (G.is_break || *stop) {
+    data->was_cancelled = true;
+    return;
+  }
+
+  *progress = 0.2f;
+  *do_update = true;
+
+  /* Adding IDs to the main database is not thread-safe, so collections and objects are created on
+   * this thread, before any of their data is read. */
+  data->stage_reader->create_prototype_collections();
+
+  const USDStageReader::ReaderVector &readers = data->stage_reader->readers();
+  const float size = static_cast<float>(readers.size());
+  size_t i = 0;
+  for (const std::unique_ptr<USDPrimReader> &reader : readers) {
+    reader->create_object();
+
+    if ((++i & 1023) == 0) {
+      *progress = 0.2f + 0.3f * (i / size);
+      *do_update = true;
+
+      if (G.is_break || *stop) {
+        data->was_cancelled = true;
+        return;
+      }
+    }
+  }
+
+  for (const std::unique_ptr<USDPrimReader> &reader : readers) {
+    if (reader->parent() != nullptr) {
+      reader->object()->parent = reader->parent()->object();
+    }
+  }
+
+  *progress = 0.5f;
+  *do_update = true;
+
+  /* Only the first time sample is imported. */
+  data->stage_reader->read_object_data(pxr::UsdTimeCode::EarliestTime());
+
+  if (G.is_break || *stop) {
+    data->was_cancelled = true;
+    return;
+  }
+
+  *progress = 1.0f;
+  *do_update = true;
+}
+
+static void import_endjob(void *customdata)
+{
+  ImportJobData *data = static_cast<ImportJobData *>(customdata);
+
+  std::vector<Object *> objects;
+  if (data->stage_reader) {
+    for (const std::unique_ptr<USDPrimReader> &reader : data->stage_reader->readers()) {
+      /* It's possible that cancellation occurred before the reader created its objects. */
+      if (reader->object() != nullptr) {
+        reader->collect_objects(objects);
+      }
+    }
+  }
+
+  if (data->was_cancelled) {
+    /* The objects and prototype collections are not used by anything else yet, they have no users
+     * to remove. Freeing the objects only removes their user of the object data, free that too. */
+    Set<ID *> object_data;
+    for (Object *ob : objects) {
+      if (ob->data != nullptr) {
+        object_data.add(static_cast<ID *>(ob->data));
+      }
+      BKE_id_free(data->bmain, ob);
+    }
+    for (ID *id : object_data) {
+      if (ID_REAL_USERS(id) <= 0) {
+        BKE_id_free(data->bmain, id);
+      }
+    }
+    for (const auto &item : data->context->prototype_collections) {
+      BKE_id_free(data->bmain, item.second);
+    }
+  }
+  else if (data->stage_reader) {
+    /* Objects are gathered in a new collection in the active one. The view layers are synced
+     * once after adding all objects instead of once for every object. */
+    ViewLayer *view_layer = data->view_layer;
+    LayerCollection *lc = BKE_layer_collection_get_active(view_layer);
+    char collection_name[MAX_ID_NAME - 2];
+    STRNCPY(collection_name, BLI_path_basename(data->filename));
+    BLI_path_extension_replace(collection_name, sizeof(collection_name), "");
+    Collection *import_collection = BKE_collection_add(
+        data->bmain, lc->collection, collection_name);
+
+    for (const std::unique_ptr<USDPrimReader> &reader : data->stage_reader->readers()) {
+      Collection *collection = reader->prototype_path().IsEmpty() ?
+                                   import_collection :
+                                   data->context->find_prototype_collection(
+                                       reader->prototype_path());
+      std::vector<Object *> reader_objects;
+      reader->collect_objects(reader_objects);
+      for (Object *ob : reader_objects) {
+        BKE_collection_object_add_nosync(data->bmain, collection, ob);
+        DEG_id_tag_update_ex(data->bmain,
+                             &ob->id,
+                             ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY | ID_RECALC_BASE_FLAGS);
+      }
+    }
+
+    BKE_main_collection_sync(data->bmain);
+
+    BKE_view_layer_base_deselect_all(view_layer);
+    LISTBASE_FOREACH (CollectionObject *, cob, &import_collection->gobjects) {
+      Base *base = BKE_view_layer_base_find(view_layer, cob->ob);
+      if (base != nullptr) {
+        BKE_view_layer_base_select_and_set_active(view_layer, base);
+      }
+    }
+
+    DEG_id_tag_update(&lc->collection->id, ID_RECALC_COPY_ON_WRITE);
+    DEG_id_tag_update(&data->scene->id, ID_RECALC_BASE_FLAGS);
+    DEG_relations_tag_update(data->bmain);
+
+    if (data->is_background_job) {
+      /* Blender already returned from the import operator, so we need to store our own extra undo
+       * step. */
+      ED_undo_push(data->C, "USD Import Finished");
+    }
+  }
+
+  WM_set_locked_interface(data->wm, false);
+
+  if (data->stage_open_failed) {
+    WM_reportf(RPT_ERROR, "USD Import: unable to open stage to read %s", data->filename);
+  }
+  else {
+    data->import_ok = !data->was_cancelled;
+  }
+
+  WM_main_add_notifier(NC_SCENE | ND_FRAME, data->scene);
+}
+
+static void import_freejob(void *customdata)
+{
+  ImportJobData *data = static_cast<ImportJobData *>(customdata);
+  delete data;
+}
+
 }  // namespace blender::io::usd
 
 bool USD_export(bContext *C,
@@ -237,6 +463,64 @@ bool USD_export(bContext *C,
   return export_ok;
 }
 
+bool USD_import(bContext *C,
+                const char *filepath,
+                const USDImportParams *params,
+                bool as_background_job)
+{
+  blender::io::usd::ensure_usd_plugin_path_registered();
+
+  /* Using new here since MEM_* functions do not call constructor to properly initialize data. */
+  blender::io::usd::ImportJobData *job = new blender::io::usd::ImportJobData();
+  job->C = C;
+  job->bmain = CTX_data_main(C);
+  job->scene = CTX_data_scene(C);
+  job->view_layer = CTX_data_view_layer(C);
+  job->wm = CTX_wm_manager(C);
+  job->stage_open_failed = false;
+  job->was_cancelled = false;
+  job->import_ok = false;
+  job->is_background_job = as_background_job;
+  BLI_strncpy(job->filename, filepath, sizeof(job->filename));
+  job->params = *params;
+
+  G.is_break = false;
+
+  bool import_ok = false;
+  if (as_background_job) {
+    wmJob *wm_job = WM_jobs_get(job->wm,
+                                CTX_wm_window(C),
+                                job->scene,
+                                "USD Import",
+                                WM_JOB_PROGRESS,
+                                WM_JOB_TYPE_ALEMBIC);
+
+    /* setup job */
+    WM_jobs_customdata_set(wm_job, job, blender::io::usd::import_freejob);
+    WM_jobs_timer(wm_job, 0.1, NC_SCENE | ND_FRAME, NC_SCENE | ND_FRAME);
+    WM_jobs_callbacks(wm_job,
+                      blender::io::usd::import_startjob,
+                      nullptr,
+                      nullptr,
+                      blender::io::usd::import_endjob);
+
+    WM_jobs_start(CTX_wm_manager(C), wm_job);
+  }
+  else {
+    /* Fake a job context, so that we don't need NULL pointer checks while importing. */
+    short stop = 0, do_update = 0;
+    float progress = 0.0f;
+
+    blender::io::usd::import_startjob(job, &stop, &do_update, &progress);
+    blender::io::usd::import_endjob(job);
+    import_ok = job->import_ok;
+
+    blender::io::usd::import_freejob(job);
+  }
+
+  return import_ok;
+}
+
 int USD_get_version(void)
 {
   /* USD 19.11 defines:
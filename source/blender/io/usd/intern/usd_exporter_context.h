@@ -28,6 +28,7 @@ struct Depsgraph;
 namespace blender::io::usd {
 
 class USDHierarchyIterator;
+class USDMeshDeduplicator;
 
 struct USDExporterContext {
   Depsgraph *depsgraph;
@@ -35,6 +36,8 @@ struct USDExporterContext {
   const pxr::SdfPath usd_path;
   const USDHierarchyIterator *hierarchy_iterator;
   const USDExportParams &export_params;
+  /* Only used when `export_params.deduplicate_meshes` is set. */
+  USDMeshDeduplicator *mesh_deduplicator;
 };
 
 }  // namespace blender::io::usd
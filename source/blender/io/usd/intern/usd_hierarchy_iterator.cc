@@ -82,7 +82,12 @@ const pxr::UsdTimeCode &USDHierarchyIterator::get_export_time_code() const
 
 USDExporterContext USDHierarchyIterator::create_usd_export_context(const HierarchyContext *context)
 {
-  return USDExporterContext{depsgraph_, stage_, pxr::SdfPath(context->export_path), this, params_};
+  return USDExporterContext{depsgraph_,
+                            stage_,
+                            pxr::SdfPath(context->export_path),
+                            this,
+                            params_,
+                            &mesh_deduplicator_};
 }
 
 AbstractHierarchyWriter *USDHierarchyIterator::create_transform_writer(
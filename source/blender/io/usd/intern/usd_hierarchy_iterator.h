@@ -21,6 +21,7 @@
 #include "IO_abstract_hierarchy_iterator.h"
 #include "usd.h"
 #include "usd_exporter_context.h"
+#include "usd_mesh_deduplicator.h"
 
 #include <string>
 
@@ -41,6 +42,7 @@ class USDHierarchyIterator : public AbstractHierarchyIterator {
   const pxr::UsdStageRefPtr stage_;
   pxr::UsdTimeCode export_time_;
   const USDExportParams &params_;
+  USDMeshDeduplicator mesh_deduplicator_;
 
  public:
   USDHierarchyIterator(Depsgraph *depsgraph,
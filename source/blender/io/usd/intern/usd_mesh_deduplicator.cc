@@ -0,0 +1,71 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup usd
+ */
+
+#include "usd_mesh_deduplicator.h"
+
+#include <pxr/usd/usd/attribute.h>
+
+#include "BLI_hash_mm2a.h"
+
+namespace blender::io::usd {
+
+uint32_t usd_hash_bytes(const void *data, const size_t size, const uint32_t seed)
+{
+  return BLI_hash_mm2(static_cast<const unsigned char *>(data), size, seed);
+}
+
+bool USDMeshContent::is_written_at(const pxr::UsdStageRefPtr &stage,
+                                   const pxr::SdfPath &usd_path) const
+{
+  for (const std::pair<pxr::SdfPath, pxr::VtValue> &attribute : attributes) {
+    const pxr::UsdAttribute attr = stage->GetAttributeAtPath(
+        attribute.first.MakeAbsolutePath(usd_path));
+    pxr::VtValue value;
+    if (!attr || !attr.Get(&value, pxr::UsdTimeCode::Default()) || value != attribute.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+pxr::SdfPath USDMeshDeduplicator::find_or_add(const pxr::UsdStageRefPtr &stage,
+                                              const USDMeshContent &content,
+                                              const pxr::SdfPath &usd_path)
+{
+  const auto range = written_meshes_.equal_range(content.hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const WrittenMesh &written_mesh = it->second;
+    /* Each attribute of the content has to be written with the same value. With the same number
+     * of attributes, the written mesh can't have any others either. */
+    if (written_mesh.attributes_num == content.attributes.size() &&
+        written_mesh.materials == content.materials &&
+        content.is_written_at(stage, written_mesh.usd_path)) {
+      return written_mesh.usd_path;
+    }
+  }
+  written_meshes_.emplace(content.hash,
+                          WrittenMesh{usd_path, content.materials, content.attributes.size()});
+  return pxr::SdfPath();
+}
+
+}  // namespace blender::io::usd
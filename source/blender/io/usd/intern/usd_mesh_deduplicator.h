@@ -0,0 +1,110 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+/** \file
+ * \ingroup usd
+ */
+
+#include <pxr/base/tf/token.h>
+#include <pxr/base/vt/array.h>
+#include <pxr/base/vt/value.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/stage.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct Material;
+
+namespace blender::io::usd {
+
+/* Everything that is written for a mesh prim, to find meshes that can be written only once. */
+struct USDMeshContent {
+  /* Authored attributes and their value at the default time, by path relative to the mesh prim,
+   * in a fixed order. Copies of #VtArray share their data, so this is cheap. */
+  std::vector<std::pair<pxr::SdfPath, pxr::VtValue>> attributes;
+  std::vector<const Material *> materials;
+  uint32_t hash = 0;
+
+  /* Add an attribute of the mesh prim, or of the child prim `child_name`, and add its values to
+   * the hash. */
+  template<typename T> void add(const pxr::TfToken &name, const pxr::VtArray<T> &array);
+  template<typename T>
+  void add(const pxr::TfToken &child_name,
+           const pxr::TfToken &name,
+           const pxr::VtArray<T> &array);
+
+  /* Compare with what was written for the mesh prim at `usd_path`. */
+  bool is_written_at(const pxr::UsdStageRefPtr &stage, const pxr::SdfPath &usd_path) const;
+
+ private:
+  template<typename T>
+  void add_attribute(const pxr::SdfPath &path, const pxr::VtArray<T> &array);
+};
+
+uint32_t usd_hash_bytes(const void *data, size_t size, uint32_t seed);
+
+template<typename T>
+void USDMeshContent::add_attribute(const pxr::SdfPath &path, const pxr::VtArray<T> &array)
+{
+  hash = hash * 31 + static_cast<uint32_t>(path.GetHash());
+  hash = usd_hash_bytes(array.cdata(), array.size() * sizeof(T), hash);
+  attributes.emplace_back(path, pxr::VtValue(array));
+}
+
+template<typename T>
+void USDMeshContent::add(const pxr::TfToken &name, const pxr::VtArray<T> &array)
+{
+  add_attribute(pxr::SdfPath::ReflexiveRelativePath().AppendProperty(name), array);
+}
+
+template<typename T>
+void USDMeshContent::add(const pxr::TfToken &child_name,
+                         const pxr::TfToken &name,
+                         const pxr::VtArray<T> &array)
+{
+  add_attribute(
+      pxr::SdfPath::ReflexiveRelativePath().AppendChild(child_name).AppendProperty(name), array);
+}
+
+/* Remembers which mesh prim was written for what content. Only used from the thread that writes
+ * to the stage. Only the hash and the path of each mesh are kept, the arrays are read back from
+ * the stage when a mesh with the same hash is found, so they aren't kept in memory twice. */
+class USDMeshDeduplicator {
+ private:
+  struct WrittenMesh {
+    pxr::SdfPath usd_path;
+    std::vector<const Material *> materials;
+    size_t attributes_num;
+  };
+  std::unordered_multimap<uint32_t, WrittenMesh> written_meshes_;
+
+ public:
+  /* Return the path of a mesh prim written earlier with the same content. When there is none, an
+   * empty path is returned and `usd_path` is remembered as holding the content, which the caller
+   * has to write to `stage` then. */
+  pxr::SdfPath find_or_add(const pxr::UsdStageRefPtr &stage,
+                           const USDMeshContent &content,
+                           const pxr::SdfPath &usd_path);
+};
+
+}  // namespace blender::io::usd
@@ -0,0 +1,151 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup usd
+ */
+
+#include "usd_reader_instance.h"
+
+#include <pxr/base/vt/array.h>
+
+#include "BKE_lib_id.h"
+#include "BKE_object.h"
+
+#include "BLI_string.h"
+#include "BLI_task.hh"
+
+#include "DNA_collection_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+static Object *add_collection_instance_empty(Main *bmain,
+                                             const char *name,
+                                             Collection *collection)
+{
+  Object *ob = BKE_object_add_only_object(bmain, OB_EMPTY, name);
+  ob->data = nullptr;
+  if (collection != nullptr) {
+    ob->instance_collection = collection;
+    ob->transflag |= OB_DUPLICOLLECTION;
+    id_us_plus(&collection->id);
+  }
+  return ob;
+}
+
+USDInstanceReader::USDInstanceReader(const pxr::UsdPrim &prim, const USDImporterContext &context)
+    : USDPrimReader(prim, context)
+{
+}
+
+void USDInstanceReader::create_object()
+{
+  Collection *collection = context_.find_prototype_collection(prim_.GetPrototype().GetPath());
+  object_ = add_collection_instance_empty(context_.bmain, name().c_str(), collection);
+}
+
+void USDInstanceReader::collect_prototype_paths(std::vector<pxr::SdfPath> &r_paths) const
+{
+  r_paths.push_back(prim_.GetPrototype().GetPath());
+}
+
+USDPointInstancerReader::USDPointInstancerReader(const pxr::UsdPrim &prim,
+                                                 const USDImporterContext &context)
+    : USDPrimReader(prim, context), instancer_(prim)
+{
+  instancer_.GetPrototypesRel().GetTargets(&prototype_paths_);
+}
+
+void USDPointInstancerReader::create_object()
+{
+  object_ = BKE_object_add_only_object(context_.bmain, OB_EMPTY, name().c_str());
+  object_->data = nullptr;
+
+  /* The set of instances is not animated on import, only the first time sample is used. */
+  const pxr::UsdTimeCode time = pxr::UsdTimeCode::EarliestTime();
+  pxr::VtIntArray proto_indices;
+  instancer_.GetProtoIndicesAttr().Get(&proto_indices, time);
+  const std::vector<bool> mask = instancer_.ComputeMaskAtTime(time);
+
+  for (int i = 0; i < static_cast<int>(proto_indices.size()); i++) {
+    const int proto_index = proto_indices[i];
+    if (!mask.empty() && (i >= static_cast<int>(mask.size()) || !mask[i])) {
+      continue;
+    }
+    if (proto_index < 0 || proto_index >= static_cast<int>(prototype_paths_.size())) {
+      continue;
+    }
+
+    char instance_name[MAX_ID_NAME - 2];
+    BLI_snprintf(instance_name, sizeof(instance_name), "%s_%d", name().c_str(), i);
+    Collection *collection = context_.find_prototype_collection(prototype_paths_[proto_index]);
+    Object *ob = add_collection_instance_empty(context_.bmain, instance_name, collection);
+    ob->parent = object_;
+
+    instance_objects_.push_back(ob);
+    instance_indices_.push_back(i);
+  }
+}
+
+void USDPointInstancerReader::read_object_data(const pxr::UsdTimeCode time)
+{
+  USDPrimReader::read_object_data(time);
+
+  if (instance_objects_.empty()) {
+    return;
+  }
+
+  /* The prototype's own transform is part of the imported prototype objects already. */
+  pxr::VtArray<pxr::GfMatrix4d> usd_xforms;
+  if (!instancer_.ComputeInstanceTransformsAtTime(&usd_xforms,
+                                                   time,
+                                                   time,
+                                                   pxr::UsdGeomPointInstancer::ExcludeProtoXform,
+                                                   pxr::UsdGeomPointInstancer::IgnoreMask)) {
+    return;
+  }
+  /* Non-const access to a shared #VtArray copies its data, which is not thread-safe. */
+  const pxr::VtArray<pxr::GfMatrix4d> &xforms = usd_xforms;
+
+  parallel_for(IndexRange(instance_objects_.size()), 1024, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      const int instance_index = instance_indices_[i];
+      if (instance_index >= static_cast<int>(xforms.size())) {
+        continue;
+      }
+      float matrix[4][4];
+      copy_m4_from_usd(matrix, xforms[instance_index]);
+      BKE_object_apply_mat4(instance_objects_[i], matrix, true, false);
+    }
+  });
+}
+
+void USDPointInstancerReader::collect_objects(std::vector<Object *> &r_objects) const
+{
+  USDPrimReader::collect_objects(r_objects);
+  r_objects.insert(r_objects.end(), instance_objects_.begin(), instance_objects_.end());
+}
+
+void USDPointInstancerReader::collect_prototype_paths(std::vector<pxr::SdfPath> &r_paths) const
+{
+  r_paths.insert(r_paths.end(), prototype_paths_.begin(), prototype_paths_.end());
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,61 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+/** \file
+ * \ingroup usd
+ */
+
+#include "usd_reader_prim.h"
+
+#include <pxr/usd/usdGeom/pointInstancer.h>
+
+namespace blender::io::usd {
+
+/* Reader for instanceable prims. The instance becomes an empty that instances the collection
+ * holding the objects of its prototype, so that the prototype is only imported once. */
+class USDInstanceReader : public USDPrimReader {
+ public:
+  USDInstanceReader(const pxr::UsdPrim &prim, const USDImporterContext &context);
+
+  void create_object() override;
+  void collect_prototype_paths(std::vector<pxr::SdfPath> &r_paths) const override;
+};
+
+/* Reader for point instancers. The instancer becomes an empty, with a child empty for every
+ * visible instance that instances the collection of the instance's prototype. */
+class USDPointInstancerReader : public USDPrimReader {
+ private:
+  pxr::UsdGeomPointInstancer instancer_;
+  pxr::SdfPathVector prototype_paths_;
+
+  /* Empties of the visible instances, and the index of their instance in the instancer. */
+  std::vector<Object *> instance_objects_;
+  std::vector<int> instance_indices_;
+
+ public:
+  USDPointInstancerReader(const pxr::UsdPrim &prim, const USDImporterContext &context);
+
+  void create_object() override;
+  void read_object_data(pxr::UsdTimeCode time) override;
+  void collect_objects(std::vector<Object *> &r_objects) const override;
+  void collect_prototype_paths(std::vector<pxr::SdfPath> &r_paths) const override;
+};
+
+}  // namespace blender::io::usd
@@ -0,0 +1,273 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup usd
+ */
+
+#include "usd_reader_mesh.h"
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+#include <pxr/usd/sdf/types.h>
+#include <pxr/usd/usdGeom/primvarsAPI.h>
+#include <pxr/usd/usdGeom/tokens.h>
+
+#include <iostream>
+
+#include "BKE_customdata.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_array.hh"
+#include "BLI_float3.hh"
+#include "BLI_math_vector.h"
+#include "BLI_task.hh"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+/* Index of the USD face corner that a Blender loop is read from. Left-handed faces are wound the
+ * other way around, so their corners are reversed while keeping the first one in place. */
+static int usd_corner_index(const int loopstart,
+                            const int totloop,
+                            const int loop_offset,
+                            const bool is_left_handed)
+{
+  if (!is_left_handed || loop_offset == 0) {
+    return loopstart + loop_offset;
+  }
+  return loopstart + totloop - loop_offset;
+}
+
+/* Call `fn(loop_index, usd_corner_index, vertex_index)` for all loops of the mesh. */
+template<typename Fn>
+static void for_each_mesh_loop(const Mesh *mesh, const bool is_left_handed, const Fn &fn)
+{
+  parallel_for(IndexRange(mesh->totpoly), 1024, [&](IndexRange range) {
+    for (const int64_t poly_index : range) {
+      const MPoly &mpoly = mesh->mpoly[poly_index];
+      for (int i = 0; i < mpoly.totloop; i++) {
+        const int loop_index = mpoly.loopstart + i;
+        const int corner_index = usd_corner_index(
+            mpoly.loopstart, mpoly.totloop, i, is_left_handed);
+        fn(loop_index, corner_index, mesh->mloop[loop_index].v);
+      }
+    }
+  });
+}
+
+USDMeshReader::USDMeshReader(const pxr::UsdPrim &prim, const USDImporterContext &context)
+    : USDPrimReader(prim, context), mesh_prim_(prim)
+{
+}
+
+void USDMeshReader::create_object()
+{
+  Mesh *mesh = BKE_mesh_add(context_.bmain, name().c_str());
+
+  object_ = BKE_object_add_only_object(context_.bmain, OB_MESH, name().c_str());
+  object_->data = mesh;
+}
+
+void USDMeshReader::read_object_data(const pxr::UsdTimeCode time)
+{
+  USDPrimReader::read_object_data(time);
+
+  Mesh *mesh = static_cast<Mesh *>(object_->data);
+
+  /* The arrays are only accessed through const references from here on. Non-const access copies
+   * the data when it is shared with USD's own caches, which is not thread-safe. */
+  pxr::VtVec3fArray usd_positions;
+  pxr::VtIntArray usd_face_counts;
+  pxr::VtIntArray usd_face_indices;
+  mesh_prim_.GetPointsAttr().Get(&usd_positions, time);
+  mesh_prim_.GetFaceVertexCountsAttr().Get(&usd_face_counts, time);
+  mesh_prim_.GetFaceVertexIndicesAttr().Get(&usd_face_indices, time);
+  const pxr::VtVec3fArray &positions = usd_positions;
+  const pxr::VtIntArray &face_counts = usd_face_counts;
+  const pxr::VtIntArray &face_indices = usd_face_indices;
+
+  pxr::TfToken orientation;
+  mesh_prim_.GetOrientationAttr().Get(&orientation);
+  const bool is_left_handed = orientation == pxr::UsdGeomTokens->leftHanded;
+
+  /* Check the topology before using it, so that broken files don't crash Blender. */
+  Array<int> loop_starts(face_counts.size());
+  int64_t tot_loops = 0;
+  for (const int64_t i : loop_starts.index_range()) {
+    if (face_counts[i] < 3) {
+      std::cerr << "USD Import: face with less than three vertices in " << prim_.GetPath()
+                << ", skipping mesh\n";
+      return;
+    }
+    loop_starts[i] = static_cast<int>(tot_loops);
+    tot_loops += face_counts[i];
+  }
+  if (tot_loops != static_cast<int64_t>(face_indices.size())) {
+    std::cerr << "USD Import: face vertex counts and indices don't match in " << prim_.GetPath()
+              << ", skipping mesh\n";
+    return;
+  }
+  for (const int vertex_index : face_indices) {
+    if (vertex_index < 0 || vertex_index >= static_cast<int64_t>(positions.size())) {
+      std::cerr << "USD Import: face vertex index out of range in " << prim_.GetPath()
+                << ", skipping mesh\n";
+      return;
+    }
+  }
+
+  mesh->totvert = static_cast<int>(positions.size());
+  mesh->totpoly = static_cast<int>(face_counts.size());
+  mesh->totloop = static_cast<int>(tot_loops);
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+
+  parallel_for(IndexRange(mesh->totvert), 4096, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      copy_v3_v3(mesh->mvert[i].co, positions[i].data());
+    }
+  });
+
+  parallel_for(IndexRange(mesh->totpoly), 1024, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      MPoly &mpoly = mesh->mpoly[i];
+      mpoly.loopstart = loop_starts[i];
+      mpoly.totloop = face_counts[i];
+      for (int j = 0; j < mpoly.totloop; j++) {
+        const int corner_index = usd_corner_index(
+            mpoly.loopstart, mpoly.totloop, j, is_left_handed);
+        mesh->mloop[mpoly.loopstart + j].v = static_cast<uint>(face_indices[corner_index]);
+      }
+    }
+  });
+
+  if (context_.params.import_uvmaps) {
+    read_uvs(mesh, time, is_left_handed);
+  }
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+
+  if (context_.params.import_normals) {
+    read_normals(mesh, time, is_left_handed);
+  }
+
+  if (context_.params.validate_meshes) {
+    BKE_mesh_validate(mesh, false, false);
+  }
+}
+
+/* Every primvar holding 2D float coordinates becomes a UV map of the same name. This is the
+ * inverse of the exporter, which writes every UV map as such a primvar. */
+void USDMeshReader::read_uvs(Mesh *mesh, const pxr::UsdTimeCode time, const bool is_left_handed)
+{
+  const pxr::UsdGeomPrimvarsAPI primvars_api(prim_);
+  for (const pxr::UsdGeomPrimvar &primvar : primvars_api.GetPrimvars()) {
+    const pxr::SdfValueTypeName type_name = primvar.GetTypeName();
+    if (!ELEM(type_name,
+              pxr::SdfValueTypeNames->TexCoord2fArray,
+              pxr::SdfValueTypeNames->Float2Array)) {
+      continue;
+    }
+
+    const pxr::TfToken interpolation = primvar.GetInterpolation();
+    const bool is_face_varying = interpolation == pxr::UsdGeomTokens->faceVarying;
+    const bool is_vertex = ELEM(
+        interpolation, pxr::UsdGeomTokens->vertex, pxr::UsdGeomTokens->varying);
+    if (!is_face_varying && !is_vertex) {
+      continue;
+    }
+
+    pxr::VtVec2fArray usd_uvs;
+    if (!primvar.ComputeFlattened(&usd_uvs, time)) {
+      continue;
+    }
+    const pxr::VtVec2fArray &uvs = usd_uvs;
+    const int64_t expected_size = is_face_varying ? mesh->totloop : mesh->totvert;
+    if (static_cast<int64_t>(uvs.size()) != expected_size) {
+      std::cerr << "USD Import: UV primvar " << primvar.GetName() << " of " << prim_.GetPath()
+                << " has the wrong number of values, skipping it\n";
+      continue;
+    }
+
+    const std::string uv_name = primvar.GetPrimvarName().GetString();
+    MLoopUV *mloopuv = static_cast<MLoopUV *>(CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop, uv_name.c_str()));
+    for_each_mesh_loop(
+        mesh, is_left_handed, [&](const int loop_index, const int corner_index, const uint vert) {
+          copy_v2_v2(mloopuv[loop_index].uv,
+                     uvs[is_face_varying ? corner_index : static_cast<int>(vert)].data());
+        });
+  }
+  BKE_mesh_update_customdata_pointers(mesh, false);
+}
+
+void USDMeshReader::read_normals(Mesh *mesh,
+                                 const pxr::UsdTimeCode time,
+                                 const bool is_left_handed)
+{
+  pxr::VtVec3fArray usd_normals;
+  if (!mesh_prim_.GetNormalsAttr().Get(&usd_normals, time) || usd_normals.empty()) {
+    return;
+  }
+  const pxr::VtVec3fArray &normals = usd_normals;
+
+  const pxr::TfToken interpolation = mesh_prim_.GetNormalsInterpolation();
+  const int64_t normals_size = static_cast<int64_t>(normals.size());
+  if (interpolation == pxr::UsdGeomTokens->faceVarying && normals_size == mesh->totloop) {
+    Array<float3> loop_normals(mesh->totloop);
+    for_each_mesh_loop(
+        mesh, is_left_handed, [&](const int loop_index, const int corner_index, const uint) {
+          normalize_v3_v3(loop_normals[loop_index], normals[corner_index].data());
+        });
+    mesh->flag |= ME_AUTOSMOOTH;
+    BKE_mesh_set_custom_normals(mesh, reinterpret_cast<float(*)[3]>(loop_normals.data()));
+  }
+  else if (ELEM(interpolation, pxr::UsdGeomTokens->vertex, pxr::UsdGeomTokens->varying) &&
+           normals_size == mesh->totvert) {
+    Array<float3> vert_normals(mesh->totvert);
+    parallel_for(vert_normals.index_range(), 4096, [&](IndexRange range) {
+      for (const int64_t i : range) {
+        normalize_v3_v3(vert_normals[i], normals[i].data());
+      }
+    });
+    mesh->flag |= ME_AUTOSMOOTH;
+    BKE_mesh_set_custom_normals_from_vertices(
+        mesh, reinterpret_cast<float(*)[3]>(vert_normals.data()));
+  }
+  else {
+    return;
+  }
+
+  /* Custom normals are only used by smooth shaded faces. */
+  for (MPoly &mpoly : MutableSpan(mesh->mpoly, mesh->totpoly)) {
+    mpoly.flag |= ME_SMOOTH;
+  }
+}
+
+}  // namespace blender::io::usd
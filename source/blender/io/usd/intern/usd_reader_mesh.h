@@ -0,0 +1,48 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+/** \file
+ * \ingroup usd
+ */
+
+#include "usd_reader_prim.h"
+
+#include <pxr/usd/usdGeom/mesh.h>
+
+struct Mesh;
+
+namespace blender::io::usd {
+
+class USDMeshReader : public USDPrimReader {
+ private:
+  pxr::UsdGeomMesh mesh_prim_;
+
+ public:
+  USDMeshReader(const pxr::UsdPrim &prim, const USDImporterContext &context);
+
+  void create_object() override;
+  void read_object_data(pxr::UsdTimeCode time) override;
+
+ private:
+  void read_uvs(Mesh *mesh, pxr::UsdTimeCode time, bool is_left_handed);
+  void read_normals(Mesh *mesh, pxr::UsdTimeCode time, bool is_left_handed);
+};
+
+}  // namespace blender::io::usd
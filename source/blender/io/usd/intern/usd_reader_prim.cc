@@ -0,0 +1,143 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup usd
+ */
+
+#include "usd_reader_prim.h"
+
+#include <pxr/usd/usdGeom/xformable.h>
+
+#include "BKE_object.h"
+
+#include "BLI_math_matrix.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+void copy_m4_from_usd(float r_mat[4][4], const pxr::GfMatrix4d &usd_matrix)
+{
+  const double *usd_data = usd_matrix.GetArray();
+  for (int i = 0; i < 16; i++) {
+    r_mat[i / 4][i % 4] = static_cast<float>(usd_data[i]);
+  }
+}
+
+Collection *USDImporterContext::find_prototype_collection(const pxr::SdfPath &prototype_path) const
+{
+  const std::map<pxr::SdfPath, Collection *>::const_iterator it = prototype_collections.find(
+      prototype_path);
+  if (it == prototype_collections.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+USDPrimReader::USDPrimReader(const pxr::UsdPrim &prim, const USDImporterContext &context)
+    : prim_(prim), context_(context), object_(nullptr), parent_(nullptr)
+{
+}
+
+void USDPrimReader::read_object_data(const pxr::UsdTimeCode time)
+{
+  read_transform(time);
+}
+
+const pxr::UsdPrim &USDPrimReader::prim() const
+{
+  return prim_;
+}
+
+Object *USDPrimReader::object() const
+{
+  return object_;
+}
+
+void USDPrimReader::collect_objects(std::vector<Object *> &r_objects) const
+{
+  r_objects.push_back(object_);
+}
+
+void USDPrimReader::collect_prototype_paths(std::vector<pxr::SdfPath> &UNUSED(r_paths)) const
+{
+}
+
+std::string USDPrimReader::name() const
+{
+  return prim_.GetName().GetString();
+}
+
+USDPrimReader *USDPrimReader::parent() const
+{
+  return parent_;
+}
+
+void USDPrimReader::set_parent(USDPrimReader *parent)
+{
+  parent_ = parent;
+}
+
+const pxr::SdfPath &USDPrimReader::prototype_path() const
+{
+  return prototype_path_;
+}
+
+void USDPrimReader::set_prototype_path(const pxr::SdfPath &prototype_path)
+{
+  prototype_path_ = prototype_path;
+}
+
+void USDPrimReader::read_transform(const pxr::UsdTimeCode time)
+{
+  float matrix[4][4];
+  unit_m4(matrix);
+
+  pxr::UsdGeomXformable xformable(prim_);
+  if (xformable) {
+    pxr::GfMatrix4d usd_matrix;
+    bool resets_xform_stack = false;
+    if (xformable.GetLocalTransformation(&usd_matrix, &resets_xform_stack, time)) {
+      copy_m4_from_usd(matrix, usd_matrix);
+    }
+  }
+
+  /* Objects inside a prototype are placed by the instances, which already carry the conversion
+   * to Blender's axes and units. */
+  if (parent_ == nullptr && prototype_path_.IsEmpty()) {
+    mul_m4_m4m4(matrix, context_.root_transform, matrix);
+  }
+
+  BKE_object_apply_mat4(object_, matrix, true, false);
+}
+
+USDXformReader::USDXformReader(const pxr::UsdPrim &prim, const USDImporterContext &context)
+    : USDPrimReader(prim, context)
+{
+}
+
+void USDXformReader::create_object()
+{
+  object_ = BKE_object_add_only_object(context_.bmain, OB_EMPTY, name().c_str());
+  object_->data = nullptr;
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,114 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+/** \file
+ * \ingroup usd
+ */
+
+#include "usd.h"
+
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/timeCode.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct Collection;
+struct Main;
+struct Object;
+
+namespace blender::io::usd {
+
+/* USD matrices are row-major with the translation in the last row, which matches the memory
+ * layout of Blender's column-major matrices. */
+void copy_m4_from_usd(float r_mat[4][4], const pxr::GfMatrix4d &usd_matrix);
+
+/* State shared by all prim readers of one import. */
+struct USDImporterContext {
+  Main *bmain;
+  const USDImportParams &params;
+
+  /* Collection holding the imported prototype, for every prototype prim that is instanced. Filled
+   * before any object is created, and only read afterwards. */
+  std::map<pxr::SdfPath, Collection *> prototype_collections;
+
+  /* Converts from the stage's up axis and units to Blender's, applied to the objects at the root
+   * of the imported hierarchy. */
+  float root_transform[4][4];
+
+  Collection *find_prototype_collection(const pxr::SdfPath &prototype_path) const;
+};
+
+/* Creates a Blender object for one USD prim.
+ *
+ * Importing happens in two phases. First the objects are created by calling create_object() for
+ * all readers, which adds IDs to the main database and thus has to happen on one thread. Then the
+ * object data is read by calling read_object_data() for all readers, which only touches data owned
+ * by the reader's own object and can run on many threads at once. */
+class USDPrimReader {
+ protected:
+  const pxr::UsdPrim prim_;
+  const USDImporterContext &context_;
+  Object *object_;
+  USDPrimReader *parent_;
+
+  /* When the prim is part of a prototype, this is the path of that prototype. The objects of a
+   * prototype are put in its collection instead of in the scene. */
+  pxr::SdfPath prototype_path_;
+
+ public:
+  USDPrimReader(const pxr::UsdPrim &prim, const USDImporterContext &context);
+  virtual ~USDPrimReader() = default;
+
+  /* Add the Blender object, and its data-block when there is one, to the main database. */
+  virtual void create_object() = 0;
+  /* Read the data of the object at the given time. Must not add or remove IDs. */
+  virtual void read_object_data(pxr::UsdTimeCode time);
+
+  const pxr::UsdPrim &prim() const;
+  Object *object() const;
+  /* All objects created by this reader, the reader's own object first. */
+  virtual void collect_objects(std::vector<Object *> &r_objects) const;
+  /* Paths of the prototype prims instanced by this reader, which have to be imported as well. */
+  virtual void collect_prototype_paths(std::vector<pxr::SdfPath> &r_paths) const;
+  std::string name() const;
+
+  USDPrimReader *parent() const;
+  void set_parent(USDPrimReader *parent);
+
+  const pxr::SdfPath &prototype_path() const;
+  void set_prototype_path(const pxr::SdfPath &prototype_path);
+
+ protected:
+  void read_transform(pxr::UsdTimeCode time);
+};
+
+/* Reader for transform-only prims, which become empties. */
+class USDXformReader : public USDPrimReader {
+ public:
+  USDXformReader(const pxr::UsdPrim &prim, const USDImporterContext &context);
+
+  void create_object() override;
+};
+
+}  // namespace blender::io::usd
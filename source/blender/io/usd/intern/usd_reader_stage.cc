@@ -0,0 +1,233 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup usd
+ */
+
+#include "usd_reader_stage.h"
+#include "usd_reader_instance.h"
+#include "usd_reader_mesh.h"
+
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/pointInstancer.h>
+#include <pxr/usd/usdGeom/scope.h>
+#include <pxr/usd/usdGeom/xformable.h>
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <set>
+
+#include "BKE_collection.h"
+
+#include "BLI_task.hh"
+
+namespace blender::io::usd {
+
+/* The top of the hierarchy is expanded on one thread until there are at least this many subtrees
+ * left to traverse, which are then traversed in parallel. */
+static const size_t min_subtrees_num = 64;
+
+USDStageReader::USDStageReader(pxr::UsdStageRefPtr stage, USDImporterContext &context)
+    : stage_(stage), context_(context)
+{
+}
+
+USDPrimReader *USDStageReader::create_reader(const pxr::UsdPrim &prim) const
+{
+  if (context_.params.use_instancing && prim.IsInstance()) {
+    return new USDInstanceReader(prim, context_);
+  }
+  if (prim.IsA<pxr::UsdGeomPointInstancer>()) {
+    return new USDPointInstancerReader(prim, context_);
+  }
+  if (prim.IsA<pxr::UsdGeomMesh>()) {
+    return new USDMeshReader(prim, context_);
+  }
+  /* Other transformable prims, like cameras and lights, are imported as empties so that the
+   * hierarchy below them is kept. Typed prims that cannot be transformed, like materials and
+   * shaders, are skipped together with their children. */
+  if (prim.IsA<pxr::UsdGeomXformable>() || prim.IsA<pxr::UsdGeomScope>() ||
+      prim.GetTypeName().IsEmpty()) {
+    return new USDXformReader(prim, context_);
+  }
+  return nullptr;
+}
+
+pxr::UsdPrimSiblingRange USDStageReader::children(const pxr::UsdPrim &prim) const
+{
+  if (context_.params.use_instancing) {
+    return prim.GetChildren();
+  }
+  /* Without instancing, every instance gets its own copy of the prototype's prims. */
+  return prim.GetFilteredChildren(pxr::UsdTraverseInstanceProxies(pxr::UsdPrimDefaultPredicate));
+}
+
+/* The prims below instances and point instancers are imported as prototypes instead. */
+bool USDStageReader::should_descend(const pxr::UsdPrim &prim) const
+{
+  if (context_.params.use_instancing && prim.IsInstance()) {
+    return false;
+  }
+  return !prim.IsA<pxr::UsdGeomPointInstancer>();
+}
+
+USDPrimReader *USDStageReader::add_reader(const pxr::UsdPrim &prim,
+                                          USDPrimReader *parent,
+                                          const pxr::SdfPath &prototype_path,
+                                          ReaderVector &r_readers) const
+{
+  USDPrimReader *reader = create_reader(prim);
+  if (reader == nullptr) {
+    return nullptr;
+  }
+  reader->set_parent(parent);
+  reader->set_prototype_path(prototype_path);
+  r_readers.emplace_back(reader);
+  return reader;
+}
+
+void USDStageReader::traverse_subtree(const pxr::UsdPrim &prim,
+                                      USDPrimReader *parent,
+                                      const pxr::SdfPath &prototype_path,
+                                      ReaderVector &r_readers) const
+{
+  USDPrimReader *reader = add_reader(prim, parent, prototype_path, r_readers);
+  if (reader == nullptr || !should_descend(prim)) {
+    return;
+  }
+  for (const pxr::UsdPrim &child : children(prim)) {
+    traverse_subtree(child, reader, prototype_path, r_readers);
+  }
+}
+
+void USDStageReader::traverse(const std::vector<pxr::UsdPrim> &roots,
+                              const pxr::SdfPath &prototype_path)
+{
+  struct PendingPrim {
+    pxr::UsdPrim prim;
+    USDPrimReader *parent;
+  };
+
+  std::deque<PendingPrim> pending;
+  for (const pxr::UsdPrim &root : roots) {
+    pending.push_back({root, nullptr});
+  }
+
+  while (!pending.empty() && pending.size() < min_subtrees_num) {
+    const PendingPrim item = pending.front();
+    pending.pop_front();
+
+    USDPrimReader *reader = add_reader(item.prim, item.parent, prototype_path, readers_);
+    if (reader == nullptr || !should_descend(item.prim)) {
+      continue;
+    }
+    for (const pxr::UsdPrim &child : children(item.prim)) {
+      pending.push_back({child, reader});
+    }
+  }
+
+  /* Every subtree gets its own readers, which are appended in order afterwards so that the import
+   * does not depend on the scheduling of the threads. */
+  const std::vector<PendingPrim> subtrees(pending.begin(), pending.end());
+  std::vector<ReaderVector> subtree_readers(subtrees.size());
+  parallel_for(IndexRange(subtrees.size()), 1, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      traverse_subtree(subtrees[i].prim, subtrees[i].parent, prototype_path, subtree_readers[i]);
+    }
+  });
+
+  for (ReaderVector &readers : subtree_readers) {
+    std::move(readers.begin(), readers.end(), std::back_inserter(readers_));
+  }
+}
+
+void USDStageReader::collect_readers()
+{
+  const pxr::UsdPrimSiblingRange root_children = children(stage_->GetPseudoRoot());
+  traverse(std::vector<pxr::UsdPrim>(root_children.begin(), root_children.end()),
+           pxr::SdfPath());
+
+  /* Prototypes can instance other prototypes, so keep importing the ones that are found until
+   * there are no new ones. */
+  std::set<pxr::SdfPath> known_prototypes;
+  size_t readers_checked = 0;
+  while (readers_checked < readers_.size()) {
+    std::vector<std::pair<pxr::SdfPath, std::string>> new_prototypes;
+    const size_t readers_num = readers_.size();
+    for (; readers_checked < readers_num; readers_checked++) {
+      const USDPrimReader &reader = *readers_[readers_checked];
+      std::vector<pxr::SdfPath> prototype_paths;
+      reader.collect_prototype_paths(prototype_paths);
+      for (const pxr::SdfPath &path : prototype_paths) {
+        if (known_prototypes.insert(path).second) {
+          new_prototypes.emplace_back(path, reader.name());
+        }
+      }
+    }
+
+    for (const std::pair<pxr::SdfPath, std::string> &prototype : new_prototypes) {
+      const pxr::UsdPrim prototype_prim = stage_->GetPrimAtPath(prototype.first);
+      if (!prototype_prim) {
+        continue;
+      }
+
+      if (prototype_prim.IsPrototype()) {
+        /* The root prim of a native prototype stands in for the instances, which already have
+         * their own objects. Its collection is named after the first instance found, because
+         * the names of prototype roots are generated. */
+        prototypes_.push_back(prototype);
+        const pxr::UsdPrimSiblingRange prototype_children = prototype_prim.GetChildren();
+        traverse(std::vector<pxr::UsdPrim>(prototype_children.begin(), prototype_children.end()),
+                 prototype.first);
+      }
+      else {
+        /* Point instancer prototypes are regular prims, targeted by the instancer. */
+        prototypes_.emplace_back(prototype.first, prototype_prim.GetName().GetString());
+        traverse({prototype_prim}, prototype.first);
+      }
+    }
+  }
+}
+
+void USDStageReader::create_prototype_collections()
+{
+  for (const std::pair<pxr::SdfPath, std::string> &prototype : prototypes_) {
+    Collection *collection = BKE_collection_add(context_.bmain, nullptr, prototype.second.c_str());
+    context_.prototype_collections[prototype.first] = collection;
+  }
+}
+
+const USDStageReader::ReaderVector &USDStageReader::readers() const
+{
+  return readers_;
+}
+
+void USDStageReader::read_object_data(const pxr::UsdTimeCode time)
+{
+  parallel_for(IndexRange(readers_.size()), 1, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      readers_[i]->read_object_data(time);
+    }
+  });
+}
+
+}  // namespace blender::io::usd
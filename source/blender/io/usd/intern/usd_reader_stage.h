@@ -0,0 +1,83 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+/** \file
+ * \ingroup usd
+ */
+
+#include "usd_reader_prim.h"
+
+#include <pxr/usd/usd/stage.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace blender::io::usd {
+
+/* Creates the prim readers for a whole stage, and runs them in the phases described at
+ * USDPrimReader. */
+class USDStageReader {
+ public:
+  using ReaderVector = std::vector<std::unique_ptr<USDPrimReader>>;
+
+ private:
+  pxr::UsdStageRefPtr stage_;
+  USDImporterContext &context_;
+
+  /* Readers of the scene and of all instanced prototypes. Parents come before their children. */
+  ReaderVector readers_;
+  /* Path and collection name of every prototype that is imported, in order of discovery. */
+  std::vector<std::pair<pxr::SdfPath, std::string>> prototypes_;
+
+ public:
+  USDStageReader(pxr::UsdStageRefPtr stage, USDImporterContext &context);
+
+  /* Traverse the stage and create readers for all prims that are imported. The prim hierarchy is
+   * split into subtrees, which are traversed in parallel. */
+  void collect_readers();
+
+  /* Add a collection for every prototype to the main database. The collections are not linked
+   * to any scene, they are only used by the instances. */
+  void create_prototype_collections();
+
+  const ReaderVector &readers() const;
+
+  /* Read the data of all readers' objects in parallel. Their objects must exist already. */
+  void read_object_data(pxr::UsdTimeCode time);
+
+ private:
+  USDPrimReader *create_reader(const pxr::UsdPrim &prim) const;
+  pxr::UsdPrimSiblingRange children(const pxr::UsdPrim &prim) const;
+  bool should_descend(const pxr::UsdPrim &prim) const;
+
+  void traverse(const std::vector<pxr::UsdPrim> &roots, const pxr::SdfPath &prototype_path);
+  void traverse_subtree(const pxr::UsdPrim &prim,
+                        USDPrimReader *parent,
+                        const pxr::SdfPath &prototype_path,
+                        ReaderVector &r_readers) const;
+  USDPrimReader *add_reader(const pxr::UsdPrim &prim,
+                            USDPrimReader *parent,
+                            const pxr::SdfPath &prototype_path,
+                            ReaderVector &r_readers) const;
+};
+
+}  // namespace blender::io::usd
@@ -18,6 +18,7 @@
  */
 #include "usd_writer_mesh.h"
 #include "usd_hierarchy_iterator.h"
+#include "usd_mesh_deduplicator.h"
 
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/usd/usdShade/material.h>
@@ -42,7 +43,10 @@
 #include "DNA_object_fluidsim_types.h"
 #include "DNA_particle_types.h"
 
+#include <cstdio>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 namespace blender::io::usd {
 
@@ -60,6 +64,8 @@ bool USDGenericMeshWriter::is_supported(const HierarchyContext *context) const
 
 void USDGenericMeshWriter::do_write(HierarchyContext &context)
 {
+  free_deferred_sample();
+
   Object *object_eval = context.object;
   bool needsfree = false;
   Mesh *mesh = get_export_mesh(object_eval, needsfree);
@@ -68,18 +74,26 @@ void USDGenericMeshWriter::do_write(HierarchyContext &context)
     return;
   }
 
-  try {
-    write_mesh(context, mesh);
+  /* Only the prim is defined here, its data is gathered from multiple threads and written in
+   * write_deferred_sample(). */
+  deferred_sample_ = std::make_unique<DeferredSample>();
+  DeferredSample &sample = *deferred_sample_;
+  sample.object = object_eval;
+  sample.mesh = mesh;
+  sample.mesh_needs_free = needsfree;
+  sample.is_first_frame = !frame_has_been_written_;
 
-    if (needsfree) {
-      free_export_mesh(mesh);
-    }
-  }
-  catch (...) {
-    if (needsfree) {
-      free_export_mesh(mesh);
+  pxr::UsdTimeCode timecode = get_export_time_code();
+  sample.usd_mesh = pxr::UsdGeomMesh::Define(usd_export_context_.stage,
+                                             usd_export_context_.usd_path);
+  write_visibility(context, timecode, sample.usd_mesh);
+
+  if (usd_export_context_.export_params.use_instancing && context.is_instance()) {
+    if (!mark_as_instance(context, sample.usd_mesh.GetPrim())) {
+      free_deferred_sample();
+      return;
     }
-    throw;
+    sample.is_instance = true;
   }
 }
 
@@ -111,10 +125,172 @@ struct USDMeshData {
   pxr::VtFloatArray crease_sharpnesses;
 };
 
-void USDGenericMeshWriter::write_uv_maps(const Mesh *mesh, pxr::UsdGeomMesh usd_mesh)
+struct USDGenericMeshWriter::DeferredSample {
+  Object *object = nullptr;
+  Mesh *mesh = nullptr;
+  bool mesh_needs_free = false;
+  /* Copied from frame_has_been_written_, which is already set by the time the sample is
+   * written. */
+  bool is_first_frame = false;
+  /* The prim references the original data instead, only the materials have to be written. */
+  bool is_instance = false;
+  pxr::UsdGeomMesh usd_mesh;
+
+  USDMeshData mesh_data;
+  std::vector<std::pair<pxr::TfToken, pxr::VtVec2fArray>> uv_maps;
+  pxr::VtVec3fArray normals;
+  pxr::VtVec3fArray velocities;
+  bool has_velocities = false;
+
+  /* Only filled when a mesh with the same content can be referenced, instead of writing the data
+   * again. See USDExportParams::deduplicate_meshes. */
+  bool can_deduplicate = false;
+  USDMeshContent content;
+};
+
+USDGenericMeshWriter::~USDGenericMeshWriter()
 {
-  pxr::UsdTimeCode timecode = get_export_time_code();
+  free_deferred_sample();
+}
+
+bool USDGenericMeshWriter::has_deferred_sample() const
+{
+  return deferred_sample_ != nullptr;
+}
+
+void USDGenericMeshWriter::prepare_deferred_sample()
+{
+  DeferredSample &sample = *deferred_sample_;
+  const USDExportParams &export_params = usd_export_context_.export_params;
+
+  if (sample.is_instance) {
+    /* The face groups are needed for the material assignment. */
+    if (export_params.export_materials) {
+      get_geometry_data(sample.mesh, sample.mesh_data);
+    }
+    return;
+  }
+
+  get_geometry_data(sample.mesh, sample.mesh_data);
+  if (export_params.export_uvmaps) {
+    get_uv_maps(sample.mesh, sample);
+  }
+  if (export_params.export_normals) {
+    get_normals(sample.mesh, sample.normals);
+  }
+  sample.has_velocities = get_surface_velocities(sample.object, sample.mesh, sample.velocities);
+
+  /* Animated meshes are written for every frame, so they are never shared. */
+  sample.can_deduplicate = export_params.deduplicate_meshes && !is_animated_ &&
+                           sample.is_first_frame && !sample.has_velocities;
+  if (!sample.can_deduplicate) {
+    return;
+  }
+
+  /* The same attributes as write_mesh() authors, so they can be compared with the stage. */
+  const USDMeshData &mesh_data = sample.mesh_data;
+  USDMeshContent &content = sample.content;
+  content.add(pxr::UsdGeomTokens->points, mesh_data.points);
+  content.add(pxr::UsdGeomTokens->faceVertexCounts, mesh_data.face_vertex_counts);
+  content.add(pxr::UsdGeomTokens->faceVertexIndices, mesh_data.face_indices);
+  if (!mesh_data.crease_lengths.empty()) {
+    content.add(pxr::UsdGeomTokens->creaseLengths, mesh_data.crease_lengths);
+    content.add(pxr::UsdGeomTokens->creaseIndices, mesh_data.crease_vertex_indices);
+    content.add(pxr::UsdGeomTokens->creaseSharpnesses, mesh_data.crease_sharpnesses);
+  }
+  for (const std::pair<pxr::TfToken, pxr::VtVec2fArray> &uv_map : sample.uv_maps) {
+    content.add(pxr::TfToken("primvars:" + uv_map.first.GetString()), uv_map.second);
+  }
+  if (export_params.export_normals) {
+    content.add(pxr::UsdGeomTokens->normals, sample.normals);
+  }
+
+  /* The geometry subsets of the referenced mesh bind its materials, so those have to match. The
+   * subsets are written under the same conditions as in assign_materials(). */
+  if (export_params.export_materials) {
+    bool has_material = false;
+    for (int mat_num = 0; mat_num < sample.object->totcol; mat_num++) {
+      const Material *material = BKE_object_material_get(sample.object, mat_num + 1);
+      content.materials.push_back(material);
+      has_material |= material != nullptr;
+    }
+    if (has_material && mesh_data.face_groups.size() >= 2) {
+      for (const MaterialFaceGroups::value_type &face_group : mesh_data.face_groups) {
+        Material *material = BKE_object_material_get(sample.object, face_group.first + 1);
+        if (material == nullptr) {
+          continue;
+        }
+        const pxr::TfToken material_name(
+            usd_export_context_.hierarchy_iterator->get_id_name(&material->id));
+        content.add(material_name, pxr::UsdGeomTokens->indices, face_group.second);
+      }
+    }
+  }
+}
+
+void USDGenericMeshWriter::write_deferred_sample()
+{
+  try {
+    DeferredSample &sample = *deferred_sample_;
+    if (sample.is_instance) {
+      /* The material path will be of the form </_materials/{material name}>, which is outside the
+       * sub-tree pointed to by ref_path. As a result, the referenced data is not allowed to point
+       * out of its own sub-tree. It does work when we override the material with exactly the
+       * same path, though.*/
+      if (usd_export_context_.export_params.export_materials) {
+        assign_materials(sample.object, sample.usd_mesh, sample.mesh_data.face_groups);
+      }
+    }
+    else if (!write_reference_to_duplicate(sample)) {
+      write_mesh(sample);
+    }
+  }
+  catch (...) {
+    free_deferred_sample();
+    throw;
+  }
+  free_deferred_sample();
+}
 
+void USDGenericMeshWriter::free_deferred_sample()
+{
+  if (deferred_sample_ && deferred_sample_->mesh_needs_free) {
+    free_export_mesh(deferred_sample_->mesh);
+  }
+  deferred_sample_.reset();
+}
+
+/* Reference a mesh prim that was written earlier with the same content, instead of writing the
+ * same data again. Return false when the data still has to be written. */
+bool USDGenericMeshWriter::write_reference_to_duplicate(DeferredSample &sample)
+{
+  if (!sample.can_deduplicate) {
+    return false;
+  }
+
+  const pxr::SdfPath original_path = usd_export_context_.mesh_deduplicator->find_or_add(
+      usd_export_context_.stage, sample.content, usd_path());
+  if (original_path.IsEmpty()) {
+    return false;
+  }
+
+  if (!sample.usd_mesh.GetPrim().GetReferences().AddInternalReference(original_path)) {
+    printf("USD Export warning: unable to add reference from %s to %s, writing mesh data\n",
+           usd_path().GetText(),
+           original_path.GetText());
+    return false;
+  }
+
+  /* Like for instances, the material bindings point outside of the referenced sub-tree, so they
+   * are written again. */
+  if (usd_export_context_.export_params.export_materials) {
+    assign_materials(sample.object, sample.usd_mesh, sample.mesh_data.face_groups);
+  }
+  return true;
+}
+
+void USDGenericMeshWriter::get_uv_maps(const Mesh *mesh, DeferredSample &sample)
+{
   const CustomData *ldata = &mesh->ldata;
   for (int layer_idx = 0; layer_idx < ldata->totlayer; layer_idx++) {
     const CustomDataLayer *layer = &ldata->layers[layer_idx];
@@ -127,51 +303,23 @@ void USDGenericMeshWriter::write_uv_maps(const Mesh *mesh, pxr::UsdGeomMesh usd_
      * for texture coordinates by naming the UV Map as such, without having to guess which UV Map
      * is the "standard" one. */
     pxr::TfToken primvar_name(pxr::TfMakeValidIdentifier(layer->name));
-    pxr::UsdGeomPrimvar uv_coords_primvar = usd_mesh.CreatePrimvar(
-        primvar_name, pxr::SdfValueTypeNames->TexCoord2fArray, pxr::UsdGeomTokens->faceVarying);
 
     MLoopUV *mloopuv = static_cast<MLoopUV *>(layer->data);
     pxr::VtArray<pxr::GfVec2f> uv_coords;
+    uv_coords.reserve(mesh->totloop);
     for (int loop_idx = 0; loop_idx < mesh->totloop; loop_idx++) {
       uv_coords.push_back(pxr::GfVec2f(mloopuv[loop_idx].uv));
     }
-
-    if (!uv_coords_primvar.HasValue()) {
-      uv_coords_primvar.Set(uv_coords, pxr::UsdTimeCode::Default());
-    }
-    const pxr::UsdAttribute &uv_coords_attr = uv_coords_primvar.GetAttr();
-    usd_value_writer_.SetAttribute(uv_coords_attr, pxr::VtValue(uv_coords), timecode);
+    sample.uv_maps.emplace_back(primvar_name, uv_coords);
   }
 }
 
-void USDGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
+void USDGenericMeshWriter::write_mesh(DeferredSample &sample)
 {
   pxr::UsdTimeCode timecode = get_export_time_code();
   pxr::UsdTimeCode defaultTime = pxr::UsdTimeCode::Default();
-  pxr::UsdStageRefPtr stage = usd_export_context_.stage;
-  const pxr::SdfPath &usd_path = usd_export_context_.usd_path;
-
-  pxr::UsdGeomMesh usd_mesh = pxr::UsdGeomMesh::Define(stage, usd_path);
-  write_visibility(context, timecode, usd_mesh);
-
-  USDMeshData usd_mesh_data;
-  get_geometry_data(mesh, usd_mesh_data);
-
-  if (usd_export_context_.export_params.use_instancing && context.is_instance()) {
-    if (!mark_as_instance(context, usd_mesh.GetPrim())) {
-      return;
-    }
-
-    /* The material path will be of the form </_materials/{material name}>, which is outside the
-     * sub-tree pointed to by ref_path. As a result, the referenced data is not allowed to point
-     * out of its own sub-tree. It does work when we override the material with exactly the same
-     * path, though.*/
-    if (usd_export_context_.export_params.export_materials) {
-      assign_materials(context, usd_mesh, usd_mesh_data.face_groups);
-    }
-
-    return;
-  }
+  pxr::UsdGeomMesh &usd_mesh = sample.usd_mesh;
+  const USDMeshData &usd_mesh_data = sample.mesh_data;
 
   pxr::UsdAttribute attr_points = usd_mesh.CreatePointsAttr(pxr::VtValue(), true);
   pxr::UsdAttribute attr_face_vertex_counts = usd_mesh.CreateFaceVertexCountsAttr(pxr::VtValue(),
@@ -213,23 +361,38 @@ void USDGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
         attr_crease_sharpness, pxr::VtValue(usd_mesh_data.crease_sharpnesses), timecode);
   }
 
-  if (usd_export_context_.export_params.export_uvmaps) {
-    write_uv_maps(mesh, usd_mesh);
+  for (const std::pair<pxr::TfToken, pxr::VtVec2fArray> &uv_map : sample.uv_maps) {
+    pxr::UsdGeomPrimvar uv_coords_primvar = usd_mesh.CreatePrimvar(
+        uv_map.first, pxr::SdfValueTypeNames->TexCoord2fArray, pxr::UsdGeomTokens->faceVarying);
+    if (!uv_coords_primvar.HasValue()) {
+      uv_coords_primvar.Set(uv_map.second, defaultTime);
+    }
+    const pxr::UsdAttribute &uv_coords_attr = uv_coords_primvar.GetAttr();
+    usd_value_writer_.SetAttribute(uv_coords_attr, pxr::VtValue(uv_map.second), timecode);
   }
+
   if (usd_export_context_.export_params.export_normals) {
-    write_normals(mesh, usd_mesh);
+    pxr::UsdAttribute attr_normals = usd_mesh.CreateNormalsAttr(pxr::VtValue(), true);
+    if (!attr_normals.HasValue()) {
+      attr_normals.Set(sample.normals, defaultTime);
+    }
+    usd_value_writer_.SetAttribute(attr_normals, pxr::VtValue(sample.normals), timecode);
+    usd_mesh.SetNormalsInterpolation(pxr::UsdGeomTokens->faceVarying);
+  }
+
+  if (sample.has_velocities) {
+    usd_mesh.CreateVelocitiesAttr().Set(sample.velocities, timecode);
   }
-  write_surface_velocity(context.object, mesh, usd_mesh);
 
   /* TODO(Sybren): figure out what happens when the face groups change. */
-  if (frame_has_been_written_) {
+  if (!sample.is_first_frame) {
     return;
   }
 
   usd_mesh.CreateSubdivisionSchemeAttr().Set(pxr::UsdGeomTokens->none);
 
   if (usd_export_context_.export_params.export_materials) {
-    assign_materials(context, usd_mesh, usd_mesh_data.face_groups);
+    assign_materials(sample.object, usd_mesh, usd_mesh_data.face_groups);
   }
 }
 
@@ -299,11 +462,11 @@ void USDGenericMeshWriter::get_geometry_data(const Mesh *mesh, USDMeshData &usd_
   get_creases(mesh, usd_mesh_data);
 }
 
-void USDGenericMeshWriter::assign_materials(const HierarchyContext &context,
+void USDGenericMeshWriter::assign_materials(Object *object,
                                             pxr::UsdGeomMesh usd_mesh,
                                             const MaterialFaceGroups &usd_face_groups)
 {
-  if (context.object->totcol == 0) {
+  if (object->totcol == 0) {
     return;
   }
 
@@ -312,8 +475,8 @@ void USDGenericMeshWriter::assign_materials(const HierarchyContext &context,
    * https://github.com/PixarAnimationStudios/USD/issues/542 for more info. */
   bool mesh_material_bound = false;
   pxr::UsdShadeMaterialBindingAPI material_binding_api(usd_mesh.GetPrim());
-  for (int mat_num = 0; mat_num < context.object->totcol; mat_num++) {
-    Material *material = BKE_object_material_get(context.object, mat_num + 1);
+  for (int mat_num = 0; mat_num < object->totcol; mat_num++) {
+    Material *material = BKE_object_material_get(object, mat_num + 1);
     if (material == nullptr) {
       continue;
     }
@@ -347,7 +510,7 @@ void USDGenericMeshWriter::assign_materials(const HierarchyContext &context,
     short material_number = face_group.first;
     const pxr::VtIntArray &face_indices = face_group.second;
 
-    Material *material = BKE_object_material_get(context.object, material_number + 1);
+    Material *material = BKE_object_material_get(object, material_number + 1);
     if (material == nullptr) {
       continue;
     }
@@ -361,9 +524,8 @@ void USDGenericMeshWriter::assign_materials(const HierarchyContext &context,
   }
 }
 
-void USDGenericMeshWriter::write_normals(const Mesh *mesh, pxr::UsdGeomMesh usd_mesh)
+void USDGenericMeshWriter::get_normals(const Mesh *mesh, pxr::VtVec3fArray &r_loop_normals)
 {
-  pxr::UsdTimeCode timecode = get_export_time_code();
   const float(*lnors)[3] = static_cast<float(*)[3]>(CustomData_get_layer(&mesh->ldata, CD_NORMAL));
 
   pxr::VtVec3fArray loop_normals;
@@ -401,24 +563,19 @@ void USDGenericMeshWriter::write_normals(const Mesh *mesh, pxr::UsdGeomMesh usd_
     }
   }
 
-  pxr::UsdAttribute attr_normals = usd_mesh.CreateNormalsAttr(pxr::VtValue(), true);
-  if (!attr_normals.HasValue()) {
-    attr_normals.Set(loop_normals, pxr::UsdTimeCode::Default());
-  }
-  usd_value_writer_.SetAttribute(attr_normals, pxr::VtValue(loop_normals), timecode);
-  usd_mesh.SetNormalsInterpolation(pxr::UsdGeomTokens->faceVarying);
+  r_loop_normals = std::move(loop_normals);
 }
 
-void USDGenericMeshWriter::write_surface_velocity(Object *object,
+bool USDGenericMeshWriter::get_surface_velocities(Object *object,
                                                   const Mesh *mesh,
-                                                  pxr::UsdGeomMesh usd_mesh)
+                                                  pxr::VtVec3fArray &r_velocities)
 {
   /* Only velocities from the fluid simulation are exported. This is the most important case,
    * though, as the baked mesh changes topology all the time, and thus computing the velocities
    * at import time in a post-processing step is hard. */
   ModifierData *md = BKE_modifiers_findby_type(object, eModifierType_Fluidsim);
   if (md == nullptr) {
-    return;
+    return false;
   }
 
   /* Check that the fluid sim modifier is enabled and has useful data. */
@@ -426,29 +583,26 @@ void USDGenericMeshWriter::write_surface_velocity(Object *object,
   const ModifierMode required_mode = use_render ? eModifierMode_Render : eModifierMode_Realtime;
   const Scene *scene = DEG_get_evaluated_scene(usd_export_context_.depsgraph);
   if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
-    return;
+    return false;
   }
   FluidsimModifierData *fsmd = reinterpret_cast<FluidsimModifierData *>(md);
   if (!fsmd->fss || fsmd->fss->type != OB_FLUIDSIM_DOMAIN) {
-    return;
+    return false;
   }
   FluidsimSettings *fss = fsmd->fss;
   if (!fss->meshVelocities) {
-    return;
+    return false;
   }
 
   /* Export per-vertex velocity vectors. */
-  pxr::VtVec3fArray usd_velocities;
-  usd_velocities.reserve(mesh->totvert);
+  r_velocities.reserve(mesh->totvert);
 
   FluidVertexVelocity *mesh_velocities = fss->meshVelocities;
   for (int vertex_idx = 0, totvert = mesh->totvert; vertex_idx < totvert;
        ++vertex_idx, ++mesh_velocities) {
-    usd_velocities.push_back(pxr::GfVec3f(mesh_velocities->vel));
+    r_velocities.push_back(pxr::GfVec3f(mesh_velocities->vel));
   }
-
-  pxr::UsdTimeCode timecode = get_export_time_code();
-  usd_mesh.CreateVelocitiesAttr().Set(usd_velocities, timecode);
+  return true;
 }
 
 USDMeshWriter::USDMeshWriter(const USDExporterContext &ctx) : USDGenericMeshWriter(ctx)
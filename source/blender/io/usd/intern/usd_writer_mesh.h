@@ -22,14 +22,28 @@
 
 #include <pxr/usd/usdGeom/mesh.h>
 
+#include <map>
+#include <memory>
+
 namespace blender::io::usd {
 
 struct USDMeshData;
 
 /* Writer for USD geometry. Does not assume the object is a mesh object. */
 class USDGenericMeshWriter : public USDAbstractWriter {
+ private:
+  /* Data of the sample of the current frame,
+   * see AbstractHierarchyWriter::has_deferred_sample(). */
+  struct DeferredSample;
+  std::unique_ptr<DeferredSample> deferred_sample_;
+
  public:
   USDGenericMeshWriter(const USDExporterContext &ctx);
+  virtual ~USDGenericMeshWriter();
+
+  virtual bool has_deferred_sample() const override;
+  virtual void prepare_deferred_sample() override;
+  virtual void write_deferred_sample() override;
 
  protected:
   virtual bool is_supported(const HierarchyContext *context) const override;
@@ -42,14 +56,16 @@ class USDGenericMeshWriter : public USDAbstractWriter {
   /* Mapping from material slot number to array of face indices with that material. */
   typedef std::map<short, pxr::VtIntArray> MaterialFaceGroups;
 
-  void write_mesh(HierarchyContext &context, Mesh *mesh);
+  void write_mesh(DeferredSample &sample);
+  void free_deferred_sample();
+  bool write_reference_to_duplicate(DeferredSample &sample);
   void get_geometry_data(const Mesh *mesh, struct USDMeshData &usd_mesh_data);
-  void assign_materials(const HierarchyContext &context,
+  void assign_materials(Object *object,
                         pxr::UsdGeomMesh usd_mesh,
                         const MaterialFaceGroups &usd_face_groups);
-  void write_uv_maps(const Mesh *mesh, pxr::UsdGeomMesh usd_mesh);
-  void write_normals(const Mesh *mesh, pxr::UsdGeomMesh usd_mesh);
-  void write_surface_velocity(Object *object, const Mesh *mesh, pxr::UsdGeomMesh usd_mesh);
+  void get_uv_maps(const Mesh *mesh, DeferredSample &sample);
+  void get_normals(const Mesh *mesh, pxr::VtVec3fArray &r_loop_normals);
+  bool get_surface_velocities(Object *object, const Mesh *mesh, pxr::VtVec3fArray &r_velocities);
 };
 
 class USDMeshWriter : public USDGenericMeshWriter {
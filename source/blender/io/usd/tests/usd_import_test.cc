@@ -0,0 +1,269 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#include "testing/testing.h"
+
+#include "intern/usd_reader_stage.h"
+
+#include <pxr/base/plug/registry.h>
+#include <pxr/usd/usd/references.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/xform.h>
+
+#include <string>
+
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+
+#include "BLI_math_matrix.h"
+#include "BLI_path_util.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+
+#include "PIL_time.h"
+
+#define DO_PERF_TESTS 0
+
+namespace blender::io::usd {
+
+class USDImportTest : public testing::Test {
+ protected:
+  Main *bmain;
+  USDImportParams params;
+
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    const std::string &release_dir = blender::tests::flags_test_release_dir();
+    if (release_dir.empty()) {
+      FAIL();
+    }
+
+    char usd_datafiles_dir[FILE_MAX];
+    const size_t path_len = BLI_path_join(
+        usd_datafiles_dir, FILE_MAX, release_dir.c_str(), "datafiles", "usd", nullptr);
+    BLI_assert(path_len + 1 < FILE_MAX);
+    usd_datafiles_dir[path_len] = '/';
+    usd_datafiles_dir[path_len + 1] = '\0';
+    pxr::PlugRegistry::GetInstance().RegisterPlugins(usd_datafiles_dir);
+
+    bmain = BKE_main_new();
+    params.scale = 1.0f;
+    params.use_instancing = true;
+    params.import_uvmaps = true;
+    params.import_normals = true;
+    params.validate_meshes = false;
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+  }
+
+  /* A prototype holding a single quad, referenced by two instanceable prims. */
+  static pxr::UsdStageRefPtr instancing_stage_create()
+  {
+    pxr::UsdStageRefPtr stage = pxr::UsdStage::CreateInMemory();
+
+    stage->CreateClassPrim(pxr::SdfPath("/Prototype"));
+    pxr::UsdGeomMesh quad = pxr::UsdGeomMesh::Define(stage, pxr::SdfPath("/Prototype/Quad"));
+    quad.CreatePointsAttr(pxr::VtValue(pxr::VtVec3fArray{pxr::GfVec3f(0.0f, 0.0f, 0.0f),
+                                                         pxr::GfVec3f(1.0f, 0.0f, 0.0f),
+                                                         pxr::GfVec3f(1.0f, 1.0f, 0.0f),
+                                                         pxr::GfVec3f(0.0f, 1.0f, 0.0f)}));
+    quad.CreateFaceVertexCountsAttr(pxr::VtValue(pxr::VtIntArray{4}));
+    quad.CreateFaceVertexIndicesAttr(pxr::VtValue(pxr::VtIntArray{0, 1, 2, 3}));
+
+    pxr::UsdGeomXform::Define(stage, pxr::SdfPath("/World"));
+    for (const char *path : {"/World/InstanceA", "/World/InstanceB"}) {
+      pxr::UsdGeomXform instance = pxr::UsdGeomXform::Define(stage, pxr::SdfPath(path));
+      instance.GetPrim().GetReferences().AddInternalReference(pxr::SdfPath("/Prototype"));
+      instance.GetPrim().SetInstanceable(true);
+    }
+    return stage;
+  }
+
+  /* Run all import phases, except linking the objects into a scene. */
+  static void import_stage(USDStageReader &stage_reader)
+  {
+    stage_reader.collect_readers();
+    stage_reader.create_prototype_collections();
+    for (const std::unique_ptr<USDPrimReader> &reader : stage_reader.readers()) {
+      reader->create_object();
+    }
+    for (const std::unique_ptr<USDPrimReader> &reader : stage_reader.readers()) {
+      if (reader->parent() != nullptr) {
+        reader->object()->parent = reader->parent()->object();
+      }
+    }
+    stage_reader.read_object_data(pxr::UsdTimeCode::EarliestTime());
+  }
+};
+
+TEST_F(USDImportTest, InstancesShareOnePrototype)
+{
+  pxr::UsdStageRefPtr stage = instancing_stage_create();
+  USDImporterContext context{bmain, params};
+  unit_m4(context.root_transform);
+  USDStageReader stage_reader(stage, context);
+  import_stage(stage_reader);
+
+  /* World, its two instances, and the quad of the prototype. */
+  const USDStageReader::ReaderVector &readers = stage_reader.readers();
+  ASSERT_EQ(readers.size(), 4u);
+  ASSERT_EQ(context.prototype_collections.size(), 1u);
+  Collection *prototype_collection = context.prototype_collections.begin()->second;
+
+  int instances_num = 0;
+  int meshes_num = 0;
+  for (const std::unique_ptr<USDPrimReader> &reader : readers) {
+    const Object *ob = reader->object();
+    if (ob->transflag & OB_DUPLICOLLECTION) {
+      EXPECT_EQ(ob->instance_collection, prototype_collection);
+      EXPECT_STREQ(ob->parent->id.name + 2, "World");
+      instances_num++;
+    }
+    if (ob->type == OB_MESH) {
+      const Mesh *mesh = static_cast<const Mesh *>(ob->data);
+      EXPECT_EQ(mesh->totvert, 4);
+      EXPECT_EQ(mesh->totpoly, 1);
+      EXPECT_EQ(mesh->totedge, 4);
+      EXPECT_FALSE(reader->prototype_path().IsEmpty());
+      meshes_num++;
+    }
+  }
+  EXPECT_EQ(instances_num, 2);
+  EXPECT_EQ(meshes_num, 1);
+}
+
+TEST_F(USDImportTest, InstancesWithoutInstancing)
+{
+  params.use_instancing = false;
+  pxr::UsdStageRefPtr stage = instancing_stage_create();
+  USDImporterContext context{bmain, params};
+  unit_m4(context.root_transform);
+  USDStageReader stage_reader(stage, context);
+  import_stage(stage_reader);
+
+  /* Every instance gets its own copy of the quad. */
+  const USDStageReader::ReaderVector &readers = stage_reader.readers();
+  EXPECT_EQ(readers.size(), 5u);
+  EXPECT_TRUE(context.prototype_collections.empty());
+  int meshes_num = 0;
+  for (const std::unique_ptr<USDPrimReader> &reader : readers) {
+    meshes_num += reader->object()->type == OB_MESH;
+  }
+  EXPECT_EQ(meshes_num, 2);
+}
+
+#if DO_PERF_TESTS
+
+#  define PROTOTYPES_NUM 100
+#  define INSTANCES_NUM 100000
+#  define PROTOTYPE_GRID_SIZE 64
+
+/* Prototypes holding a grid of quads each, referenced by many instanceable prims. */
+static pxr::UsdStageRefPtr instancing_stage_large_create()
+{
+  pxr::UsdStageRefPtr stage = pxr::UsdStage::CreateInMemory();
+
+  const int row_len = PROTOTYPE_GRID_SIZE + 1;
+  pxr::VtVec3fArray points(row_len * row_len);
+  for (int y = 0; y < row_len; y++) {
+    for (int x = 0; x < row_len; x++) {
+      points[y * row_len + x] = pxr::GfVec3f(x, y, 0.0f);
+    }
+  }
+  pxr::VtIntArray counts(PROTOTYPE_GRID_SIZE * PROTOTYPE_GRID_SIZE, 4);
+  pxr::VtIntArray indices;
+  indices.reserve(counts.size() * 4);
+  for (int y = 0; y < PROTOTYPE_GRID_SIZE; y++) {
+    for (int x = 0; x < PROTOTYPE_GRID_SIZE; x++) {
+      indices.push_back(y * row_len + x);
+      indices.push_back(y * row_len + x + 1);
+      indices.push_back((y + 1) * row_len + x + 1);
+      indices.push_back((y + 1) * row_len + x);
+    }
+  }
+
+  for (int i = 0; i < PROTOTYPES_NUM; i++) {
+    const pxr::SdfPath prototype_path("/Prototype" + std::to_string(i));
+    stage->CreateClassPrim(prototype_path);
+    pxr::UsdGeomMesh grid = pxr::UsdGeomMesh::Define(
+        stage, prototype_path.AppendChild(pxr::TfToken("Grid")));
+    grid.CreatePointsAttr(pxr::VtValue(points));
+    grid.CreateFaceVertexCountsAttr(pxr::VtValue(counts));
+    grid.CreateFaceVertexIndicesAttr(pxr::VtValue(indices));
+  }
+
+  pxr::UsdGeomXform::Define(stage, pxr::SdfPath("/World"));
+  for (int i = 0; i < INSTANCES_NUM; i++) {
+    pxr::UsdGeomXform instance = pxr::UsdGeomXform::Define(
+        stage, pxr::SdfPath("/World/Instance" + std::to_string(i)));
+    instance.GetPrim().GetReferences().AddInternalReference(
+        pxr::SdfPath("/Prototype" + std::to_string(i % PROTOTYPES_NUM)));
+    instance.GetPrim().SetInstanceable(true);
+  }
+  return stage;
+}
+
+TEST_F(USDImportTest, PerformanceInstancing)
+{
+  pxr::UsdStageRefPtr stage = instancing_stage_large_create();
+  USDImporterContext context{bmain, params};
+  unit_m4(context.root_transform);
+  USDStageReader stage_reader(stage, context);
+
+  printf("\n========== STARTING %d instances of %d prototypes ==========\n",
+         INSTANCES_NUM,
+         PROTOTYPES_NUM);
+
+  double time = PIL_check_seconds_timer();
+  stage_reader.collect_readers();
+  printf("\tcollect_readers: done in %fs\n", PIL_check_seconds_timer() - time);
+
+  time = PIL_check_seconds_timer();
+  stage_reader.create_prototype_collections();
+  for (const std::unique_ptr<USDPrimReader> &reader : stage_reader.readers()) {
+    reader->create_object();
+  }
+  printf("\tcreate_object: done in %fs\n", PIL_check_seconds_timer() - time);
+
+  time = PIL_check_seconds_timer();
+  stage_reader.read_object_data(pxr::UsdTimeCode::EarliestTime());
+  printf("\tread_object_data: done in %fs\n", PIL_check_seconds_timer() - time);
+
+  /* World, the instances and one mesh for every prototype. */
+  EXPECT_EQ(stage_reader.readers().size(), size_t(1 + INSTANCES_NUM + PROTOTYPES_NUM));
+  EXPECT_EQ(context.prototype_collections.size(), size_t(PROTOTYPES_NUM));
+
+  printf("========== ENDED %d instances of %d prototypes ==========\n\n",
+         INSTANCES_NUM,
+         PROTOTYPES_NUM);
+}
+
+#endif
+
+}  // namespace blender::io::usd
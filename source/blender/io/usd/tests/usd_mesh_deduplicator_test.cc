@@ -0,0 +1,178 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#include "testing/testing.h"
+
+#include "intern/usd_mesh_deduplicator.h"
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/plug/registry.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/usd/sdf/schema.h>
+#include <pxr/usd/usd/attribute.h>
+#include <pxr/usd/usd/stage.h>
+
+#include "BLI_path_util.h"
+#include "BLI_utildefines.h"
+
+namespace blender::io::usd {
+
+class USDMeshDeduplicatorTest : public testing::Test {
+ protected:
+  pxr::UsdStageRefPtr stage;
+  USDMeshDeduplicator deduplicator;
+
+  void SetUp() override
+  {
+    const std::string &release_dir = blender::tests::flags_test_release_dir();
+    if (release_dir.empty()) {
+      FAIL();
+    }
+
+    char usd_datafiles_dir[FILE_MAX];
+    const size_t path_len = BLI_path_join(
+        usd_datafiles_dir, FILE_MAX, release_dir.c_str(), "datafiles", "usd", nullptr);
+    BLI_assert(path_len + 1 < FILE_MAX);
+    usd_datafiles_dir[path_len] = '/';
+    usd_datafiles_dir[path_len + 1] = '\0';
+    pxr::PlugRegistry::GetInstance().RegisterPlugins(usd_datafiles_dir);
+
+    stage = pxr::UsdStage::CreateInMemory();
+  }
+
+  /* Like the mesh writer, write the content when no earlier mesh holds the same. */
+  pxr::SdfPath find_or_write(const USDMeshContent &content, const char *path)
+  {
+    const pxr::SdfPath usd_path(path);
+    const pxr::SdfPath original_path = deduplicator.find_or_add(stage, content, usd_path);
+    if (!original_path.IsEmpty()) {
+      return original_path;
+    }
+    for (const std::pair<pxr::SdfPath, pxr::VtValue> &attribute : content.attributes) {
+      const pxr::SdfPath attr_path = attribute.first.MakeAbsolutePath(usd_path);
+      pxr::UsdPrim prim = stage->DefinePrim(attr_path.GetPrimPath());
+      prim.CreateAttribute(attr_path.GetNameToken(),
+                           pxr::SdfSchema::GetInstance().FindType(attribute.second))
+          .Set(attribute.second);
+    }
+    return pxr::SdfPath();
+  }
+};
+
+/* Content of a quad, with the attributes USDGenericMeshWriter writes. */
+static USDMeshContent quad_content(const float z = 0.0f,
+                                   const int first_index = 0,
+                                   const float uv_scale = 1.0f,
+                                   const char *uv_name = "primvars:UVMap")
+{
+  pxr::VtArray<pxr::GfVec3f> points = {pxr::GfVec3f(0.0f, 0.0f, z),
+                                       pxr::GfVec3f(1.0f, 0.0f, z),
+                                       pxr::GfVec3f(1.0f, 1.0f, z),
+                                       pxr::GfVec3f(0.0f, 1.0f, z)};
+  pxr::VtArray<int> face_vertex_counts = {4};
+  pxr::VtArray<int> face_indices = {first_index,
+                                    (first_index + 1) % 4,
+                                    (first_index + 2) % 4,
+                                    (first_index + 3) % 4};
+  pxr::VtArray<pxr::GfVec2f> uvs = {pxr::GfVec2f(0.0f, 0.0f),
+                                    pxr::GfVec2f(uv_scale, 0.0f),
+                                    pxr::GfVec2f(uv_scale, uv_scale),
+                                    pxr::GfVec2f(0.0f, uv_scale)};
+
+  USDMeshContent content;
+  content.add(pxr::TfToken("points"), points);
+  content.add(pxr::TfToken("faceVertexCounts"), face_vertex_counts);
+  content.add(pxr::TfToken("faceVertexIndices"), face_indices);
+  content.add(pxr::TfToken(uv_name), uvs);
+  return content;
+}
+
+TEST_F(USDMeshDeduplicatorTest, IdenticalMeshIsFound)
+{
+  const pxr::SdfPath first_path("/root/Cube/Cube");
+
+  EXPECT_TRUE(find_or_write(quad_content(), "/root/Cube/Cube").IsEmpty());
+  EXPECT_EQ(find_or_write(quad_content(), "/root/Cube_001/Cube"), first_path);
+  /* The first path keeps being returned. */
+  EXPECT_EQ(find_or_write(quad_content(), "/root/Cube_002/Cube"), first_path);
+}
+
+TEST_F(USDMeshDeduplicatorTest, DifferentPositionsAreNotFound)
+{
+  EXPECT_TRUE(find_or_write(quad_content(0.0f), "/a").IsEmpty());
+  EXPECT_TRUE(find_or_write(quad_content(1.0f), "/b").IsEmpty());
+  EXPECT_EQ(find_or_write(quad_content(1.0f), "/c"), pxr::SdfPath("/b"));
+}
+
+TEST_F(USDMeshDeduplicatorTest, DifferentTopologyIsNotFound)
+{
+  EXPECT_TRUE(find_or_write(quad_content(0.0f, 0), "/a").IsEmpty());
+  /* Same positions, the face starts at another corner. */
+  EXPECT_TRUE(find_or_write(quad_content(0.0f, 1), "/b").IsEmpty());
+}
+
+TEST_F(USDMeshDeduplicatorTest, DifferentAttributesAreNotFound)
+{
+  EXPECT_TRUE(find_or_write(quad_content(0.0f, 0, 1.0f), "/a").IsEmpty());
+  EXPECT_TRUE(find_or_write(quad_content(0.0f, 0, 2.0f), "/b").IsEmpty());
+
+  /* Same values, but stored in a UV map with another name. */
+  EXPECT_TRUE(find_or_write(quad_content(0.0f, 0, 1.0f, "primvars:Other"), "/c").IsEmpty());
+}
+
+TEST_F(USDMeshDeduplicatorTest, AdditionalAttributesAreNotFound)
+{
+  USDMeshContent content = quad_content();
+  content.add(pxr::TfToken("Material"), pxr::TfToken("indices"), pxr::VtArray<int>{0});
+
+  USDMeshContent quad = quad_content();
+  quad.hash = content.hash;
+
+  EXPECT_TRUE(find_or_write(content, "/a").IsEmpty());
+  /* Every attribute of the quad is written at "/a", which has one more. */
+  EXPECT_TRUE(find_or_write(quad, "/b").IsEmpty());
+  EXPECT_EQ(find_or_write(content, "/c"), pxr::SdfPath("/a"));
+  EXPECT_EQ(find_or_write(quad, "/d"), pxr::SdfPath("/b"));
+}
+
+TEST_F(USDMeshDeduplicatorTest, DifferentMaterialsAreNotFound)
+{
+  const Material *material = reinterpret_cast<const Material *>(&deduplicator);
+  USDMeshContent content_a = quad_content();
+  USDMeshContent content_b = quad_content();
+  content_b.materials.push_back(material);
+
+  EXPECT_TRUE(find_or_write(content_a, "/a").IsEmpty());
+  EXPECT_TRUE(find_or_write(content_b, "/b").IsEmpty());
+  EXPECT_EQ(find_or_write(content_b, "/c"), pxr::SdfPath("/b"));
+}
+
+TEST_F(USDMeshDeduplicatorTest, HashCollisionIsNotFound)
+{
+  USDMeshContent content_a = quad_content(0.0f);
+  USDMeshContent content_b = quad_content(1.0f);
+  content_b.hash = content_a.hash;
+
+  EXPECT_TRUE(find_or_write(content_a, "/a").IsEmpty());
+  EXPECT_TRUE(find_or_write(content_b, "/b").IsEmpty());
+  EXPECT_EQ(find_or_write(content_a, "/c"), pxr::SdfPath("/a"));
+  EXPECT_EQ(find_or_write(content_b, "/d"), pxr::SdfPath("/b"));
+}
+
+}  // namespace blender::io::usd
@@ -36,9 +36,22 @@ struct USDExportParams {
   bool selected_objects_only;
   bool visible_objects_only;
   bool use_instancing;
+  /* Write meshes with the same data and materials only once, and reference that mesh from the
+   * other objects. */
+  bool deduplicate_meshes;
   enum eEvaluationMode evaluation_mode;
 };
 
+struct USDImportParams {
+  float scale;
+  /* Import instanceable prims as instances of a collection holding their prototype, instead of
+   * importing a copy of the prototype for every instance. Point instancers always instance. */
+  bool use_instancing;
+  bool import_uvmaps;
+  bool import_normals;
+  bool validate_meshes;
+};
+
 /* The USD_export takes a as_background_job parameter, and returns a boolean.
  *
  * When as_background_job=true, returns false immediately after scheduling
@@ -53,6 +66,11 @@ bool USD_export(struct bContext *C,
                 const struct USDExportParams *params,
                 bool as_background_job);
 
+bool USD_import(struct bContext *C,
+                const char *filepath,
+                const struct USDImportParams *params,
+                bool as_background_job);
+
 int USD_get_version(void);
 
 #ifdef __cplusplus
@@ -0,0 +1,40 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include "BKE_context.h"
+
+#include "IO_wavefront_obj.h"
+
+#include "obj_exporter.hh"
+#include "obj_importer.hh"
+
+bool OBJ_export(bContext *C, const OBJExportParams *export_params)
+{
+  return blender::io::obj::exporter_main(C, *export_params);
+}
+
+bool OBJ_import(bContext *C, const OBJImportParams *import_params)
+{
+  return blender::io::obj::importer_main(
+      CTX_data_main(C), CTX_data_scene(C), CTX_data_view_layer(C), *import_params);
+}
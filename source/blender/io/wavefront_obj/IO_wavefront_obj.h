@@ -0,0 +1,75 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup obj
+ */
+
+#include "BLI_path_util.h"
+#include "DEG_depsgraph.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bContext;
+
+struct OBJExportParams {
+  /** Full path to the destination .OBJ file. */
+  char filepath[FILE_MAX];
+
+  /** Only export selected objects. */
+  bool export_selected_objects;
+  /** Use render or viewport settings for modifiers and object visibility. */
+  eEvaluationMode export_eval_mode;
+
+  /** Axes of the file, converted from Blender's Y forward and Z up (`OB_POSX` .. `OB_NEGZ`). */
+  int forward_axis;
+  int up_axis;
+  float scaling_factor;
+
+  bool export_uv;
+  bool export_normals;
+  /** Write `usemtl` statements with the names of the materials of the faces. */
+  bool export_materials;
+  bool export_smooth_groups;
+};
+
+struct OBJImportParams {
+  /** Full path to the source .OBJ file. */
+  char filepath[FILE_MAX];
+
+  /** Axes of the file, converted to Blender's Y forward and Z up (`OB_POSX` .. `OB_NEGZ`). */
+  int forward_axis;
+  int up_axis;
+  float scaling_factor;
+
+  /** Start a new object for `g` statements as well as for `o` statements. */
+  bool use_split_groups;
+  bool validate_meshes;
+};
+
+bool OBJ_export(struct bContext *C, const struct OBJExportParams *export_params);
+bool OBJ_import(struct bContext *C, const struct OBJImportParams *import_params);
+
+#ifdef __cplusplus
+}
+#endif
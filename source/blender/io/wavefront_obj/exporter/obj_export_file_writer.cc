@@ -0,0 +1,160 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include "BKE_blender_version.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+
+#include "obj_export_file_writer.hh"
+#include "IO_text_format.hh"
+#include "obj_export_mesh.hh"
+
+namespace blender::io::obj {
+
+OBJWriter::OBJWriter(const char *filepath, const OBJExportParams &export_params)
+    : export_params_(export_params)
+{
+  outfile_ = BLI_fopen(filepath, "wb");
+}
+
+OBJWriter::~OBJWriter()
+{
+  if (outfile_) {
+    fclose(outfile_);
+  }
+}
+
+void OBJWriter::write_header(const char *blend_filepath) const
+{
+  fprintf(outfile_,
+          "# Blender v%s OBJ File: '%s'\n# www.blender.org\n",
+          BKE_blender_version_string(),
+          BLI_path_basename(blend_filepath));
+}
+
+static void write_face(FormatBuffer &buffer,
+                       const OBJMesh &obj_mesh,
+                       const int poly_index,
+                       const IndexOffsets &offsets)
+{
+  const Mesh &mesh = obj_mesh.mesh();
+  const MPoly &mpoly = mesh.mpoly[poly_index];
+  const Span<int> loop_to_uv_index = obj_mesh.loop_to_uv_index();
+  const Span<int> loop_to_normal_index = obj_mesh.loop_to_normal_index();
+
+  buffer.append('f');
+  for (const int loop_index : IndexRange(mpoly.loopstart, mpoly.totloop)) {
+    buffer.append(' ');
+    buffer.append_int(int64_t(offsets.vertex_offset) + mesh.mloop[loop_index].v + 1);
+    if (!loop_to_uv_index.is_empty()) {
+      buffer.append('/');
+      buffer.append_int(int64_t(offsets.uv_vertex_offset) + loop_to_uv_index[loop_index] + 1);
+    }
+    if (!loop_to_normal_index.is_empty()) {
+      buffer.append(loop_to_uv_index.is_empty() ? "//" : "/");
+      buffer.append_int(int64_t(offsets.normal_offset) + loop_to_normal_index[loop_index] + 1);
+    }
+  }
+  buffer.append('\n');
+}
+
+IndexOffsets OBJWriter::write_object(const OBJMesh &obj_mesh, const IndexOffsets &offsets) const
+{
+  fprintf(outfile_, "o %s\n", obj_mesh.get_object_name().c_str());
+
+  const int tot_vertices = obj_mesh.tot_vertices();
+  write_formatted_chunks(outfile_, tot_vertices, [&](FormatBuffer &buffer, IndexRange range) {
+    for (const int vert_index : range) {
+      const float3 co = obj_mesh.calc_vertex_coords(vert_index);
+      buffer.append("v ");
+      buffer.append_float(co.x, 6);
+      buffer.append(' ');
+      buffer.append_float(co.y, 6);
+      buffer.append(' ');
+      buffer.append_float(co.z, 6);
+      buffer.append('\n');
+    }
+  });
+
+  const Span<float2> uv_coords = obj_mesh.uv_coords();
+  write_formatted_chunks(outfile_, uv_coords.size(), [&](FormatBuffer &buffer, IndexRange range) {
+    for (const float2 &uv : uv_coords.slice(range)) {
+      buffer.append("vt ");
+      buffer.append_float(uv.x, 6);
+      buffer.append(' ');
+      buffer.append_float(uv.y, 6);
+      buffer.append('\n');
+    }
+  });
+
+  const Span<float3> normal_coords = obj_mesh.normal_coords();
+  write_formatted_chunks(
+      outfile_, normal_coords.size(), [&](FormatBuffer &buffer, IndexRange range) {
+        for (const float3 &normal : normal_coords.slice(range)) {
+          buffer.append("vn ");
+          buffer.append_float(normal.x, 4);
+          buffer.append(' ');
+          buffer.append_float(normal.y, 4);
+          buffer.append(' ');
+          buffer.append_float(normal.z, 4);
+          buffer.append('\n');
+        }
+      });
+
+  /* Smooth groups and materials are written when they differ from the previous polygon, which
+   * only depends on the mesh, so chunks can still be formatted independently. */
+  const Mesh &mesh = obj_mesh.mesh();
+  const bool export_smooth_groups = export_params_.export_smooth_groups;
+  const bool export_materials = export_params_.export_materials;
+  write_formatted_chunks(
+      outfile_, obj_mesh.tot_polygons(), [&](FormatBuffer &buffer, IndexRange range) {
+        for (const int poly_index : range) {
+          if (export_smooth_groups) {
+            const bool smooth = mesh.mpoly[poly_index].flag & ME_SMOOTH;
+            if (poly_index == 0 || smooth != bool(mesh.mpoly[poly_index - 1].flag & ME_SMOOTH)) {
+              buffer.append(smooth ? "s 1\n" : "s off\n");
+            }
+          }
+          if (export_materials) {
+            const char *material_name = obj_mesh.get_poly_material_name(poly_index);
+            if (material_name != nullptr &&
+                (poly_index == 0 ||
+                 material_name != obj_mesh.get_poly_material_name(poly_index - 1))) {
+              buffer.append("usemtl ");
+              buffer.append(material_name);
+              buffer.append('\n');
+            }
+          }
+          write_face(buffer, obj_mesh, poly_index, offsets);
+        }
+      });
+
+  IndexOffsets next_offsets = offsets;
+  next_offsets.vertex_offset += tot_vertices;
+  next_offsets.uv_vertex_offset += uv_coords.size();
+  next_offsets.normal_offset += normal_coords.size();
+  return next_offsets;
+}
+
+}  // namespace blender::io::obj
@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <cstdio>
+
+#include "BLI_utility_mixins.hh"
+
+#include "IO_wavefront_obj.h"
+
+namespace blender::io::obj {
+
+class OBJMesh;
+
+/**
+ * Indices in OBJ files are global, objects written earlier offset the indices of later ones.
+ */
+struct IndexOffsets {
+  int vertex_offset = 0;
+  int uv_vertex_offset = 0;
+  int normal_offset = 0;
+};
+
+class OBJWriter : NonMovable, NonCopyable {
+ private:
+  const OBJExportParams &export_params_;
+  FILE *outfile_;
+
+ public:
+  OBJWriter(const char *filepath, const OBJExportParams &export_params);
+  ~OBJWriter();
+
+  bool is_open() const
+  {
+    return outfile_ != nullptr;
+  }
+
+  void write_header(const char *blend_filepath) const;
+  /**
+   * Write vertices, UV's, normals and faces of the object, formatted from multiple threads.
+   * \return The offsets for the next object.
+   */
+  IndexOffsets write_object(const OBJMesh &obj_mesh, const IndexOffsets &offsets) const;
+};
+
+}  // namespace blender::io::obj
@@ -0,0 +1,180 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <cmath>
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_material.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
+#include "BKE_object.h"
+
+#include "BLI_map.hh"
+#include "BLI_math.h"
+#include "BLI_task.hh"
+
+#include "DNA_material_types.h"
+#include "DNA_object_types.h"
+
+#include "obj_export_mesh.hh"
+
+namespace blender::io::obj {
+
+OBJMesh::OBJMesh(Object *object_eval, const OBJExportParams &export_params)
+    : object_name_(object_eval->id.name + 2)
+{
+  Mesh *mesh_eval = BKE_object_get_evaluated_mesh(object_eval);
+  if (mesh_eval == nullptr) {
+    mesh_eval = static_cast<Mesh *>(object_eval->data);
+  }
+  /* Layers added for export must not end up in the evaluated mesh of the depsgraph. */
+  export_mesh_eval_ = BKE_mesh_copy_for_eval(mesh_eval, true);
+
+  float axes_transform[3][3];
+  unit_m3(axes_transform);
+  mat3_from_axis_conversion(
+      OB_POSY, OB_POSZ, export_params.forward_axis, export_params.up_axis, axes_transform);
+  float transform[4][4];
+  copy_m4_m3(transform, axes_transform);
+  mul_m4_m4m4(transform, transform, object_eval->obmat);
+  world_and_axes_normal_transform_ = float4x4(transform).inverted_transposed_affine();
+  mul_mat3_m4_fl(transform, export_params.scaling_factor);
+  mul_v3_fl(transform[3], export_params.scaling_factor);
+  world_and_axes_transform_ = float4x4(transform);
+
+  if (export_params.export_uv) {
+    store_uv_coords_and_indices();
+  }
+  if (export_params.export_normals) {
+    store_normal_coords_and_indices(4);
+  }
+
+  const int tot_materials = max_ii(*BKE_object_material_len_p(object_eval), 1);
+  for (const int i : IndexRange(tot_materials)) {
+    const Material *material = BKE_object_material_get(object_eval, short(i + 1));
+    material_names_.append(material ? material->id.name + 2 : nullptr);
+  }
+}
+
+OBJMesh::~OBJMesh()
+{
+  BKE_id_free(nullptr, export_mesh_eval_);
+}
+
+float3 OBJMesh::calc_vertex_coords(const int vert_index) const
+{
+  return world_and_axes_transform_ * float3(export_mesh_eval_->mvert[vert_index].co);
+}
+
+const char *OBJMesh::get_poly_material_name(const int poly_index) const
+{
+  const int mat_nr = export_mesh_eval_->mpoly[poly_index].mat_nr;
+  return material_names_[min_ii(mat_nr, material_names_.size() - 1)];
+}
+
+/**
+ * Share UV coordinates between the loops of a vertex that are connected in UV space.
+ */
+void OBJMesh::store_uv_coords_and_indices()
+{
+  const Mesh *mesh = export_mesh_eval_;
+  const MLoopUV *mloopuv = static_cast<const MLoopUV *>(
+      CustomData_get_layer(&mesh->ldata, CD_MLOOPUV));
+  if (mloopuv == nullptr || mesh->totpoly == 0) {
+    return;
+  }
+
+  const float limit[2] = {STD_UV_CONNECT_LIMIT, STD_UV_CONNECT_LIMIT};
+  UvVertMap *uv_vert_map = BKE_mesh_uv_vert_map_create(
+      mesh->mpoly, mesh->mloop, mloopuv, mesh->totpoly, mesh->totvert, limit, false, false);
+
+  loop_to_uv_index_.reinitialize(mesh->totloop);
+  uv_coords_.reserve(mesh->totvert);
+  for (const int vert_index : IndexRange(mesh->totvert)) {
+    const UvMapVert *uv_vert = BKE_mesh_uv_vert_map_get_vert(uv_vert_map, vert_index);
+    for (; uv_vert; uv_vert = uv_vert->next) {
+      const int loop_index = mesh->mpoly[uv_vert->poly_index].loopstart +
+                             uv_vert->loop_of_poly_index;
+      if (uv_vert->separate) {
+        uv_coords_.append(float2(mloopuv[loop_index].uv));
+      }
+      loop_to_uv_index_[loop_index] = uv_coords_.size() - 1;
+    }
+  }
+  BKE_mesh_uv_vert_map_free(uv_vert_map);
+}
+
+namespace {
+/** Normal rounded to the precision it is written with, equal keys give the same text. */
+struct NormalKey {
+  int x, y, z;
+
+  uint64_t hash() const
+  {
+    return uint64_t(x) * 73856093 ^ uint64_t(y) * 19349663 ^ uint64_t(z) * 83492791;
+  }
+
+  friend bool operator==(const NormalKey &a, const NormalKey &b)
+  {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+  }
+};
+}  // namespace
+
+/**
+ * Store every distinct loop normal once, split normals follow the smooth flags, sharp edges and
+ * custom normals of the mesh.
+ */
+void OBJMesh::store_normal_coords_and_indices(const int precision)
+{
+  Mesh *mesh = export_mesh_eval_;
+  BKE_mesh_calc_normals_split(mesh);
+  const float(*loop_normals)[3] = static_cast<const float(*)[3]>(
+      CustomData_get_layer(&mesh->ldata, CD_NORMAL));
+
+  const float scale = powf(10.0f, float(precision));
+  Array<NormalKey> loop_keys(mesh->totloop);
+  parallel_for(IndexRange(mesh->totloop), 4096, [&](IndexRange range) {
+    for (const int loop_index : range) {
+      float3 normal = world_and_axes_normal_transform_.ref_3x3() *
+                      float3(loop_normals[loop_index]);
+      normalize_v3(normal);
+      loop_keys[loop_index] = {int(std::nearbyint(normal.x * scale)),
+                               int(std::nearbyint(normal.y * scale)),
+                               int(std::nearbyint(normal.z * scale))};
+    }
+  });
+
+  Map<NormalKey, int> normal_indices;
+  loop_to_normal_index_.reinitialize(mesh->totloop);
+  for (const int loop_index : IndexRange(mesh->totloop)) {
+    const NormalKey &key = loop_keys[loop_index];
+    loop_to_normal_index_[loop_index] = normal_indices.lookup_or_add_cb(key, [&]() {
+      normal_coords_.append(float3(key.x, key.y, key.z) / scale);
+      return normal_coords_.size() - 1;
+    });
+  }
+}
+
+}  // namespace blender::io::obj
@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <string>
+
+#include "BLI_array.hh"
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+#include "BLI_float4x4.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_utility_mixins.hh"
+#include "BLI_vector.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "IO_wavefront_obj.h"
+
+struct Object;
+
+namespace blender::io::obj {
+
+/**
+ * Evaluated mesh of an object with everything the writer needs: transformed coordinates and
+ * de-duplicated UV coordinates and normals, with the index of each of them for every loop.
+ */
+class OBJMesh : NonCopyable {
+ private:
+  /** Copied, the object can be a temporary instance of the depsgraph iterator. */
+  std::string object_name_;
+  /** Shallow copy of the evaluated mesh, owning the layers added for export. */
+  Mesh *export_mesh_eval_;
+  float4x4 world_and_axes_transform_;
+  float4x4 world_and_axes_normal_transform_;
+
+  Vector<float2> uv_coords_;
+  Array<int> loop_to_uv_index_;
+  Vector<float3> normal_coords_;
+  Array<int> loop_to_normal_index_;
+
+  /** Name of the material of every slot, null for empty slots. */
+  Vector<const char *> material_names_;
+
+ public:
+  OBJMesh(Object *object_eval, const OBJExportParams &export_params);
+  ~OBJMesh();
+
+  StringRefNull get_object_name() const
+  {
+    return object_name_;
+  }
+  const Mesh &mesh() const
+  {
+    return *export_mesh_eval_;
+  }
+
+  int tot_vertices() const
+  {
+    return export_mesh_eval_->totvert;
+  }
+  int tot_polygons() const
+  {
+    return export_mesh_eval_->totpoly;
+  }
+
+  float3 calc_vertex_coords(int vert_index) const;
+
+  Span<float2> uv_coords() const
+  {
+    return uv_coords_;
+  }
+  /** UV index of every loop, empty when there are no UV's to export. */
+  Span<int> loop_to_uv_index() const
+  {
+    return loop_to_uv_index_;
+  }
+  Span<float3> normal_coords() const
+  {
+    return normal_coords_;
+  }
+  /** Normal index of every loop, empty when normals are not exported. */
+  Span<int> loop_to_normal_index() const
+  {
+    return loop_to_normal_index_;
+  }
+
+  /** Name of the material used by the polygon, null when it has no material. */
+  const char *get_poly_material_name(int poly_index) const;
+
+ private:
+  void store_uv_coords_and_indices();
+  void store_normal_coords_and_indices(int precision);
+};
+
+}  // namespace blender::io::obj
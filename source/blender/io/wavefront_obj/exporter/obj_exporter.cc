@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <cstdio>
+#include <memory>
+
+#include "BKE_context.h"
+#include "BKE_main.h"
+#include "BKE_scene.h"
+
+#include "BLI_vector.hh"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "obj_export_file_writer.hh"
+#include "obj_export_mesh.hh"
+#include "obj_exporter.hh"
+
+namespace blender::io::obj {
+
+OBJDepsgraph::OBJDepsgraph(const bContext *C, const eEvaluationMode eval_mode)
+{
+  Scene *scene = CTX_data_scene(C);
+  Main *bmain = CTX_data_main(C);
+  ViewLayer *view_layer = CTX_data_view_layer(C);
+  if (eval_mode == DAG_EVAL_RENDER) {
+    depsgraph_ = DEG_graph_new(bmain, scene, view_layer, eval_mode);
+    needs_free_ = true;
+    DEG_graph_build_for_all_objects(depsgraph_);
+    BKE_scene_graph_evaluated_ensure(depsgraph_, bmain);
+  }
+  else {
+    depsgraph_ = CTX_data_ensure_evaluated_depsgraph(C);
+    needs_free_ = false;
+  }
+}
+
+OBJDepsgraph::~OBJDepsgraph()
+{
+  if (needs_free_) {
+    DEG_graph_free(depsgraph_);
+  }
+}
+
+Depsgraph *OBJDepsgraph::get()
+{
+  return depsgraph_;
+}
+
+static Vector<std::unique_ptr<OBJMesh>> filter_supported_objects(
+    Depsgraph *depsgraph, const OBJExportParams &export_params)
+{
+  Vector<std::unique_ptr<OBJMesh>> r_exportable_meshes;
+  DEG_OBJECT_ITER_BEGIN (depsgraph,
+                         object,
+                         DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
+                             DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET | DEG_ITER_OBJECT_FLAG_VISIBLE |
+                             DEG_ITER_OBJECT_FLAG_DUPLI) {
+    if (export_params.export_selected_objects && !(object->base_flag & BASE_SELECTED)) {
+      continue;
+    }
+    if (object->type != OB_MESH) {
+      continue;
+    }
+    r_exportable_meshes.append(std::make_unique<OBJMesh>(object, export_params));
+  }
+  DEG_OBJECT_ITER_END;
+  return r_exportable_meshes;
+}
+
+bool exporter_main(bContext *C, const OBJExportParams &export_params)
+{
+  OBJDepsgraph obj_depsgraph(C, export_params.export_eval_mode);
+  Vector<std::unique_ptr<OBJMesh>> exportable_meshes = filter_supported_objects(
+      obj_depsgraph.get(), export_params);
+
+  OBJWriter writer(export_params.filepath, export_params);
+  if (!writer.is_open()) {
+    fprintf(stderr, "Error: cannot open file '%s' for writing\n", export_params.filepath);
+    return false;
+  }
+
+  writer.write_header(BKE_main_blendfile_path(CTX_data_main(C)));
+  IndexOffsets offsets;
+  for (const std::unique_ptr<OBJMesh> &obj_mesh : exportable_meshes) {
+    offsets = writer.write_object(*obj_mesh, offsets);
+  }
+  return true;
+}
+
+}  // namespace blender::io::obj
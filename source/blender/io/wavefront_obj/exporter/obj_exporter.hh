@@ -0,0 +1,57 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup obj
+ */
+
+#include "BLI_utility_mixins.hh"
+
+#include "IO_wavefront_obj.h"
+
+struct bContext;
+struct Depsgraph;
+
+namespace blender::io::obj {
+
+/**
+ * Depsgraph evaluated with the settings chosen for the export, owned by the exporter when the
+ * evaluation mode differs from the one of the viewport.
+ */
+class OBJDepsgraph : NonMovable, NonCopyable {
+ private:
+  Depsgraph *depsgraph_ = nullptr;
+  bool needs_free_ = false;
+
+ public:
+  OBJDepsgraph(const bContext *C, eEvaluationMode eval_mode);
+  ~OBJDepsgraph();
+
+  Depsgraph *get();
+};
+
+/**
+ * Write the visible mesh objects of the scene to a single OBJ file.
+ * \return False when the file can't be written.
+ */
+bool exporter_main(bContext *C, const OBJExportParams &export_params);
+
+}  // namespace blender::io::obj
@@ -0,0 +1,417 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "BLI_array.hh"
+#include "BLI_fileops.h"
+#include "BLI_task.hh"
+
+#include "IO_string_parse.hh"
+
+#include "obj_import_file_reader.hh"
+
+namespace blender::io::obj {
+
+namespace {
+
+/** Corner with indices relative to the end of the element lists, resolved when merging. */
+struct RelativeCorner {
+  int64_t corner_index;
+  /** Bit 0, 1 and 2 for the vertex, UV and normal index. */
+  uint8_t relative_mask;
+};
+
+/** Result of parsing one chunk, indices are local to the chunk until merged. */
+struct OBJChunkData : OBJFileData {
+  Vector<RelativeCorner> relative_corners;
+};
+
+}  // namespace
+
+/* -------------------------------------------------------------------- */
+/** \name Tokens
+ * \{ */
+
+static bool is_whitespace(const char c)
+{
+  return ELEM(c, ' ', '\t', '\r', '\v', '\f');
+}
+
+static bool is_digit(const char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static const char *skip_whitespace(const char *p, const char *end)
+{
+  while (p < end && is_whitespace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+/** Advance past the keyword when it is followed by whitespace or the end of the line. */
+static bool parse_keyword(const char *&p, const char *end, StringRef keyword)
+{
+  const int64_t len = keyword.size();
+  if (end - p < len || memcmp(p, keyword.data(), size_t(len)) != 0) {
+    return false;
+  }
+  if (p + len < end && !is_whitespace(p[len])) {
+    return false;
+  }
+  p += len;
+  return true;
+}
+
+static bool parse_int(const char *&p, const char *end, int &r_value)
+{
+  const char *q = p;
+  bool negative = false;
+  if (q < end && ELEM(*q, '-', '+')) {
+    negative = *q == '-';
+    q++;
+  }
+  if (q == end || !is_digit(*q)) {
+    return false;
+  }
+  int64_t value = 0;
+  for (; q < end && is_digit(*q); q++) {
+    value = std::min<int64_t>(value * 10 + (*q - '0'), INT_MAX);
+  }
+  r_value = int(negative ? -value : value);
+  p = q;
+  return true;
+}
+
+/** Parse the whitespace separated number at \a p, independent of the locale. */
+static bool parse_float(const char *&p, const char *end, float &r_value)
+{
+  p = skip_whitespace(p, end);
+  const char *start = p;
+  while (p < end && !is_whitespace(*p)) {
+    p++;
+  }
+  double value;
+  if (!io::parse_double(StringRef(start, p), value)) {
+    return false;
+  }
+  r_value = float(value);
+  return true;
+}
+
+/** Parse up to `size` floats, the ones missing in the file are left unchanged. */
+static void parse_floats(const char *p, const char *end, float *r_values, const int size)
+{
+  for (int i = 0; i < size; i++) {
+    if (!parse_float(p, end, r_values[i])) {
+      return;
+    }
+  }
+}
+
+static StringRef parse_name(const char *p, const char *end)
+{
+  p = skip_whitespace(p, end);
+  while (end > p && is_whitespace(end[-1])) {
+    end--;
+  }
+  return StringRef(p, end - p);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Statements
+ * \{ */
+
+/**
+ * Resolve a one based index, or a negative index relative to the elements read so far.
+ * \return False for the invalid index zero.
+ */
+static bool resolve_index(const int index,
+                          const int64_t elements_len,
+                          const uint8_t relative_bit,
+                          int &r_index,
+                          uint8_t &r_relative_mask)
+{
+  if (index > 0) {
+    r_index = index - 1;
+    return true;
+  }
+  if (index < 0) {
+    r_index = int(elements_len + index);
+    r_relative_mask |= relative_bit;
+    return true;
+  }
+  return false;
+}
+
+static void parse_face(const char *p, const char *end, OBJChunkData &r_data)
+{
+  FaceElem face = {r_data.face_corners.size(), 0};
+  const int64_t relative_corners_len = r_data.relative_corners.size();
+  bool is_valid = true;
+
+  while ((p = skip_whitespace(p, end)) < end) {
+    FaceCorner corner;
+    uint8_t relative_mask = 0;
+    int index;
+    if (!parse_int(p, end, index) ||
+        !resolve_index(index, r_data.vertices.size(), 1, corner.vert_index, relative_mask)) {
+      is_valid = false;
+      break;
+    }
+    if (p < end && *p == '/') {
+      p++;
+      if (parse_int(p, end, index) &&
+          !resolve_index(
+              index, r_data.uv_vertices.size(), 2, corner.uv_vert_index, relative_mask)) {
+        corner.uv_vert_index = -1;
+      }
+      if (p < end && *p == '/') {
+        p++;
+        if (parse_int(p, end, index) && !resolve_index(index,
+                                                       r_data.vertex_normals.size(),
+                                                       4,
+                                                       corner.vertex_normal_index,
+                                                       relative_mask)) {
+          corner.vertex_normal_index = -1;
+        }
+      }
+    }
+    /* Skip anything unexpected until the next corner. */
+    while (p < end && !is_whitespace(*p)) {
+      p++;
+    }
+
+    if (relative_mask) {
+      r_data.relative_corners.append({r_data.face_corners.size(), relative_mask});
+    }
+    r_data.face_corners.append(corner);
+    face.corner_count++;
+  }
+
+  if (!is_valid || face.corner_count < 3) {
+    r_data.face_corners.resize(face.start_index);
+    r_data.relative_corners.resize(relative_corners_len);
+    return;
+  }
+  r_data.faces.append(face);
+}
+
+static void parse_state_change(const eOBJStateChange type,
+                               const char *p,
+                               const char *end,
+                               OBJChunkData &r_data)
+{
+  OBJStateChange change;
+  change.type = type;
+  change.face_index = r_data.faces.size();
+  const StringRef name = parse_name(p, end);
+  if (type == eOBJStateChange::SmoothGroup) {
+    change.smooth = !name.is_empty() && name != "off" && name != "0";
+  }
+  else {
+    change.name = name;
+  }
+  r_data.state_changes.append(std::move(change));
+}
+
+static void parse_line(const char *p, const char *end, OBJChunkData &r_data)
+{
+  p = skip_whitespace(p, end);
+  if (p == end || *p == '#') {
+    return;
+  }
+  if (parse_keyword(p, end, "v")) {
+    float3 co(0.0f);
+    parse_floats(p, end, co, 3);
+    r_data.vertices.append(co);
+  }
+  else if (parse_keyword(p, end, "vt")) {
+    float2 uv(0.0f, 0.0f);
+    parse_floats(p, end, uv, 2);
+    r_data.uv_vertices.append(uv);
+  }
+  else if (parse_keyword(p, end, "vn")) {
+    float3 normal(0.0f);
+    parse_floats(p, end, normal, 3);
+    r_data.vertex_normals.append(normal);
+  }
+  else if (parse_keyword(p, end, "f")) {
+    parse_face(p, end, r_data);
+  }
+  else if (parse_keyword(p, end, "o")) {
+    parse_state_change(eOBJStateChange::Object, p, end, r_data);
+  }
+  else if (parse_keyword(p, end, "g")) {
+    parse_state_change(eOBJStateChange::Group, p, end, r_data);
+  }
+  else if (parse_keyword(p, end, "usemtl")) {
+    parse_state_change(eOBJStateChange::Material, p, end, r_data);
+  }
+  else if (parse_keyword(p, end, "s")) {
+    parse_state_change(eOBJStateChange::SmoothGroup, p, end, r_data);
+  }
+  /* Other statements (`mtllib`, lines, curves, ...) are not supported. */
+}
+
+static void parse_chunk(StringRef chunk, OBJChunkData &r_data)
+{
+  const char *p = chunk.begin();
+  const char *end = chunk.end();
+  while (p < end) {
+    const char *line_end = static_cast<const char *>(memchr(p, '\n', size_t(end - p)));
+    if (line_end == nullptr) {
+      line_end = end;
+    }
+    parse_line(p, line_end, r_data);
+    p = line_end + 1;
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Chunks
+ * \{ */
+
+static void append_chunk(OBJChunkData &chunk, OBJFileData &r_data)
+{
+  const int64_t vert_offset = r_data.vertices.size();
+  const int64_t uv_vert_offset = r_data.uv_vertices.size();
+  const int64_t normal_offset = r_data.vertex_normals.size();
+  const int64_t corner_offset = r_data.face_corners.size();
+  const int64_t face_offset = r_data.faces.size();
+
+  r_data.vertices.extend(chunk.vertices);
+  r_data.uv_vertices.extend(chunk.uv_vertices);
+  r_data.vertex_normals.extend(chunk.vertex_normals);
+  r_data.face_corners.extend(chunk.face_corners);
+  for (const RelativeCorner &relative_corner : chunk.relative_corners) {
+    FaceCorner &corner = r_data.face_corners[corner_offset + relative_corner.corner_index];
+    if (relative_corner.relative_mask & 1) {
+      corner.vert_index += int(vert_offset);
+    }
+    if (relative_corner.relative_mask & 2) {
+      corner.uv_vert_index += int(uv_vert_offset);
+    }
+    if (relative_corner.relative_mask & 4) {
+      corner.vertex_normal_index += int(normal_offset);
+    }
+  }
+
+  r_data.faces.reserve(face_offset + chunk.faces.size());
+  for (const FaceElem &face : chunk.faces) {
+    r_data.faces.append({face.start_index + corner_offset, face.corner_count});
+  }
+  for (OBJStateChange &change : chunk.state_changes) {
+    change.face_index += face_offset;
+    r_data.state_changes.append(std::move(change));
+  }
+}
+
+void parse_obj_buffer(StringRef buffer, OBJFileData &r_data, const int64_t chunk_size)
+{
+  /* Split at line ends, so every chunk can be parsed on its own. */
+  Vector<StringRef> chunks;
+  int64_t start = 0;
+  while (start < buffer.size()) {
+    int64_t end = std::min(start + chunk_size, buffer.size());
+    if (end < buffer.size()) {
+      const char *line_end = static_cast<const char *>(
+          memchr(buffer.data() + end, '\n', size_t(buffer.size() - end)));
+      end = line_end ? (line_end - buffer.data()) + 1 : buffer.size();
+    }
+    chunks.append(buffer.substr(start, end - start));
+    start = end;
+  }
+
+  Array<OBJChunkData> chunks_data(chunks.size());
+  parallel_for(chunks.index_range(), 1, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      parse_chunk(chunks[i], chunks_data[i]);
+    }
+  });
+
+  for (OBJChunkData &chunk_data : chunks_data) {
+    append_chunk(chunk_data, r_data);
+  }
+}
+
+bool parse_obj_file(const char *filepath, OBJFileData &r_data)
+{
+  FILE *file = BLI_fopen(filepath, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  /* Large blocks keep all threads busy, the part of the last line that doesn't fit in a block
+   * is moved to the start of the next one. Small files are read in one block. */
+  const int64_t max_block_size = 64 * 1024 * 1024;
+  const size_t file_size = BLI_file_size(filepath);
+  const int64_t block_size = file_size == size_t(-1) ?
+                                 max_block_size :
+                                 std::min(int64_t(file_size) + 1, max_block_size);
+  Array<char> buffer(block_size, NoInitialization());
+  int64_t buffer_used = 0;
+  while (true) {
+    const int64_t read_len = int64_t(
+        fread(buffer.data() + buffer_used, 1, size_t(buffer.size() - buffer_used), file));
+    const int64_t buffer_end = buffer_used + read_len;
+    const bool at_eof = buffer_end < buffer.size();
+
+    int64_t lines_end = buffer_end;
+    if (!at_eof) {
+      while (lines_end > 0 && buffer[lines_end - 1] != '\n') {
+        lines_end--;
+      }
+      if (lines_end == 0) {
+        /* A single line larger than the buffer. */
+        Array<char> larger_buffer(buffer.size() * 2, NoInitialization());
+        memcpy(larger_buffer.data(), buffer.data(), size_t(buffer_end));
+        buffer = std::move(larger_buffer);
+        buffer_used = buffer_end;
+        continue;
+      }
+    }
+
+    parse_obj_buffer(StringRef(buffer.data(), lines_end), r_data);
+    if (at_eof) {
+      break;
+    }
+    memmove(buffer.data(), buffer.data() + lines_end, size_t(buffer_end - lines_end));
+    buffer_used = buffer_end - lines_end;
+  }
+
+  fclose(file);
+  return true;
+}
+
+/** \} */
+
+}  // namespace blender::io::obj
@@ -0,0 +1,96 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <string>
+
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+
+namespace blender::io::obj {
+
+/** Zero based indices of one face corner, -1 when not given in the file. */
+struct FaceCorner {
+  int vert_index = -1;
+  int uv_vert_index = -1;
+  int vertex_normal_index = -1;
+};
+
+struct FaceElem {
+  /** First corner in #OBJFileData.face_corners. */
+  int64_t start_index;
+  int corner_count;
+};
+
+/** Statements that affect the faces following them. */
+enum class eOBJStateChange {
+  /** `o` statement. */
+  Object,
+  /** `g` statement. */
+  Group,
+  /** `usemtl` statement. */
+  Material,
+  /** `s` statement. */
+  SmoothGroup,
+};
+
+struct OBJStateChange {
+  eOBJStateChange type;
+  /** Index of the first face the new state applies to. */
+  int64_t face_index;
+  /** Object, group or material name. */
+  std::string name;
+  bool smooth = false;
+};
+
+/**
+ * Everything read from an OBJ file, with relative indices already resolved. Indices can still
+ * be out of range for broken files, that is checked when creating meshes.
+ */
+struct OBJFileData {
+  Vector<float3> vertices;
+  Vector<float2> uv_vertices;
+  Vector<float3> vertex_normals;
+  Vector<FaceCorner> face_corners;
+  Vector<FaceElem> faces;
+  /** In file order, so also sorted by face index. */
+  Vector<OBJStateChange> state_changes;
+};
+
+/**
+ * Parse the whole file, reading it in large blocks of complete lines that are split into
+ * chunks parsed from multiple threads.
+ * \return False when the file can't be opened.
+ */
+bool parse_obj_file(const char *filepath, OBJFileData &r_data);
+
+/**
+ * Parse complete lines of OBJ text and append them to the data read so far.
+ * \param chunk_size: Approximate size in bytes of the parts parsed by each thread.
+ */
+void parse_obj_buffer(StringRef buffer, OBJFileData &r_data, int64_t chunk_size = 256 * 1024);
+
+}  // namespace blender::io::obj
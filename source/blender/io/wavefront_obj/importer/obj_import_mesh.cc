@@ -0,0 +1,249 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <climits>
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+
+#include "BLI_math.h"
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "obj_import_mesh.hh"
+
+namespace blender::io::obj {
+
+Vector<Geometry> split_geometries(const OBJFileData &data,
+                                  const bool use_split_groups,
+                                  StringRef default_name)
+{
+  Vector<Geometry> geometries;
+  std::string name = default_name;
+  int64_t start = 0;
+  auto add_geometry = [&](const int64_t end) {
+    if (end > start) {
+      geometries.append({name, IndexRange(start, end - start)});
+    }
+    start = end;
+  };
+
+  for (const OBJStateChange &change : data.state_changes) {
+    if (change.type == eOBJStateChange::Object ||
+        (use_split_groups && change.type == eOBJStateChange::Group)) {
+      add_geometry(change.face_index);
+      name = change.name.empty() ? std::string(default_name) : change.name;
+    }
+  }
+  add_geometry(data.faces.size());
+  return geometries;
+}
+
+FaceStates resolve_face_states(const OBJFileData &data)
+{
+  FaceStates states;
+  states.material_index = Array<int>(data.faces.size(), -1);
+  states.smooth = Array<bool>(data.faces.size(), false);
+
+  int material_index = -1;
+  bool smooth = false;
+  int64_t start = 0;
+  auto fill_states = [&](const int64_t end) {
+    states.material_index.as_mutable_span().slice(start, end - start).fill(material_index);
+    states.smooth.as_mutable_span().slice(start, end - start).fill(smooth);
+    start = end;
+  };
+
+  for (const OBJStateChange &change : data.state_changes) {
+    if (change.type == eOBJStateChange::Material) {
+      fill_states(change.face_index);
+      states.material_names.add(change.name);
+      material_index = int(states.material_names.index_of(change.name));
+    }
+    else if (change.type == eOBJStateChange::SmoothGroup) {
+      fill_states(change.face_index);
+      smooth = change.smooth;
+    }
+  }
+  fill_states(data.faces.size());
+  return states;
+}
+
+static bool face_is_valid(const OBJFileData &data, const FaceElem &face)
+{
+  for (const FaceCorner &corner : data.face_corners.as_span().slice(face.start_index,
+                                                                    face.corner_count)) {
+    if (corner.vert_index < 0 || corner.vert_index >= data.vertices.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void fill_mesh_from_geometry(Mesh *mesh,
+                             const OBJFileData &data,
+                             const FaceStates &states,
+                             const Geometry &geometry,
+                             const float axes_transform[3][3],
+                             const float scaling_factor,
+                             const bool validate,
+                             Vector<int> &r_material_indices)
+{
+  /* Faces, loop offsets, material slots and the range of vertices used. */
+  Vector<int64_t> faces;
+  Vector<int> loop_starts;
+  Array<int> material_slots(states.material_names.size(), -1);
+  int tot_loops = 0;
+  int vert_min = INT_MAX;
+  int vert_max = -1;
+  for (const int64_t face_index : geometry.face_range) {
+    const FaceElem &face = data.faces[face_index];
+    if (!face_is_valid(data, face)) {
+      continue;
+    }
+    for (const FaceCorner &corner : data.face_corners.as_span().slice(face.start_index,
+                                                                      face.corner_count)) {
+      vert_min = std::min(vert_min, corner.vert_index);
+      vert_max = std::max(vert_max, corner.vert_index);
+    }
+    const int material_index = states.material_index[face_index];
+    if (material_index != -1 && material_slots[material_index] == -1) {
+      material_slots[material_index] = int(r_material_indices.size());
+      r_material_indices.append(material_index);
+    }
+    faces.append(face_index);
+    loop_starts.append(tot_loops);
+    tot_loops += face.corner_count;
+  }
+  if (faces.is_empty()) {
+    return;
+  }
+
+  /* Vertices are global in the file, only keep the ones used by this geometry. */
+  Array<int> vert_map(vert_max - vert_min + 1, -1);
+  Vector<int> used_verts;
+  for (const int64_t face_index : faces) {
+    const FaceElem &face = data.faces[face_index];
+    for (const FaceCorner &corner : data.face_corners.as_span().slice(face.start_index,
+                                                                      face.corner_count)) {
+      int &local_index = vert_map[corner.vert_index - vert_min];
+      if (local_index == -1) {
+        local_index = int(used_verts.size());
+        used_verts.append(corner.vert_index);
+      }
+    }
+  }
+
+  mesh->totvert = int(used_verts.size());
+  mesh->totpoly = int(faces.size());
+  mesh->totloop = tot_loops;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+
+  parallel_for(used_verts.index_range(), 4096, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      MVert &mvert = mesh->mvert[i];
+      mul_v3_m3v3(mvert.co, axes_transform, data.vertices[used_verts[i]]);
+      mul_v3_fl(mvert.co, scaling_factor);
+    }
+  });
+
+  parallel_for(faces.index_range(), 1024, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      const int64_t face_index = faces[i];
+      const FaceElem &face = data.faces[face_index];
+      MPoly &mpoly = mesh->mpoly[i];
+      mpoly.loopstart = loop_starts[i];
+      mpoly.totloop = face.corner_count;
+      const int material_index = states.material_index[face_index];
+      mpoly.mat_nr = short(material_index == -1 ? 0 : material_slots[material_index]);
+      mpoly.flag = states.smooth[face_index] ? ME_SMOOTH : 0;
+      for (const int j : IndexRange(face.corner_count)) {
+        const FaceCorner &corner = data.face_corners[face.start_index + j];
+        mesh->mloop[mpoly.loopstart + j].v = uint(vert_map[corner.vert_index - vert_min]);
+      }
+    }
+  });
+
+  /* UV's and normals, when the faces have them. */
+  const int64_t tot_uv_verts = data.uv_vertices.size();
+  const int64_t tot_normals = data.vertex_normals.size();
+  bool has_uvs = false;
+  bool has_normals = true;
+  for (const int64_t face_index : faces) {
+    const FaceElem &face = data.faces[face_index];
+    for (const FaceCorner &corner : data.face_corners.as_span().slice(face.start_index,
+                                                                      face.corner_count)) {
+      has_uvs |= corner.uv_vert_index >= 0 && corner.uv_vert_index < tot_uv_verts;
+      has_normals &= corner.vertex_normal_index >= 0 &&
+                     corner.vertex_normal_index < tot_normals;
+    }
+  }
+
+  auto for_each_loop_corner = [&](auto fn) {
+    parallel_for(faces.index_range(), 1024, [&](IndexRange range) {
+      for (const int64_t i : range) {
+        const FaceElem &face = data.faces[faces[i]];
+        for (const int j : IndexRange(face.corner_count)) {
+          fn(loop_starts[i] + j, data.face_corners[face.start_index + j]);
+        }
+      }
+    });
+  };
+
+  if (has_uvs) {
+    MLoopUV *mloopuv = static_cast<MLoopUV *>(CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop, "UVMap"));
+    for_each_loop_corner([&](const int loop_index, const FaceCorner &corner) {
+      if (corner.uv_vert_index >= 0 && corner.uv_vert_index < tot_uv_verts) {
+        copy_v2_v2(mloopuv[loop_index].uv, data.uv_vertices[corner.uv_vert_index]);
+      }
+    });
+    BKE_mesh_update_customdata_pointers(mesh, false);
+  }
+
+  BKE_mesh_calc_edges(mesh, false, false);
+  BKE_mesh_calc_normals(mesh);
+
+  if (has_normals) {
+    Array<float3> loop_normals(mesh->totloop);
+    for_each_loop_corner([&](const int loop_index, const FaceCorner &corner) {
+      mul_v3_m3v3(loop_normals[loop_index],
+                  axes_transform,
+                  data.vertex_normals[corner.vertex_normal_index]);
+      normalize_v3(loop_normals[loop_index]);
+    });
+    mesh->flag |= ME_AUTOSMOOTH;
+    BKE_mesh_set_custom_normals(mesh, reinterpret_cast<float(*)[3]>(loop_normals.data()));
+  }
+
+  if (validate) {
+    BKE_mesh_validate(mesh, false, false);
+  }
+}
+
+}  // namespace blender::io::obj
@@ -0,0 +1,80 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <string>
+
+#include "BLI_array.hh"
+#include "BLI_index_range.hh"
+#include "BLI_vector.hh"
+#include "BLI_vector_set.hh"
+
+#include "obj_import_file_reader.hh"
+
+struct Mesh;
+
+namespace blender::io::obj {
+
+/** Faces of the file that become one object. */
+struct Geometry {
+  std::string name;
+  IndexRange face_range;
+};
+
+/** Material and smooth shading of every face, from the `usemtl` and `s` statements. */
+struct FaceStates {
+  /** Index in #material_names, -1 for faces without material. */
+  Array<int> material_index;
+  Array<bool> smooth;
+  VectorSet<std::string> material_names;
+};
+
+/**
+ * Split the faces into objects at `o` statements, and at `g` statements when enabled.
+ * Objects without faces are skipped.
+ */
+Vector<Geometry> split_geometries(const OBJFileData &data,
+                                  bool use_split_groups,
+                                  StringRef default_name);
+
+FaceStates resolve_face_states(const OBJFileData &data);
+
+/**
+ * Fill the arrays of an empty mesh with the faces of the geometry and the vertices they use,
+ * faces using vertices that don't exist in the file are skipped.
+ * Only touches the mesh, so different meshes can be filled from multiple threads.
+ *
+ * \param axes_transform: Conversion from the axes of the file to Blender's axes.
+ * \param r_material_indices: The index in #FaceStates.material_names for every material slot.
+ */
+void fill_mesh_from_geometry(Mesh *mesh,
+                             const OBJFileData &data,
+                             const FaceStates &states,
+                             const Geometry &geometry,
+                             const float axes_transform[3][3],
+                             float scaling_factor,
+                             bool validate,
+                             Vector<int> &r_material_indices);
+
+}  // namespace blender::io::obj
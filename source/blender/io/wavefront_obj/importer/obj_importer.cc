@@ -0,0 +1,138 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <cstdio>
+
+#include "BKE_collection.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_material.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_math.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.hh"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "DNA_collection_types.h"
+#include "DNA_layer_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "obj_import_file_reader.hh"
+#include "obj_import_mesh.hh"
+#include "obj_importer.hh"
+
+namespace blender::io::obj {
+
+static Material *find_or_add_material(Main *bmain, const std::string &name)
+{
+  Material *material = reinterpret_cast<Material *>(
+      BKE_libblock_find_name(bmain, ID_MA, name.c_str()));
+  if (material == nullptr) {
+    material = BKE_material_add(bmain, name.c_str());
+  }
+  return material;
+}
+
+bool importer_main(Main *bmain,
+                   Scene *scene,
+                   ViewLayer *view_layer,
+                   const OBJImportParams &import_params)
+{
+  OBJFileData data;
+  if (!parse_obj_file(import_params.filepath, data)) {
+    fprintf(stderr, "Cannot read from OBJ file: '%s'\n", import_params.filepath);
+    return false;
+  }
+
+  char default_name[FILE_MAX];
+  BLI_strncpy(default_name, BLI_path_basename(import_params.filepath), sizeof(default_name));
+  BLI_path_extension_replace(default_name, sizeof(default_name), "");
+
+  const Vector<Geometry> geometries = split_geometries(
+      data, import_params.use_split_groups, default_name);
+  const FaceStates states = resolve_face_states(data);
+
+  float axes_transform[3][3];
+  unit_m3(axes_transform);
+  mat3_from_axis_conversion(
+      import_params.forward_axis, import_params.up_axis, OB_POSY, OB_POSZ, axes_transform);
+
+  /* Adding IDs changes the main database, filling the meshes only touches the meshes. */
+  Array<Object *> objects(geometries.size());
+  for (const int64_t i : geometries.index_range()) {
+    const char *name = geometries[i].name.c_str();
+    Object *ob = BKE_object_add_only_object(bmain, OB_MESH, name);
+    ob->data = BKE_mesh_add(bmain, name);
+    objects[i] = ob;
+  }
+
+  Array<Vector<int>> material_indices(geometries.size());
+  parallel_for(geometries.index_range(), 1, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      fill_mesh_from_geometry(static_cast<Mesh *>(objects[i]->data),
+                              data,
+                              states,
+                              geometries[i],
+                              axes_transform,
+                              import_params.scaling_factor,
+                              import_params.validate_meshes,
+                              material_indices[i]);
+    }
+  });
+
+  Array<Material *> materials(states.material_names.size(), nullptr);
+  for (const int64_t i : geometries.index_range()) {
+    for (const int64_t slot : material_indices[i].index_range()) {
+      const int material_index = material_indices[i][slot];
+      if (materials[material_index] == nullptr) {
+        materials[material_index] = find_or_add_material(
+            bmain, states.material_names[material_index]);
+      }
+      BKE_object_material_assign(
+          bmain, objects[i], materials[material_index], int(slot) + 1, BKE_MAT_ASSIGN_USERPREF);
+    }
+  }
+
+  BKE_view_layer_base_deselect_all(view_layer);
+  LayerCollection *lc = BKE_layer_collection_get_active(view_layer);
+  for (Object *ob : objects) {
+    BKE_collection_object_add(bmain, lc->collection, ob);
+    Base *base = BKE_view_layer_base_find(view_layer, ob);
+    BKE_view_layer_base_select_and_set_active(view_layer, base);
+    DEG_id_tag_update_ex(
+        bmain, &ob->id, ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY | ID_RECALC_BASE_FLAGS);
+  }
+  DEG_id_tag_update(&lc->collection->id, ID_RECALC_COPY_ON_WRITE);
+  DEG_id_tag_update(&scene->id, ID_RECALC_BASE_FLAGS);
+  DEG_relations_tag_update(bmain);
+  return true;
+}
+
+}  // namespace blender::io::obj
@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include "obj_import_file_reader.hh"
+#include "obj_import_mesh.hh"
+
+namespace blender::io::obj::tests {
+
+static const char *test_file =
+    "# Comment\n"
+    "mtllib cube.mtl\n"
+    "o First\n"
+    "v 1.0 2.0 3.0\n"
+    "v -1.5 0.25 1e-2\n"
+    "v 0 0 0\n"
+    "v 1 1 1\n"
+    "vt 0.5 0.5\n"
+    "vn 0 0 1\n"
+    "usemtl Red\n"
+    "s 1\n"
+    "f 1/1/1 2/1/1 3/1/1\n"
+    "f -4//1 -3//1 -2//1 -1//1\n"
+    "o Second\n"
+    "v 2 2 2\n"
+    "v 3 3 3\n"
+    "v 4 4 4\n"
+    "usemtl Blue\n"
+    "s off\n"
+    "g group\n"
+    "f -3 -2 -1\n"
+    "f 5 6\n"
+    "f 5 6 7 1\n";
+
+static void check_parsed_file(const OBJFileData &data)
+{
+  ASSERT_EQ(data.vertices.size(), 7);
+  EXPECT_EQ(data.vertices[1], float3(-1.5f, 0.25f, 0.01f));
+  ASSERT_EQ(data.uv_vertices.size(), 1);
+  EXPECT_EQ(data.uv_vertices[0], float2(0.5f, 0.5f));
+  ASSERT_EQ(data.vertex_normals.size(), 1);
+
+  /* The face with two corners is skipped. */
+  ASSERT_EQ(data.faces.size(), 4);
+  EXPECT_EQ(data.faces[0].corner_count, 3);
+  EXPECT_EQ(data.faces[1].corner_count, 4);
+  EXPECT_EQ(data.faces[3].corner_count, 4);
+
+  const FaceCorner &first = data.face_corners[data.faces[0].start_index];
+  EXPECT_EQ(first.vert_index, 0);
+  EXPECT_EQ(first.uv_vert_index, 0);
+  EXPECT_EQ(first.vertex_normal_index, 0);
+
+  const FaceCorner &relative = data.face_corners[data.faces[1].start_index];
+  EXPECT_EQ(relative.vert_index, 0);
+  EXPECT_EQ(relative.uv_vert_index, -1);
+  EXPECT_EQ(relative.vertex_normal_index, 0);
+
+  EXPECT_EQ(data.face_corners[data.faces[2].start_index].vert_index, 4);
+  EXPECT_EQ(data.face_corners[data.faces[3].start_index + 3].vert_index, 0);
+
+  const FaceStates states = resolve_face_states(data);
+  ASSERT_EQ(states.material_names.size(), 2);
+  EXPECT_EQ(states.material_names[states.material_index[0]], "Red");
+  EXPECT_EQ(states.material_names[states.material_index[2]], "Blue");
+  EXPECT_TRUE(states.smooth[1]);
+  EXPECT_FALSE(states.smooth[2]);
+
+  Vector<Geometry> geometries = split_geometries(data, false, "file");
+  ASSERT_EQ(geometries.size(), 2);
+  EXPECT_EQ(geometries[0].name, "First");
+  EXPECT_EQ(geometries[0].face_range, IndexRange(0, 2));
+  EXPECT_EQ(geometries[1].name, "Second");
+  EXPECT_EQ(geometries[1].face_range, IndexRange(2, 2));
+
+  geometries = split_geometries(data, true, "file");
+  ASSERT_EQ(geometries.size(), 2);
+  EXPECT_EQ(geometries[1].name, "group");
+}
+
+TEST(obj_import_file_reader, parse_single_chunk)
+{
+  OBJFileData data;
+  parse_obj_buffer(test_file, data);
+  check_parsed_file(data);
+}
+
+TEST(obj_import_file_reader, parse_many_chunks)
+{
+  /* Relative indices and states have to be resolved across chunks. */
+  for (const int64_t chunk_size : {1, 7, 32, 64}) {
+    OBJFileData data;
+    parse_obj_buffer(test_file, data, chunk_size);
+    check_parsed_file(data);
+  }
+}
+
+}  // namespace blender::io::obj::tests
@@ -103,6 +103,9 @@ typedef struct Mesh_Runtime {
   /** Non-manifold boundary data for Shrinkwrap Target Project. */
   struct ShrinkwrapBoundaryData *shrinkwrap_data;
 
+  /** Lazily built topology maps, `MeshAdjacencyCache` defined in 'mesh_runtime.c'. */
+  struct MeshAdjacencyCache *adjacency_cache;
+
   /** Set by modifier stack if only deformed from original. */
   char deformed_only;
   /**
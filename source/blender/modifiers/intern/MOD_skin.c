@@ -75,6 +75,7 @@
 #include "BKE_lib_id.h"
 #include "BKE_mesh.h"
 #include "BKE_mesh_mapping.h"
+#include "BKE_mesh_runtime.h"
 #include "BKE_modifier.h"
 #include "BKE_screen.h"
 
@@ -1861,8 +1862,7 @@ static Mesh *base_skin(Mesh *origmesh, SkinModifierData *smd, eSkinErrorFlag *r_
   BMesh *bm;
   EMat *emat;
   SkinNode *skin_nodes;
-  MeshElemMap *emap;
-  int *emapmem;
+  const MeshElemMap *emap;
   MVert *mvert;
   MEdge *medge;
   MDeformVert *dvert;
@@ -1877,7 +1877,8 @@ static Mesh *base_skin(Mesh *origmesh, SkinModifierData *smd, eSkinErrorFlag *r_
   totvert = origmesh->totvert;
   totedge = origmesh->totedge;
 
-  BKE_mesh_vert_edge_map_create(&emap, &emapmem, medge, totvert, totedge);
+  /* Owned by the mesh, freed along with it. */
+  emap = BKE_mesh_runtime_vert_edge_map_ensure(origmesh);
 
   emat = build_edge_mats(nodes, mvert, totvert, medge, emap, totedge, &has_valid_root);
   skin_nodes = build_frames(mvert, totvert, nodes, emap, emat);
@@ -1887,8 +1888,6 @@ static Mesh *base_skin(Mesh *origmesh, SkinModifierData *smd, eSkinErrorFlag *r_
   bm = build_skin(skin_nodes, totvert, emap, medge, totedge, dvert, smd, r_error);
 
   MEM_freeN(skin_nodes);
-  MEM_freeN(emap);
-  MEM_freeN(emapmem);
 
   if (!has_valid_root) {
     *r_error |= SKIN_ERROR_NO_VALID_ROOT;
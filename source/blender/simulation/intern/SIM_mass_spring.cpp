@@ -30,8 +30,11 @@
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
+#include "BLI_index_range.hh"
 #include "BLI_linklist.h"
+#include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_cloth.h"
@@ -719,20 +722,38 @@ static void cloth_calc_force(
                                                  "effector forces");
     float(*forcevec)[3] = is_not_hair ? winvec + mvert_num : winvec;
 
-    for (i = 0; i < cloth->mvert_num; i++) {
-      float x[3], v[3];
-      EffectedPoint epoint;
-
-      SIM_mass_spring_get_motion_state(data, i, x, v);
-      pd_point_from_loc(scene, x, v, i, &epoint);
-      BKE_effectors_apply(effectors,
-                          nullptr,
-                          clmd->sim_parms->effector_weights,
-                          &epoint,
-                          forcevec[i],
-                          winvec[i],
-                          nullptr);
+    auto calc_effector_forces = [&](const blender::IndexRange range) {
+      for (const int64_t vert_index : range) {
+        float x[3], v[3];
+        EffectedPoint epoint;
+
+        SIM_mass_spring_get_motion_state(data, vert_index, x, v);
+        pd_point_from_loc(scene, x, v, vert_index, &epoint);
+        BKE_effectors_apply(effectors,
+                            nullptr,
+                            clmd->sim_parms->effector_weights,
+                            &epoint,
+                            forcevec[vert_index],
+                            winvec[vert_index],
+                            nullptr);
+      }
+    };
+
+    /* Effectors are evaluated independently for every vertex, except for noise which draws from
+     * the random number generator of the field. That has to happen in order for the results to
+     * be the same for every bake. */
+    bool has_noise = false;
+    LISTBASE_FOREACH (EffectorCache *, eff, effectors) {
+      has_noise = has_noise || eff->pd->f_noise > 0.0f;
+    }
+    if (has_noise) {
+      calc_effector_forces(blender::IndexRange(mvert_num));
+    }
+    else {
+      blender::parallel_for(blender::IndexRange(mvert_num), 256, calc_effector_forces);
+    }
 
+    for (i = 0; i < cloth->mvert_num; i++) {
       has_wind = has_wind || !is_zero_v3(winvec[i]);
       has_force = has_force || !is_zero_v3(forcevec[i]);
     }
@@ -34,6 +34,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -46,9 +47,12 @@
 #    pragma GCC diagnostic ignored "-Wtype-limits"
 #  endif
 
-#  ifdef _OPENMP
-#    define CLOTH_OPENMP_LIMIT 512
-#  endif
+/* Vertices are processed in chunks of this size by the parallel vector and matrix operations.
+ * The chunks are fixed so that sums are always accumulated in the same order, independent of
+ * the number of threads. Otherwise simulations would give different results for each bake. */
+#  define CLOTH_PARALLEL_CHUNK_SIZE 1024
+/* Smaller meshes are processed on the calling thread. */
+#  define CLOTH_PARALLEL_LIMIT 4096
 
 //#define DEBUG_TIME
 
@@ -192,20 +196,77 @@ DO_INLINE void submul_lfvectorS(float (*to)[3],
     VECSUBMUL(to[i], fLongVector[i], scalar);
   }
 }
+/* Run `func` over chunks of #CLOTH_PARALLEL_CHUNK_SIZE vertices, returns the number of chunks. */
+static int lfvector_parallel_chunks(unsigned int verts,
+                                    void *userdata,
+                                    TaskParallelRangeFunc func)
+{
+  const int chunks_num = max_ii(
+      (int)((verts + CLOTH_PARALLEL_CHUNK_SIZE - 1) / CLOTH_PARALLEL_CHUNK_SIZE), 1);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = verts > CLOTH_PARALLEL_LIMIT;
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, chunks_num, userdata, func, &settings);
+
+  return chunks_num;
+}
+
+BLI_INLINE void lfvector_chunk_range(int chunk,
+                                     unsigned int verts,
+                                     unsigned int *r_start,
+                                     unsigned int *r_end)
+{
+  *r_start = (unsigned int)chunk * CLOTH_PARALLEL_CHUNK_SIZE;
+  *r_end = min_ii(*r_start + CLOTH_PARALLEL_CHUNK_SIZE, verts);
+}
+
+typedef struct DotLFVectorData {
+  float (*a)[3];
+  float (*b)[3];
+  unsigned int verts;
+  float *chunk_sums;
+} DotLFVectorData;
+
+static void dot_lfvector_chunk(void *__restrict userdata,
+                               const int chunk,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DotLFVectorData *data = userdata;
+  unsigned int start, end;
+  float temp = 0.0f;
+
+  lfvector_chunk_range(chunk, data->verts, &start, &end);
+  for (unsigned int i = start; i < end; i++) {
+    temp += dot_v3v3(data->a[i], data->b[i]);
+  }
+  data->chunk_sums[chunk] = temp;
+}
+
 /* dot product for big vector */
 DO_INLINE float dot_lfvector(float (*fLongVectorA)[3],
                              float (*fLongVectorB)[3],
                              unsigned int verts)
 {
-  long i = 0;
-  float temp = 0.0;
-  /* XXX brecht, disabled this for now (first schedule line was already disabled),
-   * due to non-commutative nature of floating point ops this makes the sim give
-   * different results each time you run it!
-   * schedule(guided, 2) */
-  //#pragma omp parallel for reduction(+: temp) if (verts > CLOTH_OPENMP_LIMIT)
-  for (i = 0; i < (long)verts; i++) {
-    temp += dot_v3v3(fLongVectorA[i], fLongVectorB[i]);
+  /* Due to the non-commutative nature of floating point ops, the partial sums of the chunks are
+   * added in a fixed order, otherwise the sim gives different results each time you run it. */
+  float chunk_sums_stack[64];
+  const unsigned int chunks_max = verts / CLOTH_PARALLEL_CHUNK_SIZE + 1;
+  float *chunk_sums = (chunks_max <= ARRAY_SIZE(chunk_sums_stack)) ?
+                          chunk_sums_stack :
+                          MEM_mallocN(sizeof(float) * chunks_max, __func__);
+
+  DotLFVectorData data = {fLongVectorA, fLongVectorB, verts, chunk_sums};
+  const int chunks_num = lfvector_parallel_chunks(verts, &data, dot_lfvector_chunk);
+
+  float temp = 0.0f;
+  for (int chunk = 0; chunk < chunks_num; chunk++) {
+    temp += chunk_sums[chunk];
+  }
+
+  if (chunk_sums != chunk_sums_stack) {
+    MEM_freeN(chunk_sums);
   }
   return temp;
 }
@@ -221,6 +282,27 @@ DO_INLINE void add_lfvector_lfvector(float (*to)[3],
     add_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]);
   }
 }
+typedef struct AddLFVectorData {
+  float (*to)[3];
+  float (*a)[3];
+  float (*b)[3];
+  float bS;
+  unsigned int verts;
+} AddLFVectorData;
+
+static void add_lfvector_lfvectorS_chunk(void *__restrict userdata,
+                                         const int chunk,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  AddLFVectorData *data = userdata;
+  unsigned int start, end;
+
+  lfvector_chunk_range(chunk, data->verts, &start, &end);
+  for (unsigned int i = start; i < end; i++) {
+    VECADDS(data->to[i], data->a[i], data->b[i], data->bS);
+  }
+}
+
 /* A = B + C * float --> for big vector */
 DO_INLINE void add_lfvector_lfvectorS(float (*to)[3],
                                       float (*fLongVectorA)[3],
@@ -228,11 +310,8 @@ DO_INLINE void add_lfvector_lfvectorS(float (*to)[3],
                                       float bS,
                                       unsigned int verts)
 {
-  unsigned int i = 0;
-
-  for (i = 0; i < verts; i++) {
-    VECADDS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
-  }
+  AddLFVectorData data = {to, fLongVectorA, fLongVectorB, bS, verts};
+  lfvector_parallel_chunks(verts, &data, add_lfvector_lfvectorS_chunk);
 }
 /* A = B * float + C * float --> for big vector */
 DO_INLINE void add_lfvectorS_lfvectorS(float (*to)[3],
@@ -613,35 +692,92 @@ DO_INLINE void initdiag_bfmatrix(fmatrix3x3 *matrix, float m3[3][3])
   }
 }
 
-/* SPARSE SYMMETRIC multiply big matrix with long vector*/
-/* STATUS: verified */
-DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector *fLongVector)
+/**
+ * The off-diagonal blocks of the big matrices, grouped by the vertices they belong to, either as
+ * row or as column. All matrices of the solver share the same layout of blocks, so this is built
+ * once per solve. It allows computing each element of a product with a vector independently.
+ */
+typedef struct BlockAdjacency {
+  int *vert_offsets; /* vcount + 1 offsets into blocks */
+  int *blocks;       /* two entries per off-diagonal block */
+} BlockAdjacency;
+
+static void block_adjacency_build(BlockAdjacency *adjacency, fmatrix3x3 *matrix, int num_blocks)
+{
+  const unsigned int vcount = matrix[0].vcount;
+  int *vert_offsets = adjacency->vert_offsets;
+
+  memset(vert_offsets, 0, sizeof(int) * (vcount + 1));
+  for (unsigned int i = vcount; i < vcount + num_blocks; i++) {
+    vert_offsets[matrix[i].r + 1]++;
+    if (matrix[i].c != matrix[i].r) {
+      vert_offsets[matrix[i].c + 1]++;
+    }
+  }
+  for (unsigned int i = 0; i < vcount; i++) {
+    vert_offsets[i + 1] += vert_offsets[i];
+  }
+
+  /* Blocks are added in increasing order for every vertex, which keeps the order of the sums in
+   * the matrix product the same for every solve. */
+  for (unsigned int i = vcount; i < vcount + num_blocks; i++) {
+    adjacency->blocks[vert_offsets[matrix[i].r]++] = i;
+    if (matrix[i].c != matrix[i].r) {
+      adjacency->blocks[vert_offsets[matrix[i].c]++] = i;
+    }
+  }
+  for (unsigned int i = vcount; i > 0; i--) {
+    vert_offsets[i] = vert_offsets[i - 1];
+  }
+  vert_offsets[0] = 0;
+}
+
+typedef struct MulBFMatrixData {
+  float (*to)[3];
+  fmatrix3x3 *from;
+  lfVector *fLongVector;
+  const BlockAdjacency *adjacency;
+} MulBFMatrixData;
+
+static void mul_bfmatrix_lfvector_chunk(void *__restrict userdata,
+                                        const int chunk,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  unsigned int vcount = from[0].vcount;
-  lfVector *temp = create_lfvector(vcount);
+  MulBFMatrixData *data = userdata;
+  const fmatrix3x3 *from = data->from;
+  const lfVector *fLongVector = data->fLongVector;
+  const BlockAdjacency *adjacency = data->adjacency;
+  unsigned int start, end;
 
-  zero_lfvector(to, vcount);
+  lfvector_chunk_range(chunk, from[0].vcount, &start, &end);
+  for (unsigned int i = start; i < end; i++) {
+    float *to = data->to[i];
+    zero_v3(to);
+    muladd_fmatrix_fvector(to, from[i].m, fLongVector[i]);
 
-#  pragma omp parallel sections if (vcount > CLOTH_OPENMP_LIMIT)
-  {
-#  pragma omp section
-    {
-      for (unsigned int i = from[0].vcount; i < from[0].vcount + from[0].scount; i++) {
+    for (int j = adjacency->vert_offsets[i]; j < adjacency->vert_offsets[i + 1]; j++) {
+      const fmatrix3x3 *block = &from[adjacency->blocks[j]];
+      if (block->r == (int)i) {
+        muladd_fmatrix_fvector(to, block->m, fLongVector[block->c]);
+      }
+      if (block->c == (int)i) {
         /* This is the lower triangle of the sparse matrix,
          * therefore multiplication occurs with transposed submatrices. */
-        muladd_fmatrixT_fvector(to[from[i].c], from[i].m, fLongVector[from[i].r]);
-      }
-    }
-#  pragma omp section
-    {
-      for (unsigned int i = 0; i < from[0].vcount + from[0].scount; i++) {
-        muladd_fmatrix_fvector(temp[from[i].r], from[i].m, fLongVector[from[i].c]);
+        muladd_fmatrixT_fvector(to, block->m, fLongVector[block->r]);
       }
     }
   }
-  add_lfvector_lfvector(to, to, temp, from[0].vcount);
+}
 
-  del_lfvector(temp);
+/* SPARSE SYMMETRIC multiply big matrix with long vector*/
+/* STATUS: verified */
+DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3],
+                                     fmatrix3x3 *from,
+                                     lfVector *fLongVector,
+                                     const BlockAdjacency *adjacency)
+{
+  MulBFMatrixData data = {to, from, fLongVector, adjacency};
+  lfvector_parallel_chunks(from[0].vcount, &data, mul_bfmatrix_lfvector_chunk);
 }
 
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
@@ -683,6 +819,8 @@ typedef struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+
+  BlockAdjacency adjacency; /* off-diagonal blocks per vertex, for matrix products */
 } Implicit_Data;
 
 Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
@@ -708,6 +846,11 @@ Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
   id->dV = create_lfvector(numverts);
   id->z = create_lfvector(numverts);
 
+  id->adjacency.vert_offsets = MEM_callocN(sizeof(int) * (numverts + 1),
+                                           "cloth_implicit_adjacency");
+  id->adjacency.blocks = MEM_callocN(sizeof(int) * max_ii(2 * numsprings, 1),
+                                     "cloth_implicit_adjacency");
+
   initdiag_bfmatrix(id->bigI, I);
 
   return id;
@@ -734,6 +877,9 @@ void SIM_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->dV);
   del_lfvector(id->z);
 
+  MEM_freeN(id->adjacency.vert_offsets);
+  MEM_freeN(id->adjacency.blocks);
+
   MEM_freeN(id);
 }
 
@@ -771,15 +917,31 @@ BLI_INLINE void root_to_world_m3(Implicit_Data *data,
 
 /* ================================ */
 
-DO_INLINE void filter(lfVector *V, fmatrix3x3 *S)
+typedef struct FilterData {
+  lfVector *V;
+  fmatrix3x3 *S;
+} FilterData;
+
+static void filter_chunk(void *__restrict userdata,
+                         const int chunk,
+                         const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  unsigned int i = 0;
+  FilterData *data = userdata;
+  fmatrix3x3 *S = data->S;
+  unsigned int start, end;
 
-  for (i = 0; i < S[0].vcount; i++) {
-    mul_m3_v3(S[i].m, V[S[i].r]);
+  lfvector_chunk_range(chunk, S[0].vcount, &start, &end);
+  for (unsigned int i = start; i < end; i++) {
+    mul_m3_v3(S[i].m, data->V[S[i].r]);
   }
 }
 
+DO_INLINE void filter(lfVector *V, fmatrix3x3 *S)
+{
+  FilterData data = {V, S};
+  lfvector_parallel_chunks(S[0].vcount, &data, filter_chunk);
+}
+
 /* this version of the CG algorithm does not work very well with partial constraints
  * (where S has non-zero elements). */
 #  if 0
@@ -855,6 +1017,7 @@ static int cg_filtered(lfVector *ldV,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
+                       const BlockAdjacency *adjacency,
                        ImplicitSolverResult *result)
 {
   /* Solves for unknown X in equation AX=B */
@@ -879,7 +1042,7 @@ static int cg_filtered(lfVector *ldV,
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
   /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
+  mul_bfmatrix_lfvector(AdV, lA, ldV, adjacency);
   sub_lfvector_lfvector(r, lB, AdV, numverts);
   filter(r, S);
 
@@ -902,7 +1065,7 @@ static int cg_filtered(lfVector *ldV,
 #  endif
 
   while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
+    mul_bfmatrix_lfvector(q, lA, c, adjacency);
     filter(q, S);
 
     alpha = delta_new / dot_lfvector(c, q, numverts);
@@ -1162,7 +1325,10 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  /* All matrices share the blocks added while computing the forces. */
+  block_adjacency_build(&data->adjacency, data->dFdX, data->num_blocks);
+
+  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V, &data->adjacency);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1171,7 +1337,7 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 #  endif
 
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  cg_filtered(data->dV, data->A, data->B, data->z, data->S, &data->adjacency, result);
 
   // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 